@@ -772,7 +772,7 @@ BaseType_t xSendEventStructToIPTask( const IPStackEvent_t *pxEvent, TickType_t x
  */
 NetworkBufferDescriptor_t *pxUDPPayloadBuffer_to_NetworkBuffer( void *pvBuffer );
 
-#if( ipconfigZERO_COPY_TX_DRIVER != 0 )
+#if( ipconfigZERO_COPY_TX_DRIVER != 0 ) || ( ipconfigZERO_COPY_RX_DRIVER != 0 )
 	/*
 	 * For the case where the network driver passes a buffer directly to a DMA
 	 * descriptor, this function can be used to translate a 'network buffer' to
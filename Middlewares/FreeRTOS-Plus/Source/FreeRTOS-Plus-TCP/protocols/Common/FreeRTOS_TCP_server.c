@@ -94,6 +94,7 @@ SocketSet_t xSocketSet;
 			memset( pxServer, '\0', xSize );
 			pxServer->xServerCount = xCount;
 			pxServer->xSocketSet = xSocketSet;
+			pxServer->xSelectTimeout = portMAX_DELAY;
 
 			for( xIndex = 0; xIndex < xCount; xIndex++ )
 			{
@@ -260,9 +261,17 @@ TCPClient_t **ppxClient;
 BaseType_t xIndex;
 BaseType_t xRc;
 TickType_t xTimeOut = xTaskGetTickCount();
+TickType_t xSelectTime = xBlockingTime;
+
+	/* Clients of the previous cycle could ask for an earlier wake-up */
+	if( pxServer->xSelectTimeout < xSelectTime )
+	{
+		xSelectTime = pxServer->xSelectTimeout;
+	}
+	pxServer->xSelectTimeout = portMAX_DELAY;
 
 	/* Let the server do one working cycle */
-	xRc = FreeRTOS_select( pxServer->xSocketSet, xBlockingTime );
+	xRc = FreeRTOS_select( pxServer->xSocketSet, xSelectTime );
 
 	if( xRc != 0 )
 	{
@@ -381,6 +390,15 @@ TickType_t xTimeOut = xTaskGetTickCount();
 }
 /*-----------------------------------------------------------*/
 
+void FreeRTOS_TCPServerWakeUp( TCPServer_t *pxServer, TickType_t xTicks )
+{
+	if( xTicks < pxServer->xSelectTimeout )
+	{
+		pxServer->xSelectTimeout = xTicks;
+	}
+}
+/*-----------------------------------------------------------*/
+
 static char *strnew( const char *pcString )
 {
 BaseType_t xLength;
@@ -27,6 +27,7 @@
 
 /* Application includes. */
 #include "httpserver-netconn.h"
+#include "UDP_logging.h"
 
 /* Constants -----------------------------------------------------------------*/
 /* Time constants */
@@ -34,6 +35,11 @@
 	#define HTTP_SHUTDOWN_DELAY 		3000
 #endif // HTTP_SHUTDOWN_DELAY
 
+/* Maximum number of requests per connection (it is closed after the last) */
+#ifndef HTTP_KEEP_ALIVE_MAX_REQUESTS
+	#define HTTP_KEEP_ALIVE_MAX_REQUESTS	20
+#endif /*HTTP_KEEP_ALIVE_MAX_REQUESTS*/
+
 #ifndef HTTP_WAIT_FOR_SOCKET_CLOSING_DELAY
 	#define HTTP_WAIT_FOR_SOCKET_CLOSING_DELAY 2000
 #endif /*HTTP_WAIT_FOR_SOCKET_CLOSING_DELAY*/
@@ -42,6 +48,45 @@
 	#define HTTP_ATTACK_BLOCK_TIMEOUT 	1000
 #endif // HTTP_ATTACK_BLOCK_TIMEOUT
 
+/* Requests rate limit of one client: burst of requests and rate of their
+restoring (requests per second), the next requests wait in the socket */
+#ifndef HTTP_RATE_LIMIT_BURST
+	#define HTTP_RATE_LIMIT_BURST		30
+#endif /*HTTP_RATE_LIMIT_BURST*/
+
+#ifndef HTTP_RATE_LIMIT_PER_SECOND
+	#define HTTP_RATE_LIMIT_PER_SECOND	10
+#endif /*HTTP_RATE_LIMIT_PER_SECOND*/
+
+#define HTTP_RATE_LIMIT_PERIOD		pdMS_TO_TICKS(1000 / HTTP_RATE_LIMIT_PER_SECOND)
+
+/* Maximum number of connections from one IP-address (0 - no limit), so one
+client could not take all connections of the server */
+#ifndef HTTP_MAX_CLIENT_CONNECTIONS
+	#define HTTP_MAX_CLIENT_CONNECTIONS	3
+#endif /*HTTP_MAX_CLIENT_CONNECTIONS*/
+
+/* Size of the reply header part of "pcFileBuffer", the rest of the buffer is
+used for the contents (see GetHTML_ContentBuffer) */
+#ifndef HTTP_REPLY_HEADER_MAX_LEN
+	#define HTTP_REPLY_HEADER_MAX_LEN	(384)
+#endif /*HTTP_REPLY_HEADER_MAX_LEN*/
+
+/* Minimal part of the file, which is read to the transmit stream (sector) */
+#ifndef HTTP_FILE_MIN_BLOCK
+	#define HTTP_FILE_MIN_BLOCK			(512)
+#endif /*HTTP_FILE_MIN_BLOCK*/
+
+/* Cache lifetime of static assets (s), they are revalidated with ETag after */
+#ifndef HTTP_STATIC_MAX_AGE
+	#define HTTP_STATIC_MAX_AGE			"86400"
+#endif /*HTTP_STATIC_MAX_AGE*/
+
+/* Maximum number of simultaneous event streams (each keeps a connection) */
+#ifndef HTTP_MAX_EVENT_STREAMS
+	#define HTTP_MAX_EVENT_STREAMS		2
+#endif /*HTTP_MAX_EVENT_STREAMS*/
+
 #ifndef HTTP_SERVER_BACKLOG
 	#define HTTP_SERVER_BACKLOG			(12)
 #endif
@@ -59,6 +104,11 @@
 	#define ipconfigHTTP_REQUEST_CHARACTER '?'
 #endif
 
+/* Request buffer keeps place for terminating zeros of URL, headers and body */
+#define HTTP_REQUEST_TERMINATORS		3
+
+#define HTTP_FORM_CONTENT_TYPE			"application/x-www-form-urlencoded"
+
 /* Debug options -------------------------------------------------------------*/
 //#define DEBUG_HTTP_SEND_NEG_RESULT
 
@@ -90,8 +140,31 @@ static TypeCouple_t pxTypeCouples[] =
 
 /* Variables -----------------------------------------------------------------*/
 static BaseType_t applyNetWorkSettingsAfterNetConnClose = pdFALSE;
+static BaseType_t applyFirmwareAfterNetConnClose = pdFALSE;
 static const char pcEmptyString[1] = {'\0'};
 
+/* Request headers used by the server and HTML-pages (others are skipped and
+do not take place in the request buffer) */
+static const char *const pcStoredHeaders[] =
+{
+	"Content-Type",
+	"Cookie",
+	"If-None-Match",
+	"Range",
+	"Accept-Encoding",
+};
+
+/* Connections accounting */
+static struct HTTP_ServerStats xServerStats;
+
+/* Task, which renders page now (its heap allocations are counted) */
+static TaskHandle_t xRenderTask = NULL;
+
+/* Event streams variables */
+static volatile uint32_t ulEventStreamCounter = 0;
+static Socket_t xEventStreamSignalSocket = NULL;
+static UBaseType_t uxEventStreamsNum = 0;
+
 /* Private function prototypes -----------------------------------------------*/
 /*_RB_ Need comment block, although fairly self evident. */
 #if (configUSE_FAT != 0)
@@ -109,13 +182,60 @@ static BaseType_t prvOpenURL_Internal(HTTPClient_t *pxClient);
 #if (configUSE_FAT != 0)
 static BaseType_t prvSendFile(HTTPClient_t *pxClient);
 #endif /*(configUSE_FAT != 0)*/
+static BaseType_t prvSendMemory(HTTPClient_t *pxClient);
+static BaseType_t prvGetRange(HTTPClient_t *pxClient, size_t uxSize,
+		size_t *puxStart, size_t *puxLength);
+static void prvSetRangeHeaders(HTTPClient_t *pxClient, BaseType_t xCode,
+		size_t uxSize, size_t uxStart);
 
 static BaseType_t prvSendReply(HTTPClient_t *pxClient, BaseType_t xCode,
 		BaseType_t chunked);
+static BaseType_t prvSendErrorReply(HTTPClient_t *pxClient, BaseType_t xCode);
+static void prvShutdown(HTTPClient_t *pxClient);
+static BaseType_t prvAcceptClient(HTTPClient_t *pxClient);
+static void prvUpdateRequestTokens(HTTPClient_t *pxClient);
+static void prvPauseReading(HTTPClient_t *pxClient, BaseType_t xPause);
+static void prvWaitForTokens(HTTPClient_t *pxClient);
+static BaseType_t prvReplyPending(HTTPClient_t *pxClient);
+static BaseType_t prvMatchETag(const char *pcTags, const char *pcETag);
+static BaseType_t prvAcceptEncoding(const char *pcCodings,
+		const char *pcCoding);
+static BaseType_t prvEventStreamWork(HTTPClient_t *pxClient);
+static void prvCountLatency(TickType_t xTicks);
+
+/* Request parser callbacks */
+static int prvOnMessageBegin(http_parser *pxParser);
+static int prvOnUrl(http_parser *pxParser, const char *pcAt, size_t uxLength);
+static int prvOnHeaderField(http_parser *pxParser,
+		const char *pcAt, size_t uxLength);
+static int prvOnHeaderValue(http_parser *pxParser,
+		const char *pcAt, size_t uxLength);
+static int prvOnHeadersComplete(http_parser *pxParser);
+static int prvOnBody(http_parser *pxParser, const char *pcAt, size_t uxLength);
+static int prvOnMessageComplete(http_parser *pxParser);
+
+static BaseType_t prvRequestAppend(HTTPClient_t *pxClient,
+		const char *pcData, size_t uxLength);
+static void prvRequestTerminateUrl(HTTPClient_t *pxClient);
+static void prvRequestJoinForm(HTTPClient_t *pxClient);
+static void prvReverse(char *pcData, size_t uxLength);
+static BaseType_t prvGetCommand(unsigned int uxMethod);
+
+static const http_parser_settings xParserSettings =
+{
+	.on_message_begin = prvOnMessageBegin,
+	.on_url = prvOnUrl,
+	.on_header_field = prvOnHeaderField,
+	.on_header_value = prvOnHeaderValue,
+	.on_headers_complete = prvOnHeadersComplete,
+	.on_body = prvOnBody,
+	.on_message_complete = prvOnMessageComplete,
+};
 
-static BaseType_t CheckForAllowTCP_Transmission();
-static void UpdateTCP_TransmissionTimeout(BaseType_t xRc);
-static void ResetTCP_TransmissionTimeout();
+static BaseType_t CheckForAllowTCP_Transmission(HTTPClient_t *pxClient);
+static void UpdateTCP_TransmissionTimeout(HTTPClient_t *pxClient,
+		BaseType_t xRc);
+static void ResetTCP_TransmissionTimeout(HTTPClient_t *pxClient);
 static BaseType_t FreeRTOS_SendWithWaiting(Socket_t xSocket,
 		const void *pvBuffer, size_t uxDataLength);
 
@@ -123,131 +243,136 @@ static BaseType_t FreeRTOS_SendWithWaiting(Socket_t xSocket,
 BaseType_t xHTTPClientWork(TCPClient_t *pxTCPClient)
 {
 BaseType_t xRc;
+BaseType_t xReceived = 0;
 HTTPClient_t *pxClient = (HTTPClient_t *) pxTCPClient;
 
 #if (configUSE_FAT != 0)
 	if(pxClient->pxFileHandle != NULL)
 	{
-		prvSendFile(pxClient);
-	}
-#endif /*(configUSE_FAT != 0)*/
-
-	if(pxClient->xLastRecSuccessfulTime == 0)
-	{
-		/* It is new HTTP client: set receive successful time */
-		pxClient->xLastRecSuccessfulTime = xTaskGetTickCount();
+		/* File could not be read: the reply is broken */
+		if(prvSendFile(pxClient) < 0) return (-1);
 
-		/* Clear pcCommandBuffer (use it as flag for complete HTTP request) */
-		pcCOMMAND_BUFFER[0] = '\0';
+		/* Pipelined requests wait for the end of the file, the rest of it
+		is sent on eSELECT_WRITE events */
+		if(pxClient->pxFileHandle != NULL)
+		{
+			prvPauseReading(pxClient, pdTRUE);
+			return 0;
+		}
 	}
+#endif /*(configUSE_FAT != 0)*/
 
-	BaseType_t last_xRc = 0;
-	if(pcCOMMAND_BUFFER[0] != '\0')
+	if(pxClient->pucSendData != NULL)
 	{
-		/* Previous HTTP request was not valid or is not complete:
-		try to proceed receive. Search for end of "pcCommandBuffer" */
-		for(last_xRc = 1;
-			last_xRc < (BaseType_t)(sizeof(pcCOMMAND_BUFFER)); last_xRc++)
+		if(prvSendMemory(pxClient) < 0) return (-1);
+		if(pxClient->pucSendData != NULL)
 		{
-			if(pcCOMMAND_BUFFER[last_xRc] == '\0') break;
+			prvPauseReading(pxClient, pdTRUE);
+			return 0;
 		}
 	}
 
-	if((last_xRc != 0) && (last_xRc < (BaseType_t)(sizeof(pcCOMMAND_BUFFER))))
+	/* Event stream clients only receive events */
+	if(pxClient->bits.bEventStream)
 	{
-		xRc = FreeRTOS_recv(pxClient->xSocket,
-				(void *)(&pcCOMMAND_BUFFER[last_xRc]),
-				sizeof(pcCOMMAND_BUFFER) - last_xRc, 0);
-
-		if(xRc > 0)
-		{
-			/* Add last received data length */
-			xRc += last_xRc;
-		}
+		prvPauseReading(pxClient, pdFALSE);
+		return prvEventStreamWork(pxClient);
 	}
-	else
+
+	/* Connection is closing: wait for the client to get the last reply */
+	if(pxClient->request.bShutdown)
 	{
+		prvPauseReading(pxClient, pdFALSE);
 		xRc = FreeRTOS_recv(pxClient->xSocket, (void *)pcCOMMAND_BUFFER,
 				sizeof(pcCOMMAND_BUFFER), 0);
+		if(	(xRc < 0) || ((xTaskGetTickCount() -
+			pxClient->xLastRecSuccessfulTime) >
+				HTTP_WAIT_FOR_SOCKET_CLOSING_DELAY)) return (-1);
+		return 0;
 	}
 
-	if(xRc > 0)
+	if(pxClient->xLastRecSuccessfulTime == 0)
 	{
-	BaseType_t xIndex;
-	const char *pcEndOfCmd;
-	const struct xWEB_COMMAND *curCmd;
-	char *pcBuffer = pcCOMMAND_BUFFER;
-
-		/* Update last receive successful time and reset transmission timeout */
+		/* It is new HTTP client: set receive successful time */
 		pxClient->xLastRecSuccessfulTime = xTaskGetTickCount();
-		ResetTCP_TransmissionTimeout();
+		ResetTCP_TransmissionTimeout(pxClient);
 
-		if(xRc < (BaseType_t) sizeof(pcCOMMAND_BUFFER))
-		{
-			pcBuffer[xRc] = '\0';
-		}
-		while(xRc && (pcBuffer[xRc - 1] == 13 || pcBuffer[xRc - 1] == 10))
+		/* Requests of the client are parsed as they come */
+		http_parser_init(&pxClient->xParser, HTTP_REQUEST);
+		pxClient->xParser.data = pxClient;
+
+		if(prvAcceptClient(pxClient) == pdFALSE) return 0;
+	}
+
+	/* Reply to the previous request is sent: continue with the next one, if
+	the client does not exceed its requests rate */
+	prvUpdateRequestTokens(pxClient);
+	if(HTTP_PARSER_ERRNO(&pxClient->xParser) == HPE_PAUSED)
+	{
+		if(pxClient->usRequestTokens == 0)
 		{
-			pcBuffer[--xRc] = '\0';
+			prvWaitForTokens(pxClient);
+			return 0;
 		}
-		pcEndOfCmd = pcBuffer + xRc;
+		http_parser_pause(&pxClient->xParser, 0);
+	}
+	prvPauseReading(pxClient, pdFALSE);
 
-		curCmd = xWebCommands;
+	/* Data are parsed in place in the receive stream of the socket and only
+	parsed data are released: pipelined requests, which follow paused one, stay
+	in the socket until the reply to the previous request is sent (the rest of
+	data, wrapped to the beginning of the stream, is got with the next round) */
+	for(;;)
+	{
+	char *pcData;
+	size_t uxParsed;
 
-		/* Pointing to "/index.html HTTP/1.1". */
-		pxClient->pcUrlData = pcBuffer;
+		xRc = FreeRTOS_recv(pxClient->xSocket, (void *)&pcData, 0,
+				FREERTOS_ZERO_COPY);
+		if(xRc <= 0) break;
+		xReceived += xRc;
+		xServerStats.bytesReceived += xRc;
 
-		/* Pointing to "HTTP/1.1". */
-		pxClient->pcRestData = pcEmptyString;
+		/* Update last receive successful time and reset transmission timeout */
+		pxClient->xLastRecSuccessfulTime = xTaskGetTickCount();
+		ResetTCP_TransmissionTimeout(pxClient);
 
-		/* Last entry is "ECMD_UNK". */
-		for(xIndex = 0; xIndex < WEB_CMD_COUNT - 1; xIndex++, curCmd++)
-		{
-		BaseType_t xLength;
+		/* Parser keeps its state between segments, requests are processed
+		from "on_message_complete" one by one */
+		pxClient->xRequestResult = 0;
+		uxParsed = http_parser_execute(&pxClient->xParser, &xParserSettings,
+				pcData, xRc);
+		if(uxParsed) FreeRTOS_recv(pxClient->xSocket, NULL, uxParsed, 0);
 
-			xLength = curCmd->xCommandLength;
-			if(	(xRc >= xLength) &&
-				(memcmp(curCmd->pcCommandName, pcBuffer, xLength) == 0))
-			{
-			char *pcLastPtr;
+		/* Reply is not sent: close the connection */
+		if(pxClient->xRequestResult < 0) return pxClient->xRequestResult;
 
-				pxClient->pcUrlData += xLength + 1;
-				for(pcLastPtr = (char*)pxClient->pcUrlData;
-					pcLastPtr < pcEndOfCmd; pcLastPtr++)
-				{
-					char ch = *pcLastPtr;
-					if((ch == '\0') || (strchr("\n\r \t", ch) != NULL))
-					{
-						*pcLastPtr = '\0';
-						pxClient->pcRestData = pcLastPtr + 1;
-						break;
-					}
-				}
-				break;
-			}
-		}
-
-		if(xIndex < (WEB_CMD_COUNT - 1))
+		if(HTTP_PARSER_ERRNO(&pxClient->xParser) == HPE_PAUSED) break;
+		if(HTTP_PARSER_ERRNO(&pxClient->xParser) != HPE_OK)
 		{
-			/* Check for valid HTTP request */
-			if(pxClient->pcRestData == pcEmptyString)
-			{
-				/* HTTP request is not valid or is not complete:
-				try to proceed receive */
-				return xRc;
-			}
-
-			xRc = prvProcessCmd(pxClient, xIndex);
+			FreeRTOS_printf(("xHTTPClientWork: %s\n",
+				http_errno_name(HTTP_PARSER_ERRNO(&pxClient->xParser))));
+
+			/* Request is not valid: reply and close the connection */
+			pxClient->request.bCloseConnection = pdTRUE_UNSIGNED;
+			prvSendErrorReply(pxClient, WEB_BAD_REQUEST);
+			prvShutdown(pxClient);
+			break;
 		}
 	}
-	else if(xRc < 0)
+
+	/* Pipelined requests wait in the socket until the reply is sent and
+	until the client gets the next request token */
+	if(prvReplyPending(pxClient)) prvPauseReading(pxClient, pdTRUE);
+	if(pxClient->usRequestTokens == 0) prvWaitForTokens(pxClient);
+
+	if(xRc < 0)
 	{
 		/* The connection will be closed and the client will be deleted. */
 		FreeRTOS_printf(("xHTTPClientWork: rc = %ld\n", xRc));
+		return xRc;
 	}
-
-	/* Clear pcCommandBuffer (use it as flag for complete HTTP request) */
-	pcCOMMAND_BUFFER[0] = '\0';
+	xRc = xReceived;
 
 	/* Service zero FreeRTOS_recv return */
 	if(xRc == 0)
@@ -257,7 +382,7 @@ HTTPClient_t *pxClient = (HTTPClient_t *) pxTCPClient;
 					HTTP_SHUTDOWN_DELAY) xRc = (-1);
 
 		/* Check for allowed transmission before the sending of data */
-		if(CheckForAllowTCP_Transmission() == pdFALSE) xRc = (-1);
+		if(CheckForAllowTCP_Transmission(pxClient) == pdFALSE) xRc = (-1);
 
 		if(xRc < 0)
 		{
@@ -290,6 +415,12 @@ HTTPClient_t *pxClient = (HTTPClient_t *) pxTCPClient;
 	prvFileClose(pxClient);
 #endif /*(configUSE_FAT != 0)*/
 
+	if(pxClient->bits.bEventStream)
+	{
+		pxClient->bits.bEventStream = pdFALSE_UNSIGNED;
+		if(uxEventStreamsNum) uxEventStreamsNum--;
+	}
+
 	if(applyNetWorkSettingsAfterNetConnClose)
 	{
 		/* Reinit net interface */
@@ -298,6 +429,13 @@ HTTPClient_t *pxClient = (HTTPClient_t *) pxTCPClient;
 
 		applyNetWorkSettingsAfterNetConnClose = pdFALSE;
 	}
+
+	if(applyFirmwareAfterNetConnClose)
+	{
+		/* Replace firmware (MCU is reset) */
+		applyFirmwareAfterNetConnClose = pdFALSE;
+		WebServerApplyFirmware();
+	}
 }
 /*-----------------------------------------------------------*/
 
@@ -306,71 +444,244 @@ void HTTP_ServerApplyNetworkSettingsAfterNetConnClose()
 	applyNetWorkSettingsAfterNetConnClose = pdTRUE;
 }
 
+void HTTP_ServerApplyFirmwareAfterNetConnClose()
+{
+	applyFirmwareAfterNetConnClose = pdTRUE;
+}
+
+const struct HTTP_ServerStats* HTTP_ServerGetStats()
+{
+	return &xServerStats;
+}
+
+void HTTP_ServerTraceMalloc()
+{
+	/* Called by heap for every allocation (traceMALLOC) */
+	if((xRenderTask != NULL) && (xTaskGetCurrentTaskHandle() == xRenderTask))
+		xServerStats.renderHeapAllocs++;
+}
+
 BaseType_t SendHTML_Header_OK(HTTPClient_t *pxClient)
 {
 	return prvSendReply(pxClient, WEB_REPLY_OK, pdTRUE);
 }
 
+BaseType_t SendHTML_Header_OK_Type(HTTPClient_t *pxClient,
+		const char *pcContentsType)
+{
+	SetValue(pcContentsType, pxClient->pxParent->pcContentsType,
+			sizeof(pxClient->pxParent->pcContentsType));
+	return prvSendReply(pxClient, WEB_REPLY_OK, pdTRUE);
+}
+
 BaseType_t SendHTML_Header_RedirectToRoot(HTTPClient_t *pxClient,
-		char* key, uint16_t lenght)
+		const char *pcCookie)
 {
-	char* pTmpStrPrc;
-	char* pLastTmpStrPrc;
-	uint16_t tmpStrFreeLng;
+	BaseType_t xLength;
 
-	/* Init pointers and length */
-	pTmpStrPrc = pxClient->pxParent->pcExtraContents;
-	pLastTmpStrPrc = pTmpStrPrc;
-	tmpStrFreeLng = sizeof(pxClient->pxParent->pcExtraContents);
-	if(key != NULL)
+	if(pcCookie != NULL)
 	{
-		pTmpStrPrc = SetValue("Location: /;key=", pTmpStrPrc, tmpStrFreeLng);
-		/* Correct pointers and length */
-		pLastTmpStrPrc = pTmpStrPrc;
-		tmpStrFreeLng -= (pLastTmpStrPrc - pTmpStrPrc);
-
-		if(tmpStrFreeLng < lenght)
+		/* Cookie is set with the redirection (session of the client) */
+		xLength = snprintf(pxClient->pxParent->pcExtraContents,
+				sizeof(pxClient->pxParent->pcExtraContents),
+				"Set-Cookie: %s\r\nLocation: /\r\n", pcCookie);
+		if(xLength >= (BaseType_t) sizeof(pxClient->pxParent->pcExtraContents))
 		{
-			/* It is not enough string length */
+			/* Truncated header must not be sent */
+			pxClient->pxParent->pcExtraContents[0] = '\0';
 			return -1;
 		}
-
-		pTmpStrPrc = SetValue(key, pTmpStrPrc, lenght);
-		/* Correct pointers and length */
-		pLastTmpStrPrc = pTmpStrPrc;
-		tmpStrFreeLng -= (pLastTmpStrPrc - pTmpStrPrc);
-
-		SetValue("/\r\n", pTmpStrPrc, tmpStrFreeLng);
 	}
 	else
 	{
-		/* Redirect to root directory without a key */
-		SetValue("Location: /", pTmpStrPrc, tmpStrFreeLng);
+		/* Redirect to root directory only */
+		SetValue("Location: /\r\n", pxClient->pxParent->pcExtraContents,
+				sizeof(pxClient->pxParent->pcExtraContents));
 	}
 
 	return prvSendReply(pxClient, WEB_REDIRECT, pdTRUE);
 }
 
+BaseType_t SendHTML_Header_EventStream(HTTPClient_t *pxClient)
+{
+	BaseType_t xIndex;
+
+	if(pxClient->request.bHeadOnly)
+	{
+		/* Client is not subscribed, it gets the header only */
+		strcpy(pxClient->pxParent->pcContentsType, "text/event-stream");
+		return prvSendReply(pxClient, WEB_REPLY_OK, pdTRUE);
+	}
+
+	if(uxEventStreamsNum >= HTTP_MAX_EVENT_STREAMS)
+	{
+		/* All event streams are busy */
+		prvSendReply(pxClient, WEB_SERVICE_UNAVAILABLE, pdTRUE);
+		return SendHTML_Block(pxClient, "", 0);
+	}
+
+	/* Listening socket of the server is used to wake it up on new event */
+	for(xIndex = 0; xIndex < pxClient->pxParent->xServerCount; xIndex++)
+	{
+		if(pxClient->pxParent->xServers[xIndex].eType == eSERVER_HTTP)
+		{
+			xEventStreamSignalSocket =
+					pxClient->pxParent->xServers[xIndex].xSocket;
+			break;
+		}
+	}
+
+	/* Subscribe client: the first event is sent with the next work cycle */
+	uxEventStreamsNum++;
+	pxClient->bits.bEventStream = pdTRUE_UNSIGNED;
+	pxClient->ulEventStreamCounter = ulEventStreamCounter - 1;
+	pxClient->ulEventStreamState = 0;
+
+	strcpy(pxClient->pxParent->pcContentsType, "text/event-stream");
+	return prvSendReply(pxClient, WEB_REPLY_OK, pdTRUE);
+}
+
+void HTTP_ServerEventStreamSignal()
+{
+	ulEventStreamCounter++;
+
+	/* Wake up server task, if anybody is subscribed */
+#if(ipconfigSUPPORT_SIGNALS != 0)
+	if(uxEventStreamsNum && (xEventStreamSignalSocket != NULL))
+		FreeRTOS_SignalSocket(xEventStreamSignalSocket);
+#endif /*(ipconfigSUPPORT_SIGNALS != 0)*/
+}
+
 BaseType_t SendHTML_Header_404(HTTPClient_t *pxClient)
 {
 	return prvSendReply(pxClient, WEB_NOT_FOUND, pdTRUE);
 }
 
+BaseType_t SendHTML_Header_405(HTTPClient_t *pxClient)
+{
+	return prvSendReply(pxClient, WEB_METHOD_NOT_ALLOWED, pdTRUE);
+}
+
+char* GetHTML_ContentBuffer(HTTPClient_t *pxClient, size_t *puxSize)
+{
+	*puxSize = sizeof(pcFILE_BUFFER) - HTTP_REPLY_HEADER_MAX_LEN;
+	return &pcFILE_BUFFER[HTTP_REPLY_HEADER_MAX_LEN];
+}
+
+const char* GetHTML_RequestBody(HTTPClient_t *pxClient)
+{
+	/* Body is collected by the parser (form is joined to URL parameters) */
+	if(pxClient->usBodyPos == 0) return pcEmptyString;
+	return &pxClient->pcRequest[pxClient->usBodyPos];
+}
+void* GetHTML_Scratch(HTTPClient_t *pxClient, size_t uxSize)
+{
+	/* Blocks are aligned to words */
+	size_t uxWords = (uxSize + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+	size_t uxUsed = pxClient->usScratchUsed;
+	size_t uxBytes;
+
+	if(uxWords > sizeof(pxClient->pulScratch) / sizeof(uint32_t) - uxUsed)
+	{
+		xServerStats.scratchFailures++;
+		return NULL;
+	}
+
+	pxClient->usScratchUsed = uxUsed + uxWords;
+	uxBytes = pxClient->usScratchUsed * sizeof(uint32_t);
+	if(uxBytes > xServerStats.scratchPeak) xServerStats.scratchPeak = uxBytes;
+	return &pxClient->pulScratch[uxUsed];
+}
+void ReleaseHTML_Scratch(HTTPClient_t *pxClient, void *pvBlock)
+{
+	uint32_t *pulBlock = (uint32_t *) pvBlock;
+
+	/* Blocks after the released one are released too */
+	if(	(pulBlock >= pxClient->pulScratch) &&
+		(pulBlock < &pxClient->pulScratch[pxClient->usScratchUsed]))
+	{
+		pxClient->usScratchUsed = pulBlock - pxClient->pulScratch;
+	}
+}
+char* GetHTML_RequestQuery(HTTPClient_t *pxClient)
+{
+	char *pcQuery;
+
+	/* URL is the first string of the request buffer, parameters may be
+	decoded in place */
+	if(pxClient->pcUrlData != pxClient->pcRequest) return NULL;
+	pcQuery = strchr(pxClient->pcRequest, '?');
+	if(pcQuery == NULL) return NULL;
+	return pcQuery + 1;
+}
+const char* GetHTML_RequestHeader(HTTPClient_t *pxClient, const char *pcName)
+{
+	const char *pcPtr;
+	size_t uxLength = strlen(pcName);
+
+	/* Stored headers are "\r\nName: value" lines (see prvOnHeaderField) */
+	for(pcPtr = strchr(pxClient->pcRestData, '\n'); pcPtr != NULL;
+		pcPtr = strchr(pcPtr + 1, '\n'))
+	{
+		if((strncasecmp(pcPtr + 1, pcName, uxLength) == 0) &&
+			(pcPtr[uxLength + 1] == ':'))
+		{
+			for(pcPtr += uxLength + 2; *pcPtr == ' '; pcPtr++);
+			return pcPtr;
+		}
+	}
+
+	return NULL;
+}
+
+BaseType_t SendHTML_Content(HTTPClient_t *pxClient, BaseType_t xCode,
+		const char *pcContentsType, const void *pvBuffer, size_t uxDataLength)
+{
+	/* Check for allowed transmission before the sending of data */
+	if(CheckForAllowTCP_Transmission(pxClient) == pdFALSE) return (-1);
+
+	BaseType_t xRc;
+
+	SetValue(pcContentsType, pxClient->pxParent->pcContentsType,
+			sizeof(pxClient->pxParent->pcContentsType));
+	snprintf(pxClient->pxParent->pcExtraContents,
+			sizeof(pxClient->pxParent->pcExtraContents),
+			"Content-Length: %d\r\n", (int) uxDataLength);
+
+	xRc = prvSendReply(pxClient, xCode, pdFALSE);
+	if((xRc >= 0) && uxDataLength && !pxClient->request.bHeadOnly)
+	{
+		xRc = FreeRTOS_SendWithWaiting(pxClient->xSocket,
+				pvBuffer, uxDataLength);
+		UpdateTCP_TransmissionTimeout(pxClient, xRc);
+	}
+
+	return xRc;
+}
+
 BaseType_t SendHTML_Block(HTTPClient_t *pxClient,
 		const void *pvBuffer, size_t uxDataLength)
 {
 	/* Check for allowed transmission before the sending of data */
-	if(CheckForAllowTCP_Transmission() == pdFALSE) return (-1);
+	if(CheckForAllowTCP_Transmission(pxClient) == pdFALSE) return (-1);
 
 	BaseType_t xRc;
 	char tmpStr[5];
 
+	if(pxClient->request.bHeadOnly)
+	{
+		/* Body is not sent to HEAD request, but it is counted as sent (pages
+		return the result of the last block) */
+		return (uxDataLength) ? (BaseType_t) uxDataLength :
+				(BaseType_t) sizeof("0\r\n\r\n") - 1;
+	}
+
 	if(uxDataLength == 0)
 	{
 		// Send last empty block
 		xRc = FreeRTOS_SendWithWaiting(pxClient->xSocket,
 				"0\r\n\r\n", sizeof("0\r\n\r\n") - 1);
-		UpdateTCP_TransmissionTimeout(xRc);
+		UpdateTCP_TransmissionTimeout(pxClient, xRc);
 
 		return xRc;
 	}
@@ -392,7 +703,7 @@ BaseType_t SendHTML_Block(HTTPClient_t *pxClient,
 		xRc = FreeRTOS_SendWithWaiting(pxClient->xSocket,
 				"\r\n", 	sizeof("\r\n") - 1);
 
-	UpdateTCP_TransmissionTimeout(xRc);
+	UpdateTCP_TransmissionTimeout(pxClient, xRc);
 	return xRc;
 }
 
@@ -410,8 +721,110 @@ static void prvFileClose(HTTPClient_t *pxClient)
 /*-----------------------------------------------------------*/
 
 __attribute__((weak)) void WebServerApplyNetworkSettings() {}
+__attribute__((weak)) void WebServerApplyFirmware() {}
+
+__attribute__((weak)) FHTTPBodyFunction HTTP_GetBodyHandler(
+		HTTPClient_t *pxClient)
+{
+	/* Remove compiler warning about unused parameter. */
+	(void) pxClient;
+
+	/* Bodies are stored in the request buffer */
+	return NULL;
+}
+
+__attribute__((weak)) BaseType_t HTTP_EventStreamWork(HTTPClient_t *pxClient)
+{
+	/* Send comment to keep connection alive */
+	return SendHTML_Block(pxClient, ":\n\n", sizeof(":\n\n") - 1);
+}
 
 /* Private functions ---------------------------------------------------------*/
+BaseType_t SendHTML_StaticAsset(HTTPClient_t *pxClient,
+		const struct HTTP_StaticAsset *pxAsset)
+{
+	/* Check for allowed transmission before the sending of data */
+	if(CheckForAllowTCP_Transmission(pxClient) == pdFALSE) return (-1);
+
+	BaseType_t xRc;
+	BaseType_t xCode = WEB_REPLY_OK;
+	/* Caches keep the compressed asset for the clients, which accept it */
+	const char *pcVary = pxAsset->gzip ? "Vary: Accept-Encoding\r\n" : "";
+
+	/* Asset is stored compressed only: the client, which does not accept
+	gzip, could not read it */
+	if(	pxAsset->gzip && (prvAcceptEncoding(GetHTML_RequestHeader(pxClient,
+			"Accept-Encoding"), "gzip") == pdFALSE))
+	{
+		snprintf(pxClient->pxParent->pcExtraContents,
+				sizeof(pxClient->pxParent->pcExtraContents),
+				"%sContent-Length: 0\r\n", pcVary);
+		return prvSendReply(pxClient, WEB_NOT_ACCEPTABLE, pdFALSE);
+	}
+
+	/* Client has valid copy of the asset, if it sends the same ETag */
+	if(prvMatchETag(GetHTML_RequestHeader(pxClient, "If-None-Match"),
+			pxAsset->etag))
+	{
+		xCode = WEB_NOT_MODIFIED;
+	}
+
+	SetValue(pxAsset->contentType, pxClient->pxParent->pcContentsType,
+			sizeof(pxClient->pxParent->pcContentsType));
+	if(xCode == WEB_REPLY_OK)
+	{
+		snprintf(pxClient->pxParent->pcExtraContents,
+				sizeof(pxClient->pxParent->pcExtraContents),
+				"ETag: %s\r\n%s%sContent-Length: %d\r\n",
+				pxAsset->etag,
+				pxAsset->gzip ? "Content-Encoding: gzip\r\n" : "",
+				pcVary, (int) pxAsset->size);
+	}
+	else
+	{
+		/* Reply without body */
+		snprintf(pxClient->pxParent->pcExtraContents,
+				sizeof(pxClient->pxParent->pcExtraContents),
+				"ETag: %s\r\n%s", pxAsset->etag, pcVary);
+	}
+	pxClient->bits.bCacheable = pdTRUE_UNSIGNED;
+
+	xRc = prvSendReply(pxClient, xCode, pdFALSE);
+	if((xRc >= 0) && (xCode == WEB_REPLY_OK) && !pxClient->request.bHeadOnly)
+	{
+		/* Asset is sent directly from the flash */
+		xRc = FreeRTOS_SendWithWaiting(pxClient->xSocket,
+				pxAsset->data, pxAsset->size);
+		UpdateTCP_TransmissionTimeout(pxClient, xRc);
+	}
+
+	return xRc;
+}
+BaseType_t SendHTML_Memory(HTTPClient_t *pxClient,
+		const char *pcContentsType, const void *pvData, size_t uxSize)
+{
+	/* Check for allowed transmission before the sending of data */
+	if(CheckForAllowTCP_Transmission(pxClient) == pdFALSE) return (-1);
+
+	BaseType_t xRc;
+	BaseType_t xCode;
+	size_t uxStart;
+
+	/* Whole memory or its part ("Range: bytes=first-last") */
+	xCode = prvGetRange(pxClient, uxSize, &uxStart, &pxClient->uxBytesLeft);
+	SetValue(pcContentsType, pxClient->pxParent->pcContentsType,
+			sizeof(pxClient->pxParent->pcContentsType));
+	prvSetRangeHeaders(pxClient, xCode, uxSize, uxStart);
+	if(pxClient->request.bHeadOnly) pxClient->uxBytesLeft = 0;
+
+	xRc = prvSendReply(pxClient, xCode, pdFALSE);
+	if((xRc < 0) || (pxClient->uxBytesLeft == 0u)) return xRc;
+
+	/* Large contents do not block the server: the rest is sent with the next
+	work cycles */
+	pxClient->pucSendData = (const uint8_t *) pvData + uxStart;
+	return prvSendMemory(pxClient);
+}
 static BaseType_t prvSendReply(HTTPClient_t *pxClient, BaseType_t xCode,
 		BaseType_t chunked)
 {
@@ -421,95 +834,671 @@ BaseType_t xRc;
 	/* A normal command reply on the main socket (port 21). */
 	char *pcBuffer = pxParent->pcFileBuffer;
 
-	if(chunked == pdFALSE)
+	/* Only static contents could be cached by client */
+	const char *pcCacheControl = pxClient->bits.bCacheable ?
+			"Cache-Control: public, max-age=" HTTP_STATIC_MAX_AGE "\r\n" :
+			"Cache-Control: no-cache\r\nExpires: 0\r\n";
+	pxClient->bits.bCacheable = pdFALSE_UNSIGNED;
+
+	/* Connection is kept for the next requests, until their limit */
+	char pcConnection[64];
+	if(pxClient->request.bCloseConnection)
 	{
-		xRc = snprintf(pcBuffer, sizeof(pxParent->pcFileBuffer),
-			"HTTP/1.1 %d %s\r\n"
-			"Content-Type: %s\r\n"
-			"Connection: Keep-Alive\r\n"
-			"Keep-Alive: timeout=10, max=20\r\n"
-			"Allow: GET\r\n"
-			"Cache-Control: no-cache\r\n"
-			"Expires: 0\r\n"
-			"%s\r\n",
-			(int) xCode,
-			webCodename (xCode),
-			pxParent->pcContentsType[0] ?
-					pxParent->pcContentsType : "text/html",
-			pxParent->pcExtraContents);
+		strcpy(pcConnection, "Connection: close\r\n");
 	}
 	else
 	{
-		xRc = snprintf(pcBuffer, sizeof(pxParent->pcFileBuffer),
-			"HTTP/1.1 %d %s\r\n"
-			"Transfer-Encoding: chunked\r\n"
-			"Content-Type: %s\r\n"
+		snprintf(pcConnection, sizeof(pcConnection),
 			"Connection: Keep-Alive\r\n"
-			"Keep-Alive: timeout=10, max=20\r\n"
-			"Allow: GET\r\n"
-			"Cache-Control: no-cache\r\n"
-			"Expires: 0\r\n"
-			"%s\r\n",
-			(int) xCode,
-			webCodename (xCode),
-			pxParent->pcContentsType[0] ?
-					pxParent->pcContentsType : "text/html",
-			pxParent->pcExtraContents);
+			"Keep-Alive: timeout=%d, max=%d\r\n",
+			(int) (HTTP_SHUTDOWN_DELAY / 1000),
+			(int) (HTTP_KEEP_ALIVE_MAX_REQUESTS - pxClient->usRequestsNum));
 	}
 
+	xRc = snprintf(pcBuffer, HTTP_REPLY_HEADER_MAX_LEN,
+		"HTTP/1.1 %d %s\r\n"
+		"%s"
+		"Content-Type: %s\r\n"
+		"%s"
+		"Allow: GET, HEAD, POST, PUT\r\n"
+		"%s"
+		"%s\r\n",
+		(int) xCode,
+		webCodename (xCode),
+		chunked ? "Transfer-Encoding: chunked\r\n" : "",
+		pxParent->pcContentsType[0] ?
+				pxParent->pcContentsType : "text/html",
+		pcConnection,
+		pcCacheControl,
+		pxParent->pcExtraContents);
+
 	pxParent->pcContentsType[0] = '\0';
 	pxParent->pcExtraContents[0] = '\0';
 
+	/* Reply header could be truncated */
+	if(xRc >= HTTP_REPLY_HEADER_MAX_LEN) xRc = HTTP_REPLY_HEADER_MAX_LEN - 1;
+
 	xRc = FreeRTOS_SendWithWaiting(pxClient->xSocket,
 			(const void *) pcBuffer, xRc);
 	pxClient->bits.bReplySent = pdTRUE_UNSIGNED;
 
-	UpdateTCP_TransmissionTimeout(xRc);
+	UpdateTCP_TransmissionTimeout(pxClient, xRc);
 
 	return xRc;
 }
+
+static BaseType_t prvSendErrorReply(HTTPClient_t *pxClient, BaseType_t xCode)
+{
+	/* Reply without body */
+	return SendHTML_Content(pxClient, xCode, "text/html", NULL, 0);
+}
+
+static void prvShutdown(HTTPClient_t *pxClient)
+{
+	/* Socket is closed after sending of the queued data */
+	FreeRTOS_shutdown(pxClient->xSocket, FREERTOS_SHUT_RDWR);
+	pxClient->request.bShutdown = pdTRUE_UNSIGNED;
+	pxClient->xLastRecSuccessfulTime = xTaskGetTickCount();
+	http_parser_pause(&pxClient->xParser, 1);
+}
+
+static BaseType_t prvAcceptClient(HTTPClient_t *pxClient)
+{
+	struct freertos_sockaddr xAddress;
+	TCPClient_t *pxOther;
+	BaseType_t xConnections = 0;
+
+	FreeRTOS_GetRemoteAddress(pxClient->xSocket, &xAddress);
+	pxClient->ulClientIP = xAddress.sin_addr;
+
+	/* Requests rate limit starts with full burst */
+	pxClient->usRequestTokens = HTTP_RATE_LIMIT_BURST;
+	pxClient->xRequestTokensTime = xTaskGetTickCount();
+
+#if (HTTP_MAX_CLIENT_CONNECTIONS != 0)
+	/* Count connections of the same client (including this one) */
+	for(pxOther = pxClient->pxParent->pxClients; pxOther != NULL;
+		pxOther = pxOther->pxNextClient)
+	{
+		if(	(pxOther->eType == eSERVER_HTTP) &&
+			(((HTTPClient_t *) pxOther)->ulClientIP == pxClient->ulClientIP))
+		{
+			xConnections++;
+		}
+	}
+
+	if(xConnections > HTTP_MAX_CLIENT_CONNECTIONS)
+	{
+		/* Leave connections for other clients */
+		xServerStats.rejected++;
+		UDP_LOG_WARNING("HTTP: connection of 0x%08x rejected",
+				FreeRTOS_ntohl(pxClient->ulClientIP));
+		pxClient->request.bCloseConnection = pdTRUE_UNSIGNED;
+		prvSendErrorReply(pxClient, WEB_SERVICE_UNAVAILABLE);
+		prvShutdown(pxClient);
+		return pdFALSE;
+	}
+#else
+	(void) pxOther;
+	(void) xConnections;
+#endif /*(HTTP_MAX_CLIENT_CONNECTIONS != 0)*/
+
+	xServerStats.connections++;
+	return pdTRUE;
+}
+
+static void prvUpdateRequestTokens(HTTPClient_t *pxClient)
+{
+	const TickType_t xPeriod = HTTP_RATE_LIMIT_PERIOD;
+	TickType_t xElapsed = xTaskGetTickCount() - pxClient->xRequestTokensTime;
+	UBaseType_t uxTokens = xElapsed / xPeriod;
+
+	/* Restore requests of the client with the fixed rate */
+	if(uxTokens == 0) return;
+	pxClient->xRequestTokensTime += uxTokens * xPeriod;
+
+	uxTokens += pxClient->usRequestTokens;
+	if(uxTokens > HTTP_RATE_LIMIT_BURST) uxTokens = HTTP_RATE_LIMIT_BURST;
+	pxClient->usRequestTokens = uxTokens;
+}
+
+/* Select events are level-triggered: while pipelined requests wait in the
+socket, eSELECT_READ is cleared, or select() returns at once for them */
+static void prvPauseReading(HTTPClient_t *pxClient, BaseType_t xPause)
+{
+	/* Socket set is changed by the IP-task: only on transitions */
+	if(pxClient->xReadPaused == xPause) return;
+	pxClient->xReadPaused = xPause;
+
+	if(xPause)
+	{
+		FreeRTOS_FD_CLR(pxClient->xSocket,
+				pxClient->pxParent->xSocketSet, eSELECT_READ);
+	}
+	else
+	{
+		FreeRTOS_FD_SET(pxClient->xSocket,
+				pxClient->pxParent->xSocketSet, eSELECT_READ);
+	}
+}
+
+/* Throttled client is not woken up by its requests: the server waits for
+the socket events not longer than the next token is restored */
+static void prvWaitForTokens(HTTPClient_t *pxClient)
+{
+	TickType_t xElapsed = xTaskGetTickCount() - pxClient->xRequestTokensTime;
+
+	prvPauseReading(pxClient, pdTRUE);
+	FreeRTOS_TCPServerWakeUp(pxClient->pxParent,
+			(xElapsed < HTTP_RATE_LIMIT_PERIOD) ?
+					(HTTP_RATE_LIMIT_PERIOD - xElapsed) : 0);
+}
+
+/* The rest of the reply is sent on eSELECT_WRITE events */
+static BaseType_t prvReplyPending(HTTPClient_t *pxClient)
+{
+#if (configUSE_FAT != 0)
+	if(pxClient->pxFileHandle != NULL) return pdTRUE;
+#endif /*(configUSE_FAT != 0)*/
+	return pxClient->pucSendData != NULL;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvEventStreamWork(HTTPClient_t *pxClient)
+{
+	BaseType_t xRc;
+
+	/* Requests are not expected, just watch for connection closing */
+	xRc = FreeRTOS_recv(pxClient->xSocket, (void *)pcCOMMAND_BUFFER,
+			sizeof(pcCOMMAND_BUFFER), 0);
+	if((xRc < 0) && (xRc != -pdFREERTOS_ERRNO_EINTR)) return (-1);
+
+	/* Send new event */
+	if(pxClient->ulEventStreamCounter != ulEventStreamCounter)
+	{
+		pxClient->ulEventStreamCounter = ulEventStreamCounter;
+		xRenderTask = xTaskGetCurrentTaskHandle();
+		xRc = HTTP_EventStreamWork(pxClient);
+		xRenderTask = NULL;
+		pxClient->usScratchUsed = 0;
+		if(xRc < 0) return (-1);
+	}
+
+	return 0;
+}
+
+/* "If-None-Match" is "*" or the list of entity tags ("tag", W/"tag"), which
+are compared weakly (RFC 7232) */
+static BaseType_t prvMatchETag(const char *pcTags, const char *pcETag)
+{
+	size_t uxLength = strlen(pcETag);
+	const char *pcEnd;
+	const char *pcQuote;
+	BaseType_t xMatch = pdFALSE;
+
+	if(pcTags == NULL) return pdFALSE;
+
+	/* Value ends with the next stored header */
+	for(pcEnd = pcTags + strcspn(pcTags, "\r"); (pcEnd > pcTags) &&
+		((pcEnd[-1] == ' ') || (pcEnd[-1] == '\t')); pcEnd--);
+	if((pcEnd - pcTags == 1) && (*pcTags == '*')) return pdTRUE;
+
+	for(;;)
+	{
+		while(	(pcTags < pcEnd) &&
+				((*pcTags == ',') || (*pcTags == ' ') || (*pcTags == '\t')))
+		{
+			pcTags++;
+		}
+		if(pcTags == pcEnd) return xMatch;
+
+		/* Weak tag matches the same strong one */
+		if((pcEnd - pcTags > 2) && (strncmp(pcTags, "W/", 2) == 0))
+			pcTags += 2;
+		if(*pcTags != '"') return pdFALSE;
+		pcQuote = memchr(pcTags + 1, '"', pcEnd - pcTags - 1);
+		if(pcQuote == NULL) return pdFALSE;
+
+		if(	((size_t) (pcQuote + 1 - pcTags) == uxLength) &&
+			(memcmp(pcTags, pcETag, uxLength) == 0)) xMatch = pdTRUE;
+
+		/* Tags are separated with commas only: malformed list matches
+		nothing */
+		for(pcTags = pcQuote + 1; (pcTags < pcEnd) &&
+			((*pcTags == ' ') || (*pcTags == '\t')); pcTags++);
+		if((pcTags < pcEnd) && (*pcTags != ',')) return pdFALSE;
+	}
+}
+
+/* "Accept-Encoding" is the list of codings with weights ("gzip;q=0.5"): the
+coding is accepted, if it is listed (or "*" is) without zero weight. Clients
+without the header get only identity (most tools do not decompress) */
+static BaseType_t prvAcceptEncoding(const char *pcCodings,
+		const char *pcCoding)
+{
+	size_t uxLength = strlen(pcCoding);
+	size_t uxItem;
+	size_t uxName;
+	const char *pcWeight;
+	BaseType_t xAccepted;
+	BaseType_t xAny = pdFALSE;
+
+	if(pcCodings == NULL) return pdFALSE;
+
+	for(;;)
+	{
+		pcCodings += strspn(pcCodings, ", \t");
+		if((*pcCodings == '\0') || (*pcCodings == '\r')) return xAny;
+		uxItem = strcspn(pcCodings, ",\r");
+		uxName = strcspn(pcCodings, ",;\r \t");
+
+		/* Zero weight ("q=0", "q=0.000") refuses the coding */
+		xAccepted = pdTRUE;
+		pcWeight = memchr(pcCodings, '=', uxItem);
+		if((pcWeight != NULL) && (uxName < uxItem))
+		{
+			for(pcWeight++; *pcWeight == '0' || *pcWeight == '.'; pcWeight++);
+			if(	(pcWeight >= pcCodings + uxItem) || (*pcWeight == ' ') ||
+				(*pcWeight == '\t')) xAccepted = pdFALSE;
+		}
+
+		if(	(uxName == uxLength) &&
+			(strncasecmp(pcCodings, pcCoding, uxLength) == 0))
+		{
+			return xAccepted;
+		}
+		if((uxName == 1) && (*pcCodings == '*')) xAny = xAccepted;
+
+		pcCodings += uxItem;
+	}
+}
+
+static void prvCountLatency(TickType_t xTicks)
+{
+	static const uint16_t pusBounds[] = HTTP_LATENCY_BOUNDS;
+	uint32_t ulTime = xTicks * portTICK_PERIOD_MS;
+	BaseType_t xIndex;
+
+	/* Histogram buckets are not cumulative: one counter per request */
+	for(xIndex = 0; xIndex < ARRAY_SIZE(pusBounds); xIndex++)
+	{
+		if(ulTime <= pusBounds[xIndex]) break;
+	}
+	xServerStats.latency[xIndex]++;
+	xServerStats.latencySum += ulTime;
+}
+/*-----------------------------------------------------------*/
+
+static int prvOnMessageBegin(http_parser *pxParser)
+{
+	HTTPClient_t *pxClient = (HTTPClient_t *) pxParser->data;
+
+	/* Start new request */
+	pxClient->usRequestLength = 0;
+	pxClient->usHeadersPos = 0;
+	pxClient->usBodyPos = 0;
+	pxClient->request.ulRequestFlags = 0;
+	pxClient->pcUrlData = pcEmptyString;
+	pxClient->pcRestData = pcEmptyString;
+	pxClient->fBodyHandler = NULL;
+	pxClient->usScratchUsed = 0;
+	pxClient->xRequestStartTime = xTaskGetTickCount();
+
+	return 0;
+}
+
+static int prvOnUrl(http_parser *pxParser, const char *pcAt, size_t uxLength)
+{
+	HTTPClient_t *pxClient = (HTTPClient_t *) pxParser->data;
+
+	/* URL could come with several segments */
+	if(pxClient->request.bUrlTooLong) return 0;
+	if(prvRequestAppend(pxClient, pcAt, uxLength) == pdFALSE)
+		pxClient->request.bUrlTooLong = pdTRUE_UNSIGNED;
+
+	return 0;
+}
+
+static int prvOnHeaderField(http_parser *pxParser,
+		const char *pcAt, size_t uxLength)
+{
+	HTTPClient_t *pxClient = (HTTPClient_t *) pxParser->data;
+
+	if(pxClient->usHeadersPos == 0) prvRequestTerminateUrl(pxClient);
+
+	if(pxClient->request.bHeaderName == pdFALSE_UNSIGNED)
+	{
+		/* Name of the new header: store it until it is known to be used */
+		pxClient->request.bHeaderName = pdTRUE_UNSIGNED;
+		pxClient->request.bHeaderSkip = pdFALSE_UNSIGNED;
+		pxClient->usHeaderStart = pxClient->usRequestLength;
+		if(prvRequestAppend(pxClient, "\r\n", 2) == pdFALSE)
+			pxClient->request.bHeaderSkip = pdTRUE_UNSIGNED;
+	}
+
+	if(	(pxClient->request.bHeaderSkip == pdFALSE_UNSIGNED) &&
+		(prvRequestAppend(pxClient, pcAt, uxLength) == pdFALSE))
+	{
+		pxClient->request.bHeaderSkip = pdTRUE_UNSIGNED;
+		pxClient->usRequestLength = pxClient->usHeaderStart;
+	}
+
+	return 0;
+}
+
+static int prvOnHeaderValue(http_parser *pxParser,
+		const char *pcAt, size_t uxLength)
+{
+	HTTPClient_t *pxClient = (HTTPClient_t *) pxParser->data;
+
+	if(pxClient->request.bHeaderName)
+	{
+		/* Name is complete: check it for used headers */
+		const char *pcName = &pxClient->pcRequest[pxClient->usHeaderStart + 2];
+		size_t uxNameLength = pxClient->usRequestLength -
+				pxClient->usHeaderStart - 2;
+		BaseType_t xIndex;
+
+		pxClient->request.bHeaderName = pdFALSE_UNSIGNED;
+		if(pxClient->request.bHeaderSkip == pdFALSE_UNSIGNED)
+		{
+			for(xIndex = 0; xIndex < ARRAY_SIZE(pcStoredHeaders); xIndex++)
+			{
+				if(	(strncasecmp(pcName, pcStoredHeaders[xIndex],
+						uxNameLength) == 0) &&
+					(pcStoredHeaders[xIndex][uxNameLength] == '\0')) break;
+			}
+
+			if(	(xIndex == ARRAY_SIZE(pcStoredHeaders)) ||
+				(prvRequestAppend(pxClient, ": ", 2) == pdFALSE))
+			{
+				/* Drop the name of not used header */
+				pxClient->request.bHeaderSkip = pdTRUE_UNSIGNED;
+				pxClient->usRequestLength = pxClient->usHeaderStart;
+			}
+		}
+	}
+
+	if(	(pxClient->request.bHeaderSkip == pdFALSE_UNSIGNED) &&
+		(prvRequestAppend(pxClient, pcAt, uxLength) == pdFALSE))
+	{
+		/* Header does not fit the request buffer: drop it */
+		pxClient->request.bHeaderSkip = pdTRUE_UNSIGNED;
+		pxClient->usRequestLength = pxClient->usHeaderStart;
+	}
+
+	return 0;
+}
+
+static int prvOnHeadersComplete(http_parser *pxParser)
+{
+	HTTPClient_t *pxClient = (HTTPClient_t *) pxParser->data;
+	const char *pcType;
+
+	if(pxClient->usHeadersPos == 0) prvRequestTerminateUrl(pxClient);
+
+	/* Terminate headers, body follows them */
+	prvRequestAppend(pxClient, pcEmptyString, 1);
+	pxClient->usBodyPos = pxClient->usRequestLength;
+	pxClient->pcRestData = &pxClient->pcRequest[pxClient->usHeadersPos];
+
+	pxClient->xCommand = prvGetCommand(pxParser->method);
+
+	/* Connection is closed by request of the client or after the last allowed
+	request */
+	pxClient->usRequestsNum++;
+	if(	(pxClient->usRequestsNum >= HTTP_KEEP_ALIVE_MAX_REQUESTS) ||
+		(http_should_keep_alive(pxParser) == 0))
+	{
+		pxClient->request.bCloseConnection = pdTRUE_UNSIGNED;
+	}
+
+	/* Forms are passed to HTML-pages as URL parameters */
+	pcType = GetHTML_RequestHeader(pxClient, "Content-Type");
+	if(	(pcType != NULL) && (strncasecmp(pcType, HTTP_FORM_CONTENT_TYPE,
+			sizeof(HTTP_FORM_CONTENT_TYPE) - 1) == 0))
+	{
+		pxClient->request.bFormBody = pdTRUE_UNSIGNED;
+	}
+
+	/* Large bodies (uploads) are passed to the page as they come */
+	if(pxClient->request.bUrlTooLong == pdFALSE_UNSIGNED)
+	{
+		pxClient->pcUrlData = pxClient->pcRequest;
+		pxClient->fBodyHandler = HTTP_GetBodyHandler(pxClient);
+		if(pxClient->fBodyHandler != NULL)
+			pxClient->fBodyHandler(pxClient, NULL, 0);
+	}
+
+	return 0;
+}
+
+static int prvOnBody(http_parser *pxParser, const char *pcAt, size_t uxLength)
+{
+	HTTPClient_t *pxClient = (HTTPClient_t *) pxParser->data;
+
+	if(pxClient->fBodyHandler != NULL)
+	{
+		pxClient->fBodyHandler(pxClient, pcAt, uxLength);
+		return 0;
+	}
+
+	/* The rest of too large body is received, but is not stored */
+	if(pxClient->request.bBodyTooLarge) return 0;
+	if(prvRequestAppend(pxClient, pcAt, uxLength) == pdFALSE)
+		pxClient->request.bBodyTooLarge = pdTRUE_UNSIGNED;
+
+	return 0;
+}
+
+static int prvOnMessageComplete(http_parser *pxParser)
+{
+	HTTPClient_t *pxClient = (HTTPClient_t *) pxParser->data;
+	BaseType_t xRc;
+
+	/* Terminate body */
+	prvRequestAppend(pxClient, pcEmptyString, 1);
+
+	if(pxClient->request.bUrlTooLong)
+	{
+		xRc = prvSendErrorReply(pxClient, WEB_URI_TOO_LONG);
+	}
+	else if(pxClient->request.bBodyTooLarge)
+	{
+		xRc = prvSendErrorReply(pxClient, WEB_PAYLOAD_TOO_LARGE);
+	}
+	else
+	{
+		if(	pxClient->request.bFormBody &&
+			(pxClient->usRequestLength - pxClient->usBodyPos > 1))
+		{
+			prvRequestJoinForm(pxClient);
+		}
+
+		pxClient->pcUrlData = pxClient->pcRequest;
+		pxClient->pcRestData = &pxClient->pcRequest[pxClient->usHeadersPos];
+
+		/* Pages take temporary buffers from the scratch memory of the
+		request, it is released after the reply */
+		xRenderTask = xTaskGetCurrentTaskHandle();
+		xRc = prvProcessCmd(pxClient, pxClient->xCommand);
+		xRenderTask = NULL;
+		pxClient->usScratchUsed = 0;
+	}
+	prvCountLatency(xTaskGetTickCount() - pxClient->xRequestStartTime);
+
+	/* Stop parsing, if the connection is closing or is switched to events.
+	Pipelined requests also wait, while the file is sent by parts or while
+	the client exceeds its requests rate */
+	xServerStats.requests++;
+	if(pxClient->usRequestTokens) pxClient->usRequestTokens--;
+	if(pxClient->usRequestTokens == 0)
+	{
+		xServerStats.throttled++;
+		http_parser_pause(pxParser, 1);
+	}
+
+	pxClient->xRequestResult = xRc;
+	if((xRc >= 0) && pxClient->request.bCloseConnection) prvShutdown(pxClient);
+	if((xRc < 0) || pxClient->bits.bEventStream) http_parser_pause(pxParser, 1);
+#if (configUSE_FAT != 0)
+	if(pxClient->pxFileHandle != NULL) http_parser_pause(pxParser, 1);
+#endif /*(configUSE_FAT != 0)*/
+	if(pxClient->pucSendData != NULL) http_parser_pause(pxParser, 1);
+
+	return 0;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvRequestAppend(HTTPClient_t *pxClient,
+		const char *pcData, size_t uxLength)
+{
+	size_t uxSpace = sizeof(pxClient->pcRequest) - pxClient->usRequestLength;
+	size_t uxReserved = HTTP_REQUEST_TERMINATORS;
+
+	/* Only terminating zeros could take the reserved place */
+	if((uxLength == 1) && (*pcData == '\0')) uxReserved = 0;
+	if(uxLength + uxReserved > uxSpace) return pdFALSE;
+
+	memcpy(&pxClient->pcRequest[pxClient->usRequestLength], pcData, uxLength);
+	pxClient->usRequestLength += uxLength;
+
+	return pdTRUE;
+}
+
+static void prvRequestTerminateUrl(HTTPClient_t *pxClient)
+{
+	prvRequestAppend(pxClient, pcEmptyString, 1);
+	pxClient->usHeadersPos = pxClient->usRequestLength;
+}
+
+static void prvReverse(char *pcData, size_t uxLength)
+{
+	char *pcEnd = pcData + uxLength - 1;
+
+	for(; pcData < pcEnd; pcData++, pcEnd--)
+	{
+		char ch = *pcData;
+		*pcData = *pcEnd;
+		*pcEnd = ch;
+	}
+}
+
+static void prvRequestJoinForm(HTTPClient_t *pxClient)
+{
+	char *pcHeaders = &pxClient->pcRequest[pxClient->usHeadersPos];
+	size_t uxHeadersLength = pxClient->usBodyPos - pxClient->usHeadersPos;
+	size_t uxBodyLength = pxClient->usRequestLength - pxClient->usBodyPos;
+
+	/* "URL\0headers\0body\0" to "URL?body\0headers\0" in place: swap of
+	headers and body is rotation with three reversals */
+	prvReverse(pcHeaders, uxHeadersLength);
+	prvReverse(pcHeaders + uxHeadersLength, uxBodyLength);
+	prvReverse(pcHeaders, uxHeadersLength + uxBodyLength);
+
+	pxClient->pcRequest[pxClient->usHeadersPos - 1] =
+			(strchr(pxClient->pcRequest, '?') != NULL) ? '&' : '?';
+	pxClient->usBodyPos = pxClient->usHeadersPos;
+	pxClient->usHeadersPos += uxBodyLength;
+}
+
+static BaseType_t prvGetCommand(unsigned int uxMethod)
+{
+	switch(uxMethod)
+	{
+	case HTTP_GET:		return ECMD_GET;
+	case HTTP_HEAD:		return ECMD_HEAD;
+	case HTTP_POST:		return ECMD_POST;
+	case HTTP_PUT:		return ECMD_PUT;
+	case HTTP_DELETE:	return ECMD_DELETE;
+	case HTTP_TRACE:	return ECMD_TRACE;
+	case HTTP_OPTIONS:	return ECMD_OPTIONS;
+	case HTTP_CONNECT:	return ECMD_CONNECT;
+	case HTTP_PATCH:	return ECMD_PATCH;
+	default:			return ECMD_UNK;
+	}
+}
 /*-----------------------------------------------------------*/
 
 #if (configUSE_FAT != 0)
 static BaseType_t prvSendFile(HTTPClient_t *pxClient)
 {
-/*size_t uxSpace;*/
 size_t uxCount;
+size_t uxSize;
+size_t uxStart;
+BaseType_t xCode;
+BaseType_t xSpace;
 BaseType_t xRc = 0;
+char *pcBuffer;
 
 	if(pxClient->bits.bReplySent == pdFALSE_UNSIGNED)
 	{
-		pxClient->bits.bReplySent = pdTRUE_UNSIGNED;
+		/* Whole file or its part ("Range: bytes=first-last") */
+		uxSize = (size_t) pxClient->pxFileHandle->ulFileSize;
+		xCode = prvGetRange(pxClient, uxSize, &uxStart, &pxClient->uxBytesLeft);
 
 		strcpy(pxClient->pxParent->pcContentsType,
 				pcGetContentsType(pxClient->pcCurrentFilename));
-		snprintf(pxClient->pxParent->pcExtraContents,
-				sizeof(pxClient->pxParent->pcExtraContents),
-				"Content-Length: %d\r\n", (int) pxClient->uxBytesLeft);
+		prvSetRangeHeaders(pxClient, xCode, uxSize, uxStart);
+		if(pxClient->request.bHeadOnly) pxClient->uxBytesLeft = 0;
 
-		/* "Requested file action OK". */
-		xRc = prvSendReply(pxClient, WEB_REPLY_OK, pdFALSE);
+		xRc = prvSendReply(pxClient, xCode, pdFALSE);
+		if((xRc >= 0) && uxStart && pxClient->uxBytesLeft &&
+			(ff_fseek(pxClient->pxFileHandle, (long) uxStart, FF_SEEK_SET) != 0))
+		{
+			xRc = -1;
+		}
 	}
 
-	if(xRc >= 0) do
+	/* File is read directly to the transmit stream of the socket (like FTP
+	server does): the IP-task sends the previous data, while the next part is
+	read. Only the space up to the end of the stream is given for it: when it
+	is shorter than a block, the part is read to the file buffer and is copied
+	by FreeRTOS_send() around the end. If the stream is full, the rest is sent
+	on eSELECT_WRITE event */
+	while((xRc >= 0) && (pxClient->uxBytesLeft > 0u))
 	{
 		uxCount = pxClient->uxBytesLeft;
-		if(uxCount == 0) break;
+		pcBuffer = (char *) FreeRTOS_get_tx_head(pxClient->xSocket, &xSpace);
+		if(	(pcBuffer != NULL) && (xSpace > 0) &&
+			((xSpace >= HTTP_FILE_MIN_BLOCK) || ((size_t) xSpace >= uxCount)))
+		{
+			if(uxCount > (size_t) xSpace)
+			{
+				/* Whole sectors are read, if the rest is long enough */
+				uxCount = (size_t) xSpace;
+				if(uxCount >= 2 * HTTP_FILE_MIN_BLOCK)
+					uxCount &= ~((size_t) HTTP_FILE_MIN_BLOCK - 1u);
+			}
+		}
+		else
+		{
+			xSpace = FreeRTOS_tx_space(pxClient->xSocket);
+			if(xSpace <= 0) break;
 
-		if(uxCount > sizeof(pxClient->pxParent->pcFileBuffer))
+			pcBuffer = pcFILE_BUFFER;
+			if(uxCount > (size_t) xSpace) uxCount = (size_t) xSpace;
+			if(uxCount > sizeof(pcFILE_BUFFER)) uxCount = sizeof(pcFILE_BUFFER);
+		}
+		if(ff_fread(pcBuffer, 1, uxCount, pxClient->pxFileHandle) != uxCount)
 		{
-			uxCount = sizeof(pxClient->pxParent->pcFileBuffer);
+			FreeRTOS_printf(("prvSendFile: read error of %s\n",
+					pxClient->pcCurrentFilename));
+			xRc = -1;
+			break;
 		}
-		ff_fread(pxClient->pxParent->pcFileBuffer, 1, uxCount,
-				pxClient->pxFileHandle);
 		pxClient->uxBytesLeft -= uxCount;
 
-		xRc = FreeRTOS_SendWithWaiting(pxClient->xSocket,
-				pxClient->pxParent->pcFileBuffer, uxCount);
-		if(xRc < 0) break;
-	} while(uxCount > 0u);
+		/* Data of the stream are in place already: only its head moves */
+		xRc = FreeRTOS_send(pxClient->xSocket, pcBuffer, uxCount, 0);
+		UpdateTCP_TransmissionTimeout(pxClient, xRc);
+		if(xRc > 0) xServerStats.bytesSent += xRc;
+
+		/* The part is read already: the reply is broken, if it is not sent */
+		if((xRc >= 0) && ((size_t) xRc != uxCount)) xRc = -1;
+	}
 
-	if(pxClient->uxBytesLeft == 0u)
+	if((pxClient->uxBytesLeft == 0u) || (xRc < 0))
 	{
 		/* Writing is ready, no need for further 'eSELECT_WRITE' events. */
 		FreeRTOS_FD_CLR(pxClient->xSocket,
@@ -526,6 +1515,130 @@ BaseType_t xRc = 0;
 	return xRc;
 }
 #endif /*(configUSE_FAT != 0)*/
+
+static BaseType_t prvSendMemory(HTTPClient_t *pxClient)
+{
+size_t uxCount;
+BaseType_t xSpace;
+BaseType_t xRc = 0;
+
+	/* Memory is copied to the transmit stream of the socket once: the free
+	space of the stream is taken whole, FreeRTOS_send() copies the data around
+	its end. If the stream is full, the rest is sent on eSELECT_WRITE event */
+	while(pxClient->uxBytesLeft > 0u)
+	{
+		xSpace = FreeRTOS_tx_space(pxClient->xSocket);
+		if(xSpace <= 0) break;
+
+		uxCount = pxClient->uxBytesLeft;
+		if(uxCount > (size_t) xSpace) uxCount = (size_t) xSpace;
+
+		xRc = FreeRTOS_send(pxClient->xSocket, pxClient->pucSendData,
+				uxCount, 0);
+		UpdateTCP_TransmissionTimeout(pxClient, xRc);
+		if(xRc <= 0) break;
+		xServerStats.bytesSent += xRc;
+		pxClient->pucSendData += xRc;
+		pxClient->uxBytesLeft -= (size_t) xRc;
+	}
+
+	if((pxClient->uxBytesLeft == 0u) || (xRc < 0))
+	{
+		/* Writing is ready, no need for further 'eSELECT_WRITE' events. */
+		FreeRTOS_FD_CLR(pxClient->xSocket,
+				pxClient->pxParent->xSocketSet, eSELECT_WRITE);
+		pxClient->pucSendData = NULL;
+	}
+	else
+	{
+		/* Wake up the TCP task as soon as this socket may be written to. */
+		FreeRTOS_FD_SET(pxClient->xSocket,
+				pxClient->pxParent->xSocketSet, eSELECT_WRITE);
+	}
+
+	return xRc;
+}
+
+static BaseType_t prvGetRange(HTTPClient_t *pxClient, size_t uxSize,
+		size_t *puxStart, size_t *puxLength)
+{
+const char *pcRange = GetHTML_RequestHeader(pxClient, "Range");
+char *pcEnd;
+unsigned long ulFirst;
+unsigned long ulLast;
+
+	*puxStart = 0;
+	*puxLength = uxSize;
+
+	/* Only one range is supported, whole file is sent for the others */
+	if((pcRange == NULL) || (strncmp(pcRange, "bytes=", 6) != 0))
+		return WEB_REPLY_OK;
+	pcRange += 6;
+
+	if(*pcRange == '-')
+	{
+		/* The last bytes of the file: "-length" */
+		ulLast = strtoul(pcRange + 1, &pcEnd, 10);
+		if(pcEnd == pcRange + 1) return WEB_REPLY_OK;
+		if(ulLast == 0) return WEB_RANGE_NOT_SATISFIABLE;
+		if(ulLast > uxSize) ulLast = uxSize;
+		ulFirst = uxSize - ulLast;
+		ulLast = uxSize - 1;
+	}
+	else
+	{
+		/* "first-last" or "first-" (up to the end of file) */
+		ulFirst = strtoul(pcRange, &pcEnd, 10);
+		if((pcEnd == pcRange) || (*pcEnd != '-')) return WEB_REPLY_OK;
+		pcRange = pcEnd + 1;
+		ulLast = strtoul(pcRange, &pcEnd, 10);
+		if(pcEnd == pcRange) ulLast = uxSize - 1;
+		else if(ulLast < ulFirst) return WEB_REPLY_OK;
+	}
+	if((*pcEnd != '\0') && (*pcEnd != '\r')) return WEB_REPLY_OK;
+
+	if(ulFirst >= uxSize) return WEB_RANGE_NOT_SATISFIABLE;
+	if(ulLast >= uxSize) ulLast = uxSize - 1;
+
+	*puxStart = (size_t) ulFirst;
+	*puxLength = (size_t) (ulLast - ulFirst + 1);
+	return WEB_PARTIAL_CONTENT;
+}
+
+static void prvSetRangeHeaders(HTTPClient_t *pxClient, BaseType_t xCode,
+		size_t uxSize, size_t uxStart)
+{
+	if(xCode == WEB_PARTIAL_CONTENT)
+	{
+		snprintf(pxClient->pxParent->pcExtraContents,
+				sizeof(pxClient->pxParent->pcExtraContents),
+				"Accept-Ranges: bytes\r\n"
+				"Content-Range: bytes %lu-%lu/%lu\r\n"
+				"Content-Length: %lu\r\n",
+				(unsigned long) uxStart,
+				(unsigned long) (uxStart + pxClient->uxBytesLeft - 1),
+				(unsigned long) uxSize,
+				(unsigned long) pxClient->uxBytesLeft);
+	}
+	else if(xCode == WEB_RANGE_NOT_SATISFIABLE)
+	{
+		pxClient->uxBytesLeft = 0;
+		snprintf(pxClient->pxParent->pcExtraContents,
+				sizeof(pxClient->pxParent->pcExtraContents),
+				"Content-Range: bytes */%lu\r\n"
+				"Content-Length: 0\r\n",
+				(unsigned long) uxSize);
+	}
+	else
+	{
+		/* Client could resume the download with range request */
+		snprintf(pxClient->pxParent->pcExtraContents,
+				sizeof(pxClient->pxParent->pcExtraContents),
+				"Accept-Ranges: bytes\r\n"
+				"Content-Length: %lu\r\n",
+				(unsigned long) pxClient->uxBytesLeft);
+	}
+}
 /*-----------------------------------------------------------*/
 
 static BaseType_t prvOpenURL_Internal(HTTPClient_t *pxClient)
@@ -602,7 +1715,6 @@ char pcSlash[2];
 #if (configUSE_FAT != 0)
 	else
 	{
-		pxClient->uxBytesLeft = (size_t) pxClient->pxFileHandle->ulFileSize;
 		xRc = prvSendFile(pxClient);
 	}
 #endif /*(configUSE_FAT != 0)*/
@@ -615,16 +1727,28 @@ static BaseType_t prvProcessCmd(HTTPClient_t *pxClient, BaseType_t xIndex)
 {
 BaseType_t xResult = 0;
 
+	/* Keep the method for the HTML-pages router */
+	pxClient->xCommand = xIndex;
+
 	/* A new command has been received. Process it. */
 	switch(xIndex)
 	{
+	case ECMD_HEAD:
+		/* Reply to HEAD is the reply to GET without the body */
+		pxClient->request.bHeadOnly = pdTRUE_UNSIGNED;
+		pxClient->xCommand = ECMD_GET;
+		/* Fall through */
 	case ECMD_GET:
 		xResult = prvOpenURL_Internal(pxClient);
 		break;
 
-	case ECMD_HEAD:
 	case ECMD_POST:
 	case ECMD_PUT:
+		/* Only HTML-pages router accepts data */
+		pxClient->bits.ulFlags = 0;
+		xResult = prvOpenURL(pxClient);
+		break;
+
 	case ECMD_DELETE:
 	case ECMD_TRACE:
 	case ECMD_OPTIONS:
@@ -634,6 +1758,9 @@ BaseType_t xResult = 0;
 		{
 			FreeRTOS_printf(("prvProcessCmd: Not implemented: %s\n",
 				xWebCommands[xIndex].pcCommandName));
+
+			/* Every request of the connection must get reply */
+			xResult = prvSendErrorReply(pxClient, WEB_NOT_IMPLEMENTED);
 		}
 		break;
 	}
@@ -672,17 +1799,17 @@ static const char *pcGetContentsType (const char *apFname)
 }
 #endif /*(configUSE_FAT != 0)*/
 
-static TickType_t xFreeRTOS_SendTimeOut = 0;
-static BaseType_t CheckForAllowTCP_Transmission()
+static BaseType_t CheckForAllowTCP_Transmission(HTTPClient_t *pxClient)
 {
 	TickType_t deltaTime = xTaskGetTickCount();
-	deltaTime = xFreeRTOS_SendTimeOut - deltaTime;
+	deltaTime = pxClient->xSendTimeOut - deltaTime;
 	if(deltaTime == 0) return pdTRUE;
 	if(deltaTime > HTTP_ATTACK_BLOCK_TIMEOUT) return pdTRUE;
 	return pdFALSE;
 }
 
-static void UpdateTCP_TransmissionTimeout(BaseType_t xRc)
+static void UpdateTCP_TransmissionTimeout(HTTPClient_t *pxClient,
+		BaseType_t xRc)
 {
 #ifdef DEBUG_HTTP_SEND_NEG_RESULT
 	volatile uint16_t junks = 0;
@@ -692,7 +1819,7 @@ static void UpdateTCP_TransmissionTimeout(BaseType_t xRc)
 	if(xRc == (-pdFREERTOS_ERRNO_ENOTCONN))
 	{
 		/* Socket is not connected: update timeout anyway */
-		xFreeRTOS_SendTimeOut = xTaskGetTickCount();
+		pxClient->xSendTimeOut = xTaskGetTickCount();
 		return;
 	}
 
@@ -702,19 +1829,20 @@ static void UpdateTCP_TransmissionTimeout(BaseType_t xRc)
 		junks++;
 #endif // DEBUG_HTTP_SEND_NEG_RESULT
 
-		/* Something wrong with transmission: set timeout for waiting */
-		xFreeRTOS_SendTimeOut = xTaskGetTickCount() + HTTP_ATTACK_BLOCK_TIMEOUT;
+		/* Something wrong with transmission: block only this client */
+		pxClient->xSendTimeOut = xTaskGetTickCount() + HTTP_ATTACK_BLOCK_TIMEOUT;
+		xServerStats.sendErrors++;
 		return;
 	}
 
 	/* No errors: update timeout */
-	xFreeRTOS_SendTimeOut = xTaskGetTickCount();
+	pxClient->xSendTimeOut = xTaskGetTickCount();
 }
 
-static void ResetTCP_TransmissionTimeout()
+static void ResetTCP_TransmissionTimeout(HTTPClient_t *pxClient)
 {
 	/* Update timeout */
-	xFreeRTOS_SendTimeOut = xTaskGetTickCount();
+	pxClient->xSendTimeOut = xTaskGetTickCount();
 }
 
 static BaseType_t FreeRTOS_SendWithWaiting(Socket_t xSocket,
@@ -725,6 +1853,11 @@ static BaseType_t FreeRTOS_SendWithWaiting(Socket_t xSocket,
 	BaseType_t xRc = 0;
 	TickType_t xTimeOut = xTaskGetTickCount();
 
+	/* Buffers allocated by the TCP stack are not counted as allocations of
+	the page */
+	TaskHandle_t xTask = xRenderTask;
+	xRenderTask = NULL;
+
 	while(uxDataLength)
 	{
 		uxSpace = FreeRTOS_tx_space(xSocket);
@@ -744,7 +1877,8 @@ static BaseType_t FreeRTOS_SendWithWaiting(Socket_t xSocket,
 					HTTP_WAIT_FOR_SOCKET_CLOSING_DELAY)
 			{
 				/* Time is out: do not try to send again */
-				return (-1);
+				xRc = -1;
+				break;
 			}
 			/* Make short delay */
 			vTaskDelay(1);
@@ -753,6 +1887,7 @@ static BaseType_t FreeRTOS_SendWithWaiting(Socket_t xSocket,
 		{
 			/* Reset timeout for socket closing */
 			xTimeOut = xTaskGetTickCount();
+			xServerStats.bytesSent += xRc;
 		}
 
 		/* Correct pointer with using returned positive result
@@ -761,6 +1896,7 @@ static BaseType_t FreeRTOS_SendWithWaiting(Socket_t xSocket,
 		pvBuffer += xRc;
 	}
 
+	xRenderTask = xTask;
 	return xRc;
 }
 
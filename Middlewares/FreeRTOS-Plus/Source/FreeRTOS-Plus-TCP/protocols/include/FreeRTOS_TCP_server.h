@@ -109,6 +109,10 @@ typedef struct xTCP_SERVER TCPServer_t;
 TCPServer_t *FreeRTOS_CreateTCPServer( const struct xSERVER_CONFIG *pxConfigs, BaseType_t xCount );
 void FreeRTOS_TCPServerWork( TCPServer_t *pxServer, TickType_t xBlockingTime );
 
+/* A client, which waits for time rather than for a socket event (e.g. the
+HTTP requests rate), limits the blocking time of the next select() call */
+void FreeRTOS_TCPServerWakeUp( TCPServer_t *pxServer, TickType_t xTicks );
+
 #if( ipconfigSUPPORT_SIGNALS != 0 )
 	/* FreeRTOS_TCPServerWork() calls select().
 	The two functions below provide a possibility to interrupt
@@ -39,6 +39,9 @@
 	#include "ff_stdio.h"
 #endif /*(configUSE_FAT != 0)*/
 
+/* Incremental HTTP request parser */
+#include "http_parser.h"
+
 #define FREERTOS_NO_SOCKET		NULL
 
 /* Each HTTP server has 1, at most 2 sockets */
@@ -62,6 +65,24 @@
 	#define ipconfigTCP_FILE_BUFFER_SIZE	( 2048 )
 #endif
 
+/*
+ * ipconfigHTTP_REQUEST_BUFFER_SIZE sets the size of:
+ *     pcRequest'      : a buffer of each HTTP client to collect URL, used
+ *                       headers and body of the request while it is parsed.
+ */
+#ifndef ipconfigHTTP_REQUEST_BUFFER_SIZE
+	#define ipconfigHTTP_REQUEST_BUFFER_SIZE	( 1024 )
+#endif
+
+/*
+ * ipconfigHTTP_SCRATCH_BUFFER_SIZE sets the size of:
+ *     pulScratch'     : temporary memory of HTML-pages, which is released after
+ *                       each request (pages do not use heap).
+ */
+#ifndef ipconfigHTTP_SCRATCH_BUFFER_SIZE
+	#define ipconfigHTTP_SCRATCH_BUFFER_SIZE	( 512 )
+#endif
+
 struct xTCP_CLIENT;
 
 typedef BaseType_t ( * FTCPWorkFunction ) ( struct xTCP_CLIENT * /* pxClient */ );
@@ -84,6 +105,13 @@ typedef struct xTCP_CLIENT
 
 } TCPClient_t;
 
+struct xHTTP_CLIENT;
+
+/* Receiver of the request body, which is not stored in the request buffer
+(see HTTP_GetBodyHandler): it is called with NULL data at the start */
+typedef void ( * FHTTPBodyFunction ) ( struct xHTTP_CLIENT * /* pxClient */,
+		const char * /* pcData */, size_t /* uxLength */ );
+
 struct xHTTP_CLIENT
 {
 	/* This define contains fields which must come first within each of the client structs */
@@ -93,20 +121,68 @@ struct xHTTP_CLIENT
 	TickType_t xLastRecSuccessfulTime;
 	const char *pcUrlData;
 	const char *pcRestData;
+	BaseType_t xCommand;
 
+	/* Limits of the client: transmission is blocked after errors, requests
+	are delayed over the rate limit */
+	uint32_t ulClientIP;
+	TickType_t xSendTimeOut;
+	TickType_t xRequestTokensTime;
+	uint16_t usRequestTokens;
+	TickType_t xRequestStartTime;
+	BaseType_t xReadPaused;		/* eSELECT_READ is cleared, requests wait */
+
+	/* Request is parsed as it comes: segments are not collected and rescanned.
+	"pcRequest" keeps "URL\0headers\0body\0", only used headers are stored */
+	http_parser xParser;
+	BaseType_t xRequestResult;
+	uint16_t usRequestsNum;		/* Requests of the kept alive connection */
+	uint16_t usRequestLength;
+	uint16_t usHeaderStart;
+	uint16_t usHeadersPos;
+	uint16_t usBodyPos;
+	FHTTPBodyFunction fBodyHandler;
+	char pcRequest[ ipconfigHTTP_REQUEST_BUFFER_SIZE ];
+
+	/* Scratch memory of the request (see GetHTML_Scratch) */
+	uint16_t usScratchUsed;		/* Words */
+	uint32_t pulScratch[ ipconfigHTTP_SCRATCH_BUFFER_SIZE / sizeof( uint32_t ) ];
+
+	/* Event stream (text/event-stream) state */
+	uint32_t ulEventStreamCounter;
+	uint32_t ulEventStreamState;
+
+	/* Reply body, which is sent as the socket is writable (file or memory) */
+	size_t uxBytesLeft;
+	const uint8_t *pucSendData;	/* See SendHTML_Memory */
 #if (configUSE_FAT != 0)
 	char pcCurrentFilename[ ffconfigMAX_FILENAME ];
-	size_t uxBytesLeft;
 	FF_FILE *pxFileHandle;
 #endif /*(configUSE_FAT != 0)*/
 
 	union {
 		struct {
 			uint32_t
-				bReplySent : 1;
+				bReplySent : 1,
+				bEventStream : 1,
+				bCacheable : 1;
 		};
 		uint32_t ulFlags;
 	} bits;
+	union {
+		struct {
+			uint32_t
+				bHeaderName : 1,	/* Name of the header is being received */
+				bHeaderSkip : 1,	/* Header is not used or does not fit */
+				bFormBody : 1,		/* Body is "x-www-form-urlencoded" */
+				bUrlTooLong : 1,
+				bBodyTooLarge : 1,
+				bCloseConnection : 1,	/* Close after reply to this request */
+				bHeadOnly : 1,			/* HEAD: reply without body */
+				bShutdown : 1;			/* Connection is closing */
+		};
+		uint32_t ulRequestFlags;
+	} request;
 };
 
 typedef struct xHTTP_CLIENT HTTPClient_t;
@@ -186,10 +262,12 @@ struct xTCP_SERVER
 	#endif
 	#if( ipconfigUSE_HTTP != 0 )
 		char pcContentsType[40];	/* Space for the msg: "text/javascript" */
-		char pcExtraContents[40];	/* Space for the msg: "Content-Length: 346500" */
+		char pcExtraContents[128];	/* Space for the msg: "Content-Length: 346500",
+									ETag, Content-Encoding and Set-Cookie */
 	#endif
 	BaseType_t xServerCount;
 	TCPClient_t *pxClients;
+	TickType_t xSelectTimeout;		/* See FreeRTOS_TCPServerWakeUp() */
 	struct xSERVER
 	{
 		enum eSERVER_TYPE eType;		/* eSERVER_HTTP | eSERVER_FTP */
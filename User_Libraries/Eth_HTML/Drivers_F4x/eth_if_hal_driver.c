@@ -9,6 +9,7 @@
 // FreeRTOS includes.
 #include "FreeRTOS.h"
 #include "task.h"
+#include "semphr.h"
 
 // FreeRTOS+TCP includes.
 #include "FreeRTOS_IP.h"
@@ -20,6 +21,10 @@
 // ST includes.
 #include "stm32f4xx_hal.h"
 
+// Application includes.
+#include "web-server.h"
+#include "UDP_logging.h"
+
 // Private constants and macroses ----------------------------------------------
 // The time to proper reset transmit chip, ms
 #define TIME_ETH_CHIP_RESET_ON 		50
@@ -28,6 +33,14 @@
 // Max blocking recv time
 #define MAX_RECV_BLOCK_TIME_OUT 	100
 
+// Max time to wait for a free Tx descriptor, ms
+#define MAX_SEND_BLOCK_TIME_OUT 	50
+
+// Size of network buffer with its padding (BufferAllocation_1): the longest
+// frame is received to one buffer
+#define ETH_IF_NETWORK_BUFFER_SIZE \
+	((ipBUFFER_PADDING + ETH_RX_BUF_SIZE + 3) & ~3ul)
+
 #ifndef	PHY_LS_HIGH_CHECK_TIME_MS
 	// Check if the LinkSStatus in the PHY is still high after 15 seconds of not
 	// receiving packets.
@@ -55,6 +68,14 @@ enum PHY_LinkStates
 #define EMAC_IF_ERR_EVENT       4UL
 #define EMAC_IF_ALL_EVENT       (EMAC_IF_RX_EVENT | EMAC_IF_TX_EVENT | EMAC_IF_ERR_EVENT)
 
+// Abnormal interrupts of DMA: receive buffer unavailable, receive overflow
+// and fatal bus error (it stops DMA)
+#define ETH_DMA_ERROR_INTS		(ETH_DMA_IT_RBU | ETH_DMA_IT_RO | ETH_DMA_IT_FBE)
+
+// Abnormal interrupts of a storm are logged together once per the period, ms
+// (logged errors are programmed to flash)
+#define ETH_ERROR_LOG_PERIOD	60000
+
 #define ETH_DMA_ALL_INTS \
 	(ETH_DMA_IT_TST | ETH_DMA_IT_PMT | ETH_DMA_IT_MMC | ETH_DMA_IT_NIS | ETH_DMA_IT_AIS | ETH_DMA_IT_ER | \
 	  ETH_DMA_IT_FBE | ETH_DMA_IT_ET | ETH_DMA_IT_RWT | ETH_DMA_IT_RPS | ETH_DMA_IT_RBU | ETH_DMA_IT_R | \
@@ -113,6 +134,26 @@ static void prvEMACHandlerTask(void *pvParameters);
  */
 static BaseType_t prvNetworkInterfaceInput(void);
 
+/*
+ * Chain RX descriptors and give them to DMA.
+ */
+static void prvDMARxDescListInit(void);
+
+/*
+ * Chain TX descriptors, frames not sent yet are dropped.
+ */
+static void prvDMATxDescListInit(void);
+
+/*
+ * Release descriptors (and network buffers) of sent frames.
+ */
+static BaseType_t prvReleaseTxDescriptors(void);
+
+/*
+ * Count and log abnormal interrupts, restart DMA after fatal bus error.
+ */
+static void prvProcessDMAErrors(void);
+
 static HAL_StatusTypeDef ReinitEthernet();
 static void ethernetif_reset_chip(void* arg);
 /*-----------------------------------------------------------*/
@@ -142,11 +183,30 @@ handle is used so direct notifications can be sent to the task for all EMAC/DMA
 related interrupts. */
 static TaskHandle_t xEMACTaskHandle = NULL;
 
+/* Errors of DMA since start: "abnormalInterrupts" is changed by the interrupt
+handler, the rest ones by the EMAC task only */
+static struct ETH_IF_Stats ethStats;
+
+/* Status bits of abnormal interrupts, which are not processed by the EMAC task
+yet */
+static volatile uint32_t ulDMAErrors = 0;
+
 /* MAC buffers: ---------------------------------------------------------*/
 __ALIGN_BEGIN ETH_DMADescTypeDef  DMARxDscrTab[ ETH_RXBUFNB ] __ALIGN_END;/* Ethernet Rx MA Descriptor */
 __ALIGN_BEGIN ETH_DMADescTypeDef  DMATxDscrTab[ ETH_TXBUFNB ] __ALIGN_END;/* Ethernet Tx DMA Descriptor */
+#if(ipconfigZERO_COPY_RX_DRIVER == 0)
 __ALIGN_BEGIN uint8_t Rx_Buff[ ETH_RXBUFNB ][ ETH_RX_BUF_SIZE ] __ALIGN_END; /* Ethernet Receive Buffer */
+#endif
+#if(ipconfigZERO_COPY_TX_DRIVER == 0)
 __ALIGN_BEGIN uint8_t Tx_Buff[ ETH_TXBUFNB ][ ETH_TX_BUF_SIZE ] __ALIGN_END; /* Ethernet Transmit Buffer */
+#endif
+
+/* Tx descriptors given to DMA: they are released from pxTxDescToClear, when
+DMA clears their Own bit. The semaphore counts free descriptors, the counter
+is changed with interrupts disabled. */
+static SemaphoreHandle_t xTxDescriptorSemaphore = NULL;
+static volatile UBaseType_t uxTxDescriptorsBusy = 0;
+static ETH_DMADescTypeDef *pxTxDescToClear = DMATxDscrTab;
 
 /*-----------------------------------------------------------*/
 
@@ -165,12 +225,74 @@ BaseType_t xHigherPriorityTaskWoken = 0;
 }
 /*-----------------------------------------------------------*/
 
+void HAL_ETH_ErrorCallback(ETH_HandleTypeDef *hETH)
+{
+BaseType_t xHigherPriorityTaskWoken = 0;
+uint32_t ulStatus = hETH->Instance->DMASR & ETH_DMA_ERROR_INTS;
+ETH_DMADescTypeDef *pxRxDescriptor;
+
+	/* Abnormal interrupt summary: HAL clears the summary only, status bits are
+	cleared here. They are counted and logged by the EMAC task. */
+	ethStats.abnormalInterrupts++;
+	ulDMAErrors |= ulStatus;
+	__HAL_ETH_DMA_CLEAR_IT(hETH, ulStatus & ~ETH_DMA_IT_RBU);
+
+	if((ulStatus & ETH_DMA_IT_RBU) != 0)
+	{
+		pxRxDescriptor = (ETH_DMADescTypeDef *) hETH->Instance->DMACHRDR;
+		if((pxRxDescriptor->Status & ETH_DMARXDESC_OWN) != 0)
+		{
+			/* Buffers were given back meanwhile: resume reception. */
+			__HAL_ETH_DMA_CLEAR_IT(hETH, ETH_DMA_IT_RBU);
+			hETH->Instance->DMARPDR = 0;
+		}
+		else
+		{
+			/* DMA waits for buffers: the EMAC task resumes it, when frames
+			are read (the interrupt would come again until then). */
+			__HAL_ETH_DMA_DISABLE_IT(hETH, ETH_DMA_IT_RBU);
+		}
+		ulISREvents |= EMAC_IF_RX_EVENT;
+	}
+	ulISREvents |= EMAC_IF_ERR_EVENT;
+	if(xEMACTaskHandle != NULL)
+	{
+		vTaskNotifyGiveFromISR(xEMACTaskHandle, &xHigherPriorityTaskWoken);
+		portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+	}
+}
+/*-----------------------------------------------------------*/
+
 void HAL_ETH_TxCpltCallback(ETH_HandleTypeDef *hETH)
 {
-	/* This call-back would only be useful in case packets are being sent
-	zero-copy.  Once they're sent, the buffers must be released. */
+BaseType_t xHigherPriorityTaskWoken;
 	// Prevent warning for unused parameters
 	(void)hETH;
+	/* Packets are sent zero-copy: once they're sent, the buffers must be
+	released. */
+	xHigherPriorityTaskWoken = prvReleaseTxDescriptors();
+	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+/*-----------------------------------------------------------*/
+
+/* Network buffers are static (BufferAllocation_1): DMA has no access to CCM
+RAM, which is a part of heap. */
+void vNetworkInterfaceAllocateRAMToBuffers(
+	NetworkBufferDescriptor_t pxNetworkBuffers[ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS])
+{
+static __ALIGN_BEGIN uint8_t ucNetworkPackets[ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS *
+	ETH_IF_NETWORK_BUFFER_SIZE] __ALIGN_END;
+uint8_t *pucRAMBuffer = ucNetworkPackets;
+
+	for(UBaseType_t uxIndex = 0; uxIndex < ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS;
+		uxIndex++)
+	{
+		/* Padding holds the pointer to descriptor of buffer: see
+		pxPacketBuffer_to_NetworkBuffer(). */
+		*((NetworkBufferDescriptor_t **) pucRAMBuffer) = &pxNetworkBuffers[uxIndex];
+		pxNetworkBuffers[uxIndex].pucEthernetBuffer = pucRAMBuffer + ipBUFFER_PADDING;
+		pucRAMBuffer += ETH_IF_NETWORK_BUFFER_SIZE;
+	}
 }
 /*-----------------------------------------------------------*/
 
@@ -212,11 +334,15 @@ BaseType_t xNetworkInterfaceInitialise(void)
 		// Only for inspection by debugger
 		(void) hal_eth_init_status;
 
+		// Free Tx descriptors
+		xTxDescriptorSemaphore = xSemaphoreCreateCounting(ETH_TXBUFNB, ETH_TXBUFNB);
+		configASSERT(xTxDescriptorSemaphore != NULL);
+
 		// Initialize Tx Descriptors list: Chain Mode
-		HAL_ETH_DMATxDescListInit(&hETH, DMATxDscrTab, &Tx_Buff[0][0], ETH_TXBUFNB);
+		prvDMATxDescListInit();
 
 		// Initialize Rx Descriptors list: Chain Mode
-		HAL_ETH_DMARxDescListInit(&hETH, DMARxDscrTab, &Rx_Buff[0][0], ETH_RXBUFNB);
+		prvDMARxDescListInit();
 
 		// Configure PHY to generate an interrupt when Eth Link state changes
 		uint32_t regvalue = 0;
@@ -306,7 +432,7 @@ BaseType_t xNetworkInterfaceOutput(
 	xNetworkBufferDescriptor_t* const pxDescriptor, 
 	BaseType_t bReleaseAfterSend)
 {
-BaseType_t xReturn;
+BaseType_t xReturn = pdFAIL;
 uint32_t ulTransmitSize = 0;
 __IO ETH_DMADescTypeDef *pxDmaTxDesc;
 
@@ -325,52 +451,89 @@ __IO ETH_DMADescTypeDef *pxDmaTxDesc;
 	}
 	#endif
 
-	if((ulPHYLinkStatus & PHY_LINKED_STATUS) != 0)
+	#if(ipconfigZERO_COPY_TX_DRIVER != 0)
+	{
+		/* The stack passes its buffers to the driver: buffers, which it
+		keeps, are duplicated before sending. */
+		configASSERT(bReleaseAfterSend != pdFALSE);
+	}
+	#endif
+
+	if((ulPHYLinkStatus & PHY_LINKED_STATUS) == 0)
+	{
+		/* The PHY has no Link Status, packet shall be dropped. */
+	}
+	else if(xSemaphoreTake(xTxDescriptorSemaphore,
+			pdMS_TO_TICKS(MAX_SEND_BLOCK_TIME_OUT)) != pdPASS)
+	{
+		/* All descriptors are still sent, packet shall be dropped. */
+		ethStats.txDescriptorTimeouts++;
+	}
+	else
 	{
 		/* This function does the actual transmission of the packet. The packet is
 		contained in 'pxDescriptor' that is passed to the function. */
 		pxDmaTxDesc = hETH.TxDesc;
+		configASSERT((pxDmaTxDesc->Status & ETH_DMATXDESC_OWN) == 0);
+
+		/* Get bytes in current buffer. */
+		ulTransmitSize = pxDescriptor->xDataLength;
 
-		/* Is this buffer available? */
-		if((pxDmaTxDesc->Status & ETH_DMATXDESC_OWN) != 0)
+		if(ulTransmitSize > ETH_TX_BUF_SIZE)
 		{
-			xReturn = pdFAIL;
+			ulTransmitSize = ETH_TX_BUF_SIZE;
 		}
-		else
-		{
-			/* Get bytes in current buffer. */
-			ulTransmitSize = pxDescriptor->xDataLength;
-
-			if(ulTransmitSize > ETH_TX_BUF_SIZE)
-			{
-				ulTransmitSize = ETH_TX_BUF_SIZE;
-			}
 
+		#if(ipconfigZERO_COPY_TX_DRIVER != 0)
+		{
+			/* DMA sends the network buffer: it is released, when the frame is
+			sent. */
+			pxDmaTxDesc->Buffer1Addr = (uint32_t) pxDescriptor->pucEthernetBuffer;
+			bReleaseAfterSend = pdFALSE;
+		}
+		#else
+		{
 			/* Copy the remaining bytes */
 			memcpy((void *) pxDmaTxDesc->Buffer1Addr, pxDescriptor->pucEthernetBuffer, ulTransmitSize);
+		}
+		#endif /* ipconfigZERO_COPY_TX_DRIVER */
 
-			/* Prepare transmit descriptors to give to DMA. */
-			HAL_ETH_TransmitFrame(&hETH, ulTransmitSize);
+		/* The frame is in one buffer, interrupt on completion releases it. */
+		pxDmaTxDesc->ControlBufferSize = ulTransmitSize & ETH_DMATXDESC_TBS1;
+		pxDmaTxDesc->Status |= ETH_DMATXDESC_FS | ETH_DMATXDESC_LS | ETH_DMATXDESC_IC;
 
-			iptraceNETWORK_INTERFACE_TRANSMIT();
-			xReturn = pdPASS;
+		/* Give the descriptor to DMA: it is counted before the interrupt of
+		its completion is handled. */
+		taskENTER_CRITICAL();
+		{
+			pxDmaTxDesc->Status |= ETH_DMATXDESC_OWN;
+			uxTxDescriptorsBusy++;
 		}
-	}
-	else
-	{
-		/* The PHY has no Link Status, packet shall be dropped. */
-		xReturn = pdFAIL;
-	}
+		taskEXIT_CRITICAL();
 
-	#if(ipconfigZERO_COPY_TX_DRIVER == 0)
-	{
-		/* The buffer has been sent so can be released. */
-		if(bReleaseAfterSend != pdFALSE)
+		/* Point to next descriptor */
+		hETH.TxDesc = (ETH_DMADescTypeDef *) pxDmaTxDesc->Buffer2NextDescAddr;
+
+		/* When Tx Buffer unavailable flag is set clear it and resume
+		transmission. */
+		if((hETH.Instance->DMASR & ETH_DMASR_TBUS) != 0)
 		{
-			vReleaseNetworkBufferAndDescriptor(pxDescriptor);
+			/* Clear TBUS ETHERNET DMA flag. */
+			hETH.Instance->DMASR = ETH_DMASR_TBUS;
+
+			/* Resume DMA transmission. */
+			hETH.Instance->DMATPDR = 0;
 		}
+
+		iptraceNETWORK_INTERFACE_TRANSMIT();
+		xReturn = pdPASS;
+	}
+
+	/* The buffer has been copied or dropped so can be released. */
+	if(bReleaseAfterSend != pdFALSE)
+	{
+		vReleaseNetworkBufferAndDescriptor(pxDescriptor);
 	}
-	#endif
 
 	return xReturn;
 }
@@ -378,7 +541,8 @@ __IO ETH_DMADescTypeDef *pxDmaTxDesc;
 
 static BaseType_t prvNetworkInterfaceInput(void)
 {
-xNetworkBufferDescriptor_t *pxDescriptor;
+xNetworkBufferDescriptor_t *pxCurDescriptor;
+xNetworkBufferDescriptor_t *pxNewDescriptor = NULL;
 uint16_t usReceivedLength;
 __IO ETH_DMADescTypeDef *xDMARxDescriptor;
 uint32_t ulSegCount;
@@ -394,75 +558,94 @@ const TickType_t xDescriptorWaitTime = pdMS_TO_TICKS(250);
 	{
 		/* Obtain the size of the packet and put it into the "usReceivedLength" variable. */
 		usReceivedLength = hETH.RxFrameInfos.length;
+		xDMARxDescriptor = hETH.RxFrameInfos.FSRxDesc;
 
-		if(usReceivedLength > 0)
+		if(usReceivedLength == 0)
 		{
-			/* Create a buffer of the required length. */
-			pxDescriptor = pxGetNetworkBufferWithDescriptor(usReceivedLength, xDescriptorWaitTime);
+			FreeRTOS_printf(("prvNetworkInterfaceInput: zero-sized packet?\n"));
+		}
+		else if(hETH.RxFrameInfos.SegCount > 1)
+		{
+			/* A buffer holds the longest frame: frames of several buffers are
+			not accepted. */
+			FreeRTOS_printf(("prvNetworkInterfaceInput: too long packet %u\n", usReceivedLength));
+		}
+		else
+		{
+			/* The frame is accepted, only if a new buffer can take the place
+			of its one in the ring. If not, the frame is dropped and its buffer
+			receives the next one. */
+			pxNewDescriptor = pxGetNetworkBufferWithDescriptor(ETH_RX_BUF_SIZE, xDescriptorWaitTime);
 
-			if(pxDescriptor != NULL)
+			if(pxNewDescriptor == NULL)
 			{
-				xDMARxDescriptor = hETH.RxFrameInfos.FSRxDesc;
-
-				/* Copy remaining data. */
-				if(usReceivedLength > pxDescriptor->xDataLength)
-				{
-					usReceivedLength = pxDescriptor->xDataLength;
-				}
-
-				memcpy(pxDescriptor->pucEthernetBuffer, (uint8_t *) hETH.RxFrameInfos.buffer, usReceivedLength);
-
-				xRxEvent.pvData = (void *) pxDescriptor;
-
-				/* Pass the data to the TCP/IP task for processing. */
-				if(xSendEventStructToIPTask(&xRxEvent, xDescriptorWaitTime) == pdFALSE)
-				{
-					/* Could not send the descriptor into the TCP/IP stack, it
-					must be released. */
-					vReleaseNetworkBufferAndDescriptor(pxDescriptor);
-					iptraceETHERNET_RX_EVENT_LOST();
-				}
-				else
-				{
-					iptraceNETWORK_INTERFACE_RECEIVE();
-				}
+				FreeRTOS_printf(("prvNetworkInterfaceInput: pxGetNetworkBuffer failed length %u\n", usReceivedLength));
+			}
+		}
 
-				/* Release descriptors to DMA.  Point to first descriptor. */
-				xDMARxDescriptor = hETH.RxFrameInfos.FSRxDesc;
-				ulSegCount = hETH.RxFrameInfos.SegCount;
+		if(pxNewDescriptor != NULL)
+		{
+			#if(ipconfigZERO_COPY_RX_DRIVER != 0)
+			{
+				/* The buffer of DMA is passed to the stack. The descriptor
+				gets the new one before, so it never points to a buffer of the
+				stack. */
+				pxCurDescriptor = pxPacketBuffer_to_NetworkBuffer((void *) xDMARxDescriptor->Buffer1Addr);
+				configASSERT(pxCurDescriptor != NULL);
+				xDMARxDescriptor->Buffer1Addr = (uint32_t) pxNewDescriptor->pucEthernetBuffer;
+			}
+			#else
+			{
+				/* In this mode, the two descriptors are the same. */
+				pxCurDescriptor = pxNewDescriptor;
+				memcpy(pxCurDescriptor->pucEthernetBuffer, (uint8_t *) hETH.RxFrameInfos.buffer, usReceivedLength);
+			}
+			#endif /* ipconfigZERO_COPY_RX_DRIVER */
 
-				/* Set Own bit in RX descriptors: gives the buffers back to
-				DMA. */
-				while(ulSegCount != 0)
-				{
-					xDMARxDescriptor->Status |= ETH_DMARXDESC_OWN;
-					xDMARxDescriptor = (ETH_DMADescTypeDef *) xDMARxDescriptor->Buffer2NextDescAddr;
-					ulSegCount--;
-				}
+			pxCurDescriptor->xDataLength = usReceivedLength;
+			xRxEvent.pvData = (void *) pxCurDescriptor;
 
-				/* Clear Segment_Count */
-				hETH.RxFrameInfos.SegCount = 0;
+			/* Pass the data to the TCP/IP task for processing. */
+			if(xSendEventStructToIPTask(&xRxEvent, xDescriptorWaitTime) == pdFALSE)
+			{
+				/* Could not send the descriptor into the TCP/IP stack, it
+				must be released. */
+				vReleaseNetworkBufferAndDescriptor(pxCurDescriptor);
+				iptraceETHERNET_RX_EVENT_LOST();
 			}
 			else
 			{
-				FreeRTOS_printf(("prvNetworkInterfaceInput: pxGetNetworkBuffer failed length %u\n", usReceivedLength));
+				iptraceNETWORK_INTERFACE_RECEIVE();
 			}
 		}
-		else
+
+		/* Release descriptors to DMA (dropped frames too).  Point to first
+		descriptor. */
+		ulSegCount = hETH.RxFrameInfos.SegCount;
+
+		/* Set Own bit in RX descriptors: gives the buffers back to
+		DMA. */
+		while(ulSegCount != 0)
 		{
-			FreeRTOS_printf(("prvNetworkInterfaceInput: zero-sized packet?\n"));
-			pxDescriptor = NULL;
+			xDMARxDescriptor->Status = ETH_DMARXDESC_OWN;
+			xDMARxDescriptor = (ETH_DMADescTypeDef *) xDMARxDescriptor->Buffer2NextDescAddr;
+			ulSegCount--;
 		}
 
+		/* Clear Segment_Count */
+		hETH.RxFrameInfos.SegCount = 0;
+
 		/* When Rx Buffer unavailable flag is set clear it and resume
-		reception. */
+		reception (it is counted by the interrupt). */
 		if((hETH.Instance->DMASR & ETH_DMASR_RBUS) != 0)
 		{
 			/* Clear RBUS ETHERNET DMA flag. */
 			hETH.Instance->DMASR = ETH_DMASR_RBUS;
 
-			/* Resume DMA reception. */
+			/* Resume DMA reception, the next unavailable buffer is
+			interrupted again. */
 			hETH.Instance->DMARPDR = 0;
+			__HAL_ETH_DMA_ENABLE_IT(&hETH, ETH_DMA_IT_RBU);
 		}
 	}
 
@@ -471,6 +654,159 @@ const TickType_t xDescriptorWaitTime = pdMS_TO_TICKS(250);
 }
 /*-----------------------------------------------------------*/
 
+static void prvDMARxDescListInit(void)
+{
+ETH_DMADescTypeDef *pxDMADescriptor;
+BaseType_t xIndex;
+
+	for(xIndex = 0; xIndex < ETH_RXBUFNB; xIndex++)
+	{
+		pxDMADescriptor = &DMARxDscrTab[xIndex];
+
+		#if(ipconfigZERO_COPY_RX_DRIVER != 0)
+		{
+			/* Descriptors keep their network buffers, when Ethernet is
+			initialized again. */
+			if(pxDMADescriptor->Buffer1Addr == 0)
+			{
+			NetworkBufferDescriptor_t *pxBuffer;
+
+				pxBuffer = pxGetNetworkBufferWithDescriptor(ETH_RX_BUF_SIZE, pdMS_TO_TICKS(100));
+				/* If the assert below fails, make sure that there are at
+				least ETH_RXBUFNB network buffers available during start-up
+				(ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS) */
+				configASSERT(pxBuffer != NULL);
+				if(pxBuffer != NULL)
+				{
+					pxDMADescriptor->Buffer1Addr = (uint32_t) pxBuffer->pucEthernetBuffer;
+				}
+			}
+		}
+		#else
+		{
+			pxDMADescriptor->Buffer1Addr = (uint32_t) Rx_Buff[xIndex];
+		}
+		#endif /* ipconfigZERO_COPY_RX_DRIVER */
+
+		/* Set Buffer1 size and Second Address Chained bit, interrupt on
+		receive is enabled (DIC bit is not set) */
+		pxDMADescriptor->ControlBufferSize = ETH_DMARXDESC_RCH | ETH_RX_BUF_SIZE;
+
+		/* Descriptor without buffer is not given to DMA */
+		pxDMADescriptor->Status = (pxDMADescriptor->Buffer1Addr != 0) ?
+			ETH_DMARXDESC_OWN : 0;
+
+		/* The last descriptor is chained to the first one */
+		pxDMADescriptor->Buffer2NextDescAddr = (xIndex < ETH_RXBUFNB - 1) ?
+			(uint32_t) (pxDMADescriptor + 1) : (uint32_t) DMARxDscrTab;
+	}
+
+	/* Received frames are read from the first descriptor */
+	hETH.RxDesc = DMARxDscrTab;
+	hETH.RxFrameInfos.SegCount = 0;
+
+	/* Set Receive Descriptor List Address Register */
+	hETH.Instance->DMARDLAR = (uint32_t) DMARxDscrTab;
+
+	/* Errors of reception are interrupted: HAL enables only Rx one */
+	__HAL_ETH_DMA_ENABLE_IT(&hETH, ETH_DMA_IT_AIS | ETH_DMA_ERROR_INTS);
+}
+/*-----------------------------------------------------------*/
+
+static void prvDMATxDescListInit(void)
+{
+ETH_DMADescTypeDef *pxDMADescriptor;
+BaseType_t xIndex;
+
+	/* DMA is stopped: frames, which are not sent, are dropped. */
+	while(uxTxDescriptorsBusy > 0)
+	{
+		#if(ipconfigZERO_COPY_TX_DRIVER != 0)
+		{
+			vReleaseNetworkBufferAndDescriptor(
+				pxPacketBuffer_to_NetworkBuffer((void *) pxTxDescToClear->Buffer1Addr));
+			pxTxDescToClear->Buffer1Addr = 0;
+		}
+		#endif /* ipconfigZERO_COPY_TX_DRIVER */
+
+		pxTxDescToClear = (ETH_DMADescTypeDef *) pxTxDescToClear->Buffer2NextDescAddr;
+		uxTxDescriptorsBusy--;
+		xSemaphoreGive(xTxDescriptorSemaphore);
+	}
+
+	for(xIndex = 0; xIndex < ETH_TXBUFNB; xIndex++)
+	{
+		pxDMADescriptor = &DMATxDscrTab[xIndex];
+
+		/* Set Second Address Chained bit */
+		pxDMADescriptor->Status = ETH_DMATXDESC_TCH;
+
+		#if(ipconfigZERO_COPY_TX_DRIVER == 0)
+		{
+			pxDMADescriptor->Buffer1Addr = (uint32_t) Tx_Buff[xIndex];
+		}
+		#endif /* ipconfigZERO_COPY_TX_DRIVER */
+
+		if(hETH.Init.ChecksumMode == ETH_CHECKSUM_BY_HARDWARE)
+		{
+			/* Set the DMA Tx descriptors checksum insertion */
+			pxDMADescriptor->Status |= ETH_DMATXDESC_CHECKSUMTCPUDPICMPFULL;
+		}
+
+		/* The last descriptor is chained to the first one */
+		pxDMADescriptor->Buffer2NextDescAddr = (xIndex < ETH_TXBUFNB - 1) ?
+			(uint32_t) (pxDMADescriptor + 1) : (uint32_t) DMATxDscrTab;
+	}
+
+	/* Frames are sent and released from the first descriptor */
+	hETH.TxDesc = DMATxDscrTab;
+	pxTxDescToClear = DMATxDscrTab;
+
+	/* Set Transmit Descriptor List Address Register */
+	hETH.Instance->DMATDLAR = (uint32_t) DMATxDscrTab;
+
+	/* Sent frames are released by Tx-complete interrupt */
+	__HAL_ETH_DMA_ENABLE_IT(&hETH, ETH_DMA_IT_T);
+}
+/*-----------------------------------------------------------*/
+
+/* Called from the Tx-complete interrupt or with interrupts disabled */
+static BaseType_t prvReleaseTxDescriptors(void)
+{
+BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+	/* DMA clears Own bit of descriptors in order of frames */
+	while((uxTxDescriptorsBusy > 0) &&
+		((pxTxDescToClear->Status & ETH_DMATXDESC_OWN) == 0))
+	{
+		#if(ipconfigZERO_COPY_TX_DRIVER != 0)
+		{
+		NetworkBufferDescriptor_t *pxBuffer;
+
+			pxBuffer = pxPacketBuffer_to_NetworkBuffer((void *) pxTxDescToClear->Buffer1Addr);
+			if(pxBuffer != NULL)
+			{
+				xHigherPriorityTaskWoken |= vNetworkBufferReleaseFromISR(pxBuffer);
+			}
+			pxTxDescToClear->Buffer1Addr = 0;
+		}
+		#endif /* ipconfigZERO_COPY_TX_DRIVER */
+
+		pxTxDescToClear = (ETH_DMADescTypeDef *) pxTxDescToClear->Buffer2NextDescAddr;
+		uxTxDescriptorsBusy--;
+		xSemaphoreGiveFromISR(xTxDescriptorSemaphore, &xHigherPriorityTaskWoken);
+	}
+
+	return xHigherPriorityTaskWoken;
+}
+/*-----------------------------------------------------------*/
+
+const struct ETH_IF_Stats* ETH_IF_GetStats()
+{
+	return &ethStats;
+}
+/*-----------------------------------------------------------*/
+
 BaseType_t xGetPhyLinkStatus(void)
 {
 BaseType_t xReturn;
@@ -571,17 +907,34 @@ static void prvEMACHandlerTask(void *pvParameters)
 
 		if((ulISREvents & EMAC_IF_TX_EVENT) != 0)
 		{
-			// Future extension: code to release TX buffers 
-			// if zero-copy is used.
+			// TX buffers are released by the Tx-complete interrupt.
 			ulISREvents &= ~EMAC_IF_TX_EVENT;
 		}
 
+		if(uxTxDescriptorsBusy > 0)
+		{
+			// HAL handles Tx-complete interrupt only without Rx one: frames
+			// sent meanwhile are released here.
+			taskENTER_CRITICAL();
+			prvReleaseTxDescriptors();
+			taskEXIT_CRITICAL();
+		}
+
 		if((ulISREvents & EMAC_IF_ERR_EVENT) != 0)
 		{
-			// Future extension: logging about errors that occurred.
 			ulISREvents &= ~EMAC_IF_ERR_EVENT;
+			prvProcessDMAErrors();
 		}
 
+		// Counters of missed frames are cleared on read: they are polled,
+		// frames are missed without interrupts, when the overflow one is
+		// pending
+		uint32_t ulMissed = hETH.Instance->DMAMFBOCR;
+		ethStats.rxMissedFrames += (ulMissed & ETH_DMAMFBOCR_MFC) >>
+				ETH_DMAMFBOCR_MFC_Pos;
+		ethStats.rxFifoOverflows += (ulMissed & ETH_DMAMFBOCR_MFA) >>
+				ETH_DMAMFBOCR_MFA_Pos;
+
 		if(xResult > 0)
 		{
 			// A packet was received. No need to check for the PHY status now,
@@ -624,6 +977,45 @@ prvEMACHandlerTask: PHY link now is down"));
 }
 /*-----------------------------------------------------------*/
 
+static void prvProcessDMAErrors(void)
+{
+static TickType_t xLastLogTime = 0;
+static uint32_t ulLogErrors = 0;
+static uint32_t ulLogInterrupts = 0;
+uint32_t ulErrors;
+
+	taskENTER_CRITICAL();
+	ulErrors = ulDMAErrors;
+	ulDMAErrors = 0;
+	taskEXIT_CRITICAL();
+
+	if((ulErrors & ETH_DMA_IT_RBU) != 0) ethStats.rxBufferUnavailable++;
+
+	// DMA is stopped: the IP task reinitializes the interface
+	if((ulErrors & ETH_DMA_IT_FBE) != 0)
+	{
+		UDP_LOG_ERROR("ETH: fatal bus error, DMA status 0x%08x",
+				hETH.Instance->DMASR);
+		PHY_LinkState = PHY_LinkDownState;
+		FreeRTOS_NetworkDown();
+		return;
+	}
+
+	// Lack of buffers and overflows come with load of network: a storm is
+	// reported once per the period
+	ulLogErrors |= ulErrors;
+	ulLogInterrupts++;
+	if(	(xLastLogTime != 0) &&
+		(xTaskGetTickCount() - xLastLogTime <
+			pdMS_TO_TICKS(ETH_ERROR_LOG_PERIOD))) return;
+	xLastLogTime = xTaskGetTickCount();
+	UDP_LOG_WARNING("ETH: %u abnormal interrupts, DMA status 0x%08x",
+			ulLogInterrupts, ulLogErrors);
+	ulLogErrors = 0;
+	ulLogInterrupts = 0;
+}
+/*-----------------------------------------------------------*/
+
 static HAL_StatusTypeDef ReinitEthernet()
 {
 	// Stop MAC interface
@@ -647,10 +1039,10 @@ static HAL_StatusTypeDef ReinitEthernet()
 	if(hal_eth_init_status != HAL_OK) return hal_eth_init_status;
 	
 	// Initialize Tx Descriptors list: Chain Mode
-	HAL_ETH_DMATxDescListInit(&hETH, DMATxDscrTab, &Tx_Buff[0][0], ETH_TXBUFNB);
+	prvDMATxDescListInit();
 
 	// Initialize Rx Descriptors list: Chain Mode
-	HAL_ETH_DMARxDescListInit(&hETH, DMARxDscrTab, &Rx_Buff[0][0], ETH_RXBUFNB);
+	prvDMARxDescListInit();
 
 	// Configure PHY to generate an interrupt when Eth Link state changes
 	uint32_t regvalue = 0;
@@ -21,6 +21,15 @@ static const char str_0[] = "\
 </body>\r\
 </html>";
 
+static const char str_405[] = "\
+<html>\r\
+<body>\r\
+  <font size=\"+2\">\r\
+    Error 405 - Method not allowed<br>\r\
+  </font>\r\
+</body>\r\
+</html>";
+
 // Public functions ------------------------------------------------------------
 BaseType_t Send_404(HTTPClient_t *pxClient)
 {
@@ -33,3 +42,14 @@ BaseType_t Send_404(HTTPClient_t *pxClient)
 	return SendHTML_Block(pxClient, "", 0);
 }
 
+BaseType_t Send_405(HTTPClient_t *pxClient)
+{
+	// Send html header
+	SendHTML_Header_405(pxClient);
+
+	SendHTML_Block(pxClient, str_405, sizeof(str_405) - 1);
+
+	// Send last empty block
+	return SendHTML_Block(pxClient, "", 0);
+}
+
@@ -1,25 +1,53 @@
 /* Includes ------------------------------------------------------------------*/
+#include <string.h>
+
 #include "settings.h"
+#include "main_app.h"
 #include "web-server.h"
 #include "html_txt_funcs.h"
+#include "html_query.h"
 #include "HTML_Header.h"
-#include "404.h"
 #include "HTML_Login.h"
 
 /* Private constants ---------------------------------------------------------*/
-#define HTML_LOGIN_TMP_BUF_LEN 16
-
+/* Maximum number of sessions (logged in clients), the least recently used
+   session is closed for the new one */
 #ifndef MAX_LOGINS_HTTP_CLIENTS
 #	define MAX_LOGINS_HTTP_CLIENTS 		16
 #endif /*MAX_LOGINS_HTTP_CLIENTS*/
 
+/* Session is closed, if the client does not send requests for this time (ms) */
+#ifndef HTML_SESSION_IDLE_TIMEOUT
+#	define HTML_SESSION_IDLE_TIMEOUT	(15 * 60 * 1000)
+#endif /*HTML_SESSION_IDLE_TIMEOUT*/
+
+/* Open-addressed table of sessions is filled by half at most
+   (size must be power of 2) */
+#define HTML_SESSIONS_TABLE_SIZE		(2 * MAX_LOGINS_HTTP_CLIENTS)
+#define HTML_SESSIONS_TABLE_MASK		(HTML_SESSIONS_TABLE_SIZE - 1)
+#if ((HTML_SESSIONS_TABLE_SIZE & HTML_SESSIONS_TABLE_MASK) != 0)
+#	error "MAX_LOGINS_HTTP_CLIENTS must be power of 2"
+#endif
+
+/* Token of session: 128 random bits, they are sent as 32 hex digits */
+#define HTML_SESSION_TOKEN_WORDS		4
+#define HTML_SESSION_TOKEN_DIGITS		(HTML_SESSION_TOKEN_WORDS * 8)
+
+/* Session cookie is not available for scripts and other sites */
+#define HTML_SESSION_COOKIE_NAME		"sid="
+#define HTML_SESSION_COOKIE_ATTRS		"; Path=/; HttpOnly; SameSite=Strict"
+#define HTML_SESSION_COOKIE_LEN			(sizeof(HTML_SESSION_COOKIE_NAME) - 1 + \
+		HTML_SESSION_TOKEN_DIGITS + sizeof(HTML_SESSION_COOKIE_ATTRS))
+
+#define HTML_LOGIN_TMP_BUF_LEN 16
+
 /* Structures definitions ----------------------------------------------------*/
-/* Structure member for keep client connection */
-struct __attribute__ ((__packed__)) HTTP_ClientConnection
+/* Session of logged in client */
+struct HTTP_Session
 {
-	uint32_t IP_Addr;
-	//uint16_t port;
-	uint16_t ID;
+	uint32_t token[HTML_SESSION_TOKEN_WORDS];
+	TickType_t lastAccess;
+	bool used;
 };
 
 /* Variables -----------------------------------------------------------------*/
@@ -35,19 +63,10 @@ static const char str_lgn_psswrd_h[] = "\
   <meta http-equiv=\"expires\" content=\"0\">\n\
   <meta http-equiv=\"expires\" content=\"Tue, 01 Jan 1980 1:00:00 GMT\">\n\
   <meta http-equiv=\"pragma\" content=\"no-cache\">\n\
-  <script type=\"text/javascript\">\n\
-  function stopRKey(evt)\n\
-  {\n\
-    var evt = (evt) ? evt : ((event) ? event : null);\n\
-    var node = (evt.target) ? evt.target : \
-((evt.srcElement) ? evt.srcElement : null);\n\
-    if ((evt.keyCode == 13) && (node.type==\"text\"))  {return false;}\n\
-  }\n\
-  document.onkeypress = stopRKey;\n\
-  </script>\n\
+  <script type=\"text/javascript\" src=\"/static/common.js\"></script>\n\
 </head>\n\
 <body>\n\
-<form action=\"/login\">\n";
+<form action=\"/login\" method=\"post\">\n";
 static const char str_lgn_psswrd_b[] = "\
   <font size=\"+2\">\n\
 <pre>\n\
@@ -62,12 +81,11 @@ Password: </strong>\
   </font>\n";
 
 /* Redirect HTML */
-static const char str_redirect_to_main_b[] = "\
+static const char str_redirect_to_main[] = "\
 <html>\n\
 <head>\n\
 <title>Redirect to main page after 2 seconds</title>\n\
-<meta http-equiv=\"refresh\" content=\"2; URL=;key=";
-static const char str_redirect_to_main_1[] = "/\">\n\
+<meta http-equiv=\"refresh\" content=\"2; URL=/\">\n\
 <meta name=\"keywords\" content=\"automatic redirection\">\n\
 </head>\n\
 <body>\n\
@@ -75,283 +93,127 @@ Login is successful!<br>\
 If your browser doesn't support automatically redirect,<br>\n\
 please, visit the home page manually:<br><br>\n\
   <font size=\"+2\">\n\
-  <a href=\";key=";
-static const char str_redirect_to_main_e[] = "/\">Home</a>\n\
+  <a href=\"/\">Home</a>\n\
 </font>\n\
 </body>\n\
 </html>";
 
-/* Variables for keeping clients' connection */
-static struct HTTP_ClientConnection clientConnections[MAX_LOGINS_HTTP_CLIENTS];
-static uint16_t pAppendingClientConnections = 0;
-
-/* Other variables */
-static volatile uint16_t package_ID = 0;
+/* Sessions of logged in clients: hash table with linear probing, the token
+   is random, so its first word is the hash */
+static struct HTTP_Session sessions[HTML_SESSIONS_TABLE_SIZE];
+static uint16_t sessionsNum = 0;
 
 /* Private function prototypes -----------------------------------------------*/
-static BaseType_t HTML_LoginRequest(HTTPClient_t *pxClient, const char** pBuf);
+static BaseType_t HTML_LoginRequest(HTTPClient_t *pxClient);
 static BaseType_t Send_HTML(HTTPClient_t *pxClient);
-static BaseType_t Send_HTML_Redirect(HTTPClient_t *pxClient, uint16_t key);
+static BaseType_t Send_HTML_Redirect(HTTPClient_t *pxClient,
+		const struct HTTP_Session* session);
+static bool CredentialIsEqu(const char* value, const char* stored,
+		uint16_t size);
+
+/* Sessions functions */
+static bool GetSessionToken(HTTPClient_t *pxClient, uint32_t* token);
+static struct HTTP_Session* SessionFind(const uint32_t* token);
+static struct HTTP_Session* SessionCreate();
+static void SessionRemove(struct HTTP_Session* session);
+static void SessionsRemoveExpired(TickType_t now);
+static bool SessionIsExpired(const struct HTTP_Session* session,
+		TickType_t now);
+static bool TokenIsEqu(const uint32_t* token1, const uint32_t* token2);
 
 /* Public functions ----------------------------------------------------------*/
 BaseType_t HTML_Login(HTTPClient_t *pxClient)
 {
-	BaseType_t xResult = 0;
-	const char** pBuf = &pxClient->pcUrlData;
+	const char* url = pxClient->pcUrlData;
 
 	/* At first, check for "login" request */
-	if(QueryCmp(pBuf, "/login"))
+	if(QueryCmp(&url, "/login"))
 	{
 		/* Proceed login with password */
-		xResult = HTML_LoginRequest(pxClient, pBuf);
+		BaseType_t xResult = HTML_LoginRequest(pxClient);
 		if(xResult != 0) return xResult;
 		return Send_HTML(pxClient);
 	}
 
-	/* Redirect to login form from root directory */
-	if(QueryCmp(pBuf, "/") || QueryCmp(pBuf, "/HTML_Main.html"))
-	{
-		/* Redirect to login form */
-		return Send_HTML(pxClient);
-	}
-
-	/* Search for "key" symbol (";") */
-	bool foundKey = false;
-	for(uint16_t i = 0; i < 1000; i++)
-	{
-		if((**pBuf == 0) || (**pBuf == ' '))
-		{
-			/* End or brake of string */
-			break;
-		}
-		if(**pBuf == ';')
-		{
-			(*pBuf)++;
-
-			/* Found "key" symbol */
-			foundKey = true;
-			break;
-		}
-		(*pBuf)++;
-	}
+	/* Page is available in the session only (its token is in the cookie),
+	   let another parser process the request */
+	if(HTML_LoginSessionIsValid(pxClient)) return pdFALSE;
 
-	if(foundKey == false)
-	{
-		/* Did not find "key" symbol, send 404 form */
-		return Send_404(pxClient);
-	}
+	/* There is no session, redirect to login form */
+	return Send_HTML(pxClient);
+}
 
-	/* Create temporarily variables */
-	int32_t tmp32;
-	struct freertos_sockaddr pxAddress;
-	pxAddress.sin_addr = 0;
-	pxAddress.sin_port = 0;
+bool HTML_LoginSessionIsValid(HTTPClient_t *pxClient)
+{
+	uint32_t token[HTML_SESSION_TOKEN_WORDS];
+	if(GetSessionToken(pxClient, token) == false) return false;
 
-	/* Try to get the key and compare it with stored one */
-	if(ParamIsEqu(pBuf, "key") == false)
-	{
-		/* There is no "key" parameter */
-		return Send_HTML(pxClient);
-	}
+	struct HTTP_Session* session = SessionFind(token);
+	if(session == NULL) return false;
 
-	/* Try to convert string to number */
-	if(GetNumFromStr(pBuf, &tmp32, pdTRUE))
+	TickType_t now = xTaskGetTickCount();
+	if(SessionIsExpired(session, now))
 	{
-		if((tmp32 >= 0) && (tmp32 <= 0xFFFF))
-		{
-			/* Validate key with existing clients */
-			FreeRTOS_GetRemoteAddress(pxClient->xSocket, &pxAddress);
-			if(pxAddress.sin_addr/* && (pxAddress.sin_port)*/)
-			{
-				for(uint8_t i = 0; i < MAX_LOGINS_HTTP_CLIENTS; i++)
-				{
-					/* Check IP address */
-					if(clientConnections[i].IP_Addr == pxAddress.sin_addr)
-					{
-						/* Check port */
-						//if(clientConnections[i].port == pxAddress.sin_port)
-						{
-							/* Check key (IP) */
-							if(clientConnections[i].ID == tmp32)
-							{
-								/* Key is valid,
-								search for "address" symbol ("/") */
-								for(uint16_t i = 0; i < 1000; i++)
-								{
-									if((**pBuf == 0) ||(**pBuf == ' '))
-									{
-										/* End or brake of string, it impossible
-										to parse.
-										   Redirect to login form */
-										return Send_HTML(pxClient);
-									}
-									if(**pBuf == '/')
-									{
-										/* Found "address" symbol.
-										   Let another parser try to get
-										cropped the GET request */
-										return pdFALSE;
-									}
-									(*pBuf)++;
-								}
-							}
-						}
-					}
-				}
-
-				/* If any, try to login with password */
-				xResult = HTML_LoginRequest(pxClient, pBuf);
-				if(xResult != 0) return xResult;
-			}
-		}
+		SessionRemove(session);
+		return false;
 	}
 
-	/* Wrong or empty key, redirect to login form */
-	return Send_HTML(pxClient);
+	/* Session is kept while the client is active */
+	session->lastAccess = now;
+	return true;
 }
 
 /* Function to reset authorization keys */
 void ResetAuthKeys()
 {
-	for(uint8_t i = 0; i < MAX_LOGINS_HTTP_CLIENTS; i++)
-	{
-		clientConnections[i].IP_Addr = 0;
-		//clientConnections[i].port = 0;
-		clientConnections[i].ID = 0;
-	}
+	memset(sessions, 0, sizeof(sessions));
+	sessionsNum = 0;
 }
 
 /* Private functions ---------------------------------------------------------*/
-static BaseType_t HTML_LoginRequest(HTTPClient_t *pxClient, const char** pBuf)
+static BaseType_t HTML_LoginRequest(HTTPClient_t *pxClient)
 {
-	static bool firstKey = true;
-
-	/* Create temporarily variables */
-	char tmpValStr[32];
-
-	/* Check login and password */
+	/* Check login and password: both are required and are compared as whole
+	   decoded strings */
+	struct HTML_Query query;
 	BaseType_t login = pdFALSE;
-	if(SearchForStartParameter(pBuf))
+	if(HTML_QueryParse(pxClient, &query))
 	{
-		while(pdTRUE)
+		if((CredentialIsEqu(HTML_QueryGet(&query, "login"),
+				GetLogin(), HTML_LOGIN_MAX_LEN) == false) ||
+		   (CredentialIsEqu(HTML_QueryGet(&query, "password"),
+				GetPassword(), HTML_PASSW_MAX_LEN) == false))
 		{
-			/* Parse parameters */
-			/* Search login field */
-			if(ParamIsEqu(pBuf, "login"))
-			{
-				/* Get value as string */
-				GetValue(*pBuf, tmpValStr, sizeof(tmpValStr));
-
-				/* Compare with login */
-				if(ValueCmp(*pBuf, GetLogin()) == false)
-				{
-					/* Wrong login, send html to client */
-					return Send_HTML(pxClient);
-				}
-
-				/* Watch for end of parameters */
-				if(SearchForNextParameter(pBuf) == false) break;
-			}
-
-			/* Search password field */
-			if(ParamIsEqu(pBuf, "password"))
-			{
-				/* Get value as string */
-				GetValue(*pBuf, tmpValStr, sizeof(tmpValStr));
-
-				/* Compare with password */
-				if(ValueCmp(*pBuf, GetPassword()) == false)
-				{
-					/* Wrong password, send html to client */
-					return Send_HTML(pxClient);
-				}
-
-				/* Watch for end of parameters */
-				if(SearchForNextParameter(pBuf) == false) break;
-			}
-
-			/* Login button */
-			if(ParamIsEqu(pBuf, "Login"))
-			{
-				if(ValueCmp(*pBuf, "Login")) login = pdTRUE;
-			}
-
-			/* End of parsing */
-			break;
+			/* Wrong login or password, send html to client */
+			return Send_HTML(pxClient);
 		}
+
+		/* Login button */
+		if(HTML_QueryIs(&query, "Login", "Login")) login = pdTRUE;
 	}
 
 	if(login == pdFALSE)
 	{
 		/* Unexpected end, return pdFALSE for redirecting to logging form */
 		return pdFALSE;
-		/* Unexpected end, send 404 form */
-		//return Send_404(pxClient);
 	}
 
-	/* Store new key for new client */
-	struct freertos_sockaddr pxAddress;
-	pxAddress.sin_addr = 0;
-	pxAddress.sin_port = 0;
-
-	FreeRTOS_GetRemoteAddress(pxClient->xSocket, &pxAddress);
-	if((pxAddress.sin_addr == 0) || (pxAddress.sin_port == 0))
+	/* Open new session for the client */
+	struct HTTP_Session* session = SessionCreate();
+	if(session == NULL)
 	{
-		/* Something wrong with sockets,
-		   let client will try to login once again */
+		/* Random generator failed, let client will try to login once again */
 		return Send_HTML(pxClient);
 	}
 
-	/* Before adding new connection, try to search it from existing */
-	bool found = false;
-	for(uint8_t i = 0; i < MAX_LOGINS_HTTP_CLIENTS; i++)
-	{
-		/* Check IP address */
-		if(clientConnections[i].IP_Addr == pxAddress.sin_addr)
-		{
-			/* Check port */
-			//if(clientConnections[i].port == pxAddress.sin_port)
-			{
-				/* Connection already stored, just change key */
-				clientConnections[i].ID = package_ID;
-				found = true;
-			}
-		}
-	}
-
-	if(found == false)
-	{
-		/* First key must be random */
-		if(firstKey)
-		{
-			package_ID = (uint16_t)(xTaskGetTickCount() & 0xFFFF);
-			firstKey = false;
-		}
-		else
-		{
-			/* Make new ID */
-			package_ID++;
-		}
-
-		/* Create and store new connection */
-		clientConnections[pAppendingClientConnections].IP_Addr =
-				pxAddress.sin_addr;
-		/*clientConnections[pAppendingClientConnections].port =
-				pxAddress.sin_port;*/
-		clientConnections[pAppendingClientConnections].ID = package_ID;
-		pAppendingClientConnections++;
-		if(pAppendingClientConnections >= MAX_LOGINS_HTTP_CLIENTS)
-			pAppendingClientConnections = 0;
-	}
-
 	/* Redirect to main page */
-	return Send_HTML_Redirect(pxClient, package_ID);
+	return Send_HTML_Redirect(pxClient, session);
 }
 
 static BaseType_t Send_HTML(HTTPClient_t *pxClient)
 {
 	/* Attempt to create the temporary string buffer. */
-	char* tmpStr = (char*)pvPortMalloc(HTML_LOGIN_TMP_BUF_LEN);
+	char* tmpStr = (char*)GetHTML_Scratch(pxClient, HTML_LOGIN_TMP_BUF_LEN);
 	if(tmpStr == NULL)
 	{
 		FreeRTOS_printf(("Could not create temporary string buffer\n"));
@@ -402,44 +264,187 @@ static BaseType_t Send_HTML(HTTPClient_t *pxClient)
 
 	SendHTML_Block(pxClient, str_lgn_psswrd_b, sizeof(str_lgn_psswrd_b) - 1);
 
-	/* Free temporary string buffer */
-	vPortFree(tmpStr);
+	/* Release temporary string buffer */
+	ReleaseHTML_Scratch(pxClient, tmpStr);
 
 	return Send_HTML_End(pxClient);
 }
 
-static BaseType_t Send_HTML_Redirect(HTTPClient_t *pxClient, uint16_t key)
+static BaseType_t Send_HTML_Redirect(HTTPClient_t *pxClient,
+		const struct HTTP_Session* session)
 {
 	/* Attempt to create the temporary string buffer. */
-	char* tmpStr = (char*)pvPortMalloc(HTML_LOGIN_TMP_BUF_LEN);
+	char* tmpStr = (char*)GetHTML_Scratch(pxClient, HTML_SESSION_COOKIE_LEN);
 	if(tmpStr == NULL)
 	{
 		FreeRTOS_printf(("Could not create temporary string buffer\n"));
 		return -1;
 	}
 
-	/* Form key string */
-	SetNumToStr(key, tmpStr, HTML_LOGIN_TMP_BUF_LEN);
+	/* Form session cookie: "sid=<token>; <attributes>" */
+	char* pStr = SetValue(HTML_SESSION_COOKIE_NAME, tmpStr,
+			HTML_SESSION_COOKIE_LEN);
+	for(uint8_t i = 0; i < HTML_SESSION_TOKEN_WORDS; i++)
+		pStr = SetHexToStr(session->token[i], pStr, 9, false);
+	SetValue(HTML_SESSION_COOKIE_ATTRS, pStr,
+			sizeof(HTML_SESSION_COOKIE_ATTRS));
 
-	/* Send html header */
-	//SendHTML_Header_OK(pxClient);
-	SendHTML_Header_RedirectToRoot(pxClient,
-			tmpStr, GetSizeOfStr(tmpStr, HTML_LOGIN_TMP_BUF_LEN));
-
-	SendHTML_Block(pxClient, str_redirect_to_main_b,
-			sizeof(str_redirect_to_main_b) - 1);
-	SendHTML_Block(pxClient, tmpStr,
-					GetSizeOfStr(tmpStr, HTML_LOGIN_TMP_BUF_LEN));
-	SendHTML_Block(pxClient, str_redirect_to_main_1,
-			sizeof(str_redirect_to_main_1) - 1);
-	SendHTML_Block(pxClient, tmpStr,
-					GetSizeOfStr(tmpStr, HTML_LOGIN_TMP_BUF_LEN));
-	SendHTML_Block(pxClient, str_redirect_to_main_e,
-			sizeof(str_redirect_to_main_e) - 1);
-
-	/* Free temporary string buffer */
-	vPortFree(tmpStr);
+	/* Send html header with the cookie, the key is not shown in URL */
+	SendHTML_Header_RedirectToRoot(pxClient, tmpStr);
+
+	/* Release temporary string buffer */
+	ReleaseHTML_Scratch(pxClient, tmpStr);
+
+	SendHTML_Block(pxClient, str_redirect_to_main,
+			sizeof(str_redirect_to_main) - 1);
 
 	/* Send last empty block */
 	return SendHTML_Block(pxClient, "", 0);
 }
+
+/* Stored string may fill the whole array without terminal symbol */
+static bool CredentialIsEqu(const char* value, const char* stored,
+		uint16_t size)
+{
+	if(value == NULL) return false;
+	if(GetSizeOfStr(value, size + 1) > size) return false;
+	return (strncmp(value, stored, size) == 0);
+}
+
+/* Token of session from the cookie "sid" */
+static bool GetSessionToken(HTTPClient_t *pxClient, uint32_t* token)
+{
+	const char* str = GetHTML_RequestHeader(pxClient, "Cookie");
+	if(str == NULL) return false;
+
+	/* Cookies are "name=value; name=value", stored header ends with "\r\n" */
+	while((*str != '\0') && (*str != '\r'))
+	{
+		while(*str == ' ') str++;
+		if(strncmp(str, HTML_SESSION_COOKIE_NAME,
+				sizeof(HTML_SESSION_COOKIE_NAME) - 1) == 0)
+		{
+			str += sizeof(HTML_SESSION_COOKIE_NAME) - 1;
+			for(uint8_t i = 0; i < HTML_SESSION_TOKEN_DIGITS; i++)
+			{
+				char c = *(str++);
+				uint8_t digit;
+				if((c >= '0') && (c <= '9')) digit = c - '0';
+				else if((c >= 'A') && (c <= 'F')) digit = c - 'A' + 10;
+				else if((c >= 'a') && (c <= 'f')) digit = c - 'a' + 10;
+				else return false;
+				if((i % 8) == 0) token[i / 8] = 0;
+				token[i / 8] = (token[i / 8] << 4) | digit;
+			}
+			return (*str == '\0') || (*str == ';') || (*str == ' ') ||
+					(*str == '\r');
+		}
+
+		/* Skip to the next cookie */
+		while((*str != '\0') && (*str != '\r') && (*str != ';')) str++;
+		if(*str == ';') str++;
+	}
+
+	return false;
+}
+
+static struct HTTP_Session* SessionFind(const uint32_t* token)
+{
+	/* Chain of the token ends with empty slot, table is never full */
+	uint16_t idx = token[0] & HTML_SESSIONS_TABLE_MASK;
+	for(uint16_t i = 0; i < HTML_SESSIONS_TABLE_SIZE; i++)
+	{
+		if(sessions[idx].used == false) break;
+		if(TokenIsEqu(sessions[idx].token, token)) return &sessions[idx];
+		idx = (idx + 1) & HTML_SESSIONS_TABLE_MASK;
+	}
+	return NULL;
+}
+
+static struct HTTP_Session* SessionCreate()
+{
+	TickType_t now = xTaskGetTickCount();
+	uint32_t token[HTML_SESSION_TOKEN_WORDS];
+
+	/* Token is made by hardware random generator */
+	for(uint8_t i = 0; i < HTML_SESSION_TOKEN_WORDS; i++)
+	{
+		if(GetHardwareRandom(&token[i]) == false) return NULL;
+	}
+
+	/* Free place for the new session: expired sessions are closed, then the
+	   least recently used one */
+	SessionsRemoveExpired(now);
+	if(sessionsNum >= MAX_LOGINS_HTTP_CLIENTS)
+	{
+		struct HTTP_Session* oldest = NULL;
+		for(uint16_t i = 0; i < HTML_SESSIONS_TABLE_SIZE; i++)
+		{
+			if(sessions[i].used && ((oldest == NULL) ||
+				((now - sessions[i].lastAccess) >
+				 (now - oldest->lastAccess)))) oldest = &sessions[i];
+		}
+		if(oldest != NULL) SessionRemove(oldest);
+	}
+
+	/* Store it in the first empty slot of its chain */
+	uint16_t idx = token[0] & HTML_SESSIONS_TABLE_MASK;
+	while(sessions[idx].used) idx = (idx + 1) & HTML_SESSIONS_TABLE_MASK;
+
+	memcpy(sessions[idx].token, token, sizeof(token));
+	sessions[idx].lastAccess = now;
+	sessions[idx].used = true;
+	sessionsNum++;
+	return &sessions[idx];
+}
+
+static void SessionRemove(struct HTTP_Session* session)
+{
+	uint16_t hole = session - sessions;
+	uint16_t idx = hole;
+
+	/* Backward shift: sessions of the chain after the removed one are moved
+	   to the hole, if it is not before their hash slot (no deleted marks) */
+	for(;;)
+	{
+		idx = (idx + 1) & HTML_SESSIONS_TABLE_MASK;
+		if(sessions[idx].used == false) break;
+
+		uint16_t home = sessions[idx].token[0] & HTML_SESSIONS_TABLE_MASK;
+		if(((idx - home) & HTML_SESSIONS_TABLE_MASK) >=
+		   ((idx - hole) & HTML_SESSIONS_TABLE_MASK))
+		{
+			sessions[hole] = sessions[idx];
+			hole = idx;
+		}
+	}
+
+	memset(&sessions[hole], 0, sizeof(sessions[hole]));
+	sessionsNum--;
+}
+
+static void SessionsRemoveExpired(TickType_t now)
+{
+	for(uint16_t i = 0; i < HTML_SESSIONS_TABLE_SIZE; i++)
+	{
+		/* Removing moves the next session of the chain to this slot */
+		while(sessions[i].used && SessionIsExpired(&sessions[i], now))
+			SessionRemove(&sessions[i]);
+	}
+}
+
+static bool SessionIsExpired(const struct HTTP_Session* session,
+		TickType_t now)
+{
+	return (now - session->lastAccess) >
+			pdMS_TO_TICKS(HTML_SESSION_IDLE_TIMEOUT);
+}
+
+/* Comparison time does not depend on the matched part of the tokens */
+static bool TokenIsEqu(const uint32_t* token1, const uint32_t* token2)
+{
+	uint32_t diff = 0;
+	for(uint8_t i = 0; i < HTML_SESSION_TOKEN_WORDS; i++)
+		diff |= token1[i] ^ token2[i];
+	return (diff == 0);
+}
@@ -1,8 +1,10 @@
 /* Includes ----------------------------------------------------------------- */
 #include "web-server.h"
 #include "html_txt_funcs.h"
+#include "html_query.h"
 #include "HTML_Header.h"
 #include "HTML_NetworkSettings.h"
+#include "settings_registry.h"
 
 /* Private constants -------------------------------------------------------- */
 #define HTML_NETWORK_SETTINGS_TMP_BUF_LEN 16
@@ -86,182 +88,102 @@ BaseType_t Parse_HTML_NetworkSettings(HTTPClient_t *pxClient)
 	}
 	taskEXIT_CRITICAL();
 
-	/* Search for "?" - start of parameters */
+	/* Parameters are looked up by key in any order */
+	struct HTML_Query query;
 	bool apply = pdFALSE;
-	if(SearchForStartParameter(&buf))
+	if(HTML_QueryParse(pxClient, &query))
 	{
 		/* Create temporarily variables */
-		char tmpValStr[32];
-		while(pdTRUE)
-		{
-			/* Parse parameters */
-			/* Protocol type -------------------------------------------------*/
-			if(ParamIsEqu(&buf, "t_nw_st"))
-			{
-				if(ValueCmp(buf, "dn")) settings.protocolType = DHCP;
-				else if(ValueCmp(buf, "st")) settings.protocolType = Static_IP;
-
-				/* Watch for end of parameters */
-				if(SearchForNextParameter(&buf) == false) break;
-			}
-
-			/* IP */
-			if(ParamIsEqu(&buf, "IP"))
-			{
-				/* Get value as string */
-				GetValue(buf, tmpValStr, sizeof(tmpValStr));
-
-				/* Try to convert string to IP address */
-				settings.staticIP_Addr = FreeRTOS_inet_addr(tmpValStr);
+		const char* value;
 
-				/* Watch for end of parameters */
-				if(SearchForNextParameter(&buf) == false) break;
-			}
-
-			/* Netmask */
-			if(ParamIsEqu(&buf, "msk"))
-			{
-				/* Get value as string */
-				GetValue(buf, tmpValStr, sizeof(tmpValStr));
-
-				/* Try to convert string to number */
-				settings.staticNetmask = FreeRTOS_inet_addr(tmpValStr);
-
-				/* Watch for end of parameters */
-				if(SearchForNextParameter(&buf) == false) break;
-			}
-
-			/* GW */
-			if(ParamIsEqu(&buf, "GW"))
-			{
-				/* Get value as string */
-				GetValue(buf, tmpValStr, sizeof(tmpValStr));
-
-				/* Try to convert string to number */
-				settings.staticIP_Addr_GW = FreeRTOS_inet_addr(tmpValStr);
+		/* Protocol type -----------------------------------------------------*/
+		value = HTML_QueryGet(&query, "t_nw_st");
+		if(value != NULL)
+		{
+			if(ValueCmp(value, "dn")) settings.protocolType = DHCP;
+			else if(ValueCmp(value, "st")) settings.protocolType = Static_IP;
+		}
 
-				/* Watch for end of parameters */
-				if(SearchForNextParameter(&buf) == false) break;
-			}
+		/* IP */
+		value = HTML_QueryGet(&query, "IP");
+		if(value != NULL) settings.staticIP_Addr = FreeRTOS_inet_addr(value);
 
-			/* DNS */
-			if(ParamIsEqu(&buf, "DNS"))
-			{
-				/* Get value as string */
-				GetValue(buf, tmpValStr, sizeof(tmpValStr));
+		/* Netmask */
+		value = HTML_QueryGet(&query, "msk");
+		if(value != NULL) settings.staticNetmask = FreeRTOS_inet_addr(value);
 
-				/* Try to convert string to number */
-				settings.staticIP_Addr_DNS = FreeRTOS_inet_addr(tmpValStr);
+		/* GW */
+		value = HTML_QueryGet(&query, "GW");
+		if(value != NULL) settings.staticIP_Addr_GW = FreeRTOS_inet_addr(value);
 
-				/* Watch for end of parameters */
-				if(SearchForNextParameter(&buf) == false) break;
-			}
+		/* DNS */
+		value = HTML_QueryGet(&query, "DNS");
+		if(value != NULL) settings.staticIP_Addr_DNS = FreeRTOS_inet_addr(value);
 
 #ifdef ALLOW_MAC_ADDRESS_OVERRIDE
-			/* Parse MAC settings --------------------------------------------*/
-			if(ParamIsEqu(&buf, "macRB"))
-			{
-				if(ValueCmp(buf, "ovrd")) settings.MAC_AddrIsOvrd = pdTRUE;
+		/* Parse MAC settings ------------------------------------------------*/
+		if(HTML_QueryIs(&query, "macRB", "ovrd")) settings.MAC_AddrIsOvrd = pdTRUE;
 
-				/* Watch for end of parameters */
-				if(SearchForNextParameter(&buf) == false) break;
-			}
-
-			/* Parse overrode MAC */
-			if(ParamIsEqu(&buf, "mac_ovrd"))
+		/* Parse overrode MAC (value is decoded: "XX:XX:XX:XX:XX:XX") */
+		value = HTML_QueryGet(&query, "mac_ovrd");
+		if(value != NULL)
+		{
+			/* Try to convert string to MAC array */
+			BaseType_t compl = pdFALSE;
+			int32_t tmp32;
+			const char* tmpStr = value;
+			uint8_t* pMAC_Addr = settings.MAC_Addr;
+			for(uint8_t i = 0;;)
 			{
-				/* Get value as special string */
-				GetValueFromTxtField(&buf, tmpValStr, sizeof(tmpValStr), true);
-
-				/* Try to convert string to MAC array */
-				BaseType_t compl = pdFALSE;
-				int32_t tmp32;
-				const char* tmpStr = tmpValStr;
-				uint8_t* pMAC_Addr = settings.MAC_Addr;
-				for(uint8_t i = 0;;)
+				/* Get MAC octet */
+				/* Get number and validate it */
+				if(GetHexFromStr(&tmpStr, &tmp32, pdTRUE) == false)
+					break;
+				if(tmp32 <= 0xFF)
 				{
-					/* Get MAC octet */
-					/* Get number and validate it */
-					if(GetHexFromStr(&tmpStr, &tmp32, pdTRUE) == false)
-						break;
-					if(tmp32 <= 0xFF)
-					{
-						/* Append number to MAC array */
-						*pMAC_Addr = (uint8_t)(tmp32);
-					}
-
-					i++;
-					if(i >= ipMAC_ADDRESS_LENGTH_BYTES)
-					{
-						compl = pdTRUE;
-						break;
-					}
-					pMAC_Addr++;
-
-					/* Check for colon */
-					if(*tmpStr != ':') break;
-					tmpStr++;
+					/* Append number to MAC array */
+					*pMAC_Addr = (uint8_t)(tmp32);
 				}
 
-				/* Validate parsed MAC */
-				if(compl == pdFALSE)
+				i++;
+				if(i >= ipMAC_ADDRESS_LENGTH_BYTES)
 				{
-					/* Restore the current MAC */
-					taskENTER_CRITICAL();
-					{
-						const uint8_t* pCurrMAC_Addr = WebServerGetMAC_Addr();
-						uint8_t* pSetMAC_Addr = settings.MAC_Addr;
-						for(uint8_t i = 0; i < ipMAC_ADDRESS_LENGTH_BYTES; i++)
-						{
-							*pSetMAC_Addr = *pCurrMAC_Addr;
-							pSetMAC_Addr++;
-							pCurrMAC_Addr++;
-						}
-					}
-					taskEXIT_CRITICAL();
+					compl = pdTRUE;
+					break;
 				}
+				pMAC_Addr++;
 
-				/* Watch for end of parameters */
-				if(SearchForNextParameter(&buf) == false) break;
+				/* Check for colon */
+				if(*tmpStr != ':') break;
+				tmpStr++;
 			}
-#endif /*ALLOW_MAC_ADDRESS_OVERRIDE*/
 
-			/* Login and password for UI -------------------------------------*/
-			/* Login */
-			if(ParamIsEqu(&buf, "login"))
+			/* Validate parsed MAC */
+			if(compl == pdFALSE)
 			{
-				/* Get value as string */
-				GetValue(buf, tmpValStr, sizeof(tmpValStr));
-
-				/* Story it to settings variable */
-				SetValue(tmpValStr, settings.login, HTML_LOGIN_MAX_LEN);
-
-				/* Watch for end of parameters */
-				if(SearchForNextParameter(&buf) == false) break;
-			}
-
-			/* Password */
-			if(ParamIsEqu(&buf, "passw"))
-			{
-				/* Get value as string */
-				GetValue(buf, tmpValStr, sizeof(tmpValStr));
-
-				/* Story it to settings variable */
-				SetValue(tmpValStr, settings.password, HTML_PASSW_MAX_LEN);
-
-				/* Watch for end of parameters */
-				if(SearchForNextParameter(&buf) == false) break;
+				/* Restore the current MAC */
+				taskENTER_CRITICAL();
+				{
+					const uint8_t* pCurrMAC_Addr = WebServerGetMAC_Addr();
+					uint8_t* pSetMAC_Addr = settings.MAC_Addr;
+					for(uint8_t i = 0; i < ipMAC_ADDRESS_LENGTH_BYTES; i++)
+					{
+						*pSetMAC_Addr = *pCurrMAC_Addr;
+						pSetMAC_Addr++;
+						pCurrMAC_Addr++;
+					}
+				}
+				taskEXIT_CRITICAL();
 			}
+		}
+#endif /*ALLOW_MAC_ADDRESS_OVERRIDE*/
 
-			/* Apply */
-			if(ParamIsEqu(&buf, "b_apl"))
-			{
-				if(ValueCmp(buf, "apl_st")) apply = pdTRUE;
-			}
+		/* Login and password for UI (decoded: "+" and "/" are allowed) ------*/
+		HTML_QueryGetStr(&query, "login", settings.login, HTML_LOGIN_MAX_LEN);
+		HTML_QueryGetStr(&query, "passw", settings.password, HTML_PASSW_MAX_LEN);
 
-			/* End of parsing */
-			break;
-		}
+		/* Apply */
+		if(HTML_QueryIs(&query, "b_apl", "apl_st")) apply = pdTRUE;
 	}
 
 	if(apply)
@@ -275,6 +197,7 @@ BaseType_t Parse_HTML_NetworkSettings(HTTPClient_t *pxClient)
 			staticNetMask = settings.staticNetmask;
 			staticIP_GW = settings.staticIP_Addr_GW;
 			staticIP_DNS = settings.staticIP_Addr_DNS;
+			SettingsRegistryChanged();
 
 #ifdef ALLOW_MAC_ADDRESS_OVERRIDE
 			/* MAC settings */
@@ -347,7 +270,7 @@ Apply settings</button>\
 </pre>";
 
 	/* Attempt to create the temporary string buffer. */
-	char* tmpStr = (char*)pvPortMalloc(HTML_NETWORK_SETTINGS_TMP_BUF_LEN);
+	char* tmpStr = (char*)GetHTML_Scratch(pxClient, HTML_NETWORK_SETTINGS_TMP_BUF_LEN);
 	if(tmpStr == NULL)
 	{
 		FreeRTOS_printf(("Could not create temporary string buffer\n"));
@@ -610,8 +533,8 @@ Password:      ";
 			GetSizeOfStr(settings.password,
 					HTML_NETWORK_SETTINGS_TMP_BUF_LEN), 16);
 
-	/* Free temporary string buffer */
-	vPortFree(tmpStr);
+	/* Release temporary string buffer */
+	ReleaseHTML_Scratch(pxClient, tmpStr);
 	
 	/* Send end of html page */
 	SendHTML_Block(pxClient, str_end, sizeof(str_end) - 1);
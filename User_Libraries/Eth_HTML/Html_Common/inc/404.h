@@ -6,5 +6,6 @@
 
 // Public function prototypes --------------------------------------------------
 BaseType_t Send_404(HTTPClient_t *pxClient);
+BaseType_t Send_405(HTTPClient_t *pxClient);
 
 #endif // _HTTP_404_H_
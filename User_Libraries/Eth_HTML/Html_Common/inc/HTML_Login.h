@@ -6,5 +6,7 @@
 
 // Public function prototypes --------------------------------------------------
 BaseType_t HTML_Login(HTTPClient_t *pxClient);
+/* Request comes in the session of logged in client (its cookie is checked) */
+bool HTML_LoginSessionIsValid(HTTPClient_t *pxClient);
 
 #endif // _HTTP_LOGIN_H_
@@ -0,0 +1,9 @@
+/* Common script of the web UI pages */
+function stopRKey(evt)
+{
+  var evt = (evt) ? evt : ((event) ? event : null);
+  var node = (evt.target) ? evt.target :
+    ((evt.srcElement) ? evt.srcElement : null);
+  if ((evt.keyCode == 13) && (node.type=="text"))  {return false;}
+}
+document.onkeypress = stopRKey;
@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+"""Decoder of the event log of flash (see event_log.h).
+
+The dump is got from the device by "GET /api/eventlog" (the session cookie
+of web UI is required), its parts - by range requests, e.g.:
+    curl -b "<cookie>" -r 0-65535 http://<device>/api/eventlog -o part.bin
+Records are fixed-size (64 bytes): parts have to be aligned to records.
+Valid records (CRC-32) are printed in order of sequence numbers, deferred
+records are rendered with format strings of the firmware ELF (see
+decode_udp_log.py).
+
+Usage:
+    decode_event_log.py <dump.bin | -> <firmware.elf>
+"""
+
+import argparse
+import struct
+import sys
+import zlib
+
+from decode_udp_log import Elf, render, timestamp, TYPE_PREFIXES, \
+    FORMATS_SECTION
+
+RECORD_SIZE = 64
+DATA_SIZE = 44
+FORMAT_TEXT = 0xFFFF
+SEQUENCE_FREE = 0xFFFFFFFF
+
+# struct EventLogRecord: sequence, counter, fraction, format, type, length,
+# reserved, data, crc
+RECORD = struct.Struct("<IIHHBBH%dsI" % DATA_SIZE)
+
+
+def records(dump):
+    for pos in range(0, len(dump) - RECORD_SIZE + 1, RECORD_SIZE):
+        raw = dump[pos:pos + RECORD_SIZE]
+        sequence, counter, fraction, fmt, log_type, length, _, data, crc = \
+            RECORD.unpack(raw)
+        if sequence == SEQUENCE_FREE or \
+                zlib.crc32(raw[:RECORD_SIZE - 4]) != crc:
+            continue
+        yield sequence, counter, fraction, fmt, log_type, \
+            data[:min(length, DATA_SIZE)]
+
+
+def decode(elf, record):
+    sequence, counter, fraction, fmt, log_type, data = record
+    prefix = TYPE_PREFIXES[log_type] if log_type < len(TYPE_PREFIXES) \
+        else "??:"
+    if fmt == FORMAT_TEXT:
+        text = data.decode("latin-1")
+    else:
+        args = struct.unpack("<%dI" % (len(data) // 4),
+                             data[:len(data) // 4 * 4])
+        fmt_str = elf.format(fmt)
+        text = render(elf, fmt_str, args) if fmt_str is not None else \
+            "<unknown format 0x%04x: %s>" % (
+                fmt, ", ".join("0x%x" % a for a in args))
+    return "%10u %s %s%s" % (sequence, timestamp(counter, fraction), prefix,
+                             text)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Decode dump of the event log of the device")
+    parser.add_argument("dump", help="dump of /api/eventlog (- for stdin)")
+    parser.add_argument("elf", help="ELF file of the running firmware")
+    args = parser.parse_args()
+
+    elf = Elf(args.elf)
+    if FORMATS_SECTION not in elf.sections:
+        sys.stderr.write("warning: no section %s in %s\n"
+                         % (FORMATS_SECTION, args.elf))
+
+    if args.dump == "-":
+        dump = sys.stdin.buffer.read()
+    else:
+        with open(args.dump, "rb") as f:
+            dump = f.read()
+
+    for record in sorted(records(dump)):
+        print(decode(elf, record))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,183 @@
+#!/usr/bin/env python3
+"""Decoder of UDP logging with deferred records.
+
+Receives datagrams of UDP_logging.c and prints them as text. Text datagrams
+("EV:text" lines) are printed as is. Binary datagrams (zero byte, version,
+records) hold only offsets of format strings, timestamps and raw arguments:
+format strings are read from section ".log_formats" of the firmware ELF,
+strings of "%s" arguments - from its loadable sections.
+
+Usage:
+    decode_udp_log.py [-p <port>] [-b <address>] <firmware.elf>
+
+The ELF must be the same build that runs on the device.
+"""
+
+import argparse
+import datetime
+import re
+import socket
+import struct
+import sys
+
+BINARY_VERSION = 1
+FORMATS_SECTION = ".log_formats"
+
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+TYPE_PREFIXES = ("EV:", "WR:", "ER:")
+
+# Header of record after type and number of arguments (see
+# struct UDP_LogDeferredRecord): format offset, fraction, counter
+RECORD_HEADER = struct.Struct("<HHI")
+
+FORMAT_SPEC = re.compile(
+    r"%(?P<flags>[-+ #0]*)(?P<width>\d+)?(?P<precision>\.\d+)?"
+    r"(?:hh|h|ll|l|z|j|t)?(?P<conv>[diouxXcsp%])")
+
+
+class Elf:
+    """Sections of 32-bit little-endian ELF (enough for ARM firmware)."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF" or self.data[4] != 1 or \
+                self.data[5] != 1:
+            raise ValueError("%s: not a 32-bit little-endian ELF" % path)
+
+        shoff, = struct.unpack_from("<I", self.data, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", self.data,
+                                                        0x2E)
+        headers = [struct.unpack_from("<IIIIIIIIII", self.data,
+                                      shoff + i * shentsize)
+                   for i in range(shnum)]
+        names = headers[shstrndx]
+
+        self.sections = {}
+        self.loadable = []
+        for header in headers:
+            name, sh_type, flags, addr, offset, size = header[:6]
+            name = self._cstr(names[4] + name)
+            content = b"" if sh_type == SHT_NOBITS else \
+                self.data[offset:offset + size]
+            self.sections[name] = content
+            if (flags & SHF_ALLOC) and sh_type != SHT_NOBITS and size:
+                self.loadable.append((addr, content))
+
+    def _cstr(self, offset):
+        return self.data[offset:self.data.index(b"\0", offset)].decode(
+            "latin-1")
+
+    def format(self, offset):
+        formats = self.sections.get(FORMATS_SECTION, b"")
+        end = formats.find(b"\0", offset)
+        if offset >= len(formats) or end < 0:
+            return None
+        return formats[offset:end].decode("latin-1")
+
+    def string(self, addr):
+        for start, content in self.loadable:
+            if start <= addr < start + len(content):
+                end = content.find(b"\0", addr - start)
+                if end >= 0:
+                    return content[addr - start:end].decode("latin-1")
+        return "<0x%08x>" % addr
+
+
+def render(elf, fmt, args):
+    """printf of the device with 32-bit arguments."""
+    args = list(args)
+
+    def convert(match):
+        conv = match.group("conv")
+        if conv == "%":
+            return "%"
+        if not args:
+            return "<?>"
+        value = args.pop(0)
+        spec = "%" + match.group("flags") + (match.group("width") or "") + \
+            (match.group("precision") or "")
+        if conv in "di":
+            return (spec + "d") % (value - (1 << 32) if value & (1 << 31)
+                                   else value)
+        if conv == "c":
+            return (spec + "c") % chr(value & 0xFF)
+        if conv == "s":
+            return (spec + "s") % elf.string(value)
+        if conv == "p":
+            return "0x%08x" % value
+        return (spec + conv) % value
+
+    text = FORMAT_SPEC.sub(convert, fmt)
+    if args:
+        text += " <extra arguments: %s>" % ", ".join("0x%x" % a
+                                                       for a in args)
+    return text
+
+
+def timestamp(counter, fraction):
+    time = datetime.datetime(1970, 1, 1) + datetime.timedelta(
+        seconds=counter, microseconds=fraction * 1000000 // 65536)
+    return time.strftime("%Y-%m-%d %H:%M:%S.%f")[:-3]
+
+
+def decode_binary(elf, data):
+    if len(data) < 2 or data[1] != BINARY_VERSION:
+        yield "<unsupported version of binary datagram>"
+        return
+
+    pos = 2
+    while pos + 2 + RECORD_HEADER.size <= len(data):
+        log_type, args_num = data[pos], data[pos + 1]
+        offset, fraction, counter = RECORD_HEADER.unpack_from(data, pos + 2)
+        pos += 2 + RECORD_HEADER.size
+        if pos + args_num * 4 > len(data):
+            yield "<truncated record>"
+            return
+        args = struct.unpack_from("<%dI" % args_num, data, pos)
+        pos += args_num * 4
+
+        fmt = elf.format(offset)
+        prefix = TYPE_PREFIXES[log_type] if log_type < len(TYPE_PREFIXES) \
+            else "??:"
+        text = render(elf, fmt, args) if fmt is not None else \
+            "<unknown format 0x%04x: %s>" % (
+                offset, ", ".join("0x%x" % a for a in args))
+        yield "%s %s%s" % (timestamp(counter, fraction), prefix, text)
+
+
+def decode(elf, data):
+    if data[:1] == b"\0":
+        yield from decode_binary(elf, data)
+    else:
+        for line in data.decode("latin-1").splitlines():
+            yield "%23s %s" % ("", line)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Receive and decode UDP logging of the device")
+    parser.add_argument("-p", "--port", type=int, default=1536,
+                        help="UDP port of logging (default 1536)")
+    parser.add_argument("-b", "--bind", default="",
+                        help="local address to listen (default all)")
+    parser.add_argument("elf", help="ELF file of the running firmware")
+    args = parser.parse_args()
+
+    elf = Elf(args.elf)
+    if FORMATS_SECTION not in elf.sections:
+        sys.stderr.write("warning: no section %s in %s\n"
+                         % (FORMATS_SECTION, args.elf))
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind((args.bind, args.port))
+    while True:
+        data, address = sock.recvfrom(65536)
+        for line in decode(elf, data):
+            print("%s %s" % (address[0], line), flush=True)
+
+
+if __name__ == "__main__":
+    main()
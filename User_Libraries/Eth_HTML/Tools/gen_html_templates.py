@@ -0,0 +1,211 @@
+#!/usr/bin/env python3
+"""HTML templates compiler for the HTTP server.
+
+Every "<Name>.html" file of the given directories is compiled to the opcodes
+stream "tpl<Name>" (see html_template.h): runs of literal text and typed
+variable slots. Variables are written in the template as "{{type:name}}":
+
+    str      - string as is (const char*)
+    num      - signed decimal number (int32_t)
+    d2       - two decimal digits with leading zero (int32_t)
+    ip       - IP-address in network byte order (uint32_t)
+    checked  - "checked " attribute of check-box, if flag is set (bool)
+
+Indexes of variable slots are generated to the header as
+"TPL_<NAME>_<VARIABLE>" constants, "TPL_<NAME>_VARS_NUM" is the size of the
+slots array for SendHTML_Template().
+
+Usage:
+    gen_html_templates.py -o HTML_Templates.c -i HTML_Templates.h <dir> ...
+
+Output files are rewritten only if their contents were changed.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+OPCODES = {
+    "str": "HTML_TPL_STR",
+    "num": "HTML_TPL_NUM",
+    "d2": "HTML_TPL_DIGITS2",
+    "ip": "HTML_TPL_IP",
+    "checked": "HTML_TPL_CHECKED",
+}
+OPCODE_VALUES = {
+    "HTML_TPL_LITERAL": 0x01,
+    "HTML_TPL_STR": 0x10,
+    "HTML_TPL_NUM": 0x11,
+    "HTML_TPL_DIGITS2": 0x12,
+    "HTML_TPL_IP": 0x13,
+    "HTML_TPL_CHECKED": 0x14,
+}
+
+VARIABLE = re.compile(r"\{\{\s*(\w+)\s*:\s*([A-Za-z_]\w*)\s*\}\}")
+MAX_LITERAL = 0xFFFF
+
+HEADER_C = """\
+/* Compiled HTML templates of the web UI pages */
+/* This file is generated by User_Libraries/Eth_HTML/Tools/gen_html_templates.py
+ * from the "templates" directories, do not edit it manually! */
+
+/* Includes ----------------------------------------------------------------- */
+#include "HTML_Templates.h"
+
+/* Variables ---------------------------------------------------------------- */
+"""
+
+HEADER_H = """\
+/* Compiled HTML templates of the web UI pages */
+/* This file is generated by User_Libraries/Eth_HTML/Tools/gen_html_templates.py
+ * from the "templates" directories, do not edit it manually! */
+#ifndef _HTML_TEMPLATES_H_
+#define _HTML_TEMPLATES_H_
+
+/* Includes ----------------------------------------------------------------- */
+#include "html_template.h"
+
+/* Public constants --------------------------------------------------------- */
+"""
+
+
+def upper_name(name):
+    return re.sub(r"(?<=[a-z0-9])(?=[A-Z])", "_", name).upper()
+
+
+def c_string(data):
+    out = []
+    for b in data:
+        ch = chr(b)
+        if ch == "\\" or ch == '"':
+            out.append("\\" + ch)
+        elif ch == "\n":
+            out.append("\\n")
+        elif ch == "\r":
+            out.append("\\r")
+        elif ch == "\t":
+            out.append("\\t")
+        elif 0x20 <= b < 0x7F:
+            out.append(ch)
+        else:
+            out.append("\\%03o" % b)
+    return "".join(out)
+
+
+def opcode(op, *args):
+    return '"' + "".join("\\x%02x" % b for b in (OPCODE_VALUES[op],) + args) \
+        + '"'
+
+
+def compile_template(src):
+    with open(src, "rb") as f:
+        text = f.read()
+    if text.endswith(b"\n"):
+        text = text[:-1]
+    text = text.decode("utf-8")
+
+    slots = []
+    types = {}
+    lines = []
+
+    def add_literal(literal):
+        data = literal.encode("utf-8")
+        for i in range(0, len(data), MAX_LITERAL):
+            part = data[i:i + MAX_LITERAL]
+            lines.append(opcode("HTML_TPL_LITERAL",
+                                len(part) & 0xFF, len(part) >> 8))
+            # Keep text readable: one line of template is one line of C
+            for line in part.split(b"\n")[:-1]:
+                lines.append('"' + c_string(line + b"\n") + '"')
+            tail = part.split(b"\n")[-1]
+            if tail:
+                lines.append('"' + c_string(tail) + '"')
+
+    pos = 0
+    for m in VARIABLE.finditer(text):
+        vtype, name = m.group(1), m.group(2)
+        if vtype not in OPCODES:
+            sys.exit("%s: unknown type of variable '%s'" % (src, m.group(0)))
+        if name in types and types[name] != vtype:
+            sys.exit("%s: variable '%s' has different types" % (src, name))
+        if name not in types:
+            types[name] = vtype
+            slots.append(name)
+
+        if m.start() > pos:
+            add_literal(text[pos:m.start()])
+        lines.append(opcode(OPCODES[vtype], slots.index(name)))
+        pos = m.end()
+    if pos < len(text):
+        add_literal(text[pos:])
+
+    if len(slots) > 0xFF:
+        sys.exit("%s: too many variables" % src)
+    return slots, lines
+
+
+def render(templates):
+    c_out = [HEADER_C]
+    h_out = [HEADER_H]
+    for name in sorted(templates):
+        slots, lines = templates[name]
+        prefix = "TPL_" + upper_name(name)
+
+        h_out.append("/* Variables of %s template */\n" % name)
+        h_out.append("enum %s_Vars\n{\n" % name)
+        for slot in slots:
+            h_out.append("\t%s_%s,\n" % (prefix, slot.upper()))
+        h_out.append("\t%s_VARS_NUM\n};\n\n" % prefix)
+
+        # Terminating zero of the string is HTML_TPL_END
+        c_out.append("const uint8_t tpl%s[] =\n" % name)
+        c_out.append("".join("\t" + line + "\n" for line in lines[:-1]))
+        c_out.append("\t" + lines[-1] + ";\n\n")
+
+    h_out.append("/* Variables ---------------------------------------------"
+                 "------------------- */\n")
+    for name in sorted(templates):
+        h_out.append("extern const uint8_t tpl%s[];\n" % name)
+    h_out.append("\n#endif /* _HTML_TEMPLATES_H_ */\n")
+
+    return ("".join(c_out).rstrip("\n") + "\n").replace("\n", "\r\n"), \
+        "".join(h_out).replace("\n", "\r\n")
+
+
+def update(path, text):
+    if os.path.exists(path):
+        with open(path, "r", newline="") as f:
+            if f.read() == text:
+                return
+    with open(path, "w", newline="") as f:
+        f.write(text)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Compile HTML templates for HTTP server")
+    parser.add_argument("-o", "--output", required=True, help="output C-file")
+    parser.add_argument("-i", "--header", required=True,
+                        help="output header file")
+    parser.add_argument("dirs", nargs="+", help="directories with templates")
+    args = parser.parse_args()
+
+    templates = {}
+    for directory in args.dirs:
+        for file_name in sorted(os.listdir(directory)):
+            name, ext = os.path.splitext(file_name)
+            if ext != ".html":
+                continue
+            if name in templates:
+                sys.exit("Duplicated template: " + file_name)
+            templates[name] = compile_template(os.path.join(directory,
+                                                            file_name))
+
+    c_text, h_text = render(templates)
+    update(args.output, c_text)
+    update(args.header, h_text)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+"""Static assets generator for the HTTP server.
+
+Compresses every file of the given directories with gzip and writes them to
+the C-file as const table of "struct HTTP_StaticAsset" (see
+httpserver-netconn.h), sorted by path. Assets are served as
+"/static/<file name>" with precomputed ETag (CRC32 of the source file) and
+length, so nothing is computed at run time.
+
+Usage:
+    gen_static_assets.py -o HTML_Assets.c <assets dir> [<assets dir> ...]
+
+Output file is rewritten only if its contents were changed.
+"""
+
+import argparse
+import gzip
+import os
+import sys
+import zlib
+
+URL_PREFIX = "/static/"
+
+CONTENT_TYPES = {
+    ".css": "text/css",
+    ".htm": "text/html",
+    ".html": "text/html",
+    ".ico": "image/x-icon",
+    ".js": "text/javascript",
+    ".json": "application/json",
+    ".png": "image/png",
+    ".svg": "image/svg+xml",
+    ".txt": "text/plain",
+}
+
+# Already compressed formats are stored as is
+NOT_COMPRESSED = (".png", ".ico")
+
+HEADER = """\
+/* Static assets of the web UI (gzip-compressed, with precomputed ETags) */
+/* This file is generated by User_Libraries/Eth_HTML/Tools/gen_static_assets.py
+ * from the "static" directories, do not edit it manually! */
+
+/* Includes ----------------------------------------------------------------- */
+#include "httpserver-netconn.h"
+
+/* Variables ---------------------------------------------------------------- */
+"""
+
+
+def c_name(path):
+    return "asset_" + "".join(c if c.isalnum() else "_" for c in path[1:])
+
+
+def load_assets(dirs):
+    assets = {}
+    for directory in dirs:
+        for name in sorted(os.listdir(directory)):
+            src = os.path.join(directory, name)
+            if not os.path.isfile(src):
+                continue
+            ext = os.path.splitext(name)[1].lower()
+            if ext not in CONTENT_TYPES:
+                sys.exit("Unknown content type of asset: " + src)
+
+            path = URL_PREFIX + name
+            if path in assets:
+                sys.exit("Duplicated asset: " + src)
+
+            with open(src, "rb") as f:
+                data = f.read()
+            etag = '"%08x"' % (zlib.crc32(data) & 0xFFFFFFFF)
+
+            # Fixed mtime keeps output the same for the same sources
+            packed = gzip.compress(data, compresslevel=9, mtime=0)
+            use_gzip = (ext not in NOT_COMPRESSED) and (len(packed) < len(data))
+            assets[path] = (CONTENT_TYPES[ext], etag,
+                            packed if use_gzip else data, use_gzip)
+    return assets
+
+
+def render(assets):
+    out = [HEADER]
+    for path in sorted(assets):
+        data = assets[path][2]
+        out.append("/* %s (%d bytes) */\n" % (path, len(data)))
+        out.append("static const uint8_t %s[] =\n{\n" % c_name(path))
+        for i in range(0, len(data), 16):
+            out.append("\t" + ", ".join("0x%02X" % b for b in data[i:i + 16])
+                       + ",\n")
+        out.append("};\n\n")
+
+    out.append("/* Table of assets (sorted by path for binary search!) */\n")
+    out.append("const struct HTTP_StaticAsset staticAssets[] =\n{\n")
+    for path in sorted(assets):
+        content_type, etag, data, use_gzip = assets[path]
+        out.append('\t{"%s", "%s", "\\"%s\\"",\n\t\t\t%s, sizeof(%s), %s},\n'
+                   % (path, content_type, etag.strip('"'), c_name(path),
+                      c_name(path), "true" if use_gzip else "false"))
+    out.append("};\n")
+    out.append("const uint16_t staticAssetsNum =\n"
+               "\t\tsizeof(staticAssets) / sizeof(staticAssets[0]);\n")
+    return "".join(out).replace("\n", "\r\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Generate C-table of static assets for HTTP server")
+    parser.add_argument("-o", "--output", required=True, help="output C-file")
+    parser.add_argument("dirs", nargs="+", help="directories with assets")
+    args = parser.parse_args()
+
+    text = render(load_assets(args.dirs))
+
+    if os.path.exists(args.output):
+        with open(args.output, "r", newline="") as f:
+            if f.read() == text:
+                return
+    with open(args.output, "w", newline="") as f:
+        f.write(text)
+
+
+if __name__ == "__main__":
+    main()
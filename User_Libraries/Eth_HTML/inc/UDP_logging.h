@@ -5,6 +5,7 @@
 // Standard includes.
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 // FreeRTOS includes.
 #include "FreeRTOS.h"
@@ -17,6 +18,7 @@
 
 // Application includes.
 #include "html_txt_funcs.h"
+#include "settings_registry.h"
 
 // Public constants ------------------------------------------------------------
 // Logging events types
@@ -28,17 +30,102 @@ enum LogEventType
 	UNSUPPORTED_LOG_EVENT
 };
 
+// Maximum length of log line
+#ifndef MAX_UDP_LOG_MSG_SIZE
+#	define MAX_UDP_LOG_MSG_SIZE 		32
+#endif // MAX_UDP_LOG_MSG_SIZE
+
+// Deferred logging: the call site stores address of format string (it is
+// placed in section ".log_formats", that is not loaded to flash), timestamp
+// and raw arguments. Text is made by Tools/decode_udp_log.py with the ELF.
+// Arguments are integers or pointers (32-bit words), "%s" takes constant
+// strings of flash only
+#define UDP_LOG_DEFERRED_MAX_ARGS	8
+
+#define UDP_LOG_DEFERRED(type, format, ...) \
+	do \
+	{ \
+		static const char udpLogFormat[] \
+				__attribute__((section(".log_formats"), used)) = format; \
+		UDP_LoggingDeferred(type, udpLogFormat, \
+				UDP_LOG_ARGS_NUM(__VA_ARGS__), ##__VA_ARGS__); \
+	} while(0)
+#define UDP_LOG_EVENT(format, ...) \
+		UDP_LOG_DEFERRED(LOG_EVENT, format, ##__VA_ARGS__)
+#define UDP_LOG_WARNING(format, ...) \
+		UDP_LOG_DEFERRED(LOG_WARNING, format, ##__VA_ARGS__)
+#define UDP_LOG_ERROR(format, ...) \
+		UDP_LOG_DEFERRED(LOG_ERROR, format, ##__VA_ARGS__)
+
+// Number of arguments (0..UDP_LOG_DEFERRED_MAX_ARGS)
+#define UDP_LOG_ARGS_NUM(...) \
+		UDP_LOG_ARGS_NUM_(0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define UDP_LOG_ARGS_NUM_(_0, _1, _2, _3, _4, _5, _6, _7, _8, num, ...) num
+
+// Binary datagram starts with zero byte (text lines never do) and version,
+// then records "type, number of arguments, record" follow
+#define UDP_LOG_BINARY_VERSION		1
+
+// Structures definitions ------------------------------------------------------
+// Record of deferred logging (little-endian)
+struct UDP_LogDeferredRecord
+{
+	// Offset of format string in section ".log_formats"
+	uint16_t format;
+	// Timestamp: system counter of RTC and fraction of second in 1/65536 s
+	uint16_t fraction;
+	uint32_t counter;
+	uint32_t args[UDP_LOG_DEFERRED_MAX_ARGS];
+};
+
+// Log line is built by the caller (on its stack) and sent as one record
+struct UDP_LogLine
+{
+	enum LogEventType type;
+	uint16_t length;
+	char str[MAX_UDP_LOG_MSG_SIZE];
+};
+
+// Counters of logging: records are counted by writers, datagrams by the task
+struct UDP_LoggingStats
+{
+	uint32_t records;
+	// Records lost by overflow of ring
+	uint32_t dropped;
+	// Records dropped by rate limits of severities
+	uint32_t limited;
+	uint32_t datagrams;
+	uint32_t sendErrors;
+};
+
+// Public variables ------------------------------------------------------------
+// Keys of logging settings (IDs 15..21)
+extern const struct SettingsKeysTable UDP_LoggingSettingsKeys;
+
 // Public function prototypes --------------------------------------------------
 // Init functions
 void UDP_LoggingInit();
 void UDP_LoggingSetDefaults();
 void CheckUDP_LoggingTask();
+const struct UDP_LoggingStats* UDP_LoggingGetStats();
+// Erase of the event log stalls CPU (see event_log.h): it is postponed, while
+// this function returns false (weak, always true), e.g. a time-critical
+// exchange of network is due. Keep the true periods longer than the stall
+bool UDP_LoggingEraseIsAllowed();
 
-// UDP_Logging functions for sending logs
-bool UDP_LoggingPrepareLog(enum LogEventType type);
-bool UDP_LoggingAddToLog(char* log, uint16_t size);
-bool UDP_LoggingAddNumberToLog(uint32_t num);
-bool UDP_LoggingSend();
+// UDP_Logging functions for sending logs: records are written to the ring
+// from any task or interrupt, the UDP_Logging task sends them in batches.
+// Warnings and errors are also stored in the event log of flash (see
+// event_log.h), even if they are not sent
+bool UDP_LoggingLog(enum LogEventType type, const char* str);
+bool UDP_LoggingPrepareLog(struct UDP_LogLine* line, enum LogEventType type);
+bool UDP_LoggingAddToLog(struct UDP_LogLine* line, const char* log,
+		uint16_t size);
+bool UDP_LoggingAddNumberToLog(struct UDP_LogLine* line, uint32_t num);
+bool UDP_LoggingSend(struct UDP_LogLine* line);
+// Use macros UDP_LOG_EVENT, UDP_LOG_WARNING, UDP_LOG_ERROR
+bool UDP_LoggingDeferred(enum LogEventType type, const char* format,
+		uint8_t argsNum, ...);
 
 // Application settings functions
 bool GetUDP_LoggingEnable();
@@ -53,5 +140,8 @@ bool GetUDP_LogWarnings();
 void SetUDP_LogWarnings(bool val);
 bool GetUDP_LogErrors();
 void SetUDP_LogErrors(bool val);
+// Records are sent as syslog messages (RFC 5424), one per datagram
+bool GetUDP_LoggingSyslog();
+void SetUDP_LoggingSyslog(bool val);
 
 #endif // _UDP_LOGGING_H_
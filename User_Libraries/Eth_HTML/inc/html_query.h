@@ -0,0 +1,54 @@
+#ifndef _HTML_QUERY_H_
+#define _HTML_QUERY_H_
+
+/* Includes ----------------------------------------------------------------- */
+/* Standard includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Application includes */
+#include "httpserver-netconn.h"
+
+/* Public constants --------------------------------------------------------- */
+/* Parameters over the limit are ignored */
+#ifndef HTML_QUERY_MAX_PARAMS
+#	define HTML_QUERY_MAX_PARAMS		24
+#endif /* HTML_QUERY_MAX_PARAMS */
+
+/* Structures definitions --------------------------------------------------- */
+/* Decoded parameter "key=value" */
+struct HTML_QueryParam
+{
+	const char* key;
+	const char* value;
+};
+
+/* Index of request parameters, built by HTML_QueryParse() */
+struct HTML_Query
+{
+	uint16_t num;
+	struct HTML_QueryParam params[HTML_QUERY_MAX_PARAMS];
+};
+
+/* Public function prototypes ----------------------------------------------- */
+/* Split parameters of the request (after "?", form body is joined to them)
+ * and URL-decode them in place with one scan. Must be called once per request:
+ * the request buffer is changed. Return false, if there are no parameters */
+bool HTML_QueryParse(HTTPClient_t *pxClient, struct HTML_Query* query);
+
+/* Value of parameter (NULL, if it is absent). Key without "=" has empty value */
+const char* HTML_QueryGet(const struct HTML_Query* query, const char* key);
+/* Value of parameter "<key><index>" (for tables: "NTP_nm0", "NTP_nm1"...) */
+const char* HTML_QueryGetIdx(const struct HTML_Query* query, const char* key,
+		uint16_t index);
+/* Parameter is present and its value is equal to the string */
+bool HTML_QueryIs(const struct HTML_Query* query, const char* key,
+		const char* value);
+/* Parameter is present and its value is a number */
+bool HTML_QueryGetNum(const struct HTML_Query* query, const char* key,
+		int32_t* num);
+/* Copy value of parameter to the string (truncated to the size) */
+bool HTML_QueryGetStr(const struct HTML_Query* query, const char* key,
+		char* dstStr, uint16_t size);
+
+#endif /* _HTML_QUERY_H_ */
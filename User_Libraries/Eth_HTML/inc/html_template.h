@@ -0,0 +1,42 @@
+#ifndef _HTML_TEMPLATE_H_
+#define _HTML_TEMPLATE_H_
+
+/* Includes ----------------------------------------------------------------- */
+/* Standard includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Application includes */
+#include "httpserver-netconn.h"
+
+/* Public constants --------------------------------------------------------- */
+/* Opcodes of compiled templates (see Tools/gen_html_templates.py):
+ * HTML_TPL_LITERAL is followed by 16-bit length (LE) and text,
+ * variables opcodes are followed by index of variable slot */
+enum HTML_TemplateOpcode
+{
+	HTML_TPL_END = 0x00,
+	HTML_TPL_LITERAL = 0x01,
+	HTML_TPL_STR = 0x10,		/* String as is */
+	HTML_TPL_NUM = 0x11,		/* Signed decimal number */
+	HTML_TPL_DIGITS2 = 0x12,	/* Two decimal digits (with leading zero) */
+	HTML_TPL_IP = 0x13,			/* IP-address in network byte order */
+	HTML_TPL_CHECKED = 0x14,	/* "checked " attribute, if flag is set */
+};
+
+/* Structures definitions --------------------------------------------------- */
+/* Value of template variable slot */
+union HTML_TemplateVar
+{
+	const char* str;
+	int32_t num;
+	uint32_t ip;
+	bool flag;
+};
+
+/* Public function prototypes ----------------------------------------------- */
+/* Render compiled template to the client in one pass (chunked, without end) */
+BaseType_t SendHTML_Template(HTTPClient_t *pxClient, const uint8_t* tpl,
+		const union HTML_TemplateVar* vars);
+
+#endif /* _HTML_TEMPLATE_H_ */
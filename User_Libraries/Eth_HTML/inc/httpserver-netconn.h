@@ -16,21 +16,125 @@
 #include "FreeRTOS_Sockets.h"
 
 /* FreeRTOS Protocol includes */
+#include "FreeRTOS_HTTP_commands.h"
 #include "FreeRTOS_TCP_server.h"
 #include "FreeRTOS_server_private.h"
 
 /* Application includes */
 #include "html_txt_funcs.h"
 
+/* Constants ---------------------------------------------------------------- */
+/* Allowed methods masks of the HTML-pages routes */
+#define HTTP_ROUTE_GET				(1 << ECMD_GET)
+#define HTTP_ROUTE_HEAD				(1 << ECMD_HEAD)
+#define HTTP_ROUTE_POST				(1 << ECMD_POST)
+#define HTTP_ROUTE_PUT				(1 << ECMD_PUT)
+
+/* Upper bounds (ms) of the requests latency histogram buckets, the last bucket
+has no bound ("+Inf") */
+#define HTTP_LATENCY_BOUNDS			{5, 10, 25, 50, 100, 250, 500, 1000}
+#define HTTP_LATENCY_BUCKETS_NUM	9
+
+/* Structures definitions --------------------------------------------------- */
+/* HTML-pages route: tables of routes have to be sorted by path (strcmp) */
+struct HTTP_Route
+{
+	const char* path;
+	BaseType_t (*handler)(HTTPClient_t *pxClient);
+	uint16_t methods;
+	bool auth;
+	/* Receiver of large body (NULL - body is stored in the request) */
+	FHTTPBodyFunction body;
+};
+
+/* Static asset in flash (see Tools/gen_static_assets.py): tables of assets
+have to be sorted by path (strcmp) */
+struct HTTP_StaticAsset
+{
+	const char* path;
+	const char* contentType;
+	const char* etag;
+	const uint8_t* data;
+	uint32_t size;
+	bool gzip;
+};
+
+/* Connections accounting of the HTTP server (counters since start): they are
+only changed by the server task, readers get them without locks */
+struct HTTP_ServerStats
+{
+	uint32_t connections;	/* Accepted connections */
+	uint32_t rejected;		/* Connections over the limit of one client */
+	uint32_t requests;
+	uint32_t throttled;		/* Requests delayed by the rate limit */
+	uint32_t sendErrors;	/* Failed transmissions (client is blocked) */
+	uint32_t renderHeapAllocs;	/* Heap allocations of pages (must be 0) */
+	uint32_t scratchPeak;		/* Maximum used scratch memory (bytes) */
+	uint32_t scratchFailures;	/* Scratch memory was exhausted */
+	uint32_t bytesReceived;
+	uint32_t bytesSent;
+	/* Requests by processing time (each bucket is counted separately) */
+	uint32_t latency[HTTP_LATENCY_BUCKETS_NUM];
+	uint32_t latencySum;		/* ms */
+};
+
+/* Variables ---------------------------------------------------------------- */
+/* Generated table of static assets */
+extern const struct HTTP_StaticAsset staticAssets[];
+extern const uint16_t staticAssetsNum;
+
 /* Public function prototypes ----------------------------------------------- */
 void HTTP_ServerInit();
 void HTTP_ServerApplyNetworkSettingsAfterNetConnClose();
+void HTTP_ServerApplyFirmwareAfterNetConnClose();
+/* Called after closing of connection (see the function above) */
+void WebServerApplyFirmware();
+const struct HTTP_ServerStats* HTTP_ServerGetStats();
+/* Heap allocations hook (traceMALLOC in FreeRTOSConfig.h) */
+void HTTP_ServerTraceMalloc();
 BaseType_t prvOpenURL(HTTPClient_t *pxClient);
+/* Receiver of the request body (NULL - it is stored in the request buffer),
+it is requested after headers */
+FHTTPBodyFunction HTTP_GetBodyHandler(HTTPClient_t *pxClient);
 BaseType_t SendHTML_Block(HTTPClient_t *pxClient,
 		const void *pvBuffer, size_t uxDataLength);
+/* Contents with known length (Content-Length), not chunked */
+BaseType_t SendHTML_Content(HTTPClient_t *pxClient, BaseType_t xCode,
+		const char *pcContentsType, const void *pvBuffer, size_t uxDataLength);
+/* Temporary memory of page (NULL, if it is exhausted): it is released
+after the request, pages and helpers do not use heap */
+void* GetHTML_Scratch(HTTPClient_t *pxClient, size_t uxSize);
+/* Release the block and all blocks taken after it */
+void ReleaseHTML_Scratch(HTTPClient_t *pxClient, void *pvBlock);
+/* Part of the transmit buffer for contents (see SendHTML_Content) */
+char* GetHTML_ContentBuffer(HTTPClient_t *pxClient, size_t *puxSize);
+/* Body of request (empty string, if it is absent) */
+const char* GetHTML_RequestBody(HTTPClient_t *pxClient);
+/* Parameters of request after "?" (NULL, if they are absent), writable */
+char* GetHTML_RequestQuery(HTTPClient_t *pxClient);
+/* Value of request header (NULL, if it is absent) */
+const char* GetHTML_RequestHeader(HTTPClient_t *pxClient, const char *pcName);
+/* Cacheable static asset with ETag (304 reply for the same If-None-Match) */
+BaseType_t SendHTML_StaticAsset(HTTPClient_t *pxClient,
+		const struct HTTP_StaticAsset *pxAsset);
+/* Contents in memory with range requests ("Range: bytes=first-last"), they
+are sent in parts as the socket is writable: memory must stay mapped */
+BaseType_t SendHTML_Memory(HTTPClient_t *pxClient,
+		const char *pcContentsType, const void *pvData, size_t uxSize);
 BaseType_t SendHTML_Header_OK(HTTPClient_t *pxClient);
+/* Chunked reply with another type of contents than "text/html" */
+BaseType_t SendHTML_Header_OK_Type(HTTPClient_t *pxClient,
+		const char *pcContentsType);
+/* Redirection to the root page, cookie (NULL - none) is set with it */
 BaseType_t SendHTML_Header_RedirectToRoot(HTTPClient_t *pxClient,
-		char* key, uint16_t lenght);
+		const char *pcCookie);
 BaseType_t SendHTML_Header_404(HTTPClient_t *pxClient);
+BaseType_t SendHTML_Header_405(HTTPClient_t *pxClient);
+
+/* Event stream (Server-Sent Events) functions */
+BaseType_t SendHTML_Header_EventStream(HTTPClient_t *pxClient);
+void HTTP_ServerEventStreamSignal();
+/* Called for every subscribed client after HTTP_ServerEventStreamSignal */
+BaseType_t HTTP_EventStreamWork(HTTPClient_t *pxClient);
 
 #endif /*__HTTPSERVER_NETCONN_H__*/
@@ -10,6 +10,7 @@
 
 /* Application includes. */
 #include "settings.h"
+#include "settings_registry.h"
 
 /* Public constants ----------------------------------------------------------*/
 enum ProtocolType
@@ -31,6 +32,16 @@ enum FF_DiskState
 };
 #endif /*(configUSE_FAT == 1)*/
 
+/* Errors of Ethernet DMA since start */
+struct ETH_IF_Stats
+{
+	uint32_t abnormalInterrupts;
+	uint32_t rxBufferUnavailable;
+	uint32_t rxMissedFrames;		/* Rx buffer was unavailable */
+	uint32_t rxFifoOverflows;
+	uint32_t txDescriptorTimeouts;	/* Frame dropped: no free Tx descriptor */
+};
+
 /* Public variables ----------------------------------------------------------*/
 extern enum ProtocolType currProtocolType;
 extern uint32_t staticIP_Addr;
@@ -38,6 +49,9 @@ extern uint32_t staticNetMask;
 extern uint32_t staticIP_GW;
 extern uint32_t staticIP_DNS;
 
+/* Keys of network settings, login and password (IDs 1..7) */
+extern const struct SettingsKeysTable WebServerSettingsKeys;
+
 /* Public function prototypes ------------------------------------------------*/
 void WebServerInit();
 void WebServerSetDefaults();
@@ -71,5 +85,7 @@ void ResetAuthKeys();
 /* Disk state */
 enum FF_DiskState GetFF_DiskState();
 #endif /*(configUSE_FAT == 1)*/
+/* Errors of Ethernet DMA */
+const struct ETH_IF_Stats* ETH_IF_GetStats();
 
 #endif /*_WEB_SERVER_H_*/
@@ -2,27 +2,111 @@
 */
 
 // Includes --------------------------------------------------------------------
+#include <stdarg.h>
+#include <string.h>
+
 #include "settings.h"
 
 // Application includes.
 #include "UDP_logging.h"
+#include "settings_registry.h"
+#include "event_log.h"
+#include "rtc.h"
 
 // Private constants -----------------------------------------------------------
-// Logging constants
-#ifndef MAX_UDP_LOG_MSG_SIZE
-#	define MAX_UDP_LOG_MSG_SIZE 		32
-#endif // MAX_UDP_LOG_MSG_SIZE
-
 // Socket constants
 #ifndef UDP_LOGGING_DEFAULT_PORT
 #	define UDP_LOGGING_DEFAULT_PORT 	1536
 #endif // UDP_LOGGING_DEFAULT_PORT
 
+// Size of ring of records, bytes (power of 2)
+#ifndef UDP_LOGGING_RING_SIZE
+#	define UDP_LOGGING_RING_SIZE		2048
+#endif // UDP_LOGGING_RING_SIZE
+
+// Records are sent in datagrams up to MTU (without IP and UDP headers)
+#define UDP_LOGGING_DATAGRAM_SIZE	(ipconfigNETWORK_MTU - \
+		ipSIZE_OF_IPv4_HEADER - ipSIZE_OF_UDP_HEADER)
+
+// Record of ring: header word "length | type << 16 | state << 24" and text,
+// size is aligned to 4. Zero header - space is reserved, record is written
+#define RECORD_HEADER_SIZE			4
+#define RECORD_SIZE(length)			((RECORD_HEADER_SIZE + (length) + 3) & ~3ul)
+#define RECORD_HEADER(length, type, state) \
+		((uint32_t)(length) | ((uint32_t)(type) << 16) | ((uint32_t)(state) << 24))
+#define RECORD_LENGTH(header)		((header) & 0xFFFF)
+#define RECORD_TYPE(header)			(((header) >> 16) & 0xFF)
+#define RECORD_STATE(header)		((header) >> 24)
+
+enum RecordState
+{
+	RECORD_RESERVED,
+	RECORD_READY,
+	// Binary record of deferred logging
+	RECORD_DEFERRED,
+	// Rest of ring before its end, record is placed from the start
+	RECORD_PADDING
+};
+
 // FreeRTOS constants
 #ifndef UDP_LOGGING_TASK_PRIORITY
 #	define UDP_LOGGING_TASK_PRIORITY 	(tskIDLE_PRIORITY + 1)
 #endif /*UDP_LOGGING_TASK_PRIORITY*/
-#define UDP_LOGGING_TASK_STACK_SIZE (configMINIMAL_STACK_SIZE)
+#define UDP_LOGGING_TASK_STACK_SIZE (configMINIMAL_STACK_SIZE * 2)
+
+// Period of retries, if socket was not created, ms
+#define UDP_LOGGING_RETRY_PERIOD	1000
+
+// Token buckets of severities (events, warnings, errors): records per second
+// and burst. Records over the limit are dropped and reported periodically
+#ifndef UDP_LOGGING_RATE_LIMITS
+#	define UDP_LOGGING_RATE_LIMITS		{10, 20, 50}
+#endif // UDP_LOGGING_RATE_LIMITS
+#ifndef UDP_LOGGING_BURST_LIMITS
+#	define UDP_LOGGING_BURST_LIMITS		{20, 40, 100}
+#endif // UDP_LOGGING_BURST_LIMITS
+
+// Period of reports of dropped records, ms
+#define UDP_LOGGING_DROPS_REPORT_PERIOD	10000
+
+// Records of these and higher severities are stored in the event log of flash
+// (see event_log.c), whether they are sent or not
+#ifndef UDP_LOGGING_STORE_MIN_TYPE
+#	define UDP_LOGGING_STORE_MIN_TYPE	LOG_WARNING
+#endif // UDP_LOGGING_STORE_MIN_TYPE
+
+// Stored records are programmed to flash by blocks or after the period, ms
+// (errors are programmed at once)
+#ifndef UDP_LOGGING_STORE_PERIOD
+#	define UDP_LOGGING_STORE_PERIOD		10000
+#endif // UDP_LOGGING_STORE_PERIOD
+
+// Erasing of the oldest sector of the event log stalls CPU up to 2 s: it is
+// done ahead, when nothing was stored for the quiet time, ms. It is not done
+// more often than the minimum period, and during a storm of records it waits
+// up to the maximum period (the full log drops records meanwhile), ms. So the
+// stall comes once per the minimum period at most, and it comes while
+// UDP_LoggingEraseIsAllowed is false (see the SNTP client) only once per the
+// maximum period
+#ifndef UDP_LOGGING_ERASE_QUIET_TIME
+#	define UDP_LOGGING_ERASE_QUIET_TIME	5000
+#endif // UDP_LOGGING_ERASE_QUIET_TIME
+#ifndef UDP_LOGGING_ERASE_MIN_PERIOD
+#	define UDP_LOGGING_ERASE_MIN_PERIOD	60000
+#endif // UDP_LOGGING_ERASE_MIN_PERIOD
+#ifndef UDP_LOGGING_ERASE_MAX_PERIOD
+#	define UDP_LOGGING_ERASE_MAX_PERIOD	600000
+#endif // UDP_LOGGING_ERASE_MAX_PERIOD
+
+// Syslog (RFC 5424) constants: facility local0, severities of types
+// (informational, warning, error), application name
+#define SYSLOG_FACILITY				16
+#define SYSLOG_SEVERITIES			{6, 4, 3}
+#ifndef UDP_LOGGING_APP_NAME
+#	define UDP_LOGGING_APP_NAME		DEVICE_NAME
+#endif // UDP_LOGGING_APP_NAME
+// Structured data of own elements (private enterprise number for examples)
+#define SYSLOG_SD_ENTERPRISE		"@32473"
 
 // Debug options ---------------------------------------------------------------
 //#define DEBUG_
@@ -34,13 +118,40 @@ static uint32_t loggingIP_Addr = 0;
 static bool logEvents = false;
 static bool logWarnings = false;
 static bool logErrors = false;
+static bool loggingSyslog = false;
+
+// Ring of records: producers reserve space by moving the head, the task
+// frees it by moving the tail. Positions grow without wrapping to the ring
+static uint32_t ringBuf[UDP_LOGGING_RING_SIZE / sizeof(uint32_t)];
+static uint32_t ringHead = 0;
+static uint32_t ringTail = 0;
+
+// Datagram of records
+static char datagram[UDP_LOGGING_DATAGRAM_SIZE];
+
+static struct UDP_LoggingStats stats;
+
+// Rate limiter: tokens are kept in 1/1000 of record
+struct TokenBucket
+{
+	uint32_t tokens;
+	TickType_t time;
+};
+static struct TokenBucket buckets[UNSUPPORTED_LOG_EVENT];
+
+// Drops since last report: the counter saturates, it does not wrap
+static uint16_t dropsToReport = 0;
+static uint32_t lastRingDrops = 0;
+static TickType_t lastDropsReport = 0;
+
+static TickType_t lastStoreFlush = 0;
+static TickType_t lastStore = 0;
+static TickType_t lastErase = 0;
 
-// Logging variables
-static char logStr[MAX_UDP_LOG_MSG_SIZE];
-static uint16_t logLenght = 0;
-static bool logPrepared = false;
+// Sequence of syslog messages (1..2147483647)
+static uint32_t syslogSequence = 0;
 
-// Handle of the audio transactions task that service audio streams
+// Handle of the task that sends records
 static TaskHandle_t xAppTaskHandle = NULL;
 
 // The UDP socket
@@ -52,6 +163,24 @@ static uint16_t loggingPort = 0;
 
 // Private function prototypes -------------------------------------------------
 static void AppTask();
+static bool UDP_LoggingOpenSocket();
+static void UDP_LoggingCloseSocket();
+static bool UDP_LoggingIsEnabled(enum LogEventType type);
+static bool UDP_LoggingIsSent(uint8_t type);
+static bool UDP_LoggingPut(enum LogEventType type, enum RecordState state,
+		const void* data, uint16_t length);
+static void UDP_LoggingFlush();
+static void UDP_LoggingStore(uint8_t type, uint8_t state, const uint8_t* data,
+		uint16_t length);
+static void UDP_LoggingEraseAhead();
+static bool UDP_LoggingTakeToken(uint8_t type);
+static void UDP_LoggingCountDrops(uint32_t drops);
+static void UDP_LoggingReportDrops();
+static uint16_t UDP_LoggingSyslog(uint8_t type, const char* msgId,
+		uint32_t counter, uint16_t fraction);
+static char* UDP_LoggingAddStr(char* pos, const char* str);
+static char* UDP_LoggingAddNum(char* pos, uint32_t num, uint8_t digits);
+static void UDP_LoggingSendDatagram(uint16_t length);
 static BaseType_t UDP_LoggingRecv(
 		Socket_t xSocket, void* pvData, size_t xLength,
 		const struct freertos_sockaddr* pxFrom,
@@ -76,7 +205,7 @@ void UDP_LoggingInit()
 void UDP_LoggingSetDefaults()
 {
 	/* Set default parameters */
-	loggingPort = FreeRTOS_htons(UDP_LOGGING_DEFAULT_PORT);
+	SetUDP_LoggingPort(FreeRTOS_htons(UDP_LOGGING_DEFAULT_PORT));
 
 	loggingEnable = false;
 	loggingIP_Addr = FreeRTOS_inet_addr_quick(configIP_ADDR0, configIP_ADDR1,
@@ -84,6 +213,7 @@ void UDP_LoggingSetDefaults()
 	logEvents = false;
 	logWarnings = false;
 	logErrors = false;
+	loggingSyslog = false;
 }
 
 void CheckUDP_LoggingTask()
@@ -102,89 +232,82 @@ void CheckUDP_LoggingTask()
 	}
 }
 
-// UDP_Logging functions for sending logs
-bool UDP_LoggingPrepareLog(enum LogEventType type)
+const struct UDP_LoggingStats* UDP_LoggingGetStats()
 {
-	logPrepared = false;
-	if(loggingEnable == false) return false;
+	return &stats;
+}
 
-	// Reset lenght variable
-	logLenght = 0;
+// UDP_Logging functions for sending logs
+bool UDP_LoggingLog(enum LogEventType type, const char* str)
+{
+	if(UDP_LoggingIsEnabled(type) == false) return false;
+	return UDP_LoggingPut(type, RECORD_READY, str,
+			GetSizeOfStr(str, MAX_UDP_LOG_MSG_SIZE));
+}
 
-	if(type == LOG_EVENT)
-	{
-		if(logEvents == false) return false;
-		if(logLenght + sizeof("EV:") - 1 >= MAX_UDP_LOG_MSG_SIZE)
-			return false;
-		SetValue("EV:", logStr, sizeof("EV:"));
-		logLenght += sizeof("EV:") - 1;
-	}
-	else if(type == LOG_WARNING)
-	{
-		if(logWarnings == false) return false;
-		if(logLenght + sizeof("WR:") - 1 >= MAX_UDP_LOG_MSG_SIZE)
-			return false;
-		SetValue("WR:", logStr, sizeof("WR:"));
-		logLenght += sizeof("WR:") - 1;
-	}
-	else if(type == LOG_ERROR)
+bool UDP_LoggingPrepareLog(struct UDP_LogLine* line, enum LogEventType type)
+{
+	line->length = 0;
+	if(UDP_LoggingIsEnabled(type) == false)
 	{
-		if(logErrors == false) return false;
-		if(logLenght + sizeof("ER:") - 1 >= MAX_UDP_LOG_MSG_SIZE)
-			return false;
-		SetValue("ER:", logStr, sizeof("ER:"));
-		logLenght += sizeof("ER:") - 1;
+		line->type = UNSUPPORTED_LOG_EVENT;
+		return false;
 	}
-	else return false;
-
-	logPrepared = true;
+	line->type = type;
 	return true;
 }
 
-bool UDP_LoggingAddToLog(char* log, uint16_t size)
+bool UDP_LoggingAddToLog(struct UDP_LogLine* line, const char* log,
+		uint16_t size)
 {
 	// Check, is log prepared
-	if(logPrepared == false) return false;
-
-	if(logLenght + size >= MAX_UDP_LOG_MSG_SIZE) return false;
-	SetValue(log, &logStr[GetSizeOfStr(logStr, MAX_UDP_LOG_MSG_SIZE)], size);
-
-	if(log[size - 1] == 0) logLenght += size - 1;
-	else logLenght += size;
+	if(line->type >= UNSUPPORTED_LOG_EVENT) return false;
 
-	// Add terminal symbol
-	logStr[logLenght] = 0;
+	size = GetSizeOfStr(log, size);
+	if(line->length + size > MAX_UDP_LOG_MSG_SIZE) return false;
+	memcpy(&line->str[line->length], log, size);
+	line->length += size;
 
 	return true;
 }
 
-bool UDP_LoggingAddNumberToLog(uint32_t num)
+bool UDP_LoggingAddNumberToLog(struct UDP_LogLine* line, uint32_t num)
 {
 	// String for numeric values
-	static char tmpValStr[8];
+	char tmpValStr[12];
 	SetNumToStr(num, tmpValStr, sizeof(tmpValStr));
-	return UDP_LoggingAddToLog(tmpValStr,
+	return UDP_LoggingAddToLog(line, tmpValStr,
 			GetSizeOfStr(tmpValStr, sizeof(tmpValStr)));
 }
 
-bool UDP_LoggingSend()
+bool UDP_LoggingSend(struct UDP_LogLine* line)
 {
 	// Check, is log prepared
-	if(logPrepared == false) return false;
+	if(line->type >= UNSUPPORTED_LOG_EVENT) return false;
 
-	if(loggingEnable == false) return false;
+	return UDP_LoggingPut(line->type, RECORD_READY, line->str, line->length);
+}
 
-	// Create address structure
-	struct freertos_sockaddr xAddress;
-	xAddress.sin_addr = loggingIP_Addr;
-	xAddress.sin_port = loggingPort;
+bool UDP_LoggingDeferred(enum LogEventType type, const char* format,
+		uint8_t argsNum, ...)
+{
+	struct UDP_LogDeferredRecord record;
+	va_list args;
 
-	// Send log
-	FreeRTOS_sendto(xUDPSocket,
-			logStr, GetSizeOfStr(logStr, MAX_UDP_LOG_MSG_SIZE), 0,
-			&xAddress, sizeof(xAddress));
+	if(UDP_LoggingIsEnabled(type) == false) return false;
 
-	return true;
+	// Address of format is its offset: the section is placed at zero
+	record.format = (uint16_t)(uintptr_t)format;
+	RTC_GetTimestamp(&record.counter, &record.fraction);
+
+	if(argsNum > UDP_LOG_DEFERRED_MAX_ARGS) argsNum = UDP_LOG_DEFERRED_MAX_ARGS;
+	va_start(args, argsNum);
+	for(uint8_t i = 0; i < argsNum; i++) record.args[i] = va_arg(args, uint32_t);
+	va_end(args);
+
+	return UDP_LoggingPut(type, RECORD_DEFERRED, &record,
+			offsetof(struct UDP_LogDeferredRecord, args) +
+			argsNum * sizeof(uint32_t));
 }
 
 // Application settings functions
@@ -196,7 +319,9 @@ bool GetUDP_LoggingEnable()
 void SetUDP_LoggingEnable(bool val)
 {
 	// Story value
+	if(loggingEnable == val) return;
 	loggingEnable = val;
+	SettingsRegistryChanged();
 }
 
 uint32_t GetUDP_LoggingIP_Addr()
@@ -206,7 +331,9 @@ uint32_t GetUDP_LoggingIP_Addr()
 
 void SetUDP_LoggingIP_Addr(uint32_t addr)
 {
+	if(loggingIP_Addr == addr) return;
 	loggingIP_Addr = addr;
+	SettingsRegistryChanged();
 }
 
 uint16_t GetUDP_LoggingPort()
@@ -230,9 +357,10 @@ void SetUDP_LoggingPort(uint16_t val)
 	// Update port ant make trigger for rebinding
 	loggingPort = val;
 	rebindSocked = true;
+	SettingsRegistryChanged();
 
 	// Wake up task
-	vTaskResume(xAppTaskHandle);
+	if(xAppTaskHandle != NULL) xTaskNotifyGive(xAppTaskHandle);
 }
 
 bool GetUDP_LogEvents()
@@ -243,7 +371,9 @@ bool GetUDP_LogEvents()
 void SetUDP_LogEvents(bool val)
 {
 	// Story value
+	if(logEvents == val) return;
 	logEvents = val;
+	SettingsRegistryChanged();
 }
 
 bool GetUDP_LogWarnings()
@@ -254,7 +384,9 @@ bool GetUDP_LogWarnings()
 void SetUDP_LogWarnings(bool val)
 {
 	// Story value
+	if(logWarnings == val) return;
 	logWarnings = val;
+	SettingsRegistryChanged();
 }
 
 bool GetUDP_LogErrors()
@@ -265,75 +397,531 @@ bool GetUDP_LogErrors()
 void SetUDP_LogErrors(bool val)
 {
 	// Story value
+	if(logErrors == val) return;
 	logErrors = val;
+	SettingsRegistryChanged();
+}
+
+bool GetUDP_LoggingSyslog()
+{
+	return loggingSyslog;
+}
+
+void SetUDP_LoggingSyslog(bool val)
+{
+	// Story value
+	if(loggingSyslog == val) return;
+	loggingSyslog = val;
+	SettingsRegistryChanged();
+}
+
+// Settings keys
+SETTINGS_ACCESSORS(LoggingEnable, bool, GetUDP_LoggingEnable,
+		SetUDP_LoggingEnable)
+SETTINGS_ACCESSORS(LoggingIP_Addr, uint32_t, GetUDP_LoggingIP_Addr,
+		SetUDP_LoggingIP_Addr)
+SETTINGS_ACCESSORS(LoggingPort, uint32_t, GetUDP_LoggingPort,
+		SetUDP_LoggingPort)
+SETTINGS_ACCESSORS(LogEvents, bool, GetUDP_LogEvents, SetUDP_LogEvents)
+SETTINGS_ACCESSORS(LogWarnings, bool, GetUDP_LogWarnings, SetUDP_LogWarnings)
+SETTINGS_ACCESSORS(LogErrors, bool, GetUDP_LogErrors, SetUDP_LogErrors)
+SETTINGS_ACCESSORS(LoggingSyslog, bool, GetUDP_LoggingSyslog,
+		SetUDP_LoggingSyslog)
+
+static const struct SettingsKey UDP_LoggingKeys[] =
+{
+	SETTINGS_KEY_BOOL(15, LoggingEnable, false),
+	SETTINGS_KEY_UINT(16, LoggingIP_Addr, uint32_t, 0, UINT32_MAX,
+			FreeRTOS_inet_addr_quick(configIP_ADDR0, configIP_ADDR1,
+					configIP_ADDR2, configIP_ADDR3)),
+	// Port is kept in network byte order
+	SETTINGS_KEY_UINT(17, LoggingPort, uint16_t, 1, UINT16_MAX,
+			FreeRTOS_htons(UDP_LOGGING_DEFAULT_PORT)),
+	SETTINGS_KEY_BOOL(18, LogEvents, false),
+	SETTINGS_KEY_BOOL(19, LogWarnings, false),
+	SETTINGS_KEY_BOOL(20, LogErrors, false),
+	SETTINGS_KEY_BOOL(21, LoggingSyslog, false),
+};
+const struct SettingsKeysTable UDP_LoggingSettingsKeys =
+		SETTINGS_KEYS_TABLE(UDP_LoggingKeys);
+
+__attribute__((weak)) bool UDP_LoggingEraseIsAllowed()
+{
+	return true;
 }
 
 // Private functions -----------------------------------------------------------
 static void AppTask()
 {
+	for(;;)
+	{
+		// Every time check UDP-socket binded port: records are stored without
+		// network too
+		if(((xUDPSocket == NULL) || rebindSocked) &&
+			(FreeRTOS_IsNetworkUp() != pdFALSE))
+		{
+			rebindSocked = false;
+			UDP_LoggingCloseSocket();
+			UDP_LoggingOpenSocket();
+		}
+
+		// Records written while the task waits are sent together
+		ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS((xUDPSocket == NULL) ?
+				UDP_LOGGING_RETRY_PERIOD : UDP_LOGGING_DROPS_REPORT_PERIOD));
+		UDP_LoggingFlush();
+		UDP_LoggingReportDrops();
+
+		// Write-behind block of stored records
+		if(xTaskGetTickCount() - lastStoreFlush >=
+			pdMS_TO_TICKS(UDP_LOGGING_STORE_PERIOD))
+		{
+			lastStoreFlush = xTaskGetTickCount();
+			EventLogFlush();
+		}
+
+		// Sector for the next records is erased ahead
+		UDP_LoggingEraseAhead();
+	}
+}
+
+static bool UDP_LoggingOpenSocket()
+{
+	struct freertos_sockaddr xAddress;
+	BaseType_t xReceiveTimeOut = pdMS_TO_TICKS(0);
+
 	// Create and init UDP socket
 	xUDPSocket = FreeRTOS_socket(FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM,
 								 FREERTOS_IPPROTO_UDP);
-	if(xUDPSocket != NULL)
+	if(xUDPSocket == FREERTOS_INVALID_SOCKET)
 	{
-		struct freertos_sockaddr xAddress;
-#if (ipconfigUSE_CALLBACKS != 0)
-		BaseType_t xReceiveTimeOut = pdMS_TO_TICKS(0);
-#else
-		BaseType_t xReceiveTimeOut = pdMS_TO_TICKS(SNTP_RECV_TIMEOUT);
+		xUDPSocket = NULL;
+		FreeRTOS_printf(("Creating socket failed\n"));
+		return false;
+	}
+
+	xAddress.sin_addr = 0ul;
+	xAddress.sin_port = loggingPort;
+
+	FreeRTOS_bind(xUDPSocket, &xAddress, sizeof(xAddress));
+	FreeRTOS_setsockopt(xUDPSocket, 0, FREERTOS_SO_RCVTIMEO,
+						&xReceiveTimeOut, sizeof(xReceiveTimeOut));
+
+#if(ipconfigUSE_CALLBACKS != 0)
+	// Create listener handler
+	F_TCP_UDP_Handler_t xHandler;
+	memset(&xHandler, '\0', sizeof(xHandler));
+	xHandler.pxOnUDPReceive = UDP_LoggingRecv;
+	FreeRTOS_setsockopt(xUDPSocket, 0, FREERTOS_SO_UDP_RECV_HANDLER,
+						(void*) &xHandler, sizeof(xHandler));
 #endif
+	return true;
+}
+
+static void UDP_LoggingCloseSocket()
+{
+	if(xUDPSocket == NULL) return;
+
+	// Attempt graceful shutdown
+	FreeRTOS_shutdown(xUDPSocket, FREERTOS_SHUT_RDWR);
+	FreeRTOS_closesocket(xUDPSocket);
+	xUDPSocket = NULL;
+}
+
+static bool UDP_LoggingIsEnabled(enum LogEventType type)
+{
+	// Stored records are written, even if they are not sent
+	if((type >= UDP_LOGGING_STORE_MIN_TYPE) && (type < UNSUPPORTED_LOG_EVENT) &&
+		EventLogIsReady()) return true;
+	return UDP_LoggingIsSent(type);
+}
+
+static bool UDP_LoggingIsSent(uint8_t type)
+{
+	if(loggingEnable == false) return false;
+
+	if(type == LOG_EVENT) return logEvents;
+	if(type == LOG_WARNING) return logWarnings;
+	if(type == LOG_ERROR) return logErrors;
+	return false;
+}
+
+// Write record to the ring: it is called from tasks and interrupts (with
+// priority not above configMAX_SYSCALL_INTERRUPT_PRIORITY), space is
+// reserved by compare-and-swap of the head without locks
+static bool UDP_LoggingPut(enum LogEventType type, enum RecordState state,
+		const void* data, uint16_t length)
+{
+	uint8_t* ring = (uint8_t*)ringBuf;
+	uint32_t size = RECORD_SIZE(length);
+	uint32_t head = __atomic_load_n(&ringHead, __ATOMIC_RELAXED);
+	uint32_t offset, pad;
 
-		// Check, is network up
-		while(FreeRTOS_IsNetworkUp() == pdFALSE)
+	do
+	{
+		// Record is not split by the end of ring
+		offset = head & (UDP_LOGGING_RING_SIZE - 1);
+		pad = (offset + size > UDP_LOGGING_RING_SIZE) ?
+				(UDP_LOGGING_RING_SIZE - offset) : 0;
+
+		if(head + pad + size - __atomic_load_n(&ringTail, __ATOMIC_ACQUIRE) >
+			UDP_LOGGING_RING_SIZE)
 		{
-			FreeRTOS_printf(("Wait for network up event\n"));
-			vTaskDelay(300);
+			// Ring is full: the task will report lost records
+			__atomic_fetch_add(&stats.dropped, 1, __ATOMIC_RELAXED);
+			return false;
 		}
+	} while(__atomic_compare_exchange_n(&ringHead, &head, head + pad + size,
+			true, __ATOMIC_RELAXED, __ATOMIC_RELAXED) == false);
 
-		xAddress.sin_addr = 0ul;
-		xAddress.sin_port = loggingPort;
+	if(pad != 0)
+	{
+		__atomic_store_n((uint32_t*)&ring[offset],
+				RECORD_HEADER(pad - RECORD_HEADER_SIZE, 0, RECORD_PADDING),
+				__ATOMIC_RELEASE);
+		offset = 0;
+	}
 
-		FreeRTOS_bind(xUDPSocket, &xAddress, sizeof(xAddress));
-		FreeRTOS_setsockopt(xUDPSocket, 0, FREERTOS_SO_RCVTIMEO,
-							&xReceiveTimeOut, sizeof(xReceiveTimeOut));
+	// Record is published by its header after the data
+	memcpy(&ring[offset + RECORD_HEADER_SIZE], data, length);
+	__atomic_store_n((uint32_t*)&ring[offset],
+			RECORD_HEADER(length, type, state), __ATOMIC_RELEASE);
+	__atomic_fetch_add(&stats.records, 1, __ATOMIC_RELAXED);
 
-#if(ipconfigUSE_CALLBACKS != 0)
-		// Create listener handler
-		F_TCP_UDP_Handler_t xHandler;
-		memset(&xHandler, '\0', sizeof(xHandler));
-		xHandler.pxOnUDPReceive = UDP_LoggingRecv;
-		FreeRTOS_setsockopt(xUDPSocket, 0, FREERTOS_SO_UDP_RECV_HANDLER,
-							(void*) &xHandler, sizeof(xHandler));
-#endif
-	}
-	else
+	// Wake up task
+	if(xAppTaskHandle == NULL) return true;
+	if(xPortIsInsideInterrupt())
 	{
-		FreeRTOS_printf(("Creating socket failed\n"));
-		return;
+		BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+		vTaskNotifyGiveFromISR(xAppTaskHandle, &xHigherPriorityTaskWoken);
+		portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 	}
+	else xTaskNotifyGive(xAppTaskHandle);
 
-	for(;;)
+	return true;
+}
+
+// Send records of the ring: in syslog format one record per datagram,
+// otherwise in datagrams up to MTU: text records as lines "EV:text",
+// deferred records in binary datagrams. Records of severities from
+// UDP_LOGGING_STORE_MIN_TYPE are stored in the event log
+static void UDP_LoggingFlush()
+{
+	static const char* const prefixes[] = {"EV:", "WR:", "ER:"};
+	uint8_t* ring = (uint8_t*)ringBuf;
+	uint16_t length = 0;
+	bool binary = false;
+
+	while(ringTail != __atomic_load_n(&ringHead, __ATOMIC_ACQUIRE))
 	{
-		// Every time check UDP-socket binded port
-		if(rebindSocked)
+		uint32_t offset = ringTail & (UDP_LOGGING_RING_SIZE - 1);
+		uint32_t header = __atomic_load_n((uint32_t*)&ring[offset],
+				__ATOMIC_ACQUIRE);
+
+		// Record is being written: it and next ones wait for notification
+		if(RECORD_STATE(header) == RECORD_RESERVED) break;
+
+		uint16_t recLength = RECORD_LENGTH(header);
+		uint8_t type = RECORD_TYPE(header);
+		const uint8_t* data = &ring[offset + RECORD_HEADER_SIZE];
+		bool valid = (RECORD_STATE(header) == RECORD_READY) ||
+				(RECORD_STATE(header) == RECORD_DEFERRED);
+		bool send = valid && (xUDPSocket != NULL) && UDP_LoggingIsSent(type);
+		bool store = valid && (type >= UDP_LOGGING_STORE_MIN_TYPE) &&
+				EventLogIsReady();
+
+		// Storm of logs does not saturate the link, the IP task and flash
+		if((send || store) && (UDP_LoggingTakeToken(type) == false))
 		{
-			rebindSocked = false;
+			stats.limited++;
+			UDP_LoggingCountDrops(1);
+			send = false;
+			store = false;
+		}
 
-			// Attempt graceful shutdown
-			FreeRTOS_shutdown(xUDPSocket, FREERTOS_SHUT_RDWR);
-			FreeRTOS_closesocket(xUDPSocket);
+		if(store) UDP_LoggingStore(type, RECORD_STATE(header), data, recLength);
 
-			// Must not drop off the end of the RTOS task -
-			// delete the RTOS task
-			xAppTaskHandle = NULL;
-			vTaskDelete(xAppTaskHandle);
+		if(send && loggingSyslog)
+		{
+			uint32_t counter;
+			uint16_t fraction;
+			char* pos;
+
+			if(RECORD_STATE(header) == RECORD_READY)
+			{
+				RTC_GetTimestamp(&counter, &fraction);
+				pos = &datagram[UDP_LoggingSyslog(type, "-", counter,
+						fraction)];
+				*pos++ = ' ';
+				memcpy(pos, data, recLength);
+				pos += recLength;
+			}
+			else
+			{
+				// Deferred record is passed as structured data for decoder
+				struct UDP_LogDeferredRecord record;
+				uint8_t argsNum = (recLength -
+						offsetof(struct UDP_LogDeferredRecord, args)) /
+						sizeof(uint32_t);
+				memcpy(&record, data, recLength);
+				pos = &datagram[UDP_LoggingSyslog(type, "deferred",
+						record.counter, record.fraction)];
+				pos = UDP_LoggingAddStr(pos,
+						"[deferred" SYSLOG_SD_ENTERPRISE " format=\"");
+				pos = UDP_LoggingAddNum(pos, record.format, 1);
+				pos = UDP_LoggingAddStr(pos, "\" args=\"");
+				for(uint8_t i = 0; i < argsNum; i++)
+				{
+					if(i != 0) *pos++ = ' ';
+					pos = UDP_LoggingAddNum(pos, record.args[i], 1);
+				}
+				pos = UDP_LoggingAddStr(pos, "\"]");
+			}
+			UDP_LoggingSendDatagram(pos - datagram);
+		}
+		else if(send && (RECORD_STATE(header) == RECORD_READY))
+		{
+			const char* prefix = prefixes[type];
+
+			if(binary || (length + sizeof("EV:") + recLength > sizeof(datagram)))
+			{
+				if(length != 0) UDP_LoggingSendDatagram(length);
+				length = 0;
+				binary = false;
+			}
+			memcpy(&datagram[length], prefix, sizeof("EV:") - 1);
+			length += sizeof("EV:") - 1;
+			memcpy(&datagram[length], data, recLength);
+			length += recLength;
+			datagram[length++] = '\n';
+		}
+		else if(send)
+		{
+			if(!binary || (length + 2u + recLength > sizeof(datagram)))
+			{
+				if(length != 0) UDP_LoggingSendDatagram(length);
+				datagram[0] = 0;
+				datagram[1] = UDP_LOG_BINARY_VERSION;
+				length = 2;
+				binary = true;
+			}
+			datagram[length++] = type;
+			datagram[length++] = (recLength -
+					offsetof(struct UDP_LogDeferredRecord, args)) /
+					sizeof(uint32_t);
+			memcpy(&datagram[length], data, recLength);
+			length += recLength;
 		}
 
-		vTaskSuspend(xAppTaskHandle);
+		// Freed space is zeroed: headers of next records are written there
+		uint32_t size = RECORD_SIZE(recLength);
+		memset(&ring[offset], 0, size);
+		__atomic_store_n(&ringTail, ringTail + size, __ATOMIC_RELEASE);
+	}
+
+	if(length != 0) UDP_LoggingSendDatagram(length);
+}
+
+// Append record to the event log: text record with time of storing, deferred
+// record with its time and arguments
+static void UDP_LoggingStore(uint8_t type, uint8_t state, const uint8_t* data,
+		uint16_t length)
+{
+	uint32_t counter;
+	uint16_t fraction;
 
-		// Wait for next cycle
-		//vTaskDelay(1);
+	if(state == RECORD_READY)
+	{
+		RTC_GetTimestamp(&counter, &fraction);
+		EventLogAppend(type, EVENT_LOG_TEXT, counter, fraction, data, length);
+	}
+	else
+	{
+		struct UDP_LogDeferredRecord record;
+		memcpy(&record, data, length);
+		EventLogAppend(type, record.format, record.counter, record.fraction,
+				record.args,
+				length - offsetof(struct UDP_LogDeferredRecord, args));
 	}
+
+	// Errors do not wait in RAM: they could precede a reset
+	if(type == LOG_ERROR) EventLogFlush();
+	lastStore = xTaskGetTickCount();
+}
+
+// Erase the oldest sector of the event log in the quiet time, when it is
+// allowed, or, during a storm of records or a long exchange, once per the
+// maximum period
+static void UDP_LoggingEraseAhead()
+{
+	TickType_t now = xTaskGetTickCount();
+
+	if(EventLogNeedsErase() == false) return;
+	if(now - lastErase < pdMS_TO_TICKS(UDP_LOGGING_ERASE_MIN_PERIOD)) return;
+	if(((now - lastStore < pdMS_TO_TICKS(UDP_LOGGING_ERASE_QUIET_TIME)) ||
+		(UDP_LoggingEraseIsAllowed() == false)) &&
+	   (now - lastErase < pdMS_TO_TICKS(UDP_LOGGING_ERASE_MAX_PERIOD))) return;
+
+	lastErase = now;
+	EventLogEraseNext();
+}
+
+// Token bucket of severity: tokens are added with the rate up to the burst
+static bool UDP_LoggingTakeToken(uint8_t type)
+{
+	static const uint16_t rates[] = UDP_LOGGING_RATE_LIMITS;
+	static const uint16_t bursts[] = UDP_LOGGING_BURST_LIMITS;
+	struct TokenBucket* bucket = &buckets[type];
+	TickType_t now = xTaskGetTickCount();
+	uint32_t elapsed = (now - bucket->time) * portTICK_PERIOD_MS;
+
+	// Bucket is full after the burst time, longer time is not counted
+	if(elapsed > 60000) elapsed = 60000;
+	bucket->time = now;
+	bucket->tokens += elapsed * rates[type];
+	if(bucket->tokens > bursts[type] * 1000ul)
+		bucket->tokens = bursts[type] * 1000ul;
+
+	if(bucket->tokens < 1000) return false;
+	bucket->tokens -= 1000;
+	return true;
+}
+
+static void UDP_LoggingCountDrops(uint32_t drops)
+{
+	if(drops > (uint32_t)(UINT16_MAX - dropsToReport)) dropsToReport = UINT16_MAX;
+	else dropsToReport += drops;
+}
+
+// Dropped records (by overflow of ring or rate limits) are reported once per
+// period, the report is not limited
+static void UDP_LoggingReportDrops()
+{
+	uint32_t ringDrops = __atomic_load_n(&stats.dropped, __ATOMIC_RELAXED);
+	TickType_t now = xTaskGetTickCount();
+	char* pos;
+
+	UDP_LoggingCountDrops(ringDrops - lastRingDrops);
+	lastRingDrops = ringDrops;
+
+	// Drops are reported, when the socket is opened
+	if((dropsToReport == 0) || (xUDPSocket == NULL)) return;
+	if(now - lastDropsReport < pdMS_TO_TICKS(UDP_LOGGING_DROPS_REPORT_PERIOD))
+		return;
+	lastDropsReport = now;
+
+	if(loggingSyslog)
+	{
+		uint32_t counter;
+		uint16_t fraction;
+
+		RTC_GetTimestamp(&counter, &fraction);
+		pos = &datagram[UDP_LoggingSyslog(LOG_WARNING, "drops", counter,
+				fraction)];
+		pos = UDP_LoggingAddStr(pos, "[drops" SYSLOG_SD_ENTERPRISE " count=\"");
+		pos = UDP_LoggingAddNum(pos, dropsToReport, 1);
+		pos = UDP_LoggingAddStr(pos, "\"] ");
+	}
+	else pos = UDP_LoggingAddStr(datagram, "WR:");
+
+	pos = UDP_LoggingAddNum(pos, dropsToReport, 1);
+	pos = UDP_LoggingAddStr(pos, (dropsToReport == UINT16_MAX) ?
+			" or more log records dropped" : " log records dropped");
+	if(loggingSyslog == false) *pos++ = '\n';
+	dropsToReport = 0;
+
+	UDP_LoggingSendDatagram(pos - datagram);
+}
+
+// Header "<PRI>1 TIMESTAMP HOSTNAME APP-NAME PROCID MSGID" and structured data
+// "meta" of syslog message (RFC 5424) in the datagram, return its length
+static uint16_t UDP_LoggingSyslog(uint8_t type, const char* msgId,
+		uint32_t counter, uint16_t fraction)
+{
+	static const uint8_t severities[] = SYSLOG_SEVERITIES;
+	const char* hostName = pcApplicationHostnameHook();
+	char* pos = datagram;
+
+	*pos++ = '<';
+	pos = UDP_LoggingAddNum(pos, SYSLOG_FACILITY * 8 + severities[type], 1);
+	pos = UDP_LoggingAddStr(pos, ">1 ");
+
+	if(RTC_GetTimeIsValide())
+	{
+		struct DateTime dateTime;
+		CounterToStruct(counter, &dateTime);
+
+		pos = UDP_LoggingAddNum(pos, dateTime.year, 4);
+		*pos++ = '-';
+		pos = UDP_LoggingAddNum(pos, dateTime.month, 2);
+		*pos++ = '-';
+		pos = UDP_LoggingAddNum(pos, dateTime.day, 2);
+		*pos++ = 'T';
+		pos = UDP_LoggingAddNum(pos, dateTime.hour, 2);
+		*pos++ = ':';
+		pos = UDP_LoggingAddNum(pos, dateTime.minute, 2);
+		*pos++ = ':';
+		pos = UDP_LoggingAddNum(pos, dateTime.second, 2);
+		*pos++ = '.';
+		pos = UDP_LoggingAddNum(pos, ((uint32_t)fraction * 1000) >> 16, 3);
+		*pos++ = 'Z';
+	}
+	else *pos++ = '-';
+
+	*pos++ = ' ';
+	pos = UDP_LoggingAddStr(pos,
+			((hostName != NULL) && (*hostName != 0)) ? hostName : "-");
+	pos = UDP_LoggingAddStr(pos, " " UDP_LOGGING_APP_NAME " - ");
+	pos = UDP_LoggingAddStr(pos, msgId);
+
+	// Sequence allows collectors to find lost messages
+	if(++syslogSequence > (uint32_t)INT32_MAX) syslogSequence = 1;
+	pos = UDP_LoggingAddStr(pos, " [meta sequenceId=\"");
+	pos = UDP_LoggingAddNum(pos, syslogSequence, 1);
+	pos = UDP_LoggingAddStr(pos, "\" sysUpTime=\"");
+	pos = UDP_LoggingAddNum(pos,
+			(uint64_t)xTaskGetTickCount() * portTICK_PERIOD_MS / 10, 1);
+	pos = UDP_LoggingAddStr(pos, "\"]");
+
+	return pos - datagram;
+}
+
+// Return end of string
+static char* UDP_LoggingAddStr(char* pos, const char* str)
+{
+	while(*str) *pos++ = *str++;
+	return pos;
+}
+
+// Decimal number with leading zeros up to digits, return end of string
+static char* UDP_LoggingAddNum(char* pos, uint32_t num, uint8_t digits)
+{
+	char tmpStr[10];
+	uint8_t len = 0;
+
+	do
+	{
+		tmpStr[len++] = '0' + (num % 10);
+		num /= 10;
+	} while(num != 0);
+	while(len < digits) tmpStr[len++] = '0';
+	while(len) *pos++ = tmpStr[--len];
+
+	return pos;
+}
+
+static void UDP_LoggingSendDatagram(uint16_t length)
+{
+	// Create address structure
+	struct freertos_sockaddr xAddress;
+	xAddress.sin_addr = loggingIP_Addr;
+	xAddress.sin_port = loggingPort;
+
+	// Send log
+	if(FreeRTOS_sendto(xUDPSocket, datagram, length, 0,
+			&xAddress, sizeof(xAddress)) > 0)
+		stats.datagrams++;
+	else
+		stats.sendErrors++;
 }
 
 static BaseType_t UDP_LoggingRecv(
@@ -0,0 +1,138 @@
+/* Parameters of HTTP request: "key=value&key=value" is split and URL-decoded
+ * in place with one scan, handlers look up parameters by key in any order */
+
+/* Includes ----------------------------------------------------------------- */
+#include <string.h>
+
+/* Application includes */
+#include "html_txt_funcs.h"
+#include "html_query.h"
+
+/* Private function prototypes ---------------------------------------------- */
+static int8_t HexDigit(char c);
+static void QueryAdd(struct HTML_Query* query,
+		const char* key, const char* value);
+
+/* Public functions --------------------------------------------------------- */
+bool HTML_QueryParse(HTTPClient_t *pxClient, struct HTML_Query* query)
+{
+	char* src = GetHTML_RequestQuery(pxClient);
+	query->num = 0;
+	if(src == NULL) return false;
+
+	/* Decoded string is never longer than the source one, so it is written
+	   over the source: "dst" is behind "src" */
+	char* dst = src;
+	char* token = dst;
+	const char* key = NULL;
+	int8_t hi, lo;
+	for(;;)
+	{
+		char c = *(src++);
+		if((c == '&') || (c == '\0'))
+		{
+			/* End of parameter */
+			*(dst++) = '\0';
+			if(key != NULL) QueryAdd(query, key, token);
+			else if(*token != '\0') QueryAdd(query, token, dst - 1);
+
+			if((c == '\0') || (query->num >= HTML_QUERY_MAX_PARAMS)) break;
+			token = dst;
+			key = NULL;
+		}
+		else if((c == '=') && (key == NULL))
+		{
+			/* End of key, value follows it */
+			*(dst++) = '\0';
+			key = token;
+			token = dst;
+		}
+		else if(c == '+')
+		{
+			*(dst++) = ' ';
+		}
+		else if((c == '%') &&
+				((hi = HexDigit(src[0])) >= 0) && ((lo = HexDigit(src[1])) >= 0))
+		{
+			*(dst++) = (char)((hi << 4) | lo);
+			src += 2;
+		}
+		else
+		{
+			/* Wrong coded symbol is kept as is */
+			*(dst++) = c;
+		}
+	}
+
+	return (query->num != 0);
+}
+
+const char* HTML_QueryGet(const struct HTML_Query* query, const char* key)
+{
+	for(uint16_t i = 0; i < query->num; i++)
+	{
+		if(strcmp(query->params[i].key, key) == 0)
+			return query->params[i].value;
+	}
+	return NULL;
+}
+
+const char* HTML_QueryGetIdx(const struct HTML_Query* query, const char* key,
+		uint16_t index)
+{
+	char idxStr[8];
+	size_t keyLen = strlen(key);
+	SetNumToStr(index, idxStr, sizeof(idxStr));
+
+	for(uint16_t i = 0; i < query->num; i++)
+	{
+		if((strncmp(query->params[i].key, key, keyLen) == 0) &&
+		   (strcmp(query->params[i].key + keyLen, idxStr) == 0))
+			return query->params[i].value;
+	}
+	return NULL;
+}
+
+bool HTML_QueryIs(const struct HTML_Query* query, const char* key,
+		const char* value)
+{
+	const char* str = HTML_QueryGet(query, key);
+	return (str != NULL) && (strcmp(str, value) == 0);
+}
+
+bool HTML_QueryGetNum(const struct HTML_Query* query, const char* key,
+		int32_t* num)
+{
+	const char* str = HTML_QueryGet(query, key);
+	if(str == NULL) return false;
+	return GetNumFromStr(&str, num, false);
+}
+
+bool HTML_QueryGetStr(const struct HTML_Query* query, const char* key,
+		char* dstStr, uint16_t size)
+{
+	const char* str = HTML_QueryGet(query, key);
+	if((str == NULL) || (size == 0)) return false;
+
+	/* Truncated value is terminated too */
+	SetValue(str, dstStr, size - 1);
+	dstStr[size - 1] = '\0';
+	return true;
+}
+
+/* Private functions -------------------------------------------------------- */
+static int8_t HexDigit(char c)
+{
+	if((c >= '0') && (c <= '9')) return c - '0';
+	if((c >= 'A') && (c <= 'F')) return c - 'A' + 10;
+	if((c >= 'a') && (c <= 'f')) return c - 'a' + 10;
+	return -1;
+}
+
+static void QueryAdd(struct HTML_Query* query,
+		const char* key, const char* value)
+{
+	query->params[query->num].key = key;
+	query->params[query->num].value = value;
+	query->num++;
+}
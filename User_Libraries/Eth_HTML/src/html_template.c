@@ -0,0 +1,134 @@
+/* Runtime of compiled HTML templates: opcodes stream is rendered to the
+ * transmit buffer of the client and sent with chunks of buffer size */
+
+/* Includes ----------------------------------------------------------------- */
+#include <string.h>
+
+/* Application includes */
+#include "httpserver-netconn.h"
+#include "html_txt_funcs.h"
+#include "html_template.h"
+
+/* Private constants -------------------------------------------------------- */
+/* Space for any variable value (except strings) */
+#define HTML_TPL_VAR_MAX_LEN		16
+
+/* Structures definitions --------------------------------------------------- */
+/* Output buffer of template */
+struct HTML_TemplateOut
+{
+	HTTPClient_t *pxClient;
+	char* begin;
+	char* pos;
+	char* end;
+	BaseType_t xRc;
+};
+
+/* Private function prototypes ---------------------------------------------- */
+static void TemplateFlush(struct HTML_TemplateOut* out);
+static void TemplateWrite(struct HTML_TemplateOut* out,
+		const char* str, size_t len);
+static void TemplateReserve(struct HTML_TemplateOut* out, size_t len);
+
+/* Public functions --------------------------------------------------------- */
+BaseType_t SendHTML_Template(HTTPClient_t *pxClient, const uint8_t* tpl,
+		const union HTML_TemplateVar* vars)
+{
+	struct HTML_TemplateOut out;
+	size_t size;
+	uint16_t len;
+
+	out.pxClient = pxClient;
+	out.begin = GetHTML_ContentBuffer(pxClient, &size);
+	out.pos = out.begin;
+	out.end = out.begin + size;
+	out.xRc = 0;
+
+	while((*tpl != HTML_TPL_END) && (out.xRc >= 0))
+	{
+		if(*tpl == HTML_TPL_LITERAL)
+		{
+			len = tpl[1] | (tpl[2] << 8);
+			TemplateWrite(&out, (const char*)&tpl[3], len);
+			tpl += 3 + len;
+			continue;
+		}
+
+		/* Variables opcodes have the slot index only */
+		const union HTML_TemplateVar* var = &vars[tpl[1]];
+		switch(*tpl)
+		{
+		case HTML_TPL_STR:
+			if(var->str != NULL)
+				TemplateWrite(&out, var->str, strlen(var->str));
+			break;
+
+		case HTML_TPL_NUM:
+			TemplateReserve(&out, HTML_TPL_VAR_MAX_LEN);
+			out.pos = SetNumToStr(var->num, out.pos, HTML_TPL_VAR_MAX_LEN);
+			break;
+
+		case HTML_TPL_DIGITS2:
+			TemplateReserve(&out, 2);
+			*out.pos++ = ((var->num / 10) % 10) + '0';
+			*out.pos++ = (var->num % 10) + '0';
+			break;
+
+		case HTML_TPL_IP:
+			TemplateReserve(&out, HTML_TPL_VAR_MAX_LEN);
+			FreeRTOS_inet_ntoa(var->ip, out.pos);
+			out.pos += strlen(out.pos);
+			break;
+
+		case HTML_TPL_CHECKED:
+			if(var->flag)
+				TemplateWrite(&out, "checked ", sizeof("checked ") - 1);
+			break;
+
+		default:
+			/* Template is broken */
+			FreeRTOS_printf(("Unknown template opcode %d\n", *tpl));
+			return -1;
+		}
+		tpl += 2;
+	}
+
+	TemplateFlush(&out);
+	return out.xRc;
+}
+
+/* Private functions -------------------------------------------------------- */
+static void TemplateFlush(struct HTML_TemplateOut* out)
+{
+	if((out->pos != out->begin) && (out->xRc >= 0))
+		out->xRc = SendHTML_Block(out->pxClient, out->begin,
+				out->pos - out->begin);
+	out->pos = out->begin;
+}
+
+static void TemplateWrite(struct HTML_TemplateOut* out,
+		const char* str, size_t len)
+{
+	while(len)
+	{
+		size_t part = out->end - out->pos;
+
+		if(part == 0)
+		{
+			TemplateFlush(out);
+			if(out->xRc < 0) return;
+			continue;
+		}
+
+		if(part > len) part = len;
+		memcpy(out->pos, str, part);
+		out->pos += part;
+		str += part;
+		len -= part;
+	}
+}
+
+static void TemplateReserve(struct HTML_TemplateOut* out, size_t len)
+{
+	if((size_t)(out->end - out->pos) < len) TemplateFlush(out);
+}
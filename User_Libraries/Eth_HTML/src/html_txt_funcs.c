@@ -1,12 +1,43 @@
 // Includes --------------------------------------------------------------------
+#include <string.h>
+
 /* Application includes */
 #include "httpserver-netconn.h"
 #include "html_txt_funcs.h"
 
 // Private constants -----------------------------------------------------------
+/* Mantissa of parsed float keeps 9 significant digits */
+#define FLOAT_MANTISSA_LIMIT		100000000
+/* Last power of ten in the tables (floats are exact up to 10^10) */
+#define POW10_MAX					10
+
 // Debug options ---------------------------------------------------------------
 // Variables -------------------------------------------------------------------
+/* Conversion tables */
+static const char digitPairs[] =
+		"00010203040506070809"
+		"10111213141516171819"
+		"20212223242526272829"
+		"30313233343536373839"
+		"40414243444546474849"
+		"50515253545556575859"
+		"60616263646566676869"
+		"70717273747576777879"
+		"80818283848586878889"
+		"90919293949596979899";
+static const char hexDigits[] = "0123456789ABCDEF";
+static const uint64_t uintPow10[POW10_MAX + 1] = {1ULL, 10ULL, 100ULL,
+		1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+		1000000000ULL, 10000000000ULL};
+static const float floatPow10[POW10_MAX + 1] = {1e0F, 1e1F, 1e2F, 1e3F, 1e4F,
+		1e5F, 1e6F, 1e7F, 1e8F, 1e9F, 1e10F};
+
 // Private function prototypes -------------------------------------------------
+static char* UintToDigits(uint32_t num, char* end);
+static char* Uint64ToDigits(uint64_t num, char* end);
+static char* StoreStr(const char* srcStr, uint16_t length,
+		char* dstStr, uint16_t size);
+static float DecimalToFloat(uint32_t mantissa, int32_t exp10);
 
 // Public functions ------------------------------------------------------------
 void SendInput(HTTPClient_t *pxClient, bool disabled, bool readonly,
@@ -27,12 +58,10 @@ void SendInput(HTTPClient_t *pxClient, bool disabled, bool readonly,
 
 	/* Send size */
 	/* Create temporary array for 5 digits + terminate string symbol */
-	char* tmpStr = (char*)pvPortMalloc(6);
-	SetNumToStr(size, tmpStr, 6);
+	char tmpStr[6];
+	SetNumToStr(size, tmpStr, sizeof(tmpStr));
 	SendHTML_Block(pxClient, tmpStr,
-			GetSizeOfStr(tmpStr, 6));
-	/* Free temporary string buffer */
-	vPortFree(tmpStr);
+			GetSizeOfStr(tmpStr, sizeof(tmpStr)));
 	SendHTML_Block(pxClient, input_2, sizeof(input_2) - 1);
 
 	/* Send value */
@@ -238,44 +267,16 @@ bool GetNumFromStr(const char** str, int32_t* num, bool trim)
 /* Return end of destination string */
 char* SetNumToStr(int32_t num, char* str, uint16_t size)
 {
-	/* Validate input parameters */
-	if(size == 0) return str;
+	/* Sign and 10 digits at most */
+	char buf[11];
+	char* end = &buf[sizeof(buf)];
 
-	/* Check for negative values */
-	if(num < 0)
-	{
-		*str = '-';
-		str++;
-		size--;
-		num = -(num);
-	}
+	/* Magnitude of negative number is unsigned: INT32_MIN is converted too */
+	char* begin = UintToDigits((num < 0) ? (0U - (uint32_t)num) : (uint32_t)num,
+			end);
+	if(num < 0) *(--begin) = '-';
 
-	int32_t divider = 1000000000;
-	bool first = false;
-	do
-	{
-		if(size == 0) return str;
-		if(num >= divider)
-		{
-			first = true;
-			*str = (char)((num/divider) + '0');
-			str++;
-			size--;
-			num = num%divider;
-		}
-		else if((first) || (divider < 10))
-		{
-			*str = '0';
-			str++;
-			size--;
-		}
-		divider = divider/10;
-	}
-	while(divider);
-	
-	if(size == 0) return str;
-	*str = 0;
-	return str;
+	return StoreStr(begin, end - begin, str, size);
 }
 
 bool GetFloatFromStr(const char** str, float* fNum, bool trim)
@@ -287,14 +288,13 @@ bool GetFloatFromStr(const char** str, float* fNum, bool trim)
 		return false;
 	}
 
-	/* Create variables */
-	float res = 0.0F;
+	/* Create variables: digits are collected to the integer mantissa with
+	   decimal exponent and are scaled once at the end */
+	uint32_t mantissa = 0;
+	int32_t exp10 = 0;
 	bool afterDecimalPoint = false;
 	bool formatIsValid = false;
 
-	/* Divider to place digits after the decimal point */
-	float div = 1;
-
 	/* Store current string pointer */
 	const char* pStr = *str;
 
@@ -334,20 +334,14 @@ bool GetFloatFromStr(const char** str, float* fNum, bool trim)
 			/* At least, one digit has been found */
 			formatIsValid = true;
 
-			/* Integer part */
-			if(!afterDecimalPoint)
-			{
-				/* Shift the previous digits to the left */
-				res *= 10;
-				/* Add the new one */
-				res += *pStr - '0';
-			}
-			/* Decimal part */
-			else
+			/* Digits over the float precision are not stored: integer part
+			   is scaled for them, decimal part is truncated */
+			if(mantissa < FLOAT_MANTISSA_LIMIT)
 			{
-				div *= 10;
-				res += (float)(*pStr - '0') / div;
+				mantissa = mantissa * 10 + (uint32_t)(*pStr - '0');
+				if(afterDecimalPoint) exp10--;
 			}
+			else if(!afterDecimalPoint) exp10++;
 
 			/* Go to next symbol */
 			pStr++;
@@ -416,6 +410,9 @@ bool GetFloatFromStr(const char** str, float* fNum, bool trim)
 		return false;
 	}
 
+	/* Scale mantissa once */
+	float res = DecimalToFloat(mantissa, exp10);
+
 	/* Check for negative value */
 	if(negative == false) *fNum = res;
 	else *fNum = -(res);
@@ -433,81 +430,85 @@ char* SetFloatToStr(float num,
 	if(numDigitsBeforeP + numDigitsAfterP == 0) return str;
 	if(numDigitsBeforeP + numDigitsAfterP > 10) return str;
 
-	/* Check for negative values */
-	if(num < 0)
-	{
-		*str = '-';
-		str++;
-		size--;
-		num = -(num);
-	}
-
-	/* Get unsigned integer number with rounding */
-	uint32_t uintNumber = (uint32_t)(num * PowBase10(numDigitsAfterP + 1));
-	if((uintNumber % 10) >= 5) uintNumber = (uintNumber/10) + 1;
-	else uintNumber /= 10;
-
-	/* Get divider */
-	uint32_t divider = PowBase10(numDigitsBeforeP + numDigitsAfterP - 1);
-
-	/* Trim uintNumber according to total number of digits */
-	uintNumber = uintNumber%(divider * 10);
+	/* Sign, 10 digits and point at most */
+	char buf[12];
+	char* end = &buf[sizeof(buf)];
+	char* begin;
 
-	bool first = false;
-	bool point = false;
-	do
+	/* Get fields of the float number */
+	union
 	{
-		if(size == 0) return str;
+		float f;
+		uint32_t u;
+	} bits = {.f = num};
+	int32_t exp2 = (int32_t)((bits.u >> 23) & 0xFF);
+	uint64_t uintNumber = bits.u & 0x007FFFFF;
 
-		/* Point divider service */
-		if(numDigitsBeforeP == 0)
+	if(exp2 == 0xFF)
+	{
+		/* Infinity or NaN */
+		begin = end - 3;
+		memcpy(begin, (uintNumber) ? "nan" : "inf", 3);
+	}
+	else
+	{
+		/* Value is exactly "mantissa * 2^exp2" */
+		if(exp2 == 0) exp2 = 1;
+		else uintNumber |= 0x00800000;
+		exp2 -= 127 + 23;
+
+		/* Get unsigned integer "num * 10^numDigitsAfterP" exactly (24-bit
+		   mantissa multiplied by 10^10 fits 64 bits) and trim it according to
+		   total number of digits */
+		uint64_t limit = uintPow10[numDigitsBeforeP + numDigitsAfterP];
+		uintNumber *= uintPow10[numDigitsAfterP];
+		if(exp2 >= 0)
 		{
-			if(first == false)
+			/* Integer value: shift it by one bit with trimming to the limit */
+			if(uintNumber >= limit) uintNumber %= limit;
+			for(; exp2 > 0; exp2--)
 			{
-				if(size == 0) return str;
-				first = true;
-
-				/* Show at least one zero before separator */
-				*str = ('0');
-				str++;
-				size--;
+				uintNumber <<= 1;
+				if(uintNumber >= limit) uintNumber -= limit;
 			}
-			if(point == false)
+		}
+		else
+		{
+			/* Fraction bits are rounded half to even (as printf does) */
+			if(exp2 > -64)
 			{
-				if(size == 0) return str;
-				point = true;
-
-				/* Store point and do not count the size */
-				*str = ('.');
-				str++;
-				size--;
+				uint64_t half = (uint64_t)1 << (-exp2 - 1);
+				uint64_t frac = uintNumber & ((half << 1) - 1);
+				uintNumber >>= -exp2;
+				if((frac > half) || ((frac == half) && (uintNumber & 1)))
+					uintNumber++;
 			}
+			else uintNumber = 0;
+			if(uintNumber >= limit) uintNumber %= limit;
 		}
-		else numDigitsBeforeP--;
 
-		if(size == 0) return str;
-		else if(uintNumber >= divider)
+		/* Split integer and decimal parts: 32-bit division for usual values */
+		uint64_t divider = uintPow10[numDigitsAfterP];
+		uint64_t intPart;
+		if((uintNumber | divider) <= UINT32_MAX)
+			intPart = (uint32_t)uintNumber / (uint32_t)divider;
+		else intPart = uintNumber / divider;
+
+		/* Decimal part with leading zeros */
+		begin = end;
+		if(numDigitsAfterP)
 		{
-			first = true;
-			*str = (char)((uintNumber/divider) + '0');
-			str++;
-			size--;
-			uintNumber = uintNumber%divider;
+			begin = Uint64ToDigits(uintNumber - intPart * divider, end);
+			while(end - begin < numDigitsAfterP) *(--begin) = '0';
+			*(--begin) = '.';
 		}
-		else if((first) || (divider < 10))
-		{
-			*str = '0';
-			str++;
-			size--;
-		}
-		divider = divider/10;
+
+		/* Integer part: at least one zero before separator */
+		begin = Uint64ToDigits(intPart, begin);
 	}
-	while(divider);
+	if(num < 0) *(--begin) = '-';
 
-	/* All digits has been stored */
-	if(size == 0) return str;
-	*str = 0;
-	return str;
+	return StoreStr(begin, end - begin, str, size);
 }
 
 bool GetHexFromStr(const char** str, int32_t* num, bool trim)
@@ -617,47 +618,21 @@ char* SetHexToStr(uint32_t hex, char* str, uint16_t size, bool alignToLeft)
 {
 	if(size < 2) return str;
 	if(size >= 9) size = 9;
-	
-	// Catch zero converting
-	if(hex == 0)
-	{
-		if(alignToLeft)
-		{
-			*str = '0';
-			str++;
-			*str = 0;
-			return str;
-		}
-		for(; size > 1; )
-		{
-			*str = '0';
-			str++;
-			size--;
-		}
-		*str = 0;
-		return str;
-	}
 
-	bool firstNoZero = false;
-	for(uint8_t i = 0; (i < 8) && (size > 1); i++)
-	{
-		uint8_t tmpChar = (uint8_t)((hex & 0xF0000000) >> 28);
-		hex = (hex << 4);
+	/* Number of significant digits (one for zero) */
+	uint8_t digits = (hex) ? (uint8_t)(8 - (__builtin_clz(hex) >> 2)) : 1;
 
-		if(tmpChar) firstNoZero = true;
-		if((firstNoZero == false) && (alignToLeft == false))
-		{
-			if((8 - i) <= (size - 1)) firstNoZero = true;
-		}
-		if(firstNoZero)
-		{
-			if(tmpChar < 10) tmpChar += '0';
-			else tmpChar += 'A' - 10;
+	/* Right alignment adds leading zeros to the size, digits over the size
+	   are cut from the end */
+	uint8_t width = (uint8_t)(size - 1);
+	if((alignToLeft == false) && (digits < width)) digits = width;
+	if(width > digits) width = digits;
 
-			*str = tmpChar;
-			str++;
-			size--;
-		}
+	uint8_t shift = (uint8_t)(digits << 2);
+	for(uint8_t i = 0; i < width; i++)
+	{
+		shift -= 4;
+		*(str++) = hexDigits[(hex >> shift) & 0x0F];
 	}
 
 	/* All digits has been stored */
@@ -1240,14 +1215,123 @@ bool SearchForNextParameter(const char** str)
 
 uint32_t PowBase10(uint32_t power)
 {
-	uint32_t result = 1;
-	while(power)
-	{
-		result = result * 10;
-		power--;
-	}
+	if(power <= POW10_MAX) return (uint32_t)uintPow10[power];
+
+	/* Overflowed values as before */
+	uint32_t result = (uint32_t)uintPow10[POW10_MAX];
+	for(power -= POW10_MAX; power; power--) result = result * 10;
 	return result;
 }
 
 /* Private functions -------------------------------------------------------- */
 
+/* Write digits of number in front of the end, return the first digit */
+static char* UintToDigits(uint32_t num, char* end)
+{
+	/* Two digits at once */
+	while(num >= 100)
+	{
+		uint32_t rem = num % 100;
+		num /= 100;
+		*(--end) = digitPairs[rem * 2 + 1];
+		*(--end) = digitPairs[rem * 2];
+	}
+	if(num >= 10)
+	{
+		*(--end) = digitPairs[num * 2 + 1];
+		*(--end) = digitPairs[num * 2];
+	}
+	else *(--end) = (char)('0' + num);
+	return end;
+}
+
+/* The same for 64-bit number (only big values are divided as 64-bit) */
+static char* Uint64ToDigits(uint64_t num, char* end)
+{
+	if(num <= UINT32_MAX) return UintToDigits((uint32_t)num, end);
+
+	/* Lower 8 digits with leading zeros */
+	uint32_t high = (uint32_t)(num / 100000000);
+	char* begin = UintToDigits((uint32_t)(num - (uint64_t)high * 100000000),
+			end);
+	while(end - begin < 8) *(--begin) = '0';
+	return UintToDigits(high, begin);
+}
+
+/* Copy string to the destination with the size (without terminal symbol, if
+   string does not fit it). Return end of destination string */
+static char* StoreStr(const char* srcStr, uint16_t length,
+		char* dstStr, uint16_t size)
+{
+	if(length >= size)
+	{
+		memcpy(dstStr, srcStr, size);
+		return dstStr + size;
+	}
+	memcpy(dstStr, srcStr, length);
+	dstStr += length;
+	*dstStr = 0;
+	return dstStr;
+}
+
+/* Correctly rounded "mantissa * 10^exp10" for usual values */
+static float DecimalToFloat(uint32_t mantissa, int32_t exp10)
+{
+	if(mantissa == 0) return 0.0F;
+
+	if((exp10 >= 0) && (exp10 <= POW10_MAX))
+	{
+		/* Exact 64-bit integer is rounded once */
+		return (float)(mantissa * uintPow10[exp10]);
+	}
+
+	if((exp10 < 0) && (exp10 >= -POW10_MAX))
+	{
+		/* Quotient with 26..27 significant bits: 24 bits of float mantissa,
+		   round bit and the rest with remainder as sticky bits */
+		uint64_t divider = uintPow10[-exp10];
+		int32_t shift = 26 + (64 - __builtin_clzll(divider)) -
+				(32 - __builtin_clz(mantissa));
+		uint64_t dividend = (uint64_t)mantissa << shift;
+		uint64_t quotient = dividend / divider;
+		bool sticky = (dividend != quotient * divider);
+
+		int32_t cut = (quotient >= (1UL << 26)) ? 3 : 2;
+		bool round = (quotient >> (cut - 1)) & 1;
+		sticky = sticky || (quotient & ((1UL << (cut - 1)) - 1));
+		uint32_t bits = (uint32_t)(quotient >> cut);
+
+		/* Round half to even */
+		if(round && (sticky || (bits & 1))) bits++;
+		if(bits >= (1UL << 24))
+		{
+			bits >>= 1;
+			cut++;
+		}
+
+		/* "bits * 2^(cut - shift)" with hidden bit of float mantissa */
+		union
+		{
+			float f;
+			uint32_t u;
+		} res = {.u = ((uint32_t)(cut - shift + 23 + 127) << 23) |
+				(bits & 0x007FFFFF)};
+		return res.f;
+	}
+
+	/* Too big or small values: scaled by parts */
+	float res = (float)mantissa;
+	while(exp10 > 0)
+	{
+		int32_t exp = (exp10 > POW10_MAX) ? POW10_MAX : exp10;
+		res *= floatPow10[exp];
+		exp10 -= exp;
+	}
+	while(exp10 < 0)
+	{
+		int32_t exp = (-exp10 > POW10_MAX) ? POW10_MAX : -exp10;
+		res /= floatPow10[exp];
+		exp10 += exp;
+	}
+	return res;
+}
@@ -30,6 +30,7 @@
 #include "html_txt_funcs.h"
 #include "httpserver-netconn.h"
 #include "web-server.h"
+#include "settings_registry.h"
 
 /* Constants -----------------------------------------------------------------*/
 #ifndef NEXT_TRY_TO_GET_DHCP_TIMEOUT
@@ -44,6 +45,21 @@
 #define HTML_DEFAULT_LOGIN 			"admin"
 #define HTML_DEFAULT_PASSW 			"1"
 
+/* Default network settings */
+#if (ipconfigUSE_DHCP == 1)
+#	define DEFAULT_PROTOCOL_TYPE 		DHCP
+#else /*(ipconfigUSE_DHCP == 1)*/
+#	define DEFAULT_PROTOCOL_TYPE 		Static_IP
+#endif /*(ipconfigUSE_DHCP == 1)*/
+#define DEFAULT_IP_ADDR 			FreeRTOS_inet_addr_quick(configIP_ADDR0, \
+		configIP_ADDR1, configIP_ADDR2, configIP_ADDR3)
+#define DEFAULT_NET_MASK 			FreeRTOS_inet_addr_quick(configNET_MASK0, \
+		configNET_MASK1, configNET_MASK2, configNET_MASK3)
+#define DEFAULT_IP_GW 				FreeRTOS_inet_addr_quick(configGW_ADDR0, \
+		configGW_ADDR1, configGW_ADDR2, configGW_ADDR3)
+#define DEFAULT_IP_DNS 				FreeRTOS_inet_addr_quick(configDNS_ADDR0, \
+		configDNS_ADDR1, configDNS_ADDR2, configDNS_ADDR3)
+
 /* HTTP servers execute in the TCP server work task. */
 #ifndef mainTCP_SERVER_TASK_PRIORITY
 #	define mainTCP_SERVER_TASK_PRIORITY (tskIDLE_PRIORITY + 2)
@@ -148,6 +164,9 @@ void WebServerInit()
 	/* Store MAC */
 	StoreMAC_Address();
 
+	/* Init HTTP server application part */
+	HTTP_ServerInit();
+
 	/* Set network settings */
 	uint8_t* ucIPAddress = (uint8_t*)(&staticIP_Addr);
 	uint8_t* ucNetMask = (uint8_t*)(&staticNetMask);
@@ -176,20 +195,11 @@ void WebServerInit()
 
 void WebServerSetDefaults()
 {
-#if (ipconfigUSE_DHCP == 1)
-	currProtocolType = DHCP;
-#else /*(ipconfigUSE_DHCP == 1)*/
-	currProtocolType = Static_IP;
-#endif /*(ipconfigUSE_DHCP == 1)*/
-
-	staticIP_Addr = FreeRTOS_inet_addr_quick(configIP_ADDR0, configIP_ADDR1,
-											 configIP_ADDR2, configIP_ADDR3);
-	staticNetMask = FreeRTOS_inet_addr_quick(configNET_MASK0, configNET_MASK1,
-											 configNET_MASK2, configNET_MASK3);
-	staticIP_GW = FreeRTOS_inet_addr_quick(configGW_ADDR0, configGW_ADDR1,
-										   configGW_ADDR2, configGW_ADDR3);
-	staticIP_DNS = FreeRTOS_inet_addr_quick(configDNS_ADDR0, configDNS_ADDR1,
-										   configDNS_ADDR2, configDNS_ADDR3);
+	currProtocolType = DEFAULT_PROTOCOL_TYPE;
+	staticIP_Addr = DEFAULT_IP_ADDR;
+	staticNetMask = DEFAULT_NET_MASK;
+	staticIP_GW = DEFAULT_IP_GW;
+	staticIP_DNS = DEFAULT_IP_DNS;
 
 #ifdef ALLOW_MAC_ADDRESS_OVERRIDE
 	/* Disable override of MAC */
@@ -524,8 +534,10 @@ void SetLogin(char* str)
 {
 	/* Validate string for empty state */
 	if(*str == 0) return;
+	if(ValueCmp(login, str)) return;
 
 	SetValue(str, login, HTML_LOGIN_MAX_LEN);
+	SettingsRegistryChanged();
 }
 char* GetPassword()
 {
@@ -536,10 +548,56 @@ void SetPassword(char* str)
 {
 	/* Validate string for empty state */
 	if(*str == 0) return;
+	if(ValueCmp(password, str)) return;
 
 	SetValue(str, password, HTML_PASSW_MAX_LEN);
+	SettingsRegistryChanged();
+}
+
+/* Settings keys -------------------------------------------------------------*/
+SETTINGS_VARIABLE_ACCESSORS(ProtocolType, uint32_t, currProtocolType)
+SETTINGS_VARIABLE_ACCESSORS(IP_Addr, uint32_t, staticIP_Addr)
+SETTINGS_VARIABLE_ACCESSORS(NetMask, uint32_t, staticNetMask)
+SETTINGS_VARIABLE_ACCESSORS(IP_GW, uint32_t, staticIP_GW)
+SETTINGS_VARIABLE_ACCESSORS(IP_DNS, uint32_t, staticIP_DNS)
+
+static void Login_Get(void* value)
+{
+	SetValue(login, value, HTML_LOGIN_MAX_LEN);
+}
+
+static void Login_Set(const void* value)
+{
+	SetLogin((char*)value);
+}
+
+static void Password_Get(void* value)
+{
+	SetValue(password, value, HTML_PASSW_MAX_LEN);
+}
+
+static void Password_Set(const void* value)
+{
+	SetPassword((char*)value);
 }
 
+static const struct SettingsKey webServerKeys[] =
+{
+	/* Network settings */
+	SETTINGS_KEY_UINT(1, ProtocolType, enum ProtocolType, DHCP, Static_IP,
+			DEFAULT_PROTOCOL_TYPE),
+	SETTINGS_KEY_UINT(2, IP_Addr, uint32_t, 0, UINT32_MAX, DEFAULT_IP_ADDR),
+	SETTINGS_KEY_UINT(3, NetMask, uint32_t, 0, UINT32_MAX, DEFAULT_NET_MASK),
+	SETTINGS_KEY_UINT(4, IP_GW, uint32_t, 0, UINT32_MAX, DEFAULT_IP_GW),
+	SETTINGS_KEY_UINT(5, IP_DNS, uint32_t, 0, UINT32_MAX, DEFAULT_IP_DNS),
+
+	/* Login and password for UI */
+	SETTINGS_KEY_STRING(6, Login, HTML_LOGIN_MAX_LEN, HTML_DEFAULT_LOGIN),
+	SETTINGS_KEY_STRING(7, Password, HTML_PASSW_MAX_LEN, HTML_DEFAULT_PASSW),
+};
+const struct SettingsKeysTable WebServerSettingsKeys =
+		SETTINGS_KEYS_TABLE(webServerKeys);
+
 uint32_t GetUpTime()
 {
 	return upTime;
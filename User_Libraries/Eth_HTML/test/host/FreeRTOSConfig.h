@@ -0,0 +1,70 @@
+/* FreeRTOS configuration of the host tests of the web server: the options
+   follow the firmware (Config/FreeRTOSConfig.h of the projects), FAT is
+   enabled for the file replies of the HTTP server */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+
+/* Application settings */
+#include "settings.h"
+
+/* Kernel configuration ------------------------------------------------------*/
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION	0
+#define configUSE_TICKLESS_IDLE					0
+#define configTICK_RATE_HZ						(1000UL)
+#define configCPU_CLOCK_HZ						(168000000UL)
+#define configUSE_PREEMPTION					1
+#define configUSE_IDLE_HOOK						0
+#define configUSE_TICK_HOOK						0
+#define configMAX_PRIORITIES					(7)
+#define configMINIMAL_STACK_SIZE				((uint16_t)130)
+#define configTOTAL_HEAP_SIZE					((size_t)(64 * 1024))
+#define configMAX_TASK_NAME_LEN					(16)
+#define configUSE_TRACE_FACILITY				1
+#define configUSE_16_BIT_TICKS					0
+#define configIDLE_SHOULD_YIELD					1
+#define configUSE_MUTEXES						1
+#define configQUEUE_REGISTRY_SIZE				0
+#define configUSE_RECURSIVE_MUTEXES				1
+#define configUSE_COUNTING_SEMAPHORES			1
+#define configUSE_TASK_NOTIFICATIONS			1
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS	3
+#define configUSE_STATS_FORMATTING_FUNCTIONS	1
+#define configGENERATE_RUN_TIME_STATS			0
+#define configUSE_CO_ROUTINES					0
+#define configMAX_CO_ROUTINE_PRIORITIES			(2)
+#define configUSE_NEWLIB_REENTRANT 				0
+#define configSUPPORT_DYNAMIC_ALLOCATION		1
+#define configSUPPORT_STATIC_ALLOCATION			0
+
+#define configUSE_TIMERS						1
+#define configTIMER_TASK_PRIORITY				(configMAX_PRIORITIES - 1)
+#define configTIMER_QUEUE_LENGTH				5
+#define configTIMER_TASK_STACK_DEPTH			(configMINIMAL_STACK_SIZE * 2)
+
+#define INCLUDE_vTaskPrioritySet				1
+#define INCLUDE_uxTaskPriorityGet				1
+#define INCLUDE_vTaskDelete						1
+#define INCLUDE_vTaskSuspend					1
+#define INCLUDE_vTaskDelayUntil					0
+#define INCLUDE_vTaskDelay						1
+#define INCLUDE_eTaskGetState					1
+#define INCLUDE_pcTaskGetTaskName				1
+#define INCLUDE_xTaskGetSchedulerState			1
+#define INCLUDE_xTaskGetCurrentTaskHandle		1
+
+#define configASSERT(x)							assert(x)
+
+/* Servers and file system ---------------------------------------------------*/
+#define configUSE_FAT							1
+
+/* Debug output of the stacks is not checked by the tests */
+#define FreeRTOS_debug_printf(MSG)				do{} while(0)
+#define FreeRTOS_printf(MSG)					do{} while(0)
+
+#endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,51 @@
+/* FreeRTOS+FAT configuration of the host tests: RAM disk (ff_ramdisk.c) with
+   long file names, the files are served by the HTTP server */
+
+#ifndef FREERTOS_FAT_CONFIG_H
+#define FREERTOS_FAT_CONFIG_H
+
+#define ffconfigBYTE_ORDER						pdFREERTOS_LITTLE_ENDIAN
+#define ffconfigHAS_CWD							0
+#define ffconfigCWD_THREAD_LOCAL_INDEX			0
+#define ffconfigLFN_SUPPORT						1
+#define ffconfigINCLUDE_SHORT_NAME				0
+#define ffconfigSHORTNAME_CASE					0
+#define ffconfigUNICODE_UTF16_SUPPORT			0
+#define ffconfigUNICODE_UTF8_SUPPORT			0
+#define ffconfigFAT12_SUPPORT					1
+#define ffconfigOPTIMISE_UNALIGNED_ACCESS		1
+#define ffconfigCACHE_WRITE_THROUGH				1
+#define ffconfigWRITE_BOTH_FATS					1
+#define ffconfigWRITE_FREE_COUNT				1
+#define ffconfigTIME_SUPPORT					0
+#define ffconfigREMOVABLE_MEDIA					0
+#define ffconfigMOUNT_FIND_FREE					1
+#define ffconfigFSINFO_TRUSTED					1
+#define ffconfigFINDAPI_ALLOW_WILDCARDS			0
+#define ffconfigWILDCARD_INCLUDES_EXT			0
+#define ffconfigPATH_CACHE						1
+#define ffconfigPATH_CACHE_DEPTH				5
+#define ffconfigHASH_CACHE						0
+#define ffconfigMKDIR_RECURSIVE					1
+#define ffconfigMALLOC(size)					malloc(size)
+#define ffconfigFREE(ptr)						free(ptr)
+#define ffconfig64_NUM_SUPPORT					1
+#define ffconfigMAX_PARTITIONS					1
+#define ffconfigMAX_FILE_SYS					1
+#define ffconfigDRIVER_BUSY_SLEEP_MS			20
+#define ffconfigFPRINTF_SUPPORT					0
+#define ffconfigFPRINTF_BUFFER_LENGTH			128
+#define ffconfigINLINE_MEMORY_ACCESS			1
+#define ffconfigFAT_CHECK						1
+#define ffconfigMAX_FILENAME					129
+#define ffconfigUSE_DELTREE						0
+#define ffconfigPROTECT_FF_FOPEN_WITH_SEMAPHORE	0
+#define ffconfigNOT_USED_FOR_NOW				0
+#define ffconfigDEV_SUPPORT						0
+#define ffconfigUSE_NOTIFY						0
+#define ffconfigNAMES_ON_HEAP					0
+#define ffconfigHAS_FUNCTION_TAB				0
+#define ffconfigDEBUG							0
+#define FF_PRINTF(...)
+
+#endif /* FREERTOS_FAT_CONFIG_H */
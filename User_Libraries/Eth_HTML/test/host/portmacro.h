@@ -0,0 +1,57 @@
+/* Host port of FreeRTOS for the tests of the web server: there is no
+   scheduler, the tests run in one thread with the simulated tick count (see
+   tcp_sim.h) */
+
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Type definitions ----------------------------------------------------------*/
+#define portCHAR		char
+#define portFLOAT		float
+#define portDOUBLE		double
+#define portLONG		long
+#define portSHORT		short
+#define portSTACK_TYPE	uint32_t
+#define portBASE_TYPE	long
+
+typedef portSTACK_TYPE StackType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+typedef uint32_t TickType_t;
+#define portMAX_DELAY				((TickType_t)0xffffffffUL)
+#define portTICK_TYPE_IS_ATOMIC		1
+
+/* Architecture specifics ----------------------------------------------------*/
+#define portSTACK_GROWTH			(-1)
+#define portTICK_PERIOD_MS			((TickType_t)1000 / configTICK_RATE_HZ)
+#define portBYTE_ALIGNMENT			8
+
+#ifndef portINLINE
+	#define portINLINE				__inline
+#endif
+#ifndef portFORCE_INLINE
+	#define portFORCE_INLINE		inline __attribute__((always_inline))
+#endif
+
+/* Scheduler and critical sections: only one thread runs */
+#define portYIELD()
+#define portEND_SWITCHING_ISR(xSwitchRequired)	(void)(xSwitchRequired)
+#define portYIELD_FROM_ISR(x)					(void)(x)
+#define portSET_INTERRUPT_MASK_FROM_ISR()		0
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(x)	(void)(x)
+#define portDISABLE_INTERRUPTS()
+#define portENABLE_INTERRUPTS()
+#define portENTER_CRITICAL()
+#define portEXIT_CRITICAL()
+#define portNOP()
+
+#define portTASK_FUNCTION_PROTO(vFunction, pvParameters) \
+		void vFunction(void *pvParameters)
+#define portTASK_FUNCTION(vFunction, pvParameters) \
+		void vFunction(void *pvParameters)
+
+#endif /* PORTMACRO_H */
@@ -0,0 +1,324 @@
+/* JSON API of the synchronizer (HTML_API.c) on the host: /api/status and
+   /api/config over the HTTP server with the device state stubbed below. The
+   benchmark sends pipelined keep-alive requests of both pages, which are
+   serialised straight into the transmit buffer */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* Application includes */
+#include "httpserver-netconn.h"
+#include "web-server.h"
+#include "UDP_logging.h"
+#include "HTML_API.h"
+#include "rtc.h"
+#include "rtc_driver.h"
+#include "sntp.h"
+#include "fw_update.h"
+#include "event_log.h"
+#include "tcp_sim.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define CLIENT_IP				FreeRTOS_inet_addr_quick(192, 168, 0, 2)
+#define MAX_CYCLES				100000
+
+/* Pipelined requests of one connection (HTTP_KEEP_ALIVE_MAX_REQUESTS) */
+#define PIPELINED				15
+#define BENCH_CONNECTIONS		200
+
+/* Variables -----------------------------------------------------------------*/
+static const struct xSERVER_CONFIG serverConfig[] =
+{
+	{ eSERVER_HTTP, 80, 12, "" },
+};
+static TCPServer_t* server;
+
+/* Device state */
+static struct DateTime localTime = { 2026, 10, 19, 1, 12, 34, 56 };
+static struct DateTime syncTime = { 2026, 10, 19, 1, 9, 30, 0 };
+static int8_t gmt = 3;
+static bool dst = false;
+static bool syncEnabled = true;
+static uint32_t syncPeriod = 3600;
+static uint32_t startupDelay = 10;
+static int16_t correctionPPM = -12;
+static bool loggingEnable = true;
+static uint32_t loggingIP_Addr;
+static uint16_t loggingPort;
+static bool logEvents = true;
+static bool logWarnings = true;
+static bool logErrors = true;
+static bool loggingSyslog = false;
+
+struct NTP_ServerSettings NTP_Servers[QUANT_NTP_SERVERS] =
+{
+	{ true, "pool.ntp.org" },
+	{ true, "time.google.com" },
+	{ false, "ntp \"quoted\" \\ name" },
+	{ false, "" },
+};
+enum NTP_RequestStatus lastNTP_RequestStatus = NTP_RequestComplete;
+uint8_t sntpRequestedServer = 1;
+enum ProtocolType currProtocolType = Static_IP;
+uint32_t staticIP_Addr;
+uint32_t staticNetMask;
+uint32_t staticIP_GW;
+uint32_t staticIP_DNS;
+
+/* Private function prototypes -----------------------------------------------*/
+static bool Request(const char* request, int status, const char* body);
+static bool Put(const char* json, int status, const char* body);
+static bool Bench(const char* path);
+static bool Check(bool condition, const char* error);
+
+/* Public functions ----------------------------------------------------------*/
+int main()
+{
+	loggingIP_Addr = FreeRTOS_inet_addr_quick(192, 168, 0, 5);
+	loggingPort = FreeRTOS_htons(514);
+	staticIP_Addr = FreeRTOS_inet_addr_quick(192, 168, 0, 10);
+	staticNetMask = FreeRTOS_inet_addr_quick(255, 255, 255, 0);
+	staticIP_GW = FreeRTOS_inet_addr_quick(192, 168, 0, 1);
+	staticIP_DNS = FreeRTOS_inet_addr_quick(8, 8, 8, 8);
+
+	TCP_SimInit();
+	server = FreeRTOS_CreateTCPServer(serverConfig, 1);
+	if(!Check(server != NULL, "server is not created")) return 1;
+
+	if(!Check(Request("GET /api/status HTTP/1.1\r\nHost: 192.168.0.10\r\n\r\n",
+			WEB_REPLY_OK, "{\"rtc_valid\":true,"
+			"\"local_time\":\"2026-10-19T12:34:56\",\"gmt\":3,"
+			"\"ntp_enabled\":true,\"ntp_status\":\"valid\","
+			"\"last_sync\":\"2026-10-19T09:30:00\",\"offset_ms\":-7,"
+			"\"delay_ms\":21,\"server\":\"time.google.com\","
+			"\"server_status\":\"complete\",\"uptime\":86400,\"link\":true}"),
+			"status is wrong")) return 1;
+
+	if(!Check(Request("GET /api/config HTTP/1.1\r\nHost: 192.168.0.10\r\n\r\n",
+			WEB_REPLY_OK, "{\"gmt\":3,\"dst\":false,\"ntp_en\":true,"
+			"\"ntp_period\":3600,\"ntp_startup_delay\":10,"
+			"\"ntp_server0\":\"pool.ntp.org\",\"ntp_server0_en\":true,"
+			"\"ntp_server1\":\"time.google.com\",\"ntp_server1_en\":true,"
+			"\"ntp_server2\":\"ntp \\\"quoted\\\" \\\\ name\","
+			"\"ntp_server2_en\":false,"
+			"\"ntp_server3\":\"\",\"ntp_server3_en\":false,"
+			"\"rtc_corr\":-12,\"log_en\":true,\"log_ip\":\"192.168.0.5\","
+			"\"log_port\":514,\"log_evt\":true,\"log_wrn\":true,"
+			"\"log_err\":true,\"log_sys\":false,\"dhcp\":false,"
+			"\"ip\":\"192.168.0.10\",\"mask\":\"255.255.255.0\","
+			"\"gw\":\"192.168.0.1\",\"dns\":\"8.8.8.8\"}"),
+			"configuration is wrong")) return 1;
+
+	/* Members are changed by PUT, unknown and read only ones are skipped */
+	if(!Check(Put("{ \"gmt\": -5, \"ntp_server3\": \"ntp.example\", "
+			"\"ip\": \"10.0.0.1\", \"log_port\": 1514, \"rtc_corr\": 20, "
+			"\"x\": [1] }", WEB_REPLY_OK, NULL), "configuration is not put"))
+		return 1;
+	if(!Check((gmt == -5) && (strcmp(NTP_Servers[3].NTP, "ntp.example") == 0) &&
+			(loggingPort == FreeRTOS_htons(1514)) && (correctionPPM == 20) &&
+			(staticIP_Addr == FreeRTOS_inet_addr_quick(192, 168, 0, 10)),
+			"configuration is not applied")) return 1;
+
+	if(!Check(Put("{\"gmt\": 100 }", WEB_BAD_REQUEST,
+			"{\"error\":\"invalid configuration\"}") && (gmt == -5),
+			"invalid configuration is accepted")) return 1;
+	if(!Check(Put("{\"dst\": true", WEB_BAD_REQUEST, NULL) && (dst == false),
+			"unclosed object is accepted")) return 1;
+
+	if(!Check(Bench("/api/status") && Bench("/api/config"),
+			"benchmark requests are not replied")) return 1;
+
+	printf("PASS\n");
+	return 0;
+}
+
+/* Pages ---------------------------------------------------------------------*/
+BaseType_t prvOpenURL(HTTPClient_t *pxClient)
+{
+	BaseType_t xResult = Parse_API_Status(pxClient);
+
+	if(xResult == pdFALSE) xResult = Parse_API_Config(pxClient);
+	if(xResult == pdFALSE)
+		xResult = SendHTML_Content(pxClient, WEB_NOT_FOUND, "text/html", NULL, 0);
+	return xResult;
+}
+
+/* Stubs of the device -------------------------------------------------------*/
+bool RTC_GetTimeIsValide() { return true; }
+void RTC_GetLocalDateTime(struct DateTime* dateTime) { *dateTime = localTime; }
+int8_t RTC_GetGMT() { return gmt; }
+void RTC_SetGMT(int8_t val) { gmt = val; }
+bool RTC_GetDST() { return dst; }
+void RTC_SetDST(bool val) { dst = val; }
+bool ValueAsGMT_IsValide(int8_t val) { return (val >= -12) && (val <= 14); }
+int16_t RTC_DriverGetCorrectionPPM() { return correctionPPM; }
+void RTC_DriverSetCorrectionPPM(int16_t val) { correctionPPM = val; }
+
+enum NTP_TimeStatus GetNTP_TimeStatus() { return NTP_TimeValid; }
+bool SNTP_GetLastSyncTime(struct DateTime* dateTime)
+{
+	*dateTime = syncTime;
+	return true;
+}
+int32_t SNTP_GetLastSyncOffset() { return -7; }
+uint32_t SNTP_GetLastSyncDelay() { return 21; }
+bool SNTP_GetSyncEnabled() { return syncEnabled; }
+void SNTP_SetSyncEnabled(bool enabled) { syncEnabled = enabled; }
+uint32_t SNTP_GetSyncPeriod() { return syncPeriod; }
+void SNTP_SetSyncPeriod(uint32_t seconds) { syncPeriod = seconds; }
+uint32_t SNTP_GetStartupDelay() { return startupDelay; }
+void SNTP_SetStartupDelay(uint32_t seconds) { startupDelay = seconds; }
+void SNTP_SetServer(uint8_t index, const char* name, bool enabled)
+{
+	NTP_Servers[index].enabled = enabled;
+	snprintf(NTP_Servers[index].NTP, sizeof(NTP_Servers[index].NTP), "%s",
+			name);
+}
+
+bool GetUDP_LoggingEnable() { return loggingEnable; }
+void SetUDP_LoggingEnable(bool val) { loggingEnable = val; }
+uint32_t GetUDP_LoggingIP_Addr() { return loggingIP_Addr; }
+void SetUDP_LoggingIP_Addr(uint32_t val) { loggingIP_Addr = val; }
+uint16_t GetUDP_LoggingPort() { return loggingPort; }
+void SetUDP_LoggingPort(uint16_t val) { loggingPort = val; }
+bool GetUDP_LogEvents() { return logEvents; }
+void SetUDP_LogEvents(bool val) { logEvents = val; }
+bool GetUDP_LogWarnings() { return logWarnings; }
+void SetUDP_LogWarnings(bool val) { logWarnings = val; }
+bool GetUDP_LogErrors() { return logErrors; }
+void SetUDP_LogErrors(bool val) { logErrors = val; }
+bool GetUDP_LoggingSyslog() { return loggingSyslog; }
+void SetUDP_LoggingSyslog(bool val) { loggingSyslog = val; }
+
+uint32_t GetUpTime() { return 86400; }
+BaseType_t FreeRTOS_IsNetworkUp() { return pdTRUE; }
+uint32_t FreeRTOS_inet_addr(const char* pcIPAddress)
+{
+	unsigned int ip[4];
+
+	if(sscanf(pcIPAddress, "%u.%u.%u.%u", &ip[0], &ip[1], &ip[2], &ip[3]) != 4)
+		return 0;
+	return FreeRTOS_inet_addr_quick(ip[0], ip[1], ip[2], ip[3]);
+}
+
+/* Firmware and event log are not served by the test */
+const uint8_t* EventLogGetData(uint32_t* size)
+{
+	*size = 0;
+	return NULL;
+}
+enum FW_UpdateResult FW_UpdateBegin(uint32_t size)
+{
+	(void) size;
+	return FW_UpdateFlashError;
+}
+enum FW_UpdateResult FW_UpdateWrite(const void* data, size_t length)
+{
+	(void) data;
+	(void) length;
+	return FW_UpdateFlashError;
+}
+enum FW_UpdateResult FW_UpdateEnd(uint32_t crc)
+{
+	(void) crc;
+	return FW_UpdateFlashError;
+}
+void FW_UpdateApply() {}
+
+/* Private functions ---------------------------------------------------------*/
+/* Body is not checked, if it is NULL */
+static bool Request(const char* request, int status, const char* body)
+{
+	struct TCP_SimReply reply;
+	const char* type;
+	int conn = TCP_SimConnect(CLIENT_IP);
+
+	TCP_SimWriteStr(conn, request);
+	TCP_SimClose(conn);
+	if(!TCP_SimRun(server, MAX_CYCLES) || !TCP_SimGetReply(conn, &reply))
+		return false;
+
+	if(reply.status != status)
+	{
+		printf("reply %d instead of %d\n", reply.status, status);
+		return false;
+	}
+	type = TCP_SimReplyHeader(&reply, "Content-Type");
+	if((type == NULL) || strncmp(type, "application/json\r\n", 18))
+	{
+		printf("Content-Type header is wrong\n");
+		return false;
+	}
+	if((body != NULL) && ((reply.bodyLength != strlen(body)) ||
+			memcmp(reply.body, body, reply.bodyLength)))
+	{
+		printf("reply \"%.*s\"\ninstead of \"%s\"\n", (int) reply.bodyLength,
+				(const char*) reply.body, body);
+		return false;
+	}
+	return true;
+}
+
+static bool Put(const char* json, int status, const char* body)
+{
+	char request[512];
+
+	snprintf(request, sizeof(request), "PUT /api/config HTTP/1.1\r\n"
+			"Host: 192.168.0.10\r\nContent-Type: application/json\r\n"
+			"Content-Length: %u\r\n\r\n%s", (unsigned) strlen(json), json);
+	return Request(request, status, body);
+}
+
+static bool Bench(const char* path)
+{
+	static char requests[PIPELINED * 128];
+	struct TCP_SimReply reply;
+	struct timespec start;
+	struct timespec end;
+	uint32_t replies = 0;
+	size_t bytes = 0;
+	size_t length = 0;
+	double seconds;
+	int conn;
+	int i;
+
+	for(i = 0; i < PIPELINED; i++)
+	{
+		length += snprintf(&requests[length], sizeof(requests) - length,
+				"GET %s HTTP/1.1\r\nHost: 192.168.0.10\r\n"
+				"Accept: application/json\r\n%s\r\n", path,
+				(i == PIPELINED - 1) ? "Connection: close\r\n" : "");
+	}
+
+	TCP_SimResetStats();
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(i = 0; i < BENCH_CONNECTIONS; i++)
+	{
+		conn = TCP_SimConnect(CLIENT_IP);
+		TCP_SimWriteStr(conn, requests);
+		if(!TCP_SimRun(server, MAX_CYCLES)) break;
+		while(TCP_SimGetReply(conn, &reply))
+		{
+			if(reply.status != WEB_REPLY_OK) return false;
+			bytes += reply.bodyLength;
+			replies++;
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	printf("%-12s: %u requests, %.2f us/request, %u bytes of JSON, "
+			"%u work cycles\n", path, (unsigned) replies,
+			seconds * 1e6 / (replies ? replies : 1),
+			(unsigned) (bytes / (replies ? replies : 1)),
+			(unsigned) TCP_SimGetStats()->cycles);
+	return replies == BENCH_CONNECTIONS * PIPELINED;
+}
+
+static bool Check(bool condition, const char* error)
+{
+	if(!condition) printf("FAIL: %s\n", error);
+	return condition;
+}
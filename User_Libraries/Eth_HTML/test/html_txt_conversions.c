@@ -0,0 +1,473 @@
+/* Number conversions of the pages (html_txt_funcs.c) on the host, compared
+   with libc: integers and hex by the digit tables, floats with exact rounding
+   (half to even, as printf does) and their limits: truncation to the size of
+   string and to the number of digits, INT32_MIN, inf and nan. The benchmark
+   compares the time of conversions with snprintf() and strtof() */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <float.h>
+#include <math.h>
+#include <time.h>
+
+/* Application includes */
+#include "httpserver-netconn.h"
+#include "html_txt_funcs.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define RANDOM_NUMBERS			1000000
+#define RANDOM_FLOATS			200000
+#define BENCH_CALLS				2000000
+
+/* Private types -------------------------------------------------------------*/
+struct FloatCase
+{
+	float num;
+	uint16_t before;
+	uint16_t after;
+	const char* str;
+};
+
+struct ParseCase
+{
+	const char* str;
+	float num;
+};
+
+/* Variables -----------------------------------------------------------------*/
+static const int32_t numbers[] =
+{
+	0, 1, -1, 9, 10, 99, 100, -100, 12345, 99999, 100000, 999999999,
+	1000000000, -1000000000, INT32_MAX, INT32_MAX - 1, INT32_MIN,
+	INT32_MIN + 1,
+};
+
+/* Ties are rounded to even digit, as printf rounds them */
+static const struct FloatCase floatCases[] =
+{
+	{ 0.125F, 1, 2, "0.12" },
+	{ 0.375F, 1, 2, "0.38" },
+	{ 2.5F, 1, 0, "2" },
+	{ 3.5F, 1, 0, "4" },
+	{ -0.5F, 1, 0, "-0" },
+	{ 0.05F, 1, 1, "0.1" },			/* 0.0500000007 is over the half */
+	{ 9.995F, 1, 2, "9.99" },		/* 9.99499988 */
+	{ 9.9999F, 1, 2, "0.00" },		/* 10.00 without the digit over limit */
+	{ 123456.0F, 3, 1, "456.0" },	/* Digits over limit are cut */
+	{ 16777216.0F, 8, 2, "16777216.00" },
+	{ 4294967296.0F, 10, 0, "4294967296" },
+	{ FLT_MAX, 10, 0, "4516925440" },
+	{ FLT_MIN, 1, 9, "0.000000000" },
+	{ 1.0e-10F, 0, 10, "0.0000000001" },
+	{ 0.0F, 1, 3, "0.000" },
+	{ -0.0F, 1, 3, "0.000" },		/* Negative zero has no sign */
+	{ -0.0001F, 1, 3, "-0.000" },
+	{ INFINITY, 5, 2, "inf" },
+	{ -INFINITY, 5, 2, "-inf" },
+	{ NAN, 5, 2, "nan" },
+};
+
+/* Strings of the pages: separators of forms and more digits than float has */
+static const struct ParseCase parseCases[] =
+{
+	{ "3,5", 3.5F },
+	{ "3%2C5", 3.5F },
+	{ "3%2e25", 3.25F },
+	{ "  +1.5", 1.5F },
+	{ "-0.001", -0.001F },
+	{ "8388608.5", 8388608.0F },		/* Tie to even */
+	{ "8388609.5", 8388610.0F },
+	{ "16777217", 16777216.0F },
+	{ "0.1", 0.1F },
+	{ "0.0000000001", 1.0e-10F },
+	{ "4294967295", 4294967296.0F },
+	{ "123456789012", 123456789012.0F },
+	{ "0.12345678901234", 0.12345678901234F },
+	{ "1.5.3", 1.5F },
+};
+
+static uint32_t randomState = 2463534242UL;
+
+/* Private function prototypes -----------------------------------------------*/
+static bool CheckNum(int32_t num);
+static bool CheckHex(uint32_t hex);
+static bool CheckFloat(float num, uint16_t before, uint16_t after);
+static bool CheckParse(const char* str);
+static bool CheckSizes();
+static void ExpectedFloat(float num, uint16_t before, uint16_t after,
+		char* str, size_t size);
+static uint32_t Random();
+static float RandomFloat();
+static uint32_t FloatBits(float num);
+static double Seconds(const struct timespec* start);
+static void Bench();
+static bool Check(bool condition, const char* error);
+
+/* Public functions ----------------------------------------------------------*/
+int main()
+{
+	char str[32];
+	const char* pStr;
+	float fNum;
+	size_t i;
+
+	/* Integers */
+	for(i = 0; i < sizeof(numbers) / sizeof(numbers[0]); i++)
+	{
+		if(!Check(CheckNum(numbers[i]), "number is wrong")) return 1;
+	}
+	for(i = 0; i < 32; i++)
+	{
+		if(!Check(CheckHex(1UL << i) && CheckHex((1UL << i) - 1) &&
+				CheckHex(~(1UL << i)), "hex is wrong")) return 1;
+	}
+	for(i = 0; i < RANDOM_NUMBERS; i++)
+	{
+		uint32_t random = Random() >> (Random() & 31);
+		if(!Check(CheckNum((int32_t)random) && CheckNum((int32_t)(0U - random)) &&
+				CheckHex(random), "random number is wrong")) return 1;
+	}
+	for(i = 0; i <= 9; i++)
+	{
+		uint32_t pow = 1;
+		for(size_t j = 0; j < i; j++) pow *= 10;
+		if(!Check(PowBase10(i) == pow, "power of 10 is wrong")) return 1;
+	}
+
+	/* Floats to strings */
+	for(i = 0; i < sizeof(floatCases) / sizeof(floatCases[0]); i++)
+	{
+		const struct FloatCase* test = &floatCases[i];
+		SetFloatToStr(test->num, test->before, test->after, str, sizeof(str));
+		if(strcmp(str, test->str))
+		{
+			printf("FAIL: %.9g with %u.%u digits is \"%s\" instead of \"%s\"\n",
+					test->num, test->before, test->after, str, test->str);
+			return 1;
+		}
+		if(!Check(CheckFloat(test->num, test->before, test->after),
+				"float differs from libc")) return 1;
+	}
+	for(i = 0; i < RANDOM_FLOATS; i++)
+	{
+		float num = RandomFloat();
+		uint16_t before = Random() % 11;
+		uint16_t after = Random() % (11 - before);
+		if(before + after == 0) after = 1;
+		if(!Check(CheckFloat(num, before, after), "random float is wrong"))
+			return 1;
+	}
+
+	/* Strings to floats */
+	for(i = 0; i < sizeof(parseCases) / sizeof(parseCases[0]); i++)
+	{
+		pStr = parseCases[i].str;
+		if(!GetFloatFromStr(&pStr, &fNum, true) ||
+			(FloatBits(fNum) != FloatBits(parseCases[i].num)))
+		{
+			printf("FAIL: \"%s\" is %.9g instead of %.9g\n", parseCases[i].str,
+					fNum, parseCases[i].num);
+			return 1;
+		}
+	}
+	for(i = 0; i < RANDOM_FLOATS; i++)
+	{
+		/* Up to 9 significant digits with the point in any place */
+		uint32_t digits = Random() % 1000000000;
+		int point = (int)(Random() % 10);
+		int length = snprintf(str, sizeof(str), "%s%09u", (Random() & 1) ?
+				"-" : "", (unsigned) digits);
+		memmove(&str[length - point + 1], &str[length - point], point + 1);
+		str[length - point] = '.';
+		if(!Check(CheckParse(str), "random string is parsed wrong")) return 1;
+	}
+
+	if(!Check(CheckSizes(), "truncation is wrong")) return 1;
+
+	Bench();
+	printf("PASS\n");
+	return 0;
+}
+
+/* Pages ---------------------------------------------------------------------*/
+/* Server is linked with the conversions, but it is not used */
+BaseType_t prvOpenURL(HTTPClient_t *pxClient)
+{
+	return SendHTML_Content(pxClient, WEB_NOT_FOUND, "text/html", NULL, 0);
+}
+
+/* Private functions ---------------------------------------------------------*/
+static bool CheckNum(int32_t num)
+{
+	char str[16];
+	char expected[16];
+	const char* pStr = str;
+	int32_t parsed;
+	char* end = SetNumToStr(num, str, sizeof(str));
+
+	snprintf(expected, sizeof(expected), "%d", num);
+	if(strcmp(str, expected) || (end != str + strlen(expected)))
+	{
+		printf("%d is \"%s\"\n", num, str);
+		return false;
+	}
+
+	/* Parser overflows at INT32_MIN magnitude as 32-bit arithmetic does */
+	if(!GetNumFromStr(&pStr, &parsed, true) || (*pStr != '\0'))
+		return false;
+	return (num == INT32_MIN) || (parsed == num);
+}
+
+static bool CheckHex(uint32_t hex)
+{
+	char str[16];
+	char expected[16];
+	const char* pStr;
+	int32_t parsed;
+
+	for(uint16_t size = 2; size <= 12; size++)
+	{
+		/* Digits over the size are cut from the end */
+		size_t width = ((size > 9) ? 9 : size) - 1;
+
+		SetHexToStr(hex, str, size, true);
+		snprintf(expected, sizeof(expected), "%X", (unsigned) hex);
+		expected[width] = '\0';
+		if(strcmp(str, expected)) return false;
+
+		SetHexToStr(hex, str, size, false);
+		snprintf(expected, sizeof(expected), "%0*X", (int) width,
+				(unsigned) hex);
+		expected[width] = '\0';
+		if(strcmp(str, expected)) return false;
+	}
+
+	/* Whole number is parsed back as strtoul() does */
+	SetHexToStr(hex, str, 9, true);
+	pStr = str;
+	if(!GetHexFromStr(&pStr, &parsed, true)) return false;
+	return ((uint32_t)parsed == strtoul(str, NULL, 16)) &&
+			((uint32_t)parsed == hex);
+}
+
+static bool CheckFloat(float num, uint16_t before, uint16_t after)
+{
+	char str[32];
+	char expected[32];
+	char* end = SetFloatToStr(num, before, after, str, sizeof(str));
+
+	ExpectedFloat(num, before, after, expected, sizeof(expected));
+	if(strcmp(str, expected) || (end != str + strlen(str)))
+	{
+		printf("%.9g with %u.%u digits is \"%s\" instead of \"%s\"\n", num,
+				before, after, str, expected);
+		return false;
+	}
+	return true;
+}
+
+/* Strings of 9 significant digits are rounded as strtof() rounds them */
+static bool CheckParse(const char* str)
+{
+	const char* pStr = str;
+	float num;
+
+	if(!GetFloatFromStr(&pStr, &num, true) || (*pStr != '\0'))
+	{
+		printf("\"%s\" is not parsed\n", str);
+		return false;
+	}
+	if(FloatBits(num) == FloatBits(strtof(str, NULL))) return true;
+
+	printf("\"%s\" is %.9g instead of %.9g\n", str, num, strtof(str, NULL));
+	return false;
+}
+
+/* String is cut by the size without terminal symbol, the end is returned */
+static bool CheckSizes()
+{
+	char str[16];
+
+	memset(str, '#', sizeof(str));
+	if((SetNumToStr(-12345, str, 6) != str + 6) ||
+		memcmp(str, "-12345#", 7)) return false;
+	memset(str, '#', sizeof(str));
+	if((SetNumToStr(-12345, str, 4) != str + 4) ||
+		memcmp(str, "-123#", 5)) return false;
+	memset(str, '#', sizeof(str));
+	if((SetNumToStr(-12345, str, 7) != str + 6) ||
+		memcmp(str, "-12345\0#", 8)) return false;
+
+	memset(str, '#', sizeof(str));
+	if((SetFloatToStr(-1.25F, 1, 2, str, 3) != str + 3) ||
+		memcmp(str, "-1.#", 4)) return false;
+	memset(str, '#', sizeof(str));
+	if((SetFloatToStr(1.25F, 1, 2, str, 0) != str) || (str[0] != '#'))
+		return false;
+	if(SetFloatToStr(1.25F, 6, 5, str, sizeof(str)) != str) return false;
+
+	memset(str, '#', sizeof(str));
+	if((SetHexToStr(0xABCDEF, str, 1, true) != str) || (str[0] != '#'))
+		return false;
+	return (SetHexToStr(0xABCDEF, str, 4, true) == str + 3) &&
+			(strcmp(str, "ABC") == 0);
+}
+
+/* printf() with the digits of integer part over the limit cut */
+static void ExpectedFloat(float num, uint16_t before, uint16_t after,
+		char* str, size_t size)
+{
+	char libc[64];
+	const char* pInt;
+	size_t intLength;
+
+	if(isnan(num) || isinf(num))
+	{
+		snprintf(str, size, "%s%s", (num < 0) ? "-" : "",
+				isnan(num) ? "nan" : "inf");
+		return;
+	}
+
+	snprintf(libc, sizeof(libc), "%.*f", after, fabsf(num));
+	intLength = strcspn(libc, ".");
+	pInt = libc;
+	if(intLength > before)
+	{
+		pInt += intLength - before;
+		intLength = before;
+	}
+	while((intLength > 1) && (*pInt == '0'))
+	{
+		pInt++;
+		intLength--;
+	}
+
+	snprintf(str, size, "%s%.*s%s", (num < 0) ? "-" : "", (int) intLength,
+			pInt, (intLength == 0) ? "0" : "");
+	if(after) strcat(str, &libc[strcspn(libc, ".")]);
+}
+
+static uint32_t Random()
+{
+	/* Xorshift */
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return randomState;
+}
+
+/* Float of any exponent (without inf and nan) */
+static float RandomFloat()
+{
+	union
+	{
+		float f;
+		uint32_t u;
+	} bits;
+
+	do bits.u = Random();
+	while(((bits.u >> 23) & 0xFF) == 0xFF);
+
+	/* Usual values of the pages are more frequent */
+	if(Random() & 1)
+		bits.f = (float)(int32_t)bits.u / (float)(1 << (Random() & 15));
+	return bits.f;
+}
+
+static uint32_t FloatBits(float num)
+{
+	uint32_t bits;
+
+	memcpy(&bits, &num, sizeof(bits));
+	return bits;
+}
+
+static double Seconds(const struct timespec* start)
+{
+	struct timespec end;
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void Bench()
+{
+	static float floats[1024];
+	static char strings[1024][16];
+	volatile uint32_t sink = 0;
+	struct timespec start;
+	const char* pStr;
+	char str[32];
+	float fNum;
+	int32_t num;
+	int i;
+
+	for(i = 0; i < 1024; i++)
+	{
+		floats[i] = (float)(int32_t)(Random() % 2000000 - 1000000) / 1000.0F;
+		snprintf(strings[i], sizeof(strings[i]), "%.3f", floats[i]);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(i = 0; i < BENCH_CALLS; i++)
+		sink += *SetNumToStr((int32_t)Random(), str, sizeof(str));
+	printf("SetNumToStr    %6.1f ns, ", Seconds(&start) * 1e9 / BENCH_CALLS);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(i = 0; i < BENCH_CALLS; i++)
+		sink += snprintf(str, sizeof(str), "%d", (int32_t)Random());
+	printf("snprintf(%%d)    %6.1f ns\n", Seconds(&start) * 1e9 / BENCH_CALLS);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(i = 0; i < BENCH_CALLS; i++)
+		sink += *SetHexToStr(Random(), str, 9, true);
+	printf("SetHexToStr    %6.1f ns, ", Seconds(&start) * 1e9 / BENCH_CALLS);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(i = 0; i < BENCH_CALLS; i++)
+		sink += snprintf(str, sizeof(str), "%X", (unsigned) Random());
+	printf("snprintf(%%X)    %6.1f ns\n", Seconds(&start) * 1e9 / BENCH_CALLS);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(i = 0; i < BENCH_CALLS; i++)
+		sink += *SetFloatToStr(floats[i & 1023], 4, 3, str, sizeof(str));
+	printf("SetFloatToStr  %6.1f ns, ", Seconds(&start) * 1e9 / BENCH_CALLS);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(i = 0; i < BENCH_CALLS; i++)
+		sink += snprintf(str, sizeof(str), "%.3f", floats[i & 1023]);
+	printf("snprintf(%%.3f)  %6.1f ns\n", Seconds(&start) * 1e9 / BENCH_CALLS);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(i = 0; i < BENCH_CALLS; i++)
+	{
+		pStr = strings[i & 1023];
+		GetFloatFromStr(&pStr, &fNum, false);
+		sink += FloatBits(fNum);
+	}
+	printf("GetFloatFromStr%6.1f ns, ", Seconds(&start) * 1e9 / BENCH_CALLS);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(i = 0; i < BENCH_CALLS; i++)
+		sink += FloatBits(strtof(strings[i & 1023], NULL));
+	printf("strtof()        %6.1f ns\n", Seconds(&start) * 1e9 / BENCH_CALLS);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(i = 0; i < BENCH_CALLS; i++)
+	{
+		pStr = strings[i & 1023];
+		GetNumFromStr(&pStr, &num, false);
+		sink += num;
+	}
+	printf("GetNumFromStr  %6.1f ns, ", Seconds(&start) * 1e9 / BENCH_CALLS);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(i = 0; i < BENCH_CALLS; i++)
+		sink += strtol(strings[i & 1023], NULL, 10);
+	printf("strtol()        %6.1f ns\n", Seconds(&start) * 1e9 / BENCH_CALLS);
+	(void) sink;
+}
+
+static bool Check(bool condition, const char* error)
+{
+	if(!condition) printf("FAIL: %s\n", error);
+	return condition;
+}
@@ -0,0 +1,213 @@
+/* Files of the RAM disk (ff_ramdisk.c) and memory blocks (SendHTML_Memory,
+   e.g. the event log) sent by the HTTP server through the transmit stream of
+   one MSS, as the firmware configures it: replies longer than the stream,
+   ranges and the throughput of downloads with different windows of the
+   peer */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* FreeRTOS+FAT includes */
+#include "ff_stdio.h"
+#include "ff_ramdisk.h"
+
+/* Application includes */
+#include "httpserver-netconn.h"
+#include "tcp_sim.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define CLIENT_IP				FreeRTOS_inet_addr_quick(192, 168, 0, 2)
+#define MAX_CYCLES				1000000
+
+/* RAM disk of 4 MB */
+#define DISK_SECTOR_SIZE		512
+#define DISK_SECTORS			8192
+#define DISK_CACHE_SIZE			(4 * DISK_SECTOR_SIZE)
+
+#define BIG_FILE_SIZE			(1024 * 1024)
+#define MEMORY_SIZE				(64 * 1024 + 5)
+#define BENCH_DOWNLOADS			20
+
+/* Private types -------------------------------------------------------------*/
+struct TestFile
+{
+	const char* name;
+	size_t size;
+};
+
+/* Variables -----------------------------------------------------------------*/
+static const struct xSERVER_CONFIG serverConfig[] =
+{
+	{ eSERVER_HTTP, 80, 12, "" },
+};
+static const struct TestFile files[] =
+{
+	{ "/small.txt", 700 },
+	{ "/stream.bin", ipconfigHTTP_TX_BUFSIZE },
+	{ "/odd.bin", 3 * ipconfigHTTP_TX_BUFSIZE + 17 },
+	{ "/big.bin", BIG_FILE_SIZE },
+};
+/* Windows of the peer: the smallest one leaves the stream partly sent */
+static const size_t windows[] = { 536, ipconfigTCP_MSS, 2 * ipconfigTCP_MSS };
+static uint8_t disk[DISK_SECTORS * DISK_SECTOR_SIZE];
+static uint8_t contents[BIG_FILE_SIZE];
+static TCPServer_t* server;
+
+/* Private function prototypes -----------------------------------------------*/
+static bool WriteFile(const struct TestFile* file);
+static bool Download(const char* request, size_t window, int status,
+		const uint8_t* data, size_t length);
+static bool Bench(size_t window);
+static bool Check(bool condition, const char* error);
+
+/* Public functions ----------------------------------------------------------*/
+int main()
+{
+	char request[128];
+	size_t file;
+	size_t window;
+
+	for(size_t i = 0; i < sizeof(contents); i++)
+		contents[i] = (uint8_t) (i * 7 + i / 251);
+
+	if(!Check(FF_RAMDiskInit("/", disk, DISK_SECTORS, DISK_CACHE_SIZE) !=
+			NULL, "RAM disk is not mounted")) return 1;
+	for(file = 0; file < sizeof(files) / sizeof(files[0]); file++)
+	{
+		if(!Check(WriteFile(&files[file]), "file is not written")) return 1;
+	}
+
+	TCP_SimInit();
+	server = FreeRTOS_CreateTCPServer(serverConfig, 1);
+	if(!Check(server != NULL, "server is not created")) return 1;
+
+	/* Whole files: the free space of the stream wraps its end */
+	for(file = 0; file < sizeof(files) / sizeof(files[0]); file++)
+	{
+		for(window = 0; window < sizeof(windows) / sizeof(windows[0]);
+			window++)
+		{
+			snprintf(request, sizeof(request), "GET %s HTTP/1.1\r\n"
+					"Host: 192.168.0.10\r\n\r\n", files[file].name);
+			if(!Download(request, windows[window], WEB_REPLY_OK, contents,
+					files[file].size))
+			{
+				printf("%s, window %u\n", files[file].name,
+						(unsigned) windows[window]);
+				return 1;
+			}
+		}
+	}
+
+	/* Memory block is sent by parts too */
+	for(window = 0; window < sizeof(windows) / sizeof(windows[0]); window++)
+	{
+		if(!Check(Download("GET /memory HTTP/1.1\r\nHost: 192.168.0.10\r\n"
+				"\r\n", windows[window], WEB_REPLY_OK, contents, MEMORY_SIZE),
+				"memory block is not sent")) return 1;
+	}
+
+	/* Ranges of the big file */
+	if(!Check(Download("GET /big.bin HTTP/1.1\r\nHost: 192.168.0.10\r\n"
+			"Range: bytes=1000-70999\r\n\r\n", 536, WEB_PARTIAL_CONTENT,
+			&contents[1000], 70000), "range is not sent")) return 1;
+	if(!Check(Download("GET /big.bin HTTP/1.1\r\nHost: 192.168.0.10\r\n"
+			"Range: bytes=-3000\r\n\r\n", ipconfigTCP_MSS, WEB_PARTIAL_CONTENT,
+			&contents[BIG_FILE_SIZE - 3000], 3000),
+			"suffix range is not sent")) return 1;
+
+	for(window = 0; window < sizeof(windows) / sizeof(windows[0]); window++)
+	{
+		if(!Check(Bench(windows[window]), "benchmark download is broken"))
+			return 1;
+	}
+
+	printf("PASS\n");
+	return 0;
+}
+
+/* Pages ---------------------------------------------------------------------*/
+BaseType_t prvOpenURL(HTTPClient_t *pxClient)
+{
+	/* Files are served by the server itself */
+	if(strcmp(pxClient->pcUrlData, "/memory") == 0)
+	{
+		return SendHTML_Memory(pxClient, "application/octet-stream",
+				contents, MEMORY_SIZE);
+	}
+	return SendHTML_Content(pxClient, WEB_NOT_FOUND, "text/html", NULL, 0);
+}
+
+/* Private functions ---------------------------------------------------------*/
+static bool WriteFile(const struct TestFile* file)
+{
+	FF_FILE* handle = ff_fopen(file->name, "wb");
+	size_t written;
+
+	if(handle == NULL) return false;
+	written = ff_fwrite(contents, 1, file->size, handle);
+	ff_fclose(handle);
+	return written == file->size;
+}
+
+static bool Download(const char* request, size_t window, int status,
+		const uint8_t* data, size_t length)
+{
+	struct TCP_SimReply reply;
+	int conn = TCP_SimConnect(CLIENT_IP);
+
+	TCP_SimSetWindow(conn, window);
+	TCP_SimWriteStr(conn, request);
+	TCP_SimClose(conn);
+	if(!TCP_SimRun(server, MAX_CYCLES)) return false;
+
+	if(!TCP_SimGetReply(conn, &reply) || (reply.status != status))
+	{
+		printf("reply %d instead of %d\n", reply.status, status);
+		return false;
+	}
+	if((reply.bodyLength != length) || memcmp(reply.body, data, length))
+	{
+		printf("body of %u bytes differs\n", (unsigned) reply.bodyLength);
+		return false;
+	}
+
+	return TCP_SimIsClosed(conn);
+}
+
+static bool Bench(size_t window)
+{
+	struct timespec start;
+	struct timespec end;
+	double seconds;
+	int i;
+
+	TCP_SimResetStats();
+	TickType_t ticks = TCP_SimGetTicks();
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(i = 0; i < BENCH_DOWNLOADS; i++)
+	{
+		if(!Download("GET /big.bin HTTP/1.1\r\nHost: 192.168.0.10\r\n\r\n",
+				window, WEB_REPLY_OK, contents, BIG_FILE_SIZE)) return false;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	/* Steps of the network are ticks: bytes per tick are the part of the
+	window, which the server keeps filled */
+	seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	printf("window %4u: %.1f MB/s on the host, %.0f bytes per network step, "
+			"%u work cycles\n", (unsigned) window,
+			BENCH_DOWNLOADS * (double) BIG_FILE_SIZE / seconds / 1e6,
+			BENCH_DOWNLOADS * (double) BIG_FILE_SIZE /
+					(TCP_SimGetTicks() - ticks),
+			(unsigned) TCP_SimGetStats()->cycles);
+	return true;
+}
+
+static bool Check(bool condition, const char* error)
+{
+	if(!condition) printf("FAIL: %s\n", error);
+	return condition;
+}
@@ -0,0 +1,192 @@
+/* Requests of the HTTP server (FreeRTOS_HTTP_server.c) on the host, which
+   come in fragments: byte by byte, with headers and bodies split between
+   segments, and pipelined keep-alive requests split across reads. The
+   benchmark feeds the same requests with different segment sizes */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* Application includes */
+#include "httpserver-netconn.h"
+#include "tcp_sim.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define CLIENT_IP				FreeRTOS_inet_addr_quick(192, 168, 0, 2)
+#define MAX_CYCLES				100000
+
+/* Pipelined requests of one connection (HTTP_KEEP_ALIVE_MAX_REQUESTS) */
+#define PIPELINED				15
+#define BENCH_CONNECTIONS		200
+
+/* Variables -----------------------------------------------------------------*/
+static const struct xSERVER_CONFIG serverConfig[] =
+{
+	{ eSERVER_HTTP, 80, 12, "" },
+};
+static TCPServer_t* server;
+
+/* Private function prototypes -----------------------------------------------*/
+static bool CheckEcho(int conn, const char* echo);
+static void MakePipelined(char* buffer, size_t size, int requests);
+static bool Bench(size_t segment);
+static bool Check(bool condition, const char* error);
+
+/* Public functions ----------------------------------------------------------*/
+int main()
+{
+	static char requests[PIPELINED * 160];
+	char echo[64];
+	int conn;
+	int i;
+
+	TCP_SimInit();
+	server = FreeRTOS_CreateTCPServer(serverConfig, 1);
+	if(!Check(server != NULL, "server is not created")) return 1;
+
+	/* Request comes byte by byte */
+	conn = TCP_SimConnect(CLIENT_IP);
+	TCP_SimSetSegment(conn, 1);
+	TCP_SimWriteStr(conn, "GET /echo?a=1&b=2 HTTP/1.1\r\n"
+			"Host: 192.168.0.10\r\nCookie: id=42\r\n\r\n");
+	TCP_SimClose(conn);
+	if(!Check(TCP_SimRun(server, MAX_CYCLES) &&
+			CheckEcho(conn, "GET /echo?a=1&b=2 cookie=id=42 body="),
+			"request of single bytes is not parsed")) return 1;
+
+	/* Form is split in the name and in the value of the header and in the
+	body: it is joined to URL parameters */
+	conn = TCP_SimConnect(CLIENT_IP);
+	TCP_SimSetSegment(conn, 5);
+	TCP_SimWriteStr(conn, "POST /form HTTP/1.1\r\nHost: 192.168.0.10\r\n"
+			"Content-Type: application/x-www-form-urlencoded\r\n"
+			"Content-Length: 15\r\n\r\nname=ntp&val=42");
+	TCP_SimClose(conn);
+	if(!Check(TCP_SimRun(server, MAX_CYCLES) &&
+			CheckEcho(conn, "POST /form?name=ntp&val=42 cookie= body="
+					"name=ntp&val=42"), "split form is not parsed")) return 1;
+
+	/* Chunked body is decoded across segments */
+	conn = TCP_SimConnect(CLIENT_IP);
+	TCP_SimSetSegment(conn, 3);
+	TCP_SimWriteStr(conn, "PUT /data HTTP/1.1\r\nHost: 192.168.0.10\r\n"
+			"Transfer-Encoding: chunked\r\n\r\n"
+			"5\r\nhello\r\n6\r\n world\r\n0\r\n\r\n");
+	TCP_SimClose(conn);
+	if(!Check(TCP_SimRun(server, MAX_CYCLES) &&
+			CheckEcho(conn, "PUT /data cookie= body=hello world"),
+			"chunked body is not parsed")) return 1;
+
+	/* Pipelined requests are longer than the receive stream and are split
+	across reads and across its end: replies come in order, the connection
+	is closed after the last one */
+	MakePipelined(requests, sizeof(requests), PIPELINED);
+	if(!Check(strlen(requests) > ipconfigHTTP_RX_BUFSIZE,
+			"pipelined requests fit the stream")) return 1;
+	conn = TCP_SimConnect(CLIENT_IP);
+	TCP_SimSetSegment(conn, 7);
+	TCP_SimWriteStr(conn, requests);
+	if(!Check(TCP_SimRun(server, MAX_CYCLES), "pipelined requests are not "
+			"parsed")) return 1;
+	for(i = 0; i < PIPELINED; i++)
+	{
+		snprintf(echo, sizeof(echo), "GET /echo?n=%d cookie= body=", i);
+		if(!Check(CheckEcho(conn, echo), "replies are not in order"))
+			return 1;
+	}
+	if(!Check(TCP_SimNoReply(conn) && TCP_SimIsClosed(conn),
+			"connection is not closed after the last request")) return 1;
+
+	/* Segments of the same requests */
+	if(!Check(Bench(1) && Bench(7) && Bench(64) && Bench(ipconfigTCP_MSS),
+			"benchmark requests are not replied")) return 1;
+
+	printf("PASS\n");
+	return 0;
+}
+
+/* Pages ---------------------------------------------------------------------*/
+BaseType_t prvOpenURL(HTTPClient_t *pxClient)
+{
+	static const char* const methods[] = { [ECMD_GET] = "GET",
+			[ECMD_POST] = "POST", [ECMD_PUT] = "PUT" };
+	const char* cookie = GetHTML_RequestHeader(pxClient, "Cookie");
+	size_t size;
+	char* buffer = GetHTML_ContentBuffer(pxClient, &size);
+	int length;
+
+	/* Request is echoed as it is parsed */
+	length = snprintf(buffer, size, "%s %s cookie=%.*s body=%s",
+			methods[pxClient->xCommand], pxClient->pcUrlData,
+			(cookie != NULL) ? (int) strcspn(cookie, "\r") : 0,
+			(cookie != NULL) ? cookie : "", GetHTML_RequestBody(pxClient));
+	return SendHTML_Content(pxClient, WEB_REPLY_OK, "text/plain",
+			buffer, length);
+}
+
+/* Private functions ---------------------------------------------------------*/
+static bool CheckEcho(int conn, const char* echo)
+{
+	struct TCP_SimReply reply;
+
+	if(!TCP_SimGetReply(conn, &reply) || (reply.status != WEB_REPLY_OK))
+		return false;
+	if(strcmp((const char*) reply.body, echo) == 0) return true;
+
+	printf("reply \"%s\" instead of \"%s\"\n", reply.body, echo);
+	return false;
+}
+
+static void MakePipelined(char* buffer, size_t size, int requests)
+{
+	size_t length = 0;
+	int i;
+
+	for(i = 0; i < requests; i++)
+	{
+		length += snprintf(&buffer[length], size - length,
+				"GET /echo?n=%d HTTP/1.1\r\nHost: 192.168.0.10\r\n"
+				"User-Agent: host test\r\nAccept: */*\r\n"
+				"Accept-Language: en-US,en;q=0.9\r\n%s\r\n", i,
+				(i == requests - 1) ? "Connection: close\r\n" : "");
+	}
+}
+
+static bool Bench(size_t segment)
+{
+	static char requests[PIPELINED * 160];
+	struct TCP_SimReply reply;
+	struct timespec start;
+	struct timespec end;
+	uint32_t replies = 0;
+	double seconds;
+	int conn;
+	int i;
+
+	MakePipelined(requests, sizeof(requests), PIPELINED);
+	TCP_SimResetStats();
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(i = 0; i < BENCH_CONNECTIONS; i++)
+	{
+		conn = TCP_SimConnect(CLIENT_IP);
+		TCP_SimSetSegment(conn, segment);
+		TCP_SimWriteStr(conn, requests);
+		if(!TCP_SimRun(server, MAX_CYCLES)) break;
+		while(TCP_SimGetReply(conn, &reply)) replies++;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	printf("segment %4u: %u requests, %.2f us/request, %u work cycles\n",
+			(unsigned) segment, (unsigned) replies,
+			seconds * 1e6 / (replies ? replies : 1),
+			(unsigned) TCP_SimGetStats()->cycles);
+	return replies == BENCH_CONNECTIONS * PIPELINED;
+}
+
+static bool Check(bool condition, const char* error)
+{
+	if(!condition) printf("FAIL: %s\n", error);
+	return condition;
+}
@@ -0,0 +1,176 @@
+/* Static assets of the HTTP server (SendHTML_StaticAsset) on the host:
+   validation with "If-None-Match" lists and compressed assets, which are sent
+   only to the clients accepting gzip */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+
+/* Application includes */
+#include "httpserver-netconn.h"
+#include "tcp_sim.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define CLIENT_IP				FreeRTOS_inet_addr_quick(192, 168, 0, 2)
+#define MAX_CYCLES				100000
+
+#define GZIP_ETAG				"\"1a2b3c4d\""
+#define PLAIN_ETAG				"\"5e6f7a8b\""
+
+/* Private types -------------------------------------------------------------*/
+struct AssetCase
+{
+	const char* path;
+	const char* headers;
+	int status;
+	bool vary;
+};
+
+/* Variables -----------------------------------------------------------------*/
+static const struct xSERVER_CONFIG serverConfig[] =
+{
+	{ eSERVER_HTTP, 80, 12, "" },
+};
+static const uint8_t gzipData[] = { 0x1F, 0x8B, 0x08, 0x00, 0x01, 0x02 };
+static const uint8_t plainData[] = "body { margin: 0; }";
+static const struct HTTP_StaticAsset assets[] =
+{
+	{ "/app.js", "text/javascript", GZIP_ETAG, gzipData, sizeof(gzipData),
+			true },
+	{ "/style.css", "text/css", PLAIN_ETAG, plainData, sizeof(plainData),
+			false },
+};
+static const struct AssetCase cases[] =
+{
+	/* Compressed asset needs gzip in "Accept-Encoding" */
+	{ "/app.js", "", WEB_NOT_ACCEPTABLE, true },
+	{ "/app.js", "Accept-Encoding: gzip, deflate, br\r\n", WEB_REPLY_OK,
+			true },
+	{ "/app.js", "Accept-Encoding: br;q=1.0, GZIP;q=0.5\r\n", WEB_REPLY_OK,
+			true },
+	{ "/app.js", "Accept-Encoding: deflate, gzip;q=0\r\n",
+			WEB_NOT_ACCEPTABLE, true },
+	{ "/app.js", "Accept-Encoding: gzip;q=0.000, br\r\n",
+			WEB_NOT_ACCEPTABLE, true },
+	{ "/app.js", "Accept-Encoding: *\r\n", WEB_REPLY_OK, true },
+	{ "/app.js", "Accept-Encoding: *, gzip;q=0\r\n", WEB_NOT_ACCEPTABLE,
+			true },
+	{ "/app.js", "Accept-Encoding: identity\r\n", WEB_NOT_ACCEPTABLE, true },
+	{ "/app.js", "Accept-Encoding: x-gzip2\r\n", WEB_NOT_ACCEPTABLE, true },
+	{ "/style.css", "", WEB_REPLY_OK, false },
+
+	/* Entity tags are compared whole, weak tags match */
+	{ "/app.js", "Accept-Encoding: gzip\r\nIf-None-Match: " GZIP_ETAG "\r\n",
+			WEB_NOT_MODIFIED, true },
+	{ "/app.js", "Accept-Encoding: gzip\r\nIf-None-Match: \"0\", W/"
+			GZIP_ETAG " \r\n", WEB_NOT_MODIFIED, true },
+	{ "/app.js", "Accept-Encoding: gzip\r\nIf-None-Match: *\r\n",
+			WEB_NOT_MODIFIED, true },
+	{ "/app.js", "Accept-Encoding: gzip\r\nIf-None-Match: " PLAIN_ETAG
+			"\r\n", WEB_REPLY_OK, true },
+	{ "/app.js", "Accept-Encoding: gzip\r\nIf-None-Match: \"1a2b3c4d\"x, "
+			"\"other\"\r\n", WEB_REPLY_OK, true },
+	{ "/app.js", "Accept-Encoding: gzip\r\nIf-None-Match: \"1a2b3c4\"\r\n",
+			WEB_REPLY_OK, true },
+	{ "/app.js", "Accept-Encoding: gzip\r\nIf-None-Match: \"a*b\"\r\n",
+			WEB_REPLY_OK, true },
+	{ "/app.js", "Accept-Encoding: gzip\r\nIf-None-Match: W/*\r\n",
+			WEB_REPLY_OK, true },
+	{ "/app.js", "Accept-Encoding: gzip\r\nIf-None-Match: 1a2b3c4d\r\n",
+			WEB_REPLY_OK, true },
+	{ "/style.css", "If-None-Match: W/" PLAIN_ETAG "\r\n", WEB_NOT_MODIFIED,
+			false },
+};
+static TCPServer_t* server;
+
+/* Private function prototypes -----------------------------------------------*/
+static bool CheckCase(const struct AssetCase* test);
+static bool Check(bool condition, const char* error);
+
+/* Public functions ----------------------------------------------------------*/
+int main()
+{
+	size_t i;
+
+	TCP_SimInit();
+	server = FreeRTOS_CreateTCPServer(serverConfig, 1);
+	if(!Check(server != NULL, "server is not created")) return 1;
+
+	for(i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+	{
+		if(!CheckCase(&cases[i]))
+		{
+			printf("FAIL: %s with \"%s\"\n", cases[i].path, cases[i].headers);
+			return 1;
+		}
+	}
+
+	printf("PASS\n");
+	return 0;
+}
+
+/* Pages ---------------------------------------------------------------------*/
+BaseType_t prvOpenURL(HTTPClient_t *pxClient)
+{
+	size_t i;
+
+	for(i = 0; i < sizeof(assets) / sizeof(assets[0]); i++)
+	{
+		if(strcmp(pxClient->pcUrlData, assets[i].path) == 0)
+			return SendHTML_StaticAsset(pxClient, &assets[i]);
+	}
+	return SendHTML_Content(pxClient, WEB_NOT_FOUND, "text/html", NULL, 0);
+}
+
+/* Private functions ---------------------------------------------------------*/
+static bool CheckCase(const struct AssetCase* test)
+{
+	const struct HTTP_StaticAsset* asset =
+			(test->path == assets[0].path) ? &assets[0] : &assets[1];
+	struct TCP_SimReply reply;
+	const char* value;
+	char request[256];
+	int conn = TCP_SimConnect(CLIENT_IP);
+
+	snprintf(request, sizeof(request), "GET %s HTTP/1.1\r\n"
+			"Host: 192.168.0.10\r\n%s\r\n", test->path, test->headers);
+	TCP_SimWriteStr(conn, request);
+	TCP_SimClose(conn);
+	if(!TCP_SimRun(server, MAX_CYCLES) || !TCP_SimGetReply(conn, &reply))
+		return false;
+
+	if(reply.status != test->status)
+	{
+		printf("reply %d instead of %d\n", reply.status, test->status);
+		return false;
+	}
+
+	value = TCP_SimReplyHeader(&reply, "Vary");
+	if(	(value != NULL) != test->vary ||
+		((value != NULL) && strncmp(value, "Accept-Encoding\r\n", 17)))
+	{
+		printf("Vary header is wrong\n");
+		return false;
+	}
+	if(test->status == WEB_NOT_ACCEPTABLE) return reply.bodyLength == 0;
+
+	/* The same validator comes with the body and without it */
+	value = TCP_SimReplyHeader(&reply, "ETag");
+	if((value == NULL) || strncmp(value, asset->etag, strlen(asset->etag)))
+	{
+		printf("ETag header is wrong\n");
+		return false;
+	}
+	if(test->status == WEB_NOT_MODIFIED) return reply.bodyLength == 0;
+
+	value = TCP_SimReplyHeader(&reply, "Content-Encoding");
+	if((value != NULL) != asset->gzip) return false;
+	return (reply.bodyLength == asset->size) &&
+			(memcmp(reply.body, asset->data, asset->size) == 0);
+}
+
+static bool Check(bool condition, const char* error)
+{
+	if(!condition) printf("FAIL: %s\n", error);
+	return condition;
+}
@@ -0,0 +1,937 @@
+/* Host model of FreeRTOS+TCP and of the kernel for the tests of the web
+   server (see tcp_sim.h) */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "event_groups.h"
+
+/* Application includes */
+#include "UDP_logging.h"
+#include "tcp_sim.h"
+
+/* Private constants ---------------------------------------------------------*/
+/* Streams are made as prvTCPCreateStream() of the 32-bit target does */
+#define TARGET_SIZE_T				4u
+#define STREAM_LENGTH(size)	(((size) + TARGET_SIZE_T) & ~(TARGET_SIZE_T - 1u))
+
+/* Default streams of a socket (ipconfigTCP_TX/RX_BUFFER_LENGTH) */
+#define DEFAULT_STREAM_SIZE			(4 * ipconfigTCP_MSS)
+
+/* Block time of the server, which runs without requested wake-ups */
+#define RUN_BLOCK_TIME				pdMS_TO_TICKS(5000)
+
+/* Private types -------------------------------------------------------------*/
+/* Ring of the socket: one byte is always free, as in StreamBuffer_t */
+struct SimStream
+{
+	uint8_t* data;
+	size_t length;
+	size_t head;
+	size_t tail;
+};
+
+struct SimSocket
+{
+	bool listening;
+	int conn;
+	EventBits_t selectBits;
+	size_t txSize;
+	size_t rxSize;
+	struct SimStream tx;
+	struct SimStream rx;
+	bool shutdown;
+};
+
+/* Connection as the peer sees it */
+struct SimConn
+{
+	bool used;
+	bool accepted;
+	bool closed;
+	bool peerClosed;
+	uint32_t ip;
+	struct SimSocket* socket;
+	size_t segment;
+	size_t window;
+	uint8_t* input;
+	size_t inputLength;
+	size_t inputPos;
+	size_t inputSize;
+	uint8_t* output;
+	size_t outputLength;
+	size_t outputPos;
+	size_t outputSize;
+	uint8_t* body;
+	size_t bodySize;
+};
+
+/* Variables -----------------------------------------------------------------*/
+static struct SimConn conns[TCP_SIM_MAX_CONNECTIONS];
+static struct SimSocket* listener = NULL;
+static struct TCP_SimStats stats;
+static TickType_t ticks = 0;
+static bool signalled = false;
+/* Server took or gave data since the last check */
+static bool progress = false;
+/* The last select() found the server waiting for the peer */
+static bool waiting = false;
+static void* threadLocal[configNUM_THREAD_LOCAL_STORAGE_POINTERS];
+/* Socket set of the server (only one is used) */
+static uint32_t socketSet;
+
+/* Private function prototypes -----------------------------------------------*/
+static void StreamInit(struct SimStream* stream, size_t size);
+static size_t StreamCount(const struct SimStream* stream);
+static size_t StreamSpace(const struct SimStream* stream);
+static size_t StreamAdd(struct SimStream* stream, const uint8_t* data,
+		size_t length);
+static size_t StreamGet(struct SimStream* stream, uint8_t* data,
+		size_t length);
+static void Append(uint8_t** buffer, size_t* length, size_t* size,
+		const void* data, size_t count);
+static bool IsClosing(const struct SimSocket* socket);
+static void NetworkStep();
+static bool NetworkIdle();
+static bool SocketReady(const struct SimSocket* socket);
+static struct SimSocket* NewSocket();
+static void FreeSocket(struct SimSocket* socket);
+
+/* Public functions ----------------------------------------------------------*/
+void TCP_SimInit()
+{
+	int conn;
+
+	for(conn = 0; conn < TCP_SIM_MAX_CONNECTIONS; conn++)
+	{
+		free(conns[conn].input);
+		free(conns[conn].output);
+		free(conns[conn].body);
+		if(conns[conn].socket != NULL) FreeSocket(conns[conn].socket);
+	}
+	memset(conns, 0, sizeof(conns));
+	memset(&stats, 0, sizeof(stats));
+	signalled = false;
+	waiting = false;
+}
+
+int TCP_SimConnect(uint32_t ip)
+{
+	int conn;
+
+	for(conn = 0; conn < TCP_SIM_MAX_CONNECTIONS; conn++)
+	{
+		/* Closed connection is reused, when its replies are got */
+		if(	conns[conn].used &&
+			!(conns[conn].closed && TCP_SimNoReply(conn))) continue;
+
+		free(conns[conn].input);
+		free(conns[conn].output);
+		free(conns[conn].body);
+		memset(&conns[conn], 0, sizeof(conns[conn]));
+		conns[conn].used = true;
+		conns[conn].ip = ip;
+		conns[conn].segment = ipconfigTCP_MSS;
+		conns[conn].window = 2 * ipconfigTCP_MSS;
+		return conn;
+	}
+
+	return -1;
+}
+
+void TCP_SimSetSegment(int conn, size_t segment)
+{
+	conns[conn].segment = segment;
+}
+
+void TCP_SimSetWindow(int conn, size_t window)
+{
+	conns[conn].window = window;
+}
+
+void TCP_SimWrite(int conn, const void* data, size_t length)
+{
+	Append(&conns[conn].input, &conns[conn].inputLength,
+			&conns[conn].inputSize, data, length);
+}
+
+void TCP_SimWriteStr(int conn, const char* str)
+{
+	TCP_SimWrite(conn, str, strlen(str));
+}
+
+void TCP_SimClose(int conn)
+{
+	conns[conn].peerClosed = true;
+}
+
+bool TCP_SimIsClosed(int conn)
+{
+	return conns[conn].closed;
+}
+
+bool TCP_SimRun(TCPServer_t* server, uint32_t maxCycles)
+{
+	uint32_t cycle;
+	uint32_t run = 0;
+	int conn;
+
+	for(cycle = 0; cycle < maxCycles; cycle++)
+	{
+		progress = false;
+		waiting = false;
+		FreeRTOS_TCPServerWork(server, RUN_BLOCK_TIME);
+		stats.cycles++;
+
+		if(waiting)
+		{
+			/* Server waits: all data of the peer must be taken */
+			for(conn = 0; conn < TCP_SIM_MAX_CONNECTIONS; conn++)
+			{
+				struct SimConn* pxConn = &conns[conn];
+
+				if(!pxConn->used || pxConn->closed) continue;
+				if(	(pxConn->inputPos < pxConn->inputLength) ||
+					((pxConn->socket != NULL) &&
+					StreamCount(&pxConn->socket->rx)))
+				{
+					printf("server does not take data of connection %d\n",
+							conn);
+					return false;
+				}
+			}
+			return true;
+		}
+
+		if(progress)
+		{
+			run = 0;
+			continue;
+		}
+
+		/* Woken up for nothing */
+		stats.idleWakeups++;
+		if(++run > stats.spinRun) stats.spinRun = run;
+		if(run > TCP_SIM_SPIN_LIMIT)
+		{
+			printf("server spins on select()\n");
+			return false;
+		}
+	}
+
+	printf("server does not finish in %u cycles\n", (unsigned) maxCycles);
+	return false;
+}
+
+bool TCP_SimGetReply(int conn, struct TCP_SimReply* reply)
+{
+	struct SimConn* pxConn = &conns[conn];
+	const char* pcStart = (const char*) &pxConn->output[pxConn->outputPos];
+	size_t uxLength = pxConn->outputLength - pxConn->outputPos;
+	const char* pcEnd;
+	const char* pcValue;
+	size_t uxHeaders;
+	size_t uxPos;
+	size_t uxBody = 0;
+
+	memset(reply, 0, sizeof(*reply));
+	if(uxLength == 0) return false;
+
+	/* Output is kept terminated (see Append) */
+	pcEnd = strstr(pcStart, "\r\n\r\n");
+	if(pcEnd == NULL) return false;
+	uxHeaders = pcEnd + 2 - pcStart;
+	uxPos = uxHeaders + 2;
+
+	if(sscanf(pcStart, "HTTP/1.1 %d", &reply->status) != 1) return false;
+	memcpy(reply->headers, pcStart, (uxHeaders < sizeof(reply->headers)) ?
+			uxHeaders : sizeof(reply->headers) - 1);
+
+	pcValue = TCP_SimReplyHeader(reply, "Transfer-Encoding");
+	if((pcValue != NULL) && (strncmp(pcValue, "chunked", 7) == 0))
+	{
+		/* Chunks are joined */
+		for(;;)
+		{
+			char* pcSize;
+			unsigned long ulSize;
+
+			pcEnd = strstr(&pcStart[uxPos], "\r\n");
+			if(pcEnd == NULL) return false;
+			ulSize = strtoul(&pcStart[uxPos], &pcSize, 16);
+			uxPos = pcEnd + 2 - pcStart;
+			if(uxPos + ulSize + 2 > uxLength) return false;
+
+			if(pxConn->bodySize < uxBody + ulSize + 1)
+			{
+				pxConn->bodySize = uxBody + ulSize + 1;
+				pxConn->body = realloc(pxConn->body, pxConn->bodySize);
+			}
+			memcpy(&pxConn->body[uxBody], &pcStart[uxPos], ulSize);
+			uxBody += ulSize;
+			uxPos += ulSize + 2;
+			if(ulSize == 0) break;
+		}
+	}
+	else
+	{
+		pcValue = TCP_SimReplyHeader(reply, "Content-Length");
+		if((pcValue != NULL) && (reply->status != 304))
+			uxBody = strtoul(pcValue, NULL, 10);
+		if(uxPos + uxBody > uxLength) return false;
+
+		if(pxConn->bodySize < uxBody + 1)
+		{
+			pxConn->bodySize = uxBody + 1;
+			pxConn->body = realloc(pxConn->body, pxConn->bodySize);
+		}
+		memcpy(pxConn->body, &pcStart[uxPos], uxBody);
+		uxPos += uxBody;
+	}
+
+	if(pxConn->body != NULL) pxConn->body[uxBody] = '\0';
+	reply->body = pxConn->body;
+	reply->bodyLength = uxBody;
+	pxConn->outputPos += uxPos;
+	return true;
+}
+
+const char* TCP_SimReplyHeader(const struct TCP_SimReply* reply,
+		const char* name)
+{
+	const char* pcLine;
+	size_t uxLength = strlen(name);
+
+	for(pcLine = strstr(reply->headers, "\r\n"); pcLine != NULL;
+		pcLine = strstr(pcLine + 2, "\r\n"))
+	{
+		if(	(strncasecmp(pcLine + 2, name, uxLength) == 0) &&
+			(pcLine[uxLength + 2] == ':'))
+		{
+			for(pcLine += uxLength + 3; *pcLine == ' '; pcLine++);
+			return pcLine;
+		}
+	}
+
+	return NULL;
+}
+
+bool TCP_SimNoReply(int conn)
+{
+	return conns[conn].outputPos == conns[conn].outputLength;
+}
+
+const struct TCP_SimStats* TCP_SimGetStats()
+{
+	return &stats;
+}
+
+void TCP_SimResetStats()
+{
+	memset(&stats, 0, sizeof(stats));
+}
+
+TickType_t TCP_SimGetTicks()
+{
+	return ticks;
+}
+
+/* Sockets -------------------------------------------------------------------*/
+Socket_t FreeRTOS_socket(BaseType_t xDomain, BaseType_t xType,
+		BaseType_t xProtocol)
+{
+	(void) xDomain;
+	(void) xType;
+	(void) xProtocol;
+
+	return NewSocket();
+}
+
+BaseType_t FreeRTOS_bind(Socket_t xSocket,
+		struct freertos_sockaddr *pxAddress, socklen_t xAddressLength)
+{
+	(void) xSocket;
+	(void) pxAddress;
+	(void) xAddressLength;
+
+	return 0;
+}
+
+BaseType_t FreeRTOS_listen(Socket_t xSocket, BaseType_t xBacklog)
+{
+	struct SimSocket* socket = (struct SimSocket*) xSocket;
+
+	(void) xBacklog;
+
+	socket->listening = true;
+	if(listener == NULL) listener = socket;
+	return 0;
+}
+
+BaseType_t FreeRTOS_setsockopt(Socket_t xSocket, int32_t lLevel,
+		int32_t lOptionName, const void *pvOptionValue, size_t uxOptionLength)
+{
+	struct SimSocket* socket = (struct SimSocket*) xSocket;
+	const WinProperties_t* pxProps = (const WinProperties_t*) pvOptionValue;
+
+	(void) lLevel;
+	(void) uxOptionLength;
+
+	/* Sizes of the streams are taken by the accepted sockets */
+	if(lOptionName == FREERTOS_SO_WIN_PROPERTIES)
+	{
+		socket->txSize = (size_t) pxProps->lTxBufSize;
+		socket->rxSize = (size_t) pxProps->lRxBufSize;
+	}
+
+	return 0;
+}
+
+Socket_t FreeRTOS_accept(Socket_t xServerSocket,
+		struct freertos_sockaddr *pxAddress, socklen_t *pxAddressLength)
+{
+	struct SimSocket* server = (struct SimSocket*) xServerSocket;
+	struct SimSocket* socket;
+	int conn;
+
+	(void) pxAddressLength;
+
+	if(server != listener) return FREERTOS_NO_SOCKET;
+
+	for(conn = 0; conn < TCP_SIM_MAX_CONNECTIONS; conn++)
+	{
+		if(!conns[conn].used || conns[conn].accepted) continue;
+
+		socket = NewSocket();
+		socket->conn = conn;
+		StreamInit(&socket->tx, server->txSize);
+		StreamInit(&socket->rx, server->rxSize);
+		conns[conn].accepted = true;
+		conns[conn].socket = socket;
+		if(pxAddress != NULL) pxAddress->sin_addr = conns[conn].ip;
+		progress = true;
+		return socket;
+	}
+
+	return FREERTOS_NO_SOCKET;
+}
+
+BaseType_t FreeRTOS_recv(Socket_t xSocket, void *pvBuffer,
+		size_t uxBufferLength, BaseType_t xFlags)
+{
+	struct SimSocket* socket = (struct SimSocket*) xSocket;
+	size_t uxCount = StreamCount(&socket->rx);
+
+	if(uxCount == 0)
+	{
+		if(IsClosing(socket))
+		{
+			progress = true;
+			return -pdFREERTOS_ERRNO_ENOTCONN;
+		}
+		return 0;
+	}
+
+	if(xFlags & FREERTOS_ZERO_COPY)
+	{
+		/* Data up to the end of the ring */
+		*(uint8_t**) pvBuffer = &socket->rx.data[socket->rx.tail];
+		if(uxCount > socket->rx.length - socket->rx.tail)
+			uxCount = socket->rx.length - socket->rx.tail;
+		return (BaseType_t) uxCount;
+	}
+
+	uxCount = StreamGet(&socket->rx, (uint8_t*) pvBuffer, uxBufferLength);
+	if(uxCount) progress = true;
+	stats.bytesReceived += uxCount;
+	return (BaseType_t) uxCount;
+}
+
+BaseType_t FreeRTOS_send(Socket_t xSocket, const void *pvBuffer,
+		size_t uxDataLength, BaseType_t xFlags)
+{
+	struct SimSocket* socket = (struct SimSocket*) xSocket;
+	size_t uxCount;
+
+	(void) xFlags;
+
+	if(socket->shutdown || conns[socket->conn].closed)
+		return -pdFREERTOS_ERRNO_ENOTCONN;
+
+	uxCount = StreamAdd(&socket->tx, (const uint8_t*) pvBuffer, uxDataLength);
+	if(uxCount) progress = true;
+	stats.bytesSent += uxCount;
+	return (BaseType_t) uxCount;
+}
+
+BaseType_t FreeRTOS_shutdown(Socket_t xSocket, BaseType_t xHow)
+{
+	struct SimSocket* socket = (struct SimSocket*) xSocket;
+
+	(void) xHow;
+
+	socket->shutdown = true;
+	progress = true;
+	return 0;
+}
+
+BaseType_t FreeRTOS_closesocket(Socket_t xSocket)
+{
+	struct SimSocket* socket = (struct SimSocket*) xSocket;
+
+	if(!socket->listening)
+	{
+		/* The rest of data is sent before FIN */
+		struct SimConn* pxConn = &conns[socket->conn];
+		size_t uxCount = StreamCount(&socket->tx);
+		uint8_t* pucData = malloc(uxCount + 1);
+
+		StreamGet(&socket->tx, pucData, uxCount);
+		Append(&pxConn->output, &pxConn->outputLength, &pxConn->outputSize,
+				pucData, uxCount);
+		free(pucData);
+
+		pxConn->closed = true;
+		pxConn->socket = NULL;
+	}
+	else if(socket == listener)
+	{
+		listener = NULL;
+	}
+
+	FreeSocket(socket);
+	progress = true;
+	return 1;
+}
+
+BaseType_t FreeRTOS_GetRemoteAddress(Socket_t xSocket,
+		struct freertos_sockaddr *pxAddress)
+{
+	struct SimSocket* socket = (struct SimSocket*) xSocket;
+
+	pxAddress->sin_addr = conns[socket->conn].ip;
+	pxAddress->sin_port = 0;
+	return sizeof(*pxAddress);
+}
+
+BaseType_t FreeRTOS_tx_space(Socket_t xSocket)
+{
+	struct SimSocket* socket = (struct SimSocket*) xSocket;
+
+	return (BaseType_t) StreamSpace(&socket->tx);
+}
+
+uint8_t *FreeRTOS_get_tx_head(Socket_t xSocket, BaseType_t *pxLength)
+{
+	struct SimSocket* socket = (struct SimSocket*) xSocket;
+	size_t uxSpace = StreamSpace(&socket->tx);
+	size_t uxRemain = socket->tx.length - socket->tx.head;
+
+	/* Only the space up to the end of the ring (FreeRTOS_Sockets.c) */
+	*pxLength = (BaseType_t) ((uxSpace < uxRemain) ? uxSpace : uxRemain);
+	return &socket->tx.data[socket->tx.head];
+}
+
+SocketSet_t FreeRTOS_CreateSocketSet()
+{
+	return &socketSet;
+}
+
+void FreeRTOS_DeleteSocketSet(SocketSet_t xSocketSet)
+{
+	(void) xSocketSet;
+}
+
+void FreeRTOS_FD_SET(Socket_t xSocket, SocketSet_t xSocketSet,
+		EventBits_t xSelectBits)
+{
+	(void) xSocketSet;
+
+	((struct SimSocket*) xSocket)->selectBits |= xSelectBits;
+}
+
+void FreeRTOS_FD_CLR(Socket_t xSocket, SocketSet_t xSocketSet,
+		EventBits_t xSelectBits)
+{
+	(void) xSocketSet;
+
+	((struct SimSocket*) xSocket)->selectBits &= ~xSelectBits;
+}
+
+BaseType_t FreeRTOS_select(SocketSet_t xSocketSet, TickType_t xBlockTimeTicks)
+{
+	BaseType_t xReady = 0;
+	int conn;
+
+	(void) xSocketSet;
+
+	NetworkStep();
+
+	if(signalled)
+	{
+		signalled = false;
+		xReady = eSELECT_INTR;
+	}
+	if((listener != NULL) && SocketReady(listener)) xReady = eSELECT_READ;
+	for(conn = 0; conn < TCP_SIM_MAX_CONNECTIONS; conn++)
+	{
+		if((conns[conn].socket != NULL) && SocketReady(conns[conn].socket))
+			xReady = eSELECT_READ;
+	}
+	if(xReady || !NetworkIdle()) return xReady;
+
+	/* Nothing comes: the server sleeps until its wake-up time, if it asked
+	for it, or the run is finished */
+	if(xBlockTimeTicks >= RUN_BLOCK_TIME) waiting = true;
+	else ticks += xBlockTimeTicks;
+	return 0;
+}
+
+BaseType_t FreeRTOS_SignalSocket(Socket_t xSocket)
+{
+	(void) xSocket;
+
+	signalled = true;
+	return 0;
+}
+
+BaseType_t FreeRTOS_SignalSocketFromISR(Socket_t xSocket,
+		BaseType_t *pxHigherPriorityTaskWoken)
+{
+	*pxHigherPriorityTaskWoken = pdFALSE;
+	return FreeRTOS_SignalSocket(xSocket);
+}
+
+uint32_t FreeRTOS_GetIPAddress()
+{
+	return FreeRTOS_inet_addr_quick(192, 168, 0, 10);
+}
+
+/* Kernel --------------------------------------------------------------------*/
+TickType_t xTaskGetTickCount()
+{
+	return ticks;
+}
+
+void vTaskDelay(const TickType_t xTicksToDelay)
+{
+	TickType_t xTick;
+
+	/* Network works, while the task sleeps */
+	for(xTick = 0; xTick < xTicksToDelay; xTick++) NetworkStep();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+	static int task;
+
+	return (TaskHandle_t) &task;
+}
+
+BaseType_t xTaskGetSchedulerState()
+{
+	/* Locks of FreeRTOS+FAT are not taken before the scheduler starts */
+	return taskSCHEDULER_NOT_STARTED;
+}
+
+void vTaskSuspendAll()
+{
+}
+
+BaseType_t xTaskResumeAll()
+{
+	return pdFALSE;
+}
+
+void *pvTaskGetThreadLocalStoragePointer(TaskHandle_t xTaskToQuery,
+		BaseType_t xIndex)
+{
+	(void) xTaskToQuery;
+
+	return threadLocal[xIndex];
+}
+
+void vTaskSetThreadLocalStoragePointer(TaskHandle_t xTaskToSet,
+		BaseType_t xIndex, void *pvValue)
+{
+	(void) xTaskToSet;
+
+	threadLocal[xIndex] = pvValue;
+}
+
+QueueHandle_t xQueueCreateMutex(const uint8_t ucQueueType)
+{
+	static int mutex;
+
+	(void) ucQueueType;
+
+	return (QueueHandle_t) &mutex;
+}
+
+BaseType_t xQueueTakeMutexRecursive(QueueHandle_t xMutex,
+		TickType_t xTicksToWait)
+{
+	(void) xMutex;
+	(void) xTicksToWait;
+
+	return pdTRUE;
+}
+
+BaseType_t xQueueGiveMutexRecursive(QueueHandle_t xMutex)
+{
+	(void) xMutex;
+
+	return pdTRUE;
+}
+
+EventGroupHandle_t xEventGroupCreate()
+{
+	static int group;
+
+	return (EventGroupHandle_t) &group;
+}
+
+void vEventGroupDelete(EventGroupHandle_t xEventGroup)
+{
+	(void) xEventGroup;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t xEventGroup,
+		const EventBits_t uxBitsToWaitFor, const BaseType_t xClearOnExit,
+		const BaseType_t xWaitForAllBits, TickType_t xTicksToWait)
+{
+	(void) xEventGroup;
+	(void) xClearOnExit;
+	(void) xWaitForAllBits;
+	(void) xTicksToWait;
+
+	return uxBitsToWaitFor;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t xEventGroup,
+		const EventBits_t uxBitsToSet)
+{
+	(void) xEventGroup;
+
+	return uxBitsToSet;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t xEventGroup,
+		const EventBits_t uxBitsToClear)
+{
+	(void) xEventGroup;
+
+	return uxBitsToClear;
+}
+
+void *pvPortMalloc(size_t xSize)
+{
+	return malloc(xSize);
+}
+
+void vPortFree(void *pv)
+{
+	free(pv);
+}
+
+bool UDP_LoggingDeferred(enum LogEventType type, const char* format,
+		uint8_t argsNum, ...)
+{
+	(void) type;
+	(void) format;
+	(void) argsNum;
+
+	return true;
+}
+
+void vLoggingPrintf(const char *pcFormat, ...)
+{
+	(void) pcFormat;
+}
+
+/* Private functions ---------------------------------------------------------*/
+static void StreamInit(struct SimStream* stream, size_t size)
+{
+	if(size == 0) size = DEFAULT_STREAM_SIZE;
+	stream->length = STREAM_LENGTH(size);
+	stream->data = malloc(stream->length);
+	stream->head = 0;
+	stream->tail = 0;
+}
+
+static size_t StreamCount(const struct SimStream* stream)
+{
+	return (stream->head + stream->length - stream->tail) % stream->length;
+}
+
+static size_t StreamSpace(const struct SimStream* stream)
+{
+	return stream->length - 1u - StreamCount(stream);
+}
+
+static size_t StreamAdd(struct SimStream* stream, const uint8_t* data,
+		size_t length)
+{
+	size_t uxFirst;
+
+	if(length > StreamSpace(stream)) length = StreamSpace(stream);
+
+	/* Zero-copy data are in place already (FreeRTOS_get_tx_head) */
+	if(data != &stream->data[stream->head])
+	{
+		uxFirst = stream->length - stream->head;
+		if(uxFirst > length) uxFirst = length;
+		memcpy(&stream->data[stream->head], data, uxFirst);
+		memcpy(stream->data, data + uxFirst, length - uxFirst);
+	}
+	stream->head = (stream->head + length) % stream->length;
+
+	return length;
+}
+
+static size_t StreamGet(struct SimStream* stream, uint8_t* data,
+		size_t length)
+{
+	size_t uxFirst;
+
+	if(length > StreamCount(stream)) length = StreamCount(stream);
+
+	/* Data are dropped without buffer */
+	if(data != NULL)
+	{
+		uxFirst = stream->length - stream->tail;
+		if(uxFirst > length) uxFirst = length;
+		memcpy(data, &stream->data[stream->tail], uxFirst);
+		memcpy(data + uxFirst, stream->data, length - uxFirst);
+	}
+	stream->tail = (stream->tail + length) % stream->length;
+
+	return length;
+}
+
+static void Append(uint8_t** buffer, size_t* length, size_t* size,
+		const void* data, size_t count)
+{
+	/* Buffer is kept terminated for the string functions */
+	if(*length + count + 1 > *size)
+	{
+		*size = 2 * (*length + count + 1);
+		*buffer = realloc(*buffer, *size);
+	}
+	memcpy(*buffer + *length, data, count);
+	*length += count;
+	(*buffer)[*length] = '\0';
+}
+
+static bool IsClosing(const struct SimSocket* socket)
+{
+	const struct SimConn* pxConn = &conns[socket->conn];
+
+	/* FIN of the server is acknowledged or FIN of the peer is received */
+	if(socket->shutdown && (StreamCount(&socket->tx) == 0)) return true;
+	return pxConn->peerClosed && (pxConn->inputPos == pxConn->inputLength) &&
+			(StreamCount(&socket->rx) == 0);
+}
+
+static void NetworkStep()
+{
+	int conn;
+
+	ticks++;
+
+	for(conn = 0; conn < TCP_SIM_MAX_CONNECTIONS; conn++)
+	{
+		struct SimConn* pxConn = &conns[conn];
+		struct SimSocket* socket = pxConn->socket;
+		size_t uxCount;
+
+		if(socket == NULL) continue;
+
+		/* Segment of the peer */
+		uxCount = pxConn->inputLength - pxConn->inputPos;
+		if(uxCount > pxConn->segment) uxCount = pxConn->segment;
+		pxConn->inputPos += StreamAdd(&socket->rx,
+				&pxConn->input[pxConn->inputPos], uxCount);
+
+		/* Acknowledged data of the server */
+		uxCount = StreamCount(&socket->tx);
+		if(uxCount > pxConn->window) uxCount = pxConn->window;
+		if(uxCount)
+		{
+			if(pxConn->outputLength + uxCount + 1 > pxConn->outputSize)
+			{
+				pxConn->outputSize = 2 * (pxConn->outputLength + uxCount + 1);
+				pxConn->output = realloc(pxConn->output, pxConn->outputSize);
+			}
+			StreamGet(&socket->tx, &pxConn->output[pxConn->outputLength],
+					uxCount);
+			pxConn->outputLength += uxCount;
+			pxConn->output[pxConn->outputLength] = '\0';
+		}
+	}
+}
+
+static bool NetworkIdle()
+{
+	int conn;
+
+	for(conn = 0; conn < TCP_SIM_MAX_CONNECTIONS; conn++)
+	{
+		const struct SimConn* pxConn = &conns[conn];
+		const struct SimSocket* socket = pxConn->socket;
+
+		if(socket == NULL) continue;
+		if(StreamCount(&socket->tx)) return false;
+		if(	(pxConn->inputPos < pxConn->inputLength) &&
+			StreamSpace(&socket->rx)) return false;
+	}
+
+	return true;
+}
+
+static bool SocketReady(const struct SimSocket* socket)
+{
+	int conn;
+
+	if(socket->listening)
+	{
+		/* Connection waits for accept() */
+		if((socket->selectBits & eSELECT_READ) == 0) return false;
+		for(conn = 0; conn < TCP_SIM_MAX_CONNECTIONS; conn++)
+		{
+			if(conns[conn].used && !conns[conn].accepted) return true;
+		}
+		return false;
+	}
+
+	if(	(socket->selectBits & eSELECT_READ) &&
+		(StreamCount(&socket->rx) || IsClosing(socket))) return true;
+	if((socket->selectBits & eSELECT_WRITE) && StreamSpace(&socket->tx))
+		return true;
+	if((socket->selectBits & eSELECT_EXCEPT) && IsClosing(socket))
+		return true;
+
+	return false;
+}
+
+static struct SimSocket* NewSocket()
+{
+	struct SimSocket* socket = calloc(1, sizeof(struct SimSocket));
+
+	socket->conn = -1;
+	return socket;
+}
+
+static void FreeSocket(struct SimSocket* socket)
+{
+	free(socket->tx.data);
+	free(socket->rx.data);
+	free(socket);
+}
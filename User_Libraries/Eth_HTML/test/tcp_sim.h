@@ -0,0 +1,84 @@
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _TCP_SIM_H_
+#define _TCP_SIM_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* FreeRTOS+TCP includes */
+#include "FreeRTOS.h"
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_Sockets.h"
+#include "FreeRTOS_TCP_server.h"
+
+/* Public constants ----------------------------------------------------------*/
+/* Connections of the peer (accepted and closed ones) */
+#define TCP_SIM_MAX_CONNECTIONS		16
+
+/* Work cycles, which are woken up without any progress, before the server is
+   known to spin on select() */
+#define TCP_SIM_SPIN_LIMIT			100
+
+/* Public types --------------------------------------------------------------*/
+/* Reply of the server as the peer gets it (body is decoded from chunks) */
+struct TCP_SimReply
+{
+	int status;
+	char headers[1024];
+	const uint8_t* body;
+	size_t bodyLength;
+};
+
+/* Counters of the run */
+struct TCP_SimStats
+{
+	/* Work cycles of the server and the cycles woken up without progress */
+	uint32_t cycles;
+	uint32_t idleWakeups;
+	/* The longest run of idle wake-ups */
+	uint32_t spinRun;
+	uint64_t bytesReceived;
+	uint64_t bytesSent;
+};
+
+/* Public function prototypes ------------------------------------------------*/
+/* Host model of FreeRTOS+TCP behind the TCP servers (FreeRTOS_TCP_server.c):
+   streams of the sockets are rings of the same length, as the IP-task makes
+   them, so FreeRTOS_get_tx_head() gives only the contiguous space before the
+   end of the ring. The network runs with every select() and vTaskDelay(): the
+   peer delivers up to "segment" bytes of its requests and acknowledges up to
+   "window" bytes of the replies, one tick passes. The kernel functions used by
+   the servers are modelled here too (one task, scheduler is not started) */
+void TCP_SimInit();
+/* Open connection to the listening socket, returns its number */
+int TCP_SimConnect(uint32_t ip);
+void TCP_SimSetSegment(int conn, size_t segment);
+void TCP_SimSetWindow(int conn, size_t window);
+/* Queue data of the peer, it is delivered with the next steps */
+void TCP_SimWrite(int conn, const void* data, size_t length);
+void TCP_SimWriteStr(int conn, const char* str);
+/* Peer closes its side after the queued data */
+void TCP_SimClose(int conn);
+/* Server closed the socket of the connection */
+bool TCP_SimIsClosed(int conn);
+
+/* Work cycles of the server until it waits without pending data of the peer.
+   Returns false, if the server spins on select() or does not take the data */
+bool TCP_SimRun(TCPServer_t* server, uint32_t maxCycles);
+/* Next reply of the connection (body is valid until the next call) */
+bool TCP_SimGetReply(int conn, struct TCP_SimReply* reply);
+/* Value of the reply header (up to "\r\n") or NULL */
+const char* TCP_SimReplyHeader(const struct TCP_SimReply* reply,
+		const char* name);
+/* Replies of the connection are all got */
+bool TCP_SimNoReply(int conn);
+
+const struct TCP_SimStats* TCP_SimGetStats();
+void TCP_SimResetStats();
+/* Time of the model in ticks */
+TickType_t TCP_SimGetTicks();
+
+#endif /* _TCP_SIM_H_ */
@@ -0,0 +1,100 @@
+/* This is event log driver file: sectors 8..11 of internal FLASH memory
+(see event_log.c). They exist on devices with 1 MByte of flash only (the
+application, settings and the staging slot of firmware update take sectors
+0..7), the log is absent on smaller devices.
+Erasing of 128 KBytes sector stalls CPU (it reads flash) up to 2 s: it is done
+once per 2048 records at most, at the time chosen by the logging task (see
+EventLogEraseNext). The flash controller is shared (see flash_access_driver.c).
+*/
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard includes */
+#include <stdbool.h>
+
+/* Hardware includes */
+/* Hardware configure */
+#include "stm32f4xx_hal.h"
+
+/* Application includes */
+#include "flash_access.h"
+#include "event_log.h"
+
+// Private constants -----------------------------------------------------------
+// Sectors 8..11, 128 KBytes each
+#define EVENT_LOG_ADDR				((uint32_t)0x08080000)
+#define EVENT_LOG_FIRST_SECTOR		FLASH_SECTOR_8
+#define EVENT_LOG_SECTORS_NUM		4
+#define EVENT_LOG_SECTOR_SIZE		((uint32_t)0x20000)
+
+// Size of flash (KBytes) required for the sectors
+#define EVENT_LOG_FLASH_SIZE_KB		1024
+
+// Device voltage range supposed to be [2.7V to 3.6V], the operation will
+// be done by word
+#define VOLTAGE_RANGE 				FLASH_VOLTAGE_RANGE_3
+
+// Public functions ------------------------------------------------------------
+uint8_t EventLogDriverGetSectorsNum()
+{
+	// Size of flash in KBytes is programmed by manufacturer
+	if(*(const uint16_t*)FLASHSIZE_BASE < EVENT_LOG_FLASH_SIZE_KB) return 0;
+	return EVENT_LOG_SECTORS_NUM;
+}
+
+uint32_t EventLogDriverGetSectorSize()
+{
+	return EVENT_LOG_SECTOR_SIZE;
+}
+
+const uint8_t* EventLogDriverGetSector(uint8_t sector)
+{
+	return (const uint8_t*)(EVENT_LOG_ADDR + sector * EVENT_LOG_SECTOR_SIZE);
+}
+
+bool EventLogDriverErase(uint8_t sector)
+{
+	// Validate input parameters
+	if(sector >= EVENT_LOG_SECTORS_NUM) return false;
+
+	FLASH_EraseInitTypeDef pEraseInit;
+	uint32_t SectorError = 0;
+	pEraseInit.TypeErase = FLASH_TYPEERASE_SECTORS;
+	pEraseInit.Sector = EVENT_LOG_FIRST_SECTOR + sector;
+	pEraseInit.NbSectors = 1;
+	pEraseInit.VoltageRange = VOLTAGE_RANGE;
+
+	// Unlock the Flash Program Erase controller
+	if(FlashAccessUnlock() == false) return false;
+
+	// CPU is stalled by reading of flash while the sector is erased, but
+	// interrupts are not disabled
+	HAL_StatusTypeDef status = HAL_FLASHEx_Erase(&pEraseInit, &SectorError);
+
+	FlashAccessLock();
+	return (status == HAL_OK);
+}
+
+bool EventLogDriverProgram(uint8_t sector, uint32_t offset,
+		const uint32_t* data, uint32_t length)
+{
+	// Validate input parameters
+	if((sector >= EVENT_LOG_SECTORS_NUM) || (offset % sizeof(uint32_t)) ||
+	   (offset + length * sizeof(uint32_t) > EVENT_LOG_SECTOR_SIZE))
+		return false;
+
+	// Unlock the Flash Program Erase controller
+	if(FlashAccessUnlock() == false) return false;
+
+	uint32_t addr = (uint32_t)EventLogDriverGetSector(sector) + offset;
+	for(uint32_t i = 0; i < length; i++, addr += sizeof(uint32_t))
+	{
+		if(HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, addr, data[i]) != HAL_OK)
+		{
+			FlashAccessLock();
+			return false;
+		}
+	}
+
+	FlashAccessLock();
+	return true;
+}
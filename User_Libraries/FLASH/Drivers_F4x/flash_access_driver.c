@@ -0,0 +1,61 @@
+/* This is flash access driver file: one mutex owns the flash controller of
+STM32F4 between HAL_FLASH_Unlock() and HAL_FLASH_Lock(). The HAL lock of the
+controller is not atomic, and an erase of one task could start in the middle of
+programming of another one.
+Modules are initialized before the scheduler starts: then there is the only
+thread and the mutex is not taken.
+*/
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard includes */
+#include <stdbool.h>
+
+/* Hardware includes */
+/* Hardware configure */
+#include "stm32f4xx_hal.h"
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* Application includes */
+#include "flash_access.h"
+
+// Variables -------------------------------------------------------------------
+static SemaphoreHandle_t xFlashMutex = NULL;
+
+// Private function prototypes -------------------------------------------------
+static bool FlashAccessShared();
+
+// Public functions ------------------------------------------------------------
+void FlashAccessInit()
+{
+	if(xFlashMutex == NULL) xFlashMutex = xSemaphoreCreateMutex();
+	configASSERT(xFlashMutex);
+}
+
+bool FlashAccessUnlock()
+{
+	// Other task could erase a sector: wait for the end of its sequence
+	if(FlashAccessShared()) xSemaphoreTake(xFlashMutex, portMAX_DELAY);
+
+	// Unlock the Flash Program Erase controller
+	if(HAL_FLASH_Unlock() == HAL_OK) return true;
+
+	if(FlashAccessShared()) xSemaphoreGive(xFlashMutex);
+	return false;
+}
+
+void FlashAccessLock()
+{
+	HAL_FLASH_Lock();
+	if(FlashAccessShared()) xSemaphoreGive(xFlashMutex);
+}
+
+// Private functions -----------------------------------------------------------
+static bool FlashAccessShared()
+{
+	return (xFlashMutex != NULL) &&
+			(xTaskGetSchedulerState() == taskSCHEDULER_RUNNING);
+}
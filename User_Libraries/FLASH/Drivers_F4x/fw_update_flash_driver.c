@@ -0,0 +1,457 @@
+/* This is firmware update driver file: the new image is written to the
+staging slot of internal FLASH memory while it is received, then it is copied
+to the application area by the boot sector after the reset.
+
+STM32F407 has the only flash bank, so there is no bank swapping: the image is
+staged in sectors 6, 7 (see mem.ld). Sector 0 is the resident boot sector, it
+is never erased by the update. Sectors 1, 2 keep settings (.NV_dataSection),
+the application is in sectors 3..5.
+The checked image gets the mark at the end of the staging slot. The boot
+sector copies the marked image before the start of the application and then
+it clears the mark, so the copying interrupted by power loss is started again
+after the next reset.
+*/
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard includes */
+#include <string.h>
+
+/* Hardware includes */
+/* Hardware configure */
+#include "stm32f4xx_hal.h"
+
+/* Application includes */
+#include "flash_access.h"
+#include "fw_update.h"
+#include "crc32.h"
+
+// Private constants -----------------------------------------------------------
+// Image is the binary from the start of flash: its sectors 0..2 (boot sector
+// and settings, see settings_NV_manager_flash_hal_driver.c) are not copied
+#define FW_IMAGE_ADDR				((uint32_t)0x08000000)
+
+// Application area: sectors 3..5, vectors table is at its start
+#define FW_APP_ADDR					((uint32_t)0x0800C000)
+#define FW_APP_FIRST_SECTOR			FLASH_SECTOR_3
+#define FW_APP_LAST_SECTOR			FLASH_SECTOR_5
+
+// Staging slot: sectors 6 and 7, 128 KBytes each, the image has the same
+// offsets in it as in flash
+#define FW_STAGING_ADDR				((uint32_t)0x08040000)
+#define FW_STAGING_SECTOR			FLASH_SECTOR_6
+#define FW_STAGING_SECTOR_SIZE		((uint32_t)0x20000)
+#define FW_STAGING_SIZE				(2 * FW_STAGING_SECTOR_SIZE)
+
+// Mark of the checked image: the last words of the staging slot
+#define FW_MARK_ADDR				(FW_STAGING_ADDR + FW_STAGING_SIZE - \
+										sizeof(struct FW_Mark))
+#define FW_MARK_MAGIC				((uint32_t)0x4B4D5746)	// "FWMK"
+#define FW_MARK_WORDS				3	// Words programmed by the application
+#define FW_ERASED_WORD				((uint32_t)0xFFFFFFFF)
+
+// Initial stack pointer of the image must be in RAM or CCM RAM
+#define FW_RAM_ADDR					((uint32_t)0x20000000)
+#define FW_RAM_SIZE					((uint32_t)0x20000)
+#define FW_CCMRAM_ADDR				((uint32_t)0x10000000)
+#define FW_CCMRAM_SIZE				((uint32_t)0x10000)
+
+// Data is programmed by words, with one setting of control register per batch
+#define FW_BATCH_WORDS				64
+#define FW_BATCH_SIZE				(FW_BATCH_WORDS * sizeof(uint32_t))
+
+// Device voltage range supposed to be [2.7V to 3.6V], the operation will
+// be done by word
+#define VOLTAGE_RANGE 				FLASH_VOLTAGE_RANGE_3
+
+// Timeout of flash operation (ms): sector erase takes up to 4 s
+#define FW_FLASH_TIMEOUT			5000
+
+// Key of independent watchdog refreshing
+#define FW_IWDG_KEY_RELOAD			0xAAAA
+
+// Private types ---------------------------------------------------------------
+// Magic is programmed after the size and the CRC, so the mark is not valid
+// until it is programmed completely. The boot sector programs "done" to zero
+// after the copying
+struct FW_Mark
+{
+	uint32_t size;
+	uint32_t crc;
+	uint32_t magic;
+	uint32_t done;
+};
+
+struct FW_Update
+{
+	uint32_t size;			// Declared size of image
+	uint32_t crc;
+	uint32_t written;		// Bytes programmed to the staging slot
+	uint16_t batchLen;		// Bytes in the batch buffer
+	uint8_t erased;			// Mask of erased sectors of the staging slot
+	bool started;
+	bool ready;				// Image was checked
+	uint32_t batch[FW_BATCH_WORDS];
+};
+
+// Code of the boot sector (see mem.ld, sections.ld)
+#define BOOT_CODE					__attribute__((section(".boot"), noinline))
+
+typedef void (*BootVector)();
+
+// Variables -------------------------------------------------------------------
+static struct FW_Update fwUpdate;
+
+// Private function prototypes -------------------------------------------------
+static enum FW_UpdateResult FlushBatch();
+static bool EraseStagingSector(uint32_t offset);
+static bool ProgramWords(uint32_t addr, const uint32_t* words, uint16_t num);
+static bool CheckVectors();
+
+static void BootReset() BOOT_CODE __attribute__((noreturn));
+static void BootFault() BOOT_CODE __attribute__((noreturn));
+static void BootCopy(uint32_t size) BOOT_CODE;
+static void BootProgram(uint32_t addr, uint32_t word) BOOT_CODE;
+static void BootWait() BOOT_CODE;
+static uint32_t BootCRC32(const uint8_t* data, uint32_t length) BOOT_CODE;
+
+// Vectors of the boot sector: MCU starts with them (the initial stack is the
+// same as of the application, see sections.ld). Faults reset MCU
+extern uint32_t __stack;
+static const BootVector bootVectors[]
+		__attribute__((section(".boot_vectors"), used)) =
+{
+	(BootVector)&__stack,
+	BootReset,
+	BootFault,				// NMI
+	BootFault,				// Hard fault
+};
+
+// Public functions ------------------------------------------------------------
+enum FW_UpdateResult FW_UpdateBegin(uint32_t size)
+{
+	memset(&fwUpdate, 0, sizeof(fwUpdate));
+	if(	(size < FW_APP_ADDR - FW_IMAGE_ADDR + 2 * sizeof(uint32_t)) ||
+		(size > FW_UPDATE_MAX_SIZE))
+		return FW_UpdateWrongSize;
+
+	fwUpdate.size = size;
+	fwUpdate.started = true;
+	return FW_UpdateOk;
+}
+
+enum FW_UpdateResult FW_UpdateWrite(const void* data, size_t length)
+{
+	const uint8_t* src = data;
+
+	if(fwUpdate.started == false) return FW_UpdateNotStarted;
+	if(fwUpdate.written + fwUpdate.batchLen + length > fwUpdate.size)
+	{
+		fwUpdate.started = false;
+		return FW_UpdateOverflow;
+	}
+
+	// Data comes by TCP segments of any length and alignment: it is collected
+	// to the batch of words
+	while(length > 0)
+	{
+		size_t part = FW_BATCH_SIZE - fwUpdate.batchLen;
+		if(part > length) part = length;
+
+		memcpy((uint8_t*)fwUpdate.batch + fwUpdate.batchLen, src, part);
+		fwUpdate.batchLen += part;
+		src += part;
+		length -= part;
+
+		if(fwUpdate.batchLen == FW_BATCH_SIZE)
+		{
+			enum FW_UpdateResult result = FlushBatch();
+			if(result != FW_UpdateOk) return result;
+		}
+	}
+
+	return FW_UpdateOk;
+}
+
+enum FW_UpdateResult FW_UpdateEnd(uint32_t crc)
+{
+	enum FW_UpdateResult result;
+
+	if(fwUpdate.started == false) return FW_UpdateNotStarted;
+
+	// The tail of image is padded by erased flash value
+	if(fwUpdate.batchLen > 0)
+	{
+		memset((uint8_t*)fwUpdate.batch + fwUpdate.batchLen, 0xFF,
+				FW_BATCH_SIZE - fwUpdate.batchLen);
+		result = FlushBatch();
+		if(result != FW_UpdateOk) return result;
+	}
+	fwUpdate.started = false;
+
+	if(fwUpdate.written < fwUpdate.size) return FW_UpdateIncomplete;
+
+	// Place of the mark is erased (the last sector could be not used by the
+	// image, then it keeps the mark of the previous update)
+	if(EraseStagingSector(FW_MARK_ADDR - FW_STAGING_ADDR) == false)
+		return FW_UpdateFlashError;
+
+	// Image is checked as it is in flash: data cache could keep the lines read
+	// before programming
+	__HAL_FLASH_DATA_CACHE_DISABLE();
+	__HAL_FLASH_DATA_CACHE_RESET();
+	__HAL_FLASH_DATA_CACHE_ENABLE();
+
+	if(CheckVectors() == false) return FW_UpdateWrongImage;
+	if(CRC32_Calc(0, (const void*)FW_STAGING_ADDR, fwUpdate.size) != crc)
+		return FW_UpdateWrongCRC;
+
+	fwUpdate.crc = crc;
+	fwUpdate.ready = true;
+	return FW_UpdateOk;
+}
+
+bool FW_UpdateIsReady()
+{
+	return fwUpdate.ready;
+}
+
+void FW_UpdateApply()
+{
+	struct FW_Mark mark;
+
+	if(fwUpdate.ready == false) return;
+	fwUpdate.ready = false;
+
+	// Words of the mark are programmed in order, the magic is the last one
+	mark.size = fwUpdate.size;
+	mark.crc = fwUpdate.crc;
+	mark.magic = FW_MARK_MAGIC;
+	if(ProgramWords(FW_MARK_ADDR, (const uint32_t*)&mark, FW_MARK_WORDS) ==
+			false)
+		return;
+
+	// Boot sector copies the image
+	NVIC_SystemReset();
+}
+
+// Private functions -----------------------------------------------------------
+static enum FW_UpdateResult FlushBatch()
+{
+	uint32_t addr = FW_STAGING_ADDR + fwUpdate.written;
+	uint16_t words = (fwUpdate.batchLen + sizeof(uint32_t) - 1) /
+			sizeof(uint32_t);
+
+	// Batch is aligned by its size, so it is in one sector
+	if(EraseStagingSector(fwUpdate.written) == false)
+	{
+		fwUpdate.started = false;
+		return FW_UpdateFlashError;
+	}
+
+	if(ProgramWords(addr, fwUpdate.batch, words) == false)
+	{
+		fwUpdate.started = false;
+		return FW_UpdateFlashError;
+	}
+
+	fwUpdate.written += fwUpdate.batchLen;
+	fwUpdate.batchLen = 0;
+	return FW_UpdateOk;
+}
+
+static bool EraseStagingSector(uint32_t offset)
+{
+	uint8_t index = offset / FW_STAGING_SECTOR_SIZE;
+	if(fwUpdate.erased & (1 << index)) return true;
+
+	FLASH_EraseInitTypeDef pEraseInit;
+	uint32_t SectorError = 0;
+	pEraseInit.TypeErase = FLASH_TYPEERASE_SECTORS;
+	pEraseInit.Sector = FW_STAGING_SECTOR + index;
+	pEraseInit.NbSectors = 1;
+	pEraseInit.VoltageRange = VOLTAGE_RANGE;
+
+	// Unlock the Flash Program Erase controller
+	if(FlashAccessUnlock() == false) return false;
+
+	// CPU is stalled by reading of flash while the sector is erased
+	if(HAL_FLASHEx_Erase(&pEraseInit, &SectorError) != HAL_OK)
+	{
+		FlashAccessLock();
+		return false;
+	}
+
+	FlashAccessLock();
+	fwUpdate.erased |= (1 << index);
+	return true;
+}
+
+static bool ProgramWords(uint32_t addr, const uint32_t* words, uint16_t num)
+{
+	bool result = true;
+
+	if(FlashAccessUnlock() == false) return false;
+	if(FLASH_WaitForLastOperation(FW_FLASH_TIMEOUT) != HAL_OK)
+	{
+		FlashAccessLock();
+		return false;
+	}
+
+	// Program the batch by words: the size and the mode are set once
+	CLEAR_BIT(FLASH->CR, FLASH_CR_PSIZE);
+	SET_BIT(FLASH->CR, FLASH_PSIZE_WORD | FLASH_CR_PG);
+	for(uint16_t i = 0; i < num; i++)
+	{
+		*(__IO uint32_t*)addr = words[i];
+		addr += sizeof(uint32_t);
+
+		if(FLASH_WaitForLastOperation(FW_FLASH_TIMEOUT) != HAL_OK)
+		{
+			result = false;
+			break;
+		}
+	}
+	CLEAR_BIT(FLASH->CR, FLASH_CR_PG);
+
+	FlashAccessLock();
+	return result;
+}
+
+static bool CheckVectors()
+{
+	const uint32_t* vectors = (const uint32_t*)(FW_STAGING_ADDR +
+			FW_APP_ADDR - FW_IMAGE_ADDR);
+	uint32_t sp = vectors[0];
+	uint32_t reset = vectors[1];
+
+	if(	((sp <= FW_RAM_ADDR) || (sp > FW_RAM_ADDR + FW_RAM_SIZE)) &&
+		((sp <= FW_CCMRAM_ADDR) || (sp > FW_CCMRAM_ADDR + FW_CCMRAM_SIZE)))
+		return false;
+
+	// Reset handler is Thumb code of the application area
+	if((reset & 1) == 0) return false;
+	reset &= ~1UL;
+	return (reset >= FW_APP_ADDR) && (reset < FW_IMAGE_ADDR + fwUpdate.size);
+}
+
+// Boot sector -----------------------------------------------------------------
+/* Code of the boot sector is the first one after the reset. It stays as it was
+programmed by the debugger, so it does not depend on the application: it does
+not call functions out of the ".boot" section and does not use constants out of
+it, data and bss are not initialised yet. Copying is volatile to prevent
+memcpy() calls inserted by compiler */
+static void BootReset()
+{
+	const struct FW_Mark* mark = (const struct FW_Mark*)FW_MARK_ADDR;
+	const uint32_t* vectors = (const uint32_t*)FW_APP_ADDR;
+
+	// Staged image is copied again, if the copying was interrupted: it is
+	// checked before, the mark could be left from the staging of other one
+	if(	(mark->magic == FW_MARK_MAGIC) && (mark->done == FW_ERASED_WORD) &&
+		(mark->size > FW_APP_ADDR - FW_IMAGE_ADDR) &&
+		(mark->size <= FW_UPDATE_MAX_SIZE) &&
+		(BootCRC32((const uint8_t*)FW_STAGING_ADDR, mark->size) == mark->crc))
+	{
+		FLASH->KEYR = FLASH_KEY1;
+		FLASH->KEYR = FLASH_KEY2;
+		BootCopy(mark->size);
+		BootProgram((uint32_t)&mark->done, 0);
+		FLASH->CR = FLASH_CR_LOCK;
+	}
+
+	// Application area is erased (it was not programmed by the debugger)
+	while(vectors[0] == FW_ERASED_WORD) ;
+
+	// Start the application with its vectors table and stack
+	SCB->VTOR = FW_APP_ADDR;
+	__DSB();
+	__ASM volatile ("msr msp, %0\n"
+					"bx %1" : : "r" (vectors[0]), "r" (vectors[1]));
+	while(1) ;
+}
+
+static void BootFault()
+{
+	SCB->AIRCR  = ((0x5FA << SCB_AIRCR_VECTKEY_Pos) |
+				 SCB_AIRCR_SYSRESETREQ_Msk);
+	__DSB();
+	while(1) ;
+}
+
+static void BootCopy(uint32_t size)
+{
+	uint32_t end = FW_IMAGE_ADDR + size;
+
+	for(uint32_t sector = FW_APP_FIRST_SECTOR; sector <= FW_APP_LAST_SECTOR;
+		sector++)
+	{
+		// Sectors 0..3 - 16 KBytes, 4 - 64 KBytes, 5.. - 128 KBytes
+		uint32_t addr, sectorEnd;
+		if(sector < 4)
+		{
+			addr = FW_IMAGE_ADDR + sector * 0x4000;
+			sectorEnd = addr + 0x4000;
+		}
+		else if(sector == 4)
+		{
+			addr = FW_IMAGE_ADDR + 0x10000;
+			sectorEnd = addr + 0x10000;
+		}
+		else
+		{
+			addr = FW_IMAGE_ADDR + 0x20000 * (sector - 4);
+			sectorEnd = addr + 0x20000;
+		}
+
+		if(addr >= end) break;
+		if(sectorEnd > end) sectorEnd = end;
+
+		// Erase the sector
+		BootWait();
+		FLASH->CR = FLASH_PSIZE_WORD | FLASH_CR_SER |
+				(sector << FLASH_CR_SNB_Pos);
+		FLASH->CR |= FLASH_CR_STRT;
+		BootWait();
+
+		// Copy the sector from the staging slot by words
+		for(; addr < sectorEnd; addr += sizeof(uint32_t))
+		{
+			uint32_t from = addr - FW_IMAGE_ADDR + FW_STAGING_ADDR;
+			BootProgram(addr, *(__IO uint32_t*)from);
+		}
+	}
+}
+
+static void BootProgram(uint32_t addr, uint32_t word)
+{
+	FLASH->CR = FLASH_PSIZE_WORD | FLASH_CR_PG;
+	*(__IO uint32_t*)addr = word;
+	BootWait();
+}
+
+// Errors of erase or programming reset MCU: the copying is started again
+static void BootWait()
+{
+	IWDG->KR = FW_IWDG_KEY_RELOAD;
+	while(FLASH->SR & FLASH_SR_BSY) ;
+	FLASH->CR = 0;
+
+	if(FLASH->SR & (FLASH_FLAG_OPERR | FLASH_FLAG_WRPERR |
+			FLASH_FLAG_PGAERR | FLASH_FLAG_PGPERR | FLASH_FLAG_PGSERR))
+		BootFault();
+	FLASH->SR = FLASH_FLAG_EOP;
+}
+
+// Bit by bit CRC-32 of crc32.c: its table is out of the boot sector
+static uint32_t BootCRC32(const uint8_t* data, uint32_t length)
+{
+	uint32_t crc = 0xFFFFFFFF;
+
+	while(length--)
+	{
+		crc ^= *data++;
+		for(uint8_t bit = 0; bit < 8; bit++)
+			crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+	}
+	return ~crc;
+}
@@ -1,5 +1,6 @@
 /* This is settings manager driver file (store/restore global settings to
-internal FLASH memory)
+internal FLASH memory): two sectors of log-structured storage (see
+settings_NV_log.c)
 */
 
 /* Includes ------------------------------------------------------------------*/
@@ -12,9 +13,12 @@ internal FLASH memory)
 
 /* Application includes */
 #include "settings.h"
+#include "flash_access.h"
+#include "settings_NV_log.h"
 
 // Private constants -----------------------------------------------------------
 #define FLASH_PAGE_SIZE 			(uint32_t)0x4000  // Page size = 16KByte
+#define FLASH_PAGES_NUM				2
 
 // Device voltage range supposed to be [2.7V to 3.6V], the operation will
 // be done by word
@@ -33,40 +37,27 @@ internal FLASH memory)
 // Variables -------------------------------------------------------------------
 static const uint8_t __attribute__((section (".NV_dataSection"),
 		aligned(FLASH_PAGE_SIZE)))
-NV_SettingsData[FLASH_PAGE_SIZE] = {0};
+NV_SettingsData[FLASH_PAGES_NUM][FLASH_PAGE_SIZE] = {{0}};
 
 // Private function prototypes -------------------------------------------------
 
 // Public functions ------------------------------------------------------------
 void SettingsNV_ManagerDriverInit() {}
 
-bool GetBackUpNV_Memory(uint8_t* mem, uint16_t size)
+uint32_t SettingsNV_DriverGetSectorSize()
 {
-	// Validate input parameters
-	if(size > FLASH_PAGE_SIZE) return false;
-
-	for(uint16_t i = 0; i < size; i++)
-	{
-		mem[i] = NV_SettingsData[i];
-	}
-	return true;
+	return FLASH_PAGE_SIZE;
 }
 
-/*bool RAM_IsMatchToNV_Memory(uint8_t* mem, uint16_t size,
-						const uint8_t* NV_mem, uint16_t NV_size)
+const uint8_t* SettingsNV_DriverGetSector(uint8_t sector)
 {
-	for(uint16_t i = 0; i < size; i++)
-	{
-		if(i >= NV_size) return false;
-		if(mem[i] != NV_mem[i]) return false;
-	}
-	return true;
-}*/
+	return NV_SettingsData[sector];
+}
 
-bool SetBackUpNV_Memory(uint8_t* mem, uint16_t size)
+bool SettingsNV_DriverErase(uint8_t sector)
 {
 	// Validate input parameters
-	if(size > FLASH_PAGE_SIZE) return false;
+	if(sector >= FLASH_PAGES_NUM) return false;
 
 	FLASH_EraseInitTypeDef pEraseInit;
 	uint32_t SectorError = 0;
@@ -75,7 +66,7 @@ bool SetBackUpNV_Memory(uint8_t* mem, uint16_t size)
 	pEraseInit.VoltageRange = VOLTAGE_RANGE;
 
 	// Search corresponding flash sector
-	switch((uint32_t)NV_SettingsData)
+	switch((uint32_t)NV_SettingsData[sector])
 	{
 	case ADDR_FLASH_SECTOR_0:
 		//pEraseInit.Sector = FLASH_SECTOR_0;
@@ -100,30 +91,40 @@ bool SetBackUpNV_Memory(uint8_t* mem, uint16_t size)
 	}
 
 	// Unlock the Flash Program Erase controller
-	if(HAL_FLASH_Unlock() != HAL_OK) return false;
+	if(FlashAccessUnlock() == false) return false;
 
-	// Erase page before writing
-	if(HAL_FLASHEx_Erase(&pEraseInit, &SectorError) != HAL_OK)
-	{
-		// Erase operation was failed, lock flash controller and return
-		HAL_FLASH_Lock();
+	// Erase page: CPU is stalled by reading of flash while it is erased, but
+	// interrupts are not disabled
+	HAL_StatusTypeDef status = HAL_FLASHEx_Erase(&pEraseInit, &SectorError);
+
+	FlashAccessLock();
+	return (status == HAL_OK);
+}
+
+bool SettingsNV_DriverProgram(uint8_t sector, uint32_t offset,
+		const uint32_t* data, uint32_t length)
+{
+	// Validate input parameters
+	if((sector >= FLASH_PAGES_NUM) || (offset % sizeof(uint32_t)) ||
+	   (offset + length * sizeof(uint32_t) > FLASH_PAGE_SIZE))
 		return false;
-	}
-	
-	// Create register for 16 bit data
-	for(uint16_t i = 0; i < size; i++)
+
+	// Unlock the Flash Program Erase controller
+	if(FlashAccessUnlock() == false) return false;
+
+	uint32_t addr = (uint32_t)&NV_SettingsData[sector][offset];
+	for(uint32_t i = 0; i < length; i++, addr += sizeof(uint32_t))
 	{
 		// Program Flash Bank1
-		if(HAL_FLASH_Program(FLASH_TYPEPROGRAM_BYTE,
-							 (uint32_t)(&NV_SettingsData[i]), mem[i]) != HAL_OK)
+		if(HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, addr, data[i]) != HAL_OK)
 		{
 			// Flash programm failed
-			HAL_FLASH_Lock();
+			FlashAccessLock();
 			return false;
 		}
 	}
-		
-	HAL_FLASH_Lock();
+
+	FlashAccessLock();
 	return true;
 }
 	
@@ -0,0 +1,16 @@
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _CRC32_H_
+#define _CRC32_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard includes */
+#include <stdint.h>
+#include <stddef.h>
+
+/* Public function prototypes ------------------------------------------------*/
+/* CRC-32 (IEEE 802.3, the same as zlib.crc32) of data, "crc" is the result of
+   previous part (0 for the first). It is shared by the firmware update and by
+   the records of flash logs */
+uint32_t CRC32_Calc(uint32_t crc, const void* data, size_t length);
+
+#endif /* _CRC32_H_ */
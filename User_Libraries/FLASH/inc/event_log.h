@@ -0,0 +1,80 @@
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _EVENT_LOG_H_
+#define _EVENT_LOG_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Public constants ----------------------------------------------------------*/
+/* Size of record and of its data, bytes */
+#define EVENT_LOG_RECORD_SIZE		64
+#define EVENT_LOG_DATA_SIZE			44
+
+/* Format of record with text data */
+#define EVENT_LOG_TEXT				0xFFFF
+
+/* Sequence of free space (erased flash) */
+#define EVENT_LOG_FREE				0xFFFFFFFF
+
+/* Public types --------------------------------------------------------------*/
+/* Record of the log, the same in flash and in its HTTP dump (little-endian) */
+struct EventLogRecord
+{
+	uint32_t sequence;		/* Number of record since the log was formatted */
+	uint32_t counter;		/* Time of event: seconds since 1970 and 1/65536 */
+	uint16_t fraction;
+	uint16_t format;		/* Offset in ".log_formats" or EVENT_LOG_TEXT */
+	uint8_t type;			/* Severity (see enum LogEventType) */
+	uint8_t length;			/* Bytes of data: arguments or text */
+	uint16_t reserved;
+	uint8_t data[EVENT_LOG_DATA_SIZE];
+	uint32_t crc;			/* CRC-32 of the record before it */
+};
+
+/* Counters since start */
+struct EventLogStats
+{
+	uint32_t records;		/* Appended records */
+	uint32_t writes;		/* Programmed blocks (whole or partial) */
+	uint32_t erases;		/* Erased sectors (oldest records are lost) */
+	uint32_t errors;		/* Failed erases and writes */
+	uint32_t dropped;		/* Records appended to the full log */
+};
+
+/* Public function prototypes ------------------------------------------------*/
+/* Records are appended to a circular log of flash sectors: the full sector
+   is followed by the oldest one, which is erased ahead by EventLogEraseNext.
+   Records are collected in RAM block and programmed together, when the block
+   is full or by EventLogFlush. Init finds the end of the log (records without
+   valid CRC are skipped). Return false, if there is no flash for the log */
+bool EventLogInit();
+bool EventLogIsReady();
+/* Append and flush are called from one task: the log has no locks */
+bool EventLogAppend(uint8_t type, uint16_t format, uint32_t counter,
+		uint16_t fraction, const void* data, uint8_t length);
+/* Program pending records of the block to flash (the rest of block is
+   programmed later) */
+void EventLogFlush();
+/* The oldest sector, which follows the active one, is not erased yet: when
+   the active sector is full, records are dropped until it is erased */
+bool EventLogNeedsErase();
+/* Erase the oldest sector (its records are lost). It stalls CPU up to 2 s
+   (flash is not read while it is erased): the owner task chooses the time */
+bool EventLogEraseNext();
+/* Sectors of the log as one memory area: records are ordered by sequence
+   numbers, not by addresses. NULL, if there is no log */
+const uint8_t* EventLogGetData(uint32_t* size);
+const struct EventLogStats* EventLogGetStats();
+
+/* Driver functions: adjacent sectors of the same size, erased flash is 0xFF */
+uint8_t EventLogDriverGetSectorsNum();
+uint32_t EventLogDriverGetSectorSize();
+const uint8_t* EventLogDriverGetSector(uint8_t sector);
+bool EventLogDriverErase(uint8_t sector);
+/* Program words: offset is aligned to 4, length is in words */
+bool EventLogDriverProgram(uint8_t sector, uint32_t offset,
+		const uint32_t* data, uint32_t length);
+
+#endif /* _EVENT_LOG_H_ */
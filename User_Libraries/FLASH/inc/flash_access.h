@@ -0,0 +1,19 @@
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _FLASH_ACCESS_H_
+#define _FLASH_ACCESS_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard includes */
+#include <stdbool.h>
+
+/* Public function prototypes ------------------------------------------------*/
+/* Flash controller is shared by the settings, the event log and the firmware
+   update drivers: every Unlock..Lock sequence of erasing or programming takes
+   it, so sequences of different tasks do not interleave */
+void FlashAccessInit();
+/* Take the controller and unlock it (false: it is not taken) */
+bool FlashAccessUnlock();
+/* Lock the controller and release it */
+void FlashAccessLock();
+
+#endif /* _FLASH_ACCESS_H_ */
@@ -0,0 +1,44 @@
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _FW_UPDATE_H_
+#define _FW_UPDATE_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Public constants ----------------------------------------------------------*/
+/* Maximum size of image: binary from the start of flash to the end of
+   application area, without the mark at the end of staging slot */
+#define FW_UPDATE_MAX_SIZE		((uint32_t)0x40000 - 16)
+
+/* Result of firmware update functions */
+enum FW_UpdateResult
+{
+	FW_UpdateOk = 0,
+	FW_UpdateWrongSize,		/* Image is empty or does not fit the slot */
+	FW_UpdateNotStarted,	/* Data without FW_UpdateBegin() */
+	FW_UpdateOverflow,		/* Data over the declared size */
+	FW_UpdateFlashError,	/* Erase or programming was failed */
+	FW_UpdateIncomplete,	/* Image is shorter than the declared size */
+	FW_UpdateWrongImage,	/* Vectors table does not belong to this MCU */
+	FW_UpdateWrongCRC,
+};
+
+/* Public function prototypes ------------------------------------------------*/
+/* Image is written to the staging slot of flash as it comes (there is no
+   RAM buffer of the whole image), sectors of the slot are erased on demand */
+enum FW_UpdateResult FW_UpdateBegin(uint32_t size);
+enum FW_UpdateResult FW_UpdateWrite(const void* data, size_t length);
+/* Check the written image: size, vectors table and CRC-32 (see crc32.h) read
+   back from flash */
+enum FW_UpdateResult FW_UpdateEnd(uint32_t crc);
+/* Image was checked and it could be applied */
+bool FW_UpdateIsReady();
+/* Mark the checked image and reset MCU: the boot sector copies it to the
+   application area (it does not return). Nothing is done, if there is no
+   checked image */
+void FW_UpdateApply();
+
+#endif /* _FW_UPDATE_H_ */
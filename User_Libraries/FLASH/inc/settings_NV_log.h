@@ -0,0 +1,53 @@
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _SETTINGS_NV_LOG_H_
+#define _SETTINGS_NV_LOG_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Public constants ----------------------------------------------------------*/
+/* Keys of values are 1..SETTINGS_NV_LOG_MAX_KEY */
+#ifndef SETTINGS_NV_LOG_MAX_KEY
+#	define SETTINGS_NV_LOG_MAX_KEY		63
+#endif /* SETTINGS_NV_LOG_MAX_KEY */
+
+/* Maximum length of value, bytes */
+#define SETTINGS_NV_LOG_MAX_LENGTH		256
+
+/* Key reserved for records of commits */
+#define SETTINGS_NV_LOG_COMMIT_KEY		(SETTINGS_NV_LOG_MAX_KEY - 1)
+
+/* Public function prototypes ------------------------------------------------*/
+/* Settings are appended to the log as records "key, length, value, CRC-32",
+   the latest committed record of key is its value. Full sector is compacted
+   to another one: only the latest values are copied and the full sector is
+   erased. Init finds the active sector and indexes its records (interrupted
+   compacting is finished or rolled back, interrupted batch is discarded).
+   Return false, if there was no log and the storage was formatted */
+bool SettingsNV_LogInit();
+/* Latest value of key: return its length (0 - key is absent), the value is
+   truncated to the size */
+uint16_t SettingsNV_LogRead(uint16_t key, void* value, uint16_t size);
+/* Append the value, if it differs from the stored one (flash is written
+   only for changed keys). Out of batch the value is committed at once */
+bool SettingsNV_LogWrite(uint16_t key, const void* value, uint16_t length);
+/* Values written between Begin and Commit are stored atomically: after power
+   failure all of them or none are read (read returns committed values) */
+void SettingsNV_LogBegin();
+bool SettingsNV_LogCommit();
+void SettingsNV_LogRollback();
+/* Latest values of all keys in order of keys (one pass over the index) */
+void SettingsNV_LogForEach(void (*callback)(uint16_t key, const void* value,
+		uint16_t length));
+
+/* Driver functions: two sectors of the same size, erased flash is 0xFF */
+uint32_t SettingsNV_DriverGetSectorSize();
+const uint8_t* SettingsNV_DriverGetSector(uint8_t sector);
+bool SettingsNV_DriverErase(uint8_t sector);
+/* Program words: offset is aligned to 4, length is in words */
+bool SettingsNV_DriverProgram(uint8_t sector, uint32_t offset,
+		const uint32_t* data, uint32_t length);
+
+#endif /* _SETTINGS_NV_LOG_H_ */
@@ -0,0 +1,105 @@
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _SETTINGS_REGISTRY_H_
+#define _SETTINGS_REGISTRY_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Application includes */
+#include "settings_NV_log.h"
+
+/* Public constants ----------------------------------------------------------*/
+/* Key of schema version of stored settings */
+#define SETTINGS_KEY_SCHEMA_VERSION		SETTINGS_NV_LOG_MAX_KEY
+/* Keys of modules are 1..SETTINGS_KEY_MAX (keys above are reserved) */
+#define SETTINGS_KEY_MAX				(SETTINGS_NV_LOG_COMMIT_KEY - 1)
+
+/* Types of values: accessors of numbers use bool, int32_t (Int) and uint32_t
+   (UInt), strings are copied to buffers of "size" bytes */
+enum SettingsType
+{
+	SettingsTypeBool,
+	SettingsTypeInt,
+	SettingsTypeUInt,
+	SettingsTypeString
+};
+
+/* Public structures ---------------------------------------------------------*/
+/* Key of settings: ID is the key of NV log, it is never reused for another
+   meaning or type (IDs of removed keys are left unused) */
+struct SettingsKey
+{
+	uint16_t id;
+	enum SettingsType type;
+	/* Stored bytes of numbers, size of buffer with terminator of strings */
+	uint16_t size;
+	/* Range and default value of numbers */
+	int64_t min;
+	int64_t max;
+	int64_t def;
+	const char* defStr;
+	void (*get)(void* value);
+	void (*set)(const void* value);
+};
+
+/* Keys declared by a module */
+struct SettingsKeysTable
+{
+	const struct SettingsKey* keys;
+	uint16_t num;
+};
+
+/* Public macros -------------------------------------------------------------*/
+/* Keys with accessors "name##_Get" and "name##_Set" */
+#define SETTINGS_KEY_BOOL(id, name, def) \
+		{id, SettingsTypeBool, sizeof(bool), 0, 1, def, NULL, \
+		name##_Get, name##_Set}
+#define SETTINGS_KEY_INT(id, name, type, min, max, def) \
+		{id, SettingsTypeInt, sizeof(type), min, max, def, NULL, \
+		name##_Get, name##_Set}
+#define SETTINGS_KEY_UINT(id, name, type, min, max, def) \
+		{id, SettingsTypeUInt, sizeof(type), min, max, def, NULL, \
+		name##_Get, name##_Set}
+#define SETTINGS_KEY_STRING(id, name, size, def) \
+		{id, SettingsTypeString, size, 0, 0, 0, def, name##_Get, name##_Set}
+#define SETTINGS_KEYS_TABLE(keys) \
+		{keys, sizeof(keys) / sizeof(keys[0])}
+
+/* Accessors over getter and setter of module ("type" is the type of
+   accessor: bool, int32_t or uint32_t) */
+#define SETTINGS_ACCESSORS(name, type, getter, setter) \
+static void name##_Get(void* value) { *(type*)value = getter(); } \
+static void name##_Set(const void* value) { setter(*(const type*)value); }
+/* Accessors over variable of module */
+#define SETTINGS_VARIABLE_ACCESSORS(name, type, variable) \
+static void name##_Get(void* value) { *(type*)value = variable; } \
+static void name##_Set(const void* value) { variable = *(const type*)value; }
+
+/* Public function prototypes ------------------------------------------------*/
+/* Keys of modules are indexed by IDs: return false for a wrong or repeated
+   ID (the key is skipped) */
+bool SettingsRegistryInit(const struct SettingsKeysTable* const* tables,
+		uint8_t num);
+uint16_t SettingsRegistryGetKeysNum();
+/* Values are decoded and set with one scan of NV log: unknown keys are
+   skipped, wrong values are replaced with defaults. Return number of
+   restored keys */
+uint16_t SettingsRegistryRestore();
+/* Values of all keys are encoded and written to NV log (only changed values
+   are appended) */
+bool SettingsRegistryStore();
+
+/* Setters of stored settings call it after change of value: generation of
+   settings is increased and the listener task is notified */
+void SettingsRegistryChanged();
+uint32_t SettingsRegistryGetGeneration();
+/* Task, which stores settings (it is notified by SettingsRegistryChanged) */
+void SettingsRegistrySetListener(TaskHandle_t xTask);
+
+#endif /* _SETTINGS_REGISTRY_H_ */
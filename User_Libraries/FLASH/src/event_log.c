@@ -0,0 +1,301 @@
+/* Circular log of events in flash sectors: records of fixed size are collected
+ * in RAM block and programmed together to the block aligned to its size, so
+ * flash is written by blocks instead of every record. Sectors are filled in
+ * turn, the full sector is followed by the oldest one. Appending never erases
+ * (erasing stalls CPU): the oldest sector is erased ahead by the owner task
+ * (EventLogEraseNext), records of the full log are dropped until then.
+ * Records have sequence numbers and CRC: the end of log is found after reset,
+ * records interrupted by power failure are skipped by readers */
+
+/* Includes ------------------------------------------------------------------*/
+#include <assert.h>
+#include <string.h>
+#include <stddef.h>
+
+/* Application includes */
+#include "event_log.h"
+#include "crc32.h"
+
+/* Private constants ---------------------------------------------------------*/
+/* Records of block (block size is a divisor of sector size) */
+#ifndef EVENT_LOG_BLOCK_RECORDS
+#	define EVENT_LOG_BLOCK_RECORDS	8
+#endif /* EVENT_LOG_BLOCK_RECORDS */
+#define EVENT_LOG_BLOCK_SIZE		(EVENT_LOG_BLOCK_RECORDS * \
+		EVENT_LOG_RECORD_SIZE)
+
+#define LOG_ERASED_WORD				((uint32_t)0xFFFFFFFF)
+#define LOG_NO_SECTOR				0xFF
+
+/* Records are programmed by words, readers of dumps depend on the layout */
+static_assert(sizeof(struct EventLogRecord) == EVENT_LOG_RECORD_SIZE,
+		"Wrong size of event log record");
+
+/* Variables -----------------------------------------------------------------*/
+static uint8_t sectorsNum = 0;
+static uint32_t sectorSize = 0;
+static uint8_t activeSector = LOG_NO_SECTOR;
+/* Block of records: offset in the active sector, records in the block and
+   records programmed to flash */
+static uint32_t blockOffset;
+static uint16_t blockUsed;
+static uint16_t blockWritten;
+static struct EventLogRecord block[EVENT_LOG_BLOCK_RECORDS];
+static uint32_t nextSequence;
+/* Sector after the active one is erased; the active sector is full and the
+   next one is not erased (records are dropped) */
+static bool nextFree;
+static bool logFull;
+
+static struct EventLogStats stats;
+
+/* Private function prototypes -----------------------------------------------*/
+static const struct EventLogRecord* GetRecords(uint8_t sector);
+static bool IsValid(const struct EventLogRecord* record);
+static bool IsFree(const struct EventLogRecord* record);
+static bool IsSectorFree(uint8_t sector);
+static bool StartSector(uint8_t sector);
+static bool NextSector();
+static void SetPosition(uint32_t record);
+static void NextBlock();
+
+/* Public functions ----------------------------------------------------------*/
+bool EventLogInit()
+{
+	uint32_t recordsNum;
+	uint32_t end;
+	uint32_t newest = 0;
+
+	activeSector = LOG_NO_SECTOR;
+	logFull = false;
+	sectorsNum = EventLogDriverGetSectorsNum();
+	sectorSize = EventLogDriverGetSectorSize();
+	if((sectorsNum < 2) || (sectorsNum >= LOG_NO_SECTOR) ||
+	   (sectorSize % EVENT_LOG_BLOCK_SIZE)) return false;
+	recordsNum = sectorSize / EVENT_LOG_RECORD_SIZE;
+
+	/* Active sector has the latest first record */
+	for(uint8_t sector = 0; sector < sectorsNum; sector++)
+	{
+		const struct EventLogRecord* first = GetRecords(sector);
+		if(IsValid(first) && ((activeSector == LOG_NO_SECTOR) ||
+			(first->sequence > newest)))
+		{
+			activeSector = sector;
+			newest = first->sequence;
+		}
+	}
+
+	/* There is no log */
+	if(activeSector == LOG_NO_SECTOR)
+	{
+		nextSequence = 0;
+		return StartSector(0);
+	}
+
+	/* End of log is after the last written record (partly written record is
+	   not programmed again) */
+	const struct EventLogRecord* records = GetRecords(activeSector);
+	for(end = recordsNum; (end > 0) && IsFree(&records[end - 1]); end--);
+
+	nextSequence = newest + 1;
+	for(uint32_t i = 0; i < end; i++)
+	{
+		if(IsValid(&records[i]) && (records[i].sequence >= nextSequence))
+			nextSequence = records[i].sequence + 1;
+	}
+
+	nextFree = IsSectorFree((activeSector + 1) % sectorsNum);
+	SetPosition(end);
+	if(end == recordsNum) NextSector();
+	return true;
+}
+
+bool EventLogIsReady()
+{
+	return (activeSector != LOG_NO_SECTOR);
+}
+
+bool EventLogAppend(uint8_t type, uint16_t format, uint32_t counter,
+		uint16_t fraction, const void* data, uint8_t length)
+{
+	if(activeSector == LOG_NO_SECTOR) return false;
+	if(logFull)
+	{
+		stats.dropped++;
+		return false;
+	}
+
+	struct EventLogRecord* record = &block[blockUsed];
+	if(length > EVENT_LOG_DATA_SIZE) length = EVENT_LOG_DATA_SIZE;
+
+	memset(record, 0, sizeof(*record));
+	record->sequence = nextSequence++;
+	record->counter = counter;
+	record->fraction = fraction;
+	record->format = format;
+	record->type = type;
+	record->length = length;
+	record->reserved = 0xFFFF;
+	memcpy(record->data, data, length);
+	record->crc = CRC32_Calc(0, record,
+			offsetof(struct EventLogRecord, crc));
+	stats.records++;
+
+	if(++blockUsed < EVENT_LOG_BLOCK_RECORDS) return true;
+	EventLogFlush();
+	NextBlock();
+	return true;
+}
+
+void EventLogFlush()
+{
+	if((activeSector == LOG_NO_SECTOR) || (blockWritten == blockUsed)) return;
+
+	/* Failed records are not programmed again: readers skip them */
+	if(EventLogDriverProgram(activeSector,
+			blockOffset + blockWritten * EVENT_LOG_RECORD_SIZE,
+			(const uint32_t*)&block[blockWritten],
+			(blockUsed - blockWritten) * EVENT_LOG_RECORD_SIZE /
+			sizeof(uint32_t)))
+		stats.writes++;
+	else
+		stats.errors++;
+	blockWritten = blockUsed;
+}
+
+bool EventLogNeedsErase()
+{
+	return (activeSector != LOG_NO_SECTOR) && (nextFree == false);
+}
+
+bool EventLogEraseNext()
+{
+	if(EventLogNeedsErase() == false) return true;
+
+	if(EventLogDriverErase((activeSector + 1) % sectorsNum) == false)
+	{
+		stats.errors++;
+		return false;
+	}
+	stats.erases++;
+	nextFree = true;
+
+	/* Full log goes on in the erased sector */
+	if(logFull) NextSector();
+	return true;
+}
+
+const uint8_t* EventLogGetData(uint32_t* size)
+{
+	if(activeSector == LOG_NO_SECTOR)
+	{
+		*size = 0;
+		return NULL;
+	}
+
+	*size = sectorsNum * sectorSize;
+	return EventLogDriverGetSector(0);
+}
+
+const struct EventLogStats* EventLogGetStats()
+{
+	return &stats;
+}
+
+/* Private functions ---------------------------------------------------------*/
+static const struct EventLogRecord* GetRecords(uint8_t sector)
+{
+	return (const struct EventLogRecord*)EventLogDriverGetSector(sector);
+}
+
+static bool IsValid(const struct EventLogRecord* record)
+{
+	return (record->sequence != EVENT_LOG_FREE) &&
+			(CRC32_Calc(0, record, offsetof(struct EventLogRecord, crc)) ==
+			record->crc);
+}
+
+static bool IsFree(const struct EventLogRecord* record)
+{
+	const uint32_t* words = (const uint32_t*)record;
+
+	for(uint32_t i = 0; i < EVENT_LOG_RECORD_SIZE / sizeof(uint32_t); i++)
+	{
+		if(words[i] != LOG_ERASED_WORD) return false;
+	}
+	return true;
+}
+
+static bool IsSectorFree(uint8_t sector)
+{
+	const struct EventLogRecord* records = GetRecords(sector);
+	uint32_t recordsNum = sectorSize / EVENT_LOG_RECORD_SIZE;
+
+	for(uint32_t i = 0; i < recordsNum; i++)
+	{
+		if(IsFree(&records[i]) == false) return false;
+	}
+	return true;
+}
+
+/* New log is written from the start of sector: it is erased, if it is not
+   free (init only) */
+static bool StartSector(uint8_t sector)
+{
+	if(IsSectorFree(sector) == false)
+	{
+		if(EventLogDriverErase(sector) == false)
+		{
+			/* Log is stopped: records are not appended to the old ones */
+			stats.errors++;
+			activeSector = LOG_NO_SECTOR;
+			return false;
+		}
+		stats.erases++;
+	}
+
+	activeSector = sector;
+	SetPosition(0);
+	nextFree = IsSectorFree((sector + 1) % sectorsNum);
+	return true;
+}
+
+/* Full active sector is followed by the next one, if it is erased already.
+   Otherwise the log is full: records are dropped until EventLogEraseNext() */
+static bool NextSector()
+{
+	if(nextFree == false)
+	{
+		logFull = true;
+		return false;
+	}
+
+	logFull = false;
+	activeSector = (activeSector + 1) % sectorsNum;
+	SetPosition(0);
+	nextFree = IsSectorFree((activeSector + 1) % sectorsNum);
+	return true;
+}
+
+static void SetPosition(uint32_t record)
+{
+	uint32_t offset = record * EVENT_LOG_RECORD_SIZE;
+
+	blockOffset = offset - offset % EVENT_LOG_BLOCK_SIZE;
+	blockUsed = (offset - blockOffset) / EVENT_LOG_RECORD_SIZE;
+	blockWritten = blockUsed;
+}
+
+static void NextBlock()
+{
+	if(blockOffset + EVENT_LOG_BLOCK_SIZE >= sectorSize)
+	{
+		NextSector();
+		return;
+	}
+
+	blockOffset += EVENT_LOG_BLOCK_SIZE;
+	blockUsed = 0;
+	blockWritten = 0;
+}
@@ -0,0 +1,431 @@
+/* Log-structured storage of settings in two sectors of flash: changed values
+ * are appended as records, so a sector is erased once per its size of changes
+ * instead of every change, and the sectors are erased in turn.
+ * Records are pending until a commit record (sequence number of commit) is
+ * written after them: a batch of values interrupted by power failure is
+ * discarded and the previous values are read */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+
+/* Application includes */
+#include "settings_NV_log.h"
+#include "crc32.h"
+
+/* Private constants ---------------------------------------------------------*/
+/* Header of sector: the first marker is written before compacting to the
+   sector, the second one after erasing of the previous sector. The first
+   marker of the previous sector is cleared before erasing (interrupted
+   erasing could leave its header) */
+#define LOG_MARKER_RECEIVE			((uint32_t)0x474F4C52)	/* "RLOG" */
+#define LOG_MARKER_VALID			((uint32_t)0x474F4C56)	/* "VLOG" */
+#define LOG_MARKER_OBSOLETE			((uint32_t)0x00000000)
+#define LOG_ERASED_WORD				((uint32_t)0xFFFFFFFF)
+#define LOG_HEADER_SIZE				(2 * sizeof(uint32_t))
+#define LOG_NO_SECTOR				0xFF
+
+/* Record: word of key (low half) and length, value aligned to words, CRC-32
+   of the first word and value */
+#define LOG_WORDS(length)			(((uint32_t)(length) + 3) / 4)
+#define LOG_RECORD_WORDS(length)	(LOG_WORDS(length) + 2)
+
+/* Records of the commit key: sequence number commits pending records, empty
+   value discards them */
+#define LOG_COMMIT_LENGTH			sizeof(uint32_t)
+#define LOG_ROLLBACK_LENGTH			0
+
+enum LogSectorState
+{
+	LogSectorErased,
+	LogSectorReceive,		/* Compacting to the sector was not finished */
+	LogSectorValid,
+	LogSectorCorrupted
+};
+
+/* Variables -----------------------------------------------------------------*/
+static uint8_t activeSector = LOG_NO_SECTOR;
+static uint32_t freeOffset;
+/* Offsets of the latest committed and pending records of keys in the active
+   sector (0 - absent) */
+static uint32_t keysIndex[SETTINGS_NV_LOG_MAX_KEY + 1];
+static uint32_t pendingIndex[SETTINGS_NV_LOG_MAX_KEY + 1];
+static uint32_t commitSequence;
+static bool batchOpened = false;
+/* Record being written */
+static uint32_t recordBuff[LOG_RECORD_WORDS(SETTINGS_NV_LOG_MAX_LENGTH)];
+
+/* Private function prototypes -----------------------------------------------*/
+static enum LogSectorState GetSectorState(uint8_t sector);
+static bool IsErased(uint8_t sector, uint32_t offset);
+static bool Format();
+static bool IndexRecords();
+static void ApplyPending();
+static bool HasPending();
+static void PrepareRecord(uint16_t key, const void* value, uint16_t length);
+static bool AppendRecord(uint16_t key, const void* value, uint16_t length);
+static bool Compact(uint16_t newKey);
+static bool CopyRecord(uint8_t sector, uint32_t* offset,
+		const uint32_t* record);
+
+/* Public functions ----------------------------------------------------------*/
+bool SettingsNV_LogInit()
+{
+	enum LogSectorState state0 = GetSectorState(0);
+	enum LogSectorState state1 = GetSectorState(1);
+	uint32_t marker = LOG_MARKER_VALID;
+
+	activeSector = LOG_NO_SECTOR;
+	batchOpened = false;
+	if((state0 == LogSectorValid) || (state1 == LogSectorValid))
+	{
+		/* Interrupted compacting to another sector is rolled back */
+		activeSector = (state0 == LogSectorValid) ? 0 : 1;
+		if(((activeSector == 0) ? state1 : state0) != LogSectorErased)
+			SettingsNV_DriverErase(activeSector ^ 1);
+	}
+	else if((state0 == LogSectorReceive) != (state1 == LogSectorReceive))
+	{
+		/* Compacting was interrupted after copying of all values: the previous
+		   sector is erased again and the new one is completed */
+		activeSector = (state0 == LogSectorReceive) ? 0 : 1;
+		if(((activeSector == 0) ? state1 : state0) != LogSectorErased)
+			SettingsNV_DriverErase(activeSector ^ 1);
+		SettingsNV_DriverProgram(activeSector, sizeof(uint32_t), &marker, 1);
+	}
+	else
+	{
+		/* There is no log */
+		Format();
+		return false;
+	}
+
+	if(IndexRecords() == false)
+	{
+		/* Log of previous firmware has no commits: all its records are
+		   committed, the next batch starts after a commit */
+		uint32_t sequence = commitSequence + 1;
+		if(AppendRecord(SETTINGS_NV_LOG_COMMIT_KEY, &sequence,
+				LOG_COMMIT_LENGTH)) commitSequence = sequence;
+	}
+
+	/* Batch interrupted by power failure is discarded, so records of the
+	   next batch do not commit it */
+	SettingsNV_LogRollback();
+	return true;
+}
+
+uint16_t SettingsNV_LogRead(uint16_t key, void* value, uint16_t size)
+{
+	if((activeSector == LOG_NO_SECTOR) || (key == 0) ||
+	   (key > SETTINGS_NV_LOG_MAX_KEY) || (keysIndex[key] == 0))
+		return 0;
+
+	const uint8_t* record =
+			SettingsNV_DriverGetSector(activeSector) + keysIndex[key];
+	uint16_t length = *(const uint32_t*)record >> 16;
+	memcpy(value, record + sizeof(uint32_t), (length < size) ? length : size);
+	return length;
+}
+
+bool SettingsNV_LogWrite(uint16_t key, const void* value, uint16_t length)
+{
+	if((activeSector == LOG_NO_SECTOR) || (key == 0) ||
+	   (key > SETTINGS_NV_LOG_MAX_KEY) ||
+	   (key == SETTINGS_NV_LOG_COMMIT_KEY) ||
+	   (length > SETTINGS_NV_LOG_MAX_LENGTH))
+		return false;
+
+	/* Unchanged value is not written (pending value is the latest one) */
+	uint32_t offset = (pendingIndex[key] != 0) ?
+			pendingIndex[key] : keysIndex[key];
+	if(offset != 0)
+	{
+		const uint8_t* record =
+				SettingsNV_DriverGetSector(activeSector) + offset;
+		if(((*(const uint32_t*)record >> 16) == length) &&
+		   (memcmp(record + sizeof(uint32_t), value, length) == 0))
+			return true;
+	}
+
+	/* Value out of batch is committed at once */
+	if(batchOpened) return AppendRecord(key, value, length);
+	SettingsNV_LogBegin();
+	if(AppendRecord(key, value, length) == false)
+	{
+		SettingsNV_LogRollback();
+		return false;
+	}
+	return SettingsNV_LogCommit();
+}
+
+void SettingsNV_LogBegin()
+{
+	batchOpened = true;
+}
+
+bool SettingsNV_LogCommit()
+{
+	if(batchOpened == false) return false;
+	batchOpened = false;
+
+	/* Nothing was changed */
+	if(HasPending() == false) return true;
+
+	/* Pending records are committed, when the record of commit is written
+	   completely (compacting can index them) */
+	uint32_t sequence = commitSequence + 1;
+	if(AppendRecord(SETTINGS_NV_LOG_COMMIT_KEY, &sequence,
+			LOG_COMMIT_LENGTH) == false)
+	{
+		SettingsNV_LogRollback();
+		return false;
+	}
+	if(HasPending())
+	{
+		ApplyPending();
+		commitSequence = sequence;
+	}
+	return true;
+}
+
+void SettingsNV_LogRollback()
+{
+	batchOpened = false;
+	if(HasPending() == false) return;
+
+	/* Without the record pending records are discarded by the next init
+	   (compacting does not copy them) */
+	memset(pendingIndex, 0, sizeof(pendingIndex));
+	AppendRecord(SETTINGS_NV_LOG_COMMIT_KEY, NULL, LOG_ROLLBACK_LENGTH);
+}
+
+void SettingsNV_LogForEach(void (*callback)(uint16_t key, const void* value,
+		uint16_t length))
+{
+	if(activeSector == LOG_NO_SECTOR) return;
+
+	const uint8_t* base = SettingsNV_DriverGetSector(activeSector);
+	for(uint16_t key = 1; key <= SETTINGS_NV_LOG_MAX_KEY; key++)
+	{
+		if(keysIndex[key] == 0) continue;
+
+		const uint8_t* record = base + keysIndex[key];
+		callback(key, record + sizeof(uint32_t), *(const uint32_t*)record >> 16);
+	}
+}
+
+/* Private functions ---------------------------------------------------------*/
+static enum LogSectorState GetSectorState(uint8_t sector)
+{
+	const uint32_t* header = (const uint32_t*)SettingsNV_DriverGetSector(sector);
+
+	if((header[0] == LOG_ERASED_WORD) && (header[1] == LOG_ERASED_WORD))
+		return IsErased(sector, LOG_HEADER_SIZE) ?
+				LogSectorErased : LogSectorCorrupted;
+	if(header[0] != LOG_MARKER_RECEIVE) return LogSectorCorrupted;
+	if(header[1] == LOG_MARKER_VALID) return LogSectorValid;
+	/* Writing of the second marker could be interrupted */
+	return LogSectorReceive;
+}
+
+static bool IsErased(uint8_t sector, uint32_t offset)
+{
+	const uint8_t* base = SettingsNV_DriverGetSector(sector);
+	uint32_t size = SettingsNV_DriverGetSectorSize();
+
+	for(; offset < size; offset += sizeof(uint32_t))
+	{
+		if(*(const uint32_t*)(base + offset) != LOG_ERASED_WORD) return false;
+	}
+	return true;
+}
+
+static bool Format()
+{
+	const uint32_t header[2] = {LOG_MARKER_RECEIVE, LOG_MARKER_VALID};
+	uint32_t sequence = 0;
+
+	for(uint8_t sector = 0; sector < 2; sector++)
+	{
+		if((IsErased(sector, 0) == false) &&
+		   (SettingsNV_DriverErase(sector) == false))
+			return false;
+	}
+	if(SettingsNV_DriverProgram(0, 0, header, 2) == false) return false;
+
+	activeSector = 0;
+	IndexRecords();
+	return AppendRecord(SETTINGS_NV_LOG_COMMIT_KEY, &sequence,
+			LOG_COMMIT_LENGTH);
+}
+
+/* Return false, if there is no record of commit (log of previous firmware):
+   all records are committed then */
+static bool IndexRecords()
+{
+	const uint8_t* base = SettingsNV_DriverGetSector(activeSector);
+	uint32_t size = SettingsNV_DriverGetSectorSize();
+	uint32_t offset = LOG_HEADER_SIZE;
+	bool committed = false;
+
+	memset(keysIndex, 0, sizeof(keysIndex));
+	memset(pendingIndex, 0, sizeof(pendingIndex));
+	commitSequence = 0;
+	while(offset < size)
+	{
+		uint32_t head = *(const uint32_t*)(base + offset);
+		if(head == LOG_ERASED_WORD) break;
+
+		uint16_t key = head & 0xFFFF;
+		uint16_t length = head >> 16;
+		uint32_t words = LOG_RECORD_WORDS(length);
+		if((key == 0) || (key > SETTINGS_NV_LOG_MAX_KEY) ||
+		   (length > SETTINGS_NV_LOG_MAX_LENGTH) ||
+		   (offset + words * sizeof(uint32_t) > size))
+		{
+			/* Head of record is corrupted: rest of sector is not used */
+			offset = size;
+			break;
+		}
+
+		/* Record with wrong CRC (interrupted writing) is skipped */
+		const uint32_t* record = (const uint32_t*)(base + offset);
+		if(CRC32_Calc(0, record, sizeof(uint32_t) + length) ==
+				record[words - 1])
+		{
+			if(key != SETTINGS_NV_LOG_COMMIT_KEY)
+				pendingIndex[key] = offset;
+			else if(length == LOG_COMMIT_LENGTH)
+			{
+				ApplyPending();
+				commitSequence = record[1];
+				committed = true;
+			}
+			else
+				memset(pendingIndex, 0, sizeof(pendingIndex));
+		}
+		offset += words * sizeof(uint32_t);
+	}
+	if(committed == false) ApplyPending();
+
+	/* Interrupted writing could leave programmed words after the end */
+	if((offset < size) && (IsErased(activeSector, offset) == false))
+		offset = size;
+	freeOffset = offset;
+	return committed;
+}
+
+static void ApplyPending()
+{
+	for(uint16_t key = 1; key <= SETTINGS_NV_LOG_MAX_KEY; key++)
+	{
+		if(pendingIndex[key] != 0) keysIndex[key] = pendingIndex[key];
+		pendingIndex[key] = 0;
+	}
+}
+
+static bool HasPending()
+{
+	for(uint16_t key = 1; key <= SETTINGS_NV_LOG_MAX_KEY; key++)
+	{
+		if(pendingIndex[key] != 0) return true;
+	}
+	return false;
+}
+
+static void PrepareRecord(uint16_t key, const void* value, uint16_t length)
+{
+	uint32_t words = LOG_WORDS(length);
+
+	recordBuff[0] = ((uint32_t)length << 16) | key;
+	if(words != 0) recordBuff[words] = 0;
+	memcpy(&recordBuff[1], value, length);
+	recordBuff[words + 1] = CRC32_Calc(0, recordBuff,
+			sizeof(uint32_t) + length);
+}
+
+/* Record is pending (records of the commit key are not indexed) */
+static bool AppendRecord(uint16_t key, const void* value, uint16_t length)
+{
+	PrepareRecord(key, value, length);
+	uint32_t words = LOG_RECORD_WORDS(length);
+	if(freeOffset + words * sizeof(uint32_t) > SettingsNV_DriverGetSectorSize())
+		return Compact(key);
+
+	if(SettingsNV_DriverProgram(activeSector, freeOffset,
+			recordBuff, words) == false)
+	{
+		/* Rest of sector is not used after the failure */
+		freeOffset = SettingsNV_DriverGetSectorSize();
+		return false;
+	}
+	if(key != SETTINGS_NV_LOG_COMMIT_KEY) pendingIndex[key] = freeOffset;
+	freeOffset += words * sizeof(uint32_t);
+	return true;
+}
+
+/* Copy the committed values of keys and their commit, then pending values and
+   the new record of "newKey" (in recordBuff) to another sector, then erase
+   the full one */
+static bool Compact(uint16_t newKey)
+{
+	const uint8_t* src = SettingsNV_DriverGetSector(activeSector);
+	uint8_t dst = activeSector ^ 1;
+	uint32_t offset = LOG_HEADER_SIZE;
+	uint32_t marker = LOG_MARKER_RECEIVE;
+	uint32_t commitBuff[LOG_RECORD_WORDS(LOG_COMMIT_LENGTH)];
+
+	if((IsErased(dst, 0) == false) && (SettingsNV_DriverErase(dst) == false))
+		return false;
+	if(SettingsNV_DriverProgram(dst, 0, &marker, 1) == false) return false;
+
+	/* Committed values, their commit keeps the sequence number */
+	for(uint16_t key = 1; key <= SETTINGS_NV_LOG_MAX_KEY; key++)
+	{
+		if((keysIndex[key] != 0) && (CopyRecord(dst, &offset,
+				(const uint32_t*)(src + keysIndex[key])) == false))
+			return false;
+	}
+	commitBuff[0] = ((uint32_t)LOG_COMMIT_LENGTH << 16) |
+			SETTINGS_NV_LOG_COMMIT_KEY;
+	commitBuff[1] = commitSequence;
+	commitBuff[2] = CRC32_Calc(0, commitBuff,
+			sizeof(uint32_t) + LOG_COMMIT_LENGTH);
+	if(CopyRecord(dst, &offset, commitBuff) == false) return false;
+
+	/* Batch continues in the new sector */
+	for(uint16_t key = 1; key <= SETTINGS_NV_LOG_MAX_KEY; key++)
+	{
+		if((pendingIndex[key] != 0) && (key != newKey) &&
+		   (CopyRecord(dst, &offset,
+				(const uint32_t*)(src + pendingIndex[key])) == false))
+			return false;
+	}
+	if(CopyRecord(dst, &offset, recordBuff) == false) return false;
+
+	/* The new sector is valid after erasing of the full one */
+	marker = LOG_MARKER_OBSOLETE;
+	bool result =
+			SettingsNV_DriverProgram(activeSector, 0, &marker, 1) &&
+			SettingsNV_DriverErase(activeSector);
+	activeSector = dst;
+	if(result)
+	{
+		marker = LOG_MARKER_VALID;
+		result = SettingsNV_DriverProgram(dst, sizeof(uint32_t), &marker, 1);
+	}
+	IndexRecords();
+	return result;
+}
+
+static bool CopyRecord(uint8_t sector, uint32_t* offset,
+		const uint32_t* record)
+{
+	uint32_t words = LOG_RECORD_WORDS(record[0] >> 16);
+
+	if((*offset + words * sizeof(uint32_t) > SettingsNV_DriverGetSectorSize()) ||
+	   (SettingsNV_DriverProgram(sector, *offset, record, words) == false))
+		return false;
+	*offset += words * sizeof(uint32_t);
+	return true;
+}
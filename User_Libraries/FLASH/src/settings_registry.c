@@ -0,0 +1,190 @@
+/* Registry of stored settings: modules declare typed keys, values are stored
+ * as records "ID, length, value" of NV log. Numbers are little-endian with
+ * declared width, strings are stored without terminator and padding. Length
+ * of stored value is not checked with the key (only range), so firmware with
+ * wider or narrower keys reads the same log.
+ * Setters report changes, so the settings manager sleeps until something is
+ * changed instead of polling getters */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+
+/* Application includes */
+#include "settings_registry.h"
+
+/* Variables -----------------------------------------------------------------*/
+static volatile uint32_t generation = 0;
+static TaskHandle_t xListenerTask = NULL;
+
+/* Keys indexed by IDs */
+static const struct SettingsKey* keysById[SETTINGS_KEY_MAX + 1];
+static uint16_t keysNum = 0;
+static uint16_t restoredNum;
+
+/* Value of key for accessors */
+static union
+{
+	bool b;
+	int32_t i;
+	uint32_t u;
+	char str[SETTINGS_NV_LOG_MAX_LENGTH];
+} valueBuff;
+
+/* Private function prototypes -----------------------------------------------*/
+static void RestoreKey(uint16_t id, const void* value, uint16_t length);
+static bool DecodeValue(const struct SettingsKey* key, const uint8_t* data,
+		uint16_t length);
+static void GetDefaultValue(const struct SettingsKey* key);
+
+/* Public functions ----------------------------------------------------------*/
+bool SettingsRegistryInit(const struct SettingsKeysTable* const* tables,
+		uint8_t num)
+{
+	bool result = true;
+
+	for(uint8_t t = 0; t < num; t++)
+	{
+		for(uint16_t i = 0; i < tables[t]->num; i++)
+		{
+			const struct SettingsKey* key = &tables[t]->keys[i];
+			uint16_t maxSize = (key->type == SettingsTypeString) ?
+					SETTINGS_NV_LOG_MAX_LENGTH : sizeof(uint32_t);
+
+			if((key->id == 0) || (key->id > SETTINGS_KEY_MAX) ||
+			   (keysById[key->id] != NULL) ||
+			   (key->size == 0) || (key->size > maxSize))
+			{
+				result = false;
+				continue;
+			}
+			keysById[key->id] = key;
+			keysNum++;
+		}
+	}
+	return result;
+}
+
+uint16_t SettingsRegistryGetKeysNum()
+{
+	return keysNum;
+}
+
+uint16_t SettingsRegistryRestore()
+{
+	restoredNum = 0;
+	SettingsNV_LogForEach(RestoreKey);
+	return restoredNum;
+}
+
+bool SettingsRegistryStore()
+{
+	bool result = true;
+	uint8_t number[sizeof(uint32_t)];
+
+	for(uint16_t id = 1; id <= SETTINGS_KEY_MAX; id++)
+	{
+		const struct SettingsKey* key = keysById[id];
+		if(key == NULL) continue;
+
+		/* Value is taken in the critical section, flash is written out of it */
+		taskENTER_CRITICAL();
+		{
+			key->get(&valueBuff);
+		}
+		taskEXIT_CRITICAL();
+
+		const void* data = number;
+		uint16_t length = key->size;
+		if(key->type == SettingsTypeString)
+		{
+			data = valueBuff.str;
+			length = strnlen(valueBuff.str, key->size - 1);
+		}
+		else
+		{
+			uint32_t value = (key->type == SettingsTypeBool) ?
+					valueBuff.b : valueBuff.u;
+			for(uint16_t i = 0; i < length; i++)
+			{
+				number[i] = value & 0xFF;
+				value >>= 8;
+			}
+		}
+
+		if(SettingsNV_LogWrite(id, data, length) == false) result = false;
+	}
+	return result;
+}
+
+void SettingsRegistryChanged()
+{
+	taskENTER_CRITICAL();
+	{
+		generation++;
+	}
+	taskEXIT_CRITICAL();
+
+	if(xListenerTask != NULL) xTaskNotifyGive(xListenerTask);
+}
+
+uint32_t SettingsRegistryGetGeneration()
+{
+	return generation;
+}
+
+void SettingsRegistrySetListener(TaskHandle_t xTask)
+{
+	xListenerTask = xTask;
+}
+
+/* Private functions ---------------------------------------------------------*/
+static void RestoreKey(uint16_t id, const void* value, uint16_t length)
+{
+	/* Keys of other versions of firmware are skipped (NV log keeps them) */
+	if((id > SETTINGS_KEY_MAX) || (keysById[id] == NULL)) return;
+
+	const struct SettingsKey* key = keysById[id];
+	if(DecodeValue(key, value, length)) restoredNum++;
+	else GetDefaultValue(key);
+	key->set(&valueBuff);
+}
+
+static bool DecodeValue(const struct SettingsKey* key, const uint8_t* data,
+		uint16_t length)
+{
+	if(key->type == SettingsTypeString)
+	{
+		/* String is truncated to the buffer (padding is ended by zero) */
+		if(length > key->size - 1) length = key->size - 1;
+		memcpy(valueBuff.str, data, length);
+		valueBuff.str[length] = '\0';
+		return true;
+	}
+
+	/* Numbers have 1..4 bytes */
+	if((length == 0) || (length > sizeof(uint32_t))) return false;
+
+	uint32_t value = 0;
+	for(uint16_t i = length; i > 0; i--) value = (value << 8) | data[i - 1];
+	int64_t num = value;
+	if((key->type == SettingsTypeInt) && (data[length - 1] & 0x80))
+		num -= (int64_t)1 << (8 * length);
+	if((num < key->min) || (num > key->max)) return false;
+
+	if(key->type == SettingsTypeBool) valueBuff.b = (num != 0);
+	else if(key->type == SettingsTypeInt) valueBuff.i = (int32_t)num;
+	else valueBuff.u = (uint32_t)num;
+	return true;
+}
+
+static void GetDefaultValue(const struct SettingsKey* key)
+{
+	if(key->type == SettingsTypeString)
+	{
+		strncpy(valueBuff.str, key->defStr, key->size - 1);
+		valueBuff.str[key->size - 1] = '\0';
+	}
+	else if(key->type == SettingsTypeBool) valueBuff.b = (key->def != 0);
+	else if(key->type == SettingsTypeInt) valueBuff.i = (int32_t)key->def;
+	else valueBuff.u = (uint32_t)key->def;
+}
@@ -0,0 +1,146 @@
+/* Ring of the event log (event_log.c) on the host: appending never erases
+   flash, the full log drops records until the owner task erases the oldest
+   sector (EventLogEraseNext), and the log is found again after reset */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+
+/* Application includes */
+#include "event_log.h"
+#include "crc32.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define RING_SECTORS			4
+#define RING_SECTOR_SIZE		1024
+#define RING_SECTOR_RECORDS		(RING_SECTOR_SIZE / EVENT_LOG_RECORD_SIZE)
+
+/* Variables -----------------------------------------------------------------*/
+static uint32_t flash[RING_SECTORS][RING_SECTOR_SIZE / sizeof(uint32_t)];
+static uint32_t erases = 0;
+static uint32_t appended = 0;
+
+/* Private function prototypes -----------------------------------------------*/
+static bool Append(uint32_t num);
+static uint32_t LastSequence();
+static bool Check(bool condition, const char* error);
+
+/* Public functions ----------------------------------------------------------*/
+int main()
+{
+	const struct EventLogStats* stats = EventLogGetStats();
+
+	/* Readers of dumps check records with zlib.crc32 */
+	if(!Check((CRC32_Calc(0, "123456789", 9) == 0xCBF43926) &&
+			(CRC32_Calc(CRC32_Calc(0, "1234", 4), "56789", 5) == 0xCBF43926),
+			"CRC-32 differs from zlib")) return 1;
+
+	memset(flash, 0xFF, sizeof(flash));
+	if(!Check(EventLogInit() && (EventLogNeedsErase() == false),
+			"log is not started on erased flash")) return 1;
+
+	/* All sectors are filled without erasing, then records are dropped */
+	if(!Check(Append(RING_SECTORS * RING_SECTOR_RECORDS),
+			"records of free sectors are not appended")) return 1;
+	if(!Check(EventLogNeedsErase() && (erases == 0),
+			"appending erases flash")) return 1;
+	if(!Check((Append(10) == false) && (stats->dropped == 10) &&
+			(erases == 0), "full log does not drop records")) return 1;
+
+	/* Erasing of the oldest sector lets the log go on */
+	if(!Check(EventLogEraseNext() && (erases == 1) &&
+			(flash[0][0] == 0xFFFFFFFF), "oldest sector is not erased"))
+		return 1;
+	if(!Check(Append(RING_SECTOR_RECORDS / 2), "records are not appended "
+			"after erasing")) return 1;
+	EventLogFlush();
+
+	/* Next sector is erased ahead, while the active one is filled */
+	if(!Check(EventLogNeedsErase() && EventLogEraseNext() &&
+			(EventLogNeedsErase() == false) && (erases == 2),
+			"next sector is not erased ahead")) return 1;
+
+	/* Reset: the log goes on after the last record, nothing is erased */
+	uint32_t last = LastSequence();
+	if(!Check(EventLogInit() && (EventLogNeedsErase() == false) &&
+			(erases == 2), "log is not found after reset")) return 1;
+	if(!Check(Append(RING_SECTOR_RECORDS), "records are not appended after "
+			"reset")) return 1;
+	EventLogFlush();
+	if(!Check(LastSequence() == last + RING_SECTOR_RECORDS,
+			"sequence does not go on after reset")) return 1;
+
+	printf("%u records, %u dropped, %u erases\n", appended,
+			stats->dropped, erases);
+	printf("PASS\n");
+	return 0;
+}
+
+/* Driver functions ----------------------------------------------------------*/
+uint8_t EventLogDriverGetSectorsNum()
+{
+	return RING_SECTORS;
+}
+
+uint32_t EventLogDriverGetSectorSize()
+{
+	return RING_SECTOR_SIZE;
+}
+
+const uint8_t* EventLogDriverGetSector(uint8_t sector)
+{
+	return (const uint8_t*)flash[sector];
+}
+
+bool EventLogDriverErase(uint8_t sector)
+{
+	memset(flash[sector], 0xFF, sizeof(flash[sector]));
+	erases++;
+	return true;
+}
+
+bool EventLogDriverProgram(uint8_t sector, uint32_t offset,
+		const uint32_t* data, uint32_t length)
+{
+	for(uint32_t i = 0; i < length; i++)
+		flash[sector][offset / sizeof(uint32_t) + i] &= data[i];
+	return true;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/* Return false, if any of records is not appended */
+static bool Append(uint32_t num)
+{
+	bool result = true;
+
+	for(uint32_t i = 0; i < num; i++)
+	{
+		if(EventLogAppend(1, EVENT_LOG_TEXT, appended, 0, "event", 5))
+			appended++;
+		else
+			result = false;
+	}
+	return result;
+}
+
+/* The latest sequence number in flash */
+static uint32_t LastSequence()
+{
+	const struct EventLogRecord* records =
+			(const struct EventLogRecord*)flash;
+	uint32_t last = 0;
+
+	for(uint32_t i = 0; i < RING_SECTORS * RING_SECTOR_RECORDS; i++)
+	{
+		if((records[i].sequence != EVENT_LOG_FREE) &&
+		   (records[i].sequence > last))
+			last = records[i].sequence;
+	}
+	return last;
+}
+
+static bool Check(bool condition, const char* error)
+{
+	if(condition == false) printf("FAIL: %s\n", error);
+	return condition;
+}
@@ -0,0 +1,106 @@
+/* Host model of the settings flash: SettingsNV_Driver*() functions over RAM
+   with the power cut injection */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+
+/* Application includes */
+#include "settings_NV_log.h"
+#include "flash_sim.h"
+
+/* Variables -----------------------------------------------------------------*/
+struct FlashSim flashSim;
+jmp_buf flashSimCut;
+
+static long cutStep = FLASH_SIM_NO_CUT;
+static long steps;
+
+/* Private function prototypes -----------------------------------------------*/
+static bool Step();
+
+/* Public functions ----------------------------------------------------------*/
+void FlashSimInit(uint32_t sectorSize)
+{
+	memset(&flashSim, 0xFF, sizeof(flashSim));
+	memset(flashSim.erases, 0, sizeof(flashSim.erases));
+	flashSim.sectorSize = sectorSize;
+	FlashSimSetCut(FLASH_SIM_NO_CUT);
+}
+
+void FlashSimSetCut(long step)
+{
+	cutStep = step;
+	steps = 0;
+}
+
+long FlashSimGetSteps()
+{
+	return steps;
+}
+
+/* Driver functions ----------------------------------------------------------*/
+uint32_t SettingsNV_DriverGetSectorSize()
+{
+	return flashSim.sectorSize;
+}
+
+const uint8_t* SettingsNV_DriverGetSector(uint8_t sector)
+{
+	return (const uint8_t*)flashSim.data[sector];
+}
+
+bool SettingsNV_DriverErase(uint8_t sector)
+{
+	uint8_t* base = (uint8_t*)flashSim.data[sector];
+	uint32_t half = flashSim.sectorSize / 2;
+
+	if(sector >= FLASH_SIM_SECTORS) return false;
+
+	/* Interrupted erase: one half of the sector is erased, another one is
+	   not touched */
+	if(Step())
+	{
+		memset(base, 0xFF, half);
+		longjmp(flashSimCut, 1);
+	}
+	if(Step())
+	{
+		memset(base + half, 0xFF, half);
+		longjmp(flashSimCut, 1);
+	}
+
+	memset(base, 0xFF, flashSim.sectorSize);
+	flashSim.erases[sector]++;
+	return true;
+}
+
+bool SettingsNV_DriverProgram(uint8_t sector, uint32_t offset,
+		const uint32_t* data, uint32_t length)
+{
+	uint8_t* dst = (uint8_t*)flashSim.data[sector] + offset;
+	const uint8_t* src = (const uint8_t*)data;
+
+	if((sector >= FLASH_SIM_SECTORS) || (offset % sizeof(uint32_t)) ||
+	   (offset + length * sizeof(uint32_t) > flashSim.sectorSize))
+		return false;
+
+	/* Bits are only cleared: bytes are programmed one by one */
+	for(uint32_t i = 0; i < length * sizeof(uint32_t); i++)
+	{
+		if(Step())
+		{
+			/* Torn byte: only a half of its bits is programmed */
+			dst[i] &= src[i] | 0xF0;
+			longjmp(flashSimCut, 1);
+		}
+		dst[i] &= src[i];
+	}
+	return true;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/* Return true, if the power is cut at this step */
+static bool Step()
+{
+	return steps++ == cutStep;
+}
@@ -0,0 +1,45 @@
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _FLASH_SIM_H_
+#define _FLASH_SIM_H_
+
+/* Includes ------------------------------------------------------------------*/
+/* Standard includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <setjmp.h>
+
+/* Public constants ----------------------------------------------------------*/
+/* Sectors of the settings log */
+#define FLASH_SIM_SECTORS			2
+#define FLASH_SIM_MAX_SECTOR_SIZE	0x4000
+
+/* Power cut is not planned */
+#define FLASH_SIM_NO_CUT			(-1L)
+
+/* Public types --------------------------------------------------------------*/
+/* Contents and wear of the flash (saved and restored by tests) */
+struct FlashSim
+{
+	uint32_t sectorSize;
+	uint32_t erases[FLASH_SIM_SECTORS];
+	uint32_t data[FLASH_SIM_SECTORS][FLASH_SIM_MAX_SECTOR_SIZE / 4];
+};
+
+/* Public variables ----------------------------------------------------------*/
+extern struct FlashSim flashSim;
+/* Power cut returns here: longjmp() with 1 */
+extern jmp_buf flashSimCut;
+
+/* Public function prototypes ------------------------------------------------*/
+/* Host model of the flash behind SettingsNV_Driver*(): programming only
+   clears bits, erase sets the whole sector to 0xFF and counts the wear.
+   Operations are counted in steps: every programmed byte is a step, erase is
+   two steps. Power cut at a step leaves it half done (the byte has a part of
+   its bits programmed, the sector has one of its halves erased) */
+void FlashSimInit(uint32_t sectorSize);
+/* Cut the power at the step (counted from this call) or FLASH_SIM_NO_CUT */
+void FlashSimSetCut(long step);
+/* Steps done since FlashSimSetCut() */
+long FlashSimGetSteps();
+
+#endif /* _FLASH_SIM_H_ */
@@ -0,0 +1,208 @@
+/* Power failure of the settings log (settings_NV_log.c) on the host: the
+   scenario of batches, single writes and rollbacks is cut at every byte of
+   programming and in the middle of every erase (see flash_sim.c). After the
+   cut the log is initialized again and it has to keep the values of the last
+   or of the interrupted transaction, never a part of a batch. Small sectors
+   make the scenario pass through compacting several times */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+
+/* Application includes */
+#include "settings_NV_log.h"
+#include "flash_sim.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define FAULTS_SECTOR_SIZE		512
+#define FAULTS_KEYS				6
+#define FAULTS_TRANSACTIONS		100
+#define FAULTS_MAX_LENGTH		12
+
+/* Private types -------------------------------------------------------------*/
+struct FaultsValue
+{
+	uint16_t length;
+	uint8_t data[FAULTS_MAX_LENGTH];
+};
+
+/* Values of keys after every transaction of the scenario */
+struct FaultsState
+{
+	struct FaultsValue values[FAULTS_KEYS + 1];
+};
+
+/* Variables -----------------------------------------------------------------*/
+static struct FaultsState expected[FAULTS_TRANSACTIONS + 1];
+static struct FlashSim initial;
+/* Transactions finished before the cut */
+static volatile uint32_t done;
+
+/* Private function prototypes -----------------------------------------------*/
+static void MakeValue(struct FaultsValue* value, uint16_t key, uint32_t t);
+static bool InBatch(uint32_t t, uint16_t key);
+static void RunTransaction(uint32_t t);
+static bool IsState(const struct FaultsState* state, uint16_t firstKey);
+static bool CheckCut(long step);
+
+/* Public functions ----------------------------------------------------------*/
+int main()
+{
+	long step;
+
+	/* Initial values are committed, the scenario starts from them */
+	FlashSimInit(FAULTS_SECTOR_SIZE);
+	SettingsNV_LogInit();
+	for(uint16_t key = 1; key <= FAULTS_KEYS; key++)
+	{
+		MakeValue(&expected[0].values[key], key, 0);
+		SettingsNV_LogWrite(key, expected[0].values[key].data,
+				expected[0].values[key].length);
+	}
+	initial = flashSim;
+
+	/* Expected values: rollbacks (every 5th transaction) change nothing */
+	for(uint32_t t = 1; t <= FAULTS_TRANSACTIONS; t++)
+	{
+		expected[t] = expected[t - 1];
+		if((t % 5) == 0) continue;
+		for(uint16_t key = 1; key <= FAULTS_KEYS; key++)
+		{
+			if(InBatch(t, key)) MakeValue(&expected[t].values[key], key, t);
+		}
+	}
+
+	/* Power is cut at every step until the scenario is finished */
+	for(step = 0; ; step++)
+	{
+		if(CheckCut(step) == false) return 1;
+		if(done == FAULTS_TRANSACTIONS) break;
+	}
+
+	printf("%ld power cuts, %u erases of the whole scenario\n",
+			step, flashSim.erases[0] + flashSim.erases[1] -
+			initial.erases[0] - initial.erases[1]);
+	printf("PASS\n");
+	return 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+static void MakeValue(struct FaultsValue* value, uint16_t key, uint32_t t)
+{
+	/* Length changes too: records of the key differ in size */
+	value->length = 1 + (key + t) % FAULTS_MAX_LENGTH;
+	for(uint16_t i = 0; i < value->length; i++)
+		value->data[i] = (uint8_t)(key * 31 + t * 7 + i);
+}
+
+/* Transaction changes 1..3 keys: single keys are written out of batch */
+static bool InBatch(uint32_t t, uint16_t key)
+{
+	uint16_t first = 1 + t % FAULTS_KEYS;
+	uint16_t num = 1 + t % 3;
+
+	return ((key + FAULTS_KEYS - first) % FAULTS_KEYS) < num;
+}
+
+static void RunTransaction(uint32_t t)
+{
+	struct FaultsValue value;
+	uint16_t num = 0;
+
+	for(uint16_t key = 1; key <= FAULTS_KEYS; key++)
+	{
+		if(InBatch(t, key)) num++;
+	}
+
+	/* Rolled back batch leaves its values pending only */
+	if((num > 1) || ((t % 5) == 0)) SettingsNV_LogBegin();
+	for(uint16_t key = 1; key <= FAULTS_KEYS; key++)
+	{
+		if(InBatch(t, key) == false) continue;
+
+		MakeValue(&value, key, t);
+		SettingsNV_LogWrite(key, value.data, value.length);
+	}
+	if((t % 5) == 0) SettingsNV_LogRollback();
+	else if(num > 1) SettingsNV_LogCommit();
+}
+
+/* Return true, if the log reads the values of the state (keys from the
+   first one) */
+static bool IsState(const struct FaultsState* state, uint16_t firstKey)
+{
+	uint8_t data[SETTINGS_NV_LOG_MAX_LENGTH];
+
+	for(uint16_t key = firstKey; key <= FAULTS_KEYS; key++)
+	{
+		const struct FaultsValue* value = &state->values[key];
+		if((SettingsNV_LogRead(key, data, sizeof(data)) != value->length) ||
+		   memcmp(data, value->data, value->length))
+			return false;
+	}
+	return true;
+}
+
+/* Run the scenario with the power cut at the step, then check the log after
+   reset. Return false on error */
+static bool CheckCut(long step)
+{
+	struct FaultsValue value;
+
+	flashSim = initial;
+	done = 0;
+	SettingsNV_LogInit();
+
+	FlashSimSetCut(step);
+	if(setjmp(flashSimCut) == 0)
+	{
+		for(uint32_t t = 1; t <= FAULTS_TRANSACTIONS; t++)
+		{
+			RunTransaction(t);
+			done = t;
+		}
+	}
+	FlashSimSetCut(FLASH_SIM_NO_CUT);
+
+	/* Reset: values of the finished transaction or of the interrupted one */
+	if(SettingsNV_LogInit() == false)
+	{
+		printf("FAIL: step %ld: log is lost\n", step);
+		return false;
+	}
+	uint32_t t = done;
+	if(IsState(&expected[t], 1) == false)
+	{
+		if((t == FAULTS_TRANSACTIONS) ||
+		   (IsState(&expected[t + 1], 1) == false))
+		{
+			printf("FAIL: step %ld: values differ from transactions %u and %u\n",
+					step, t, t + 1);
+			return false;
+		}
+		t++;
+	}
+
+	/* The log is usable after recovery: the next value is stored, and it does
+	   not commit the rest of the interrupted batch */
+	MakeValue(&value, 1, FAULTS_TRANSACTIONS + 1);
+	if((SettingsNV_LogWrite(1, value.data, value.length) == false) ||
+	   (SettingsNV_LogInit() == false))
+	{
+		printf("FAIL: step %ld: log is not writable after recovery\n", step);
+		return false;
+	}
+	uint8_t data[SETTINGS_NV_LOG_MAX_LENGTH];
+	if((SettingsNV_LogRead(1, data, sizeof(data)) != value.length) ||
+	   memcmp(data, value.data, value.length))
+	{
+		printf("FAIL: step %ld: value after recovery is lost\n", step);
+		return false;
+	}
+	if(IsState(&expected[t], 2) == false)
+	{
+		printf("FAIL: step %ld: interrupted batch is committed later\n", step);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,220 @@
+/* Wear of the settings log (settings_NV_log.c) on the host: random values of
+   keys are written to two sectors of 16 KBytes, every value is read back and
+   the whole log is checked after re-init. The sectors have to be erased in
+   turn, and only once per sector of changed data. At the end the states left
+   by power failure at the end of compacting are recovered */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+
+/* Application includes */
+#include "settings_NV_log.h"
+#include "flash_sim.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define WEAR_SECTOR_SIZE		0x4000
+#define WEAR_KEYS				32
+#define WEAR_MAX_LENGTH			32
+#define WEAR_WRITES				200000
+/* Re-init (reset of the device) period, writes */
+#define WEAR_REINIT_PERIOD		997
+/* Endurance of STM32F4 flash, erase cycles */
+#define WEAR_ENDURANCE			10000
+
+/* Header words of sector (see settings_NV_log.c) */
+#define WEAR_MARKER_RECEIVE		((uint32_t)0x474F4C52)
+#define WEAR_MARKER_VALID		((uint32_t)0x474F4C56)
+
+/* Private types -------------------------------------------------------------*/
+struct WearValue
+{
+	uint16_t length;
+	uint8_t data[WEAR_MAX_LENGTH];
+};
+
+/* Variables -----------------------------------------------------------------*/
+static struct WearValue model[WEAR_KEYS + 1];
+static uint32_t seed = 0x2545F491;
+static uint32_t errors = 0;
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t Random();
+static void CheckKey(uint16_t key, const char* when);
+static void CheckAll(const char* when);
+static bool CheckRecovery();
+
+/* Public functions ----------------------------------------------------------*/
+int main()
+{
+	uint32_t payload = 0;
+	uint32_t changes = 0;
+
+	FlashSimInit(WEAR_SECTOR_SIZE);
+	if(SettingsNV_LogInit() != false)
+	{
+		printf("FAIL: empty flash is read as a log\n");
+		return 1;
+	}
+
+	for(uint32_t i = 0; (i < WEAR_WRITES) && (errors == 0); i++)
+	{
+		uint16_t key = 1 + Random() % WEAR_KEYS;
+		struct WearValue value = model[key];
+		bool changed;
+
+		/* Settings are saved as a whole: most of values are the same */
+		if((Random() % 4 == 0) || (value.length == 0))
+		{
+			value.length = 1 + Random() % WEAR_MAX_LENGTH;
+			for(uint16_t j = 0; j < value.length; j++)
+				value.data[j] = (uint8_t)Random();
+		}
+		changed = (model[key].length != value.length) ||
+				memcmp(model[key].data, value.data, value.length);
+
+		FlashSimSetCut(FLASH_SIM_NO_CUT);
+		if(SettingsNV_LogWrite(key, value.data, value.length) == false)
+		{
+			printf("FAIL: write %u of key %u\n", i, key);
+			return 1;
+		}
+		if(changed)
+		{
+			changes++;
+			payload += value.length;
+		}
+		else if(FlashSimGetSteps() != 0)
+		{
+			printf("FAIL: unchanged key %u is written\n", key);
+			return 1;
+		}
+		model[key] = value;
+		CheckKey(key, "after write");
+
+		if((i % WEAR_REINIT_PERIOD) == 0)
+		{
+			if(SettingsNV_LogInit() == false)
+			{
+				printf("FAIL: log is lost after write %u\n", i);
+				return 1;
+			}
+			CheckAll("after re-init");
+		}
+	}
+	if(errors) return 1;
+
+	uint32_t erases0 = flashSim.erases[0];
+	uint32_t erases1 = flashSim.erases[1];
+	uint32_t erases = erases0 + erases1;
+	printf("%u writes, %u changes (%u bytes of values)\n",
+			WEAR_WRITES, changes, payload);
+	printf("erases: sector 0 - %u, sector 1 - %u\n", erases0, erases1);
+	if(erases)
+	{
+		printf("changes per erase: %u, lifetime: %llu changes\n",
+				changes / erases, (unsigned long long)changes *
+				WEAR_ENDURANCE * 2 / erases);
+	}
+
+	/* Sectors are erased in turn (Format erases nothing on empty flash) */
+	if((erases0 > erases1 + 1) || (erases1 > erases0 + 1))
+	{
+		printf("FAIL: sectors are worn unevenly\n");
+		return 1;
+	}
+
+	/* Record takes value, head and CRC, each compacting copies the live keys:
+	   more erases mean the sector is not filled before compacting */
+	uint32_t live = WEAR_KEYS * (WEAR_MAX_LENGTH + 8) + 64;
+	uint32_t recorded = payload + changes * (8 + 3) + changes * 12;
+	if((erases == 0) ||
+	   (erases > recorded / (WEAR_SECTOR_SIZE - live) + 1))
+	{
+		printf("FAIL: %u erases for %u bytes of records\n", erases, recorded);
+		return 1;
+	}
+
+	if(CheckRecovery() == false) return 1;
+	printf("PASS\n");
+	return 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/* Deterministic xorshift32: the runs are the same */
+static uint32_t Random()
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed;
+}
+
+static void CheckKey(uint16_t key, const char* when)
+{
+	uint8_t data[SETTINGS_NV_LOG_MAX_LENGTH];
+	uint16_t length = SettingsNV_LogRead(key, data, sizeof(data));
+
+	if((length != model[key].length) ||
+	   memcmp(data, model[key].data, length))
+	{
+		if(errors++ < 10)
+			printf("FAIL: key %u is wrong %s\n", key, when);
+	}
+}
+
+static void CheckAll(const char* when)
+{
+	for(uint16_t key = 1; key <= WEAR_KEYS; key++) CheckKey(key, when);
+}
+
+/* Compacting ends with the marker of the new sector after erasing of the full
+   one: power failure could tear the marker or the erasing */
+static bool CheckRecovery()
+{
+	uint32_t size = WEAR_SECTOR_SIZE / sizeof(uint32_t);
+	uint8_t active = (flashSim.data[0][1] == WEAR_MARKER_VALID) ? 0 : 1;
+	uint8_t full = active ^ 1;
+
+	/* Torn marker: a half of its bits is programmed */
+	flashSim.data[active][1] = WEAR_MARKER_VALID | 0xFFFF0000;
+	if(SettingsNV_LogInit() == false)
+	{
+		printf("FAIL: log with torn marker is lost\n");
+		return false;
+	}
+	CheckAll("with torn marker");
+	if(flashSim.data[active][1] != WEAR_MARKER_VALID)
+	{
+		printf("FAIL: torn marker is not completed\n");
+		return false;
+	}
+
+	/* Erasing of the full sector (its marker is cleared) is interrupted,
+	   either half of it is left, the new sector has no second marker */
+	for(uint8_t half = 0; half < 2; half++)
+	{
+		memcpy(flashSim.data[full], flashSim.data[active],
+				sizeof(flashSim.data[full]));
+		flashSim.data[full][0] = 0;
+		memset(&flashSim.data[full][half * size / 2], 0xFF,
+				size / 2 * sizeof(uint32_t));
+		flashSim.data[active][1] = 0xFFFFFFFF;
+
+		if(SettingsNV_LogInit() == false)
+		{
+			printf("FAIL: log with half-erased sector is lost\n");
+			return false;
+		}
+		CheckAll("with half-erased sector");
+		if((flashSim.data[active][1] != WEAR_MARKER_VALID) ||
+		   (flashSim.data[full][0] != 0xFFFFFFFF) ||
+		   (flashSim.data[full][size / 2] != 0xFFFFFFFF))
+		{
+			printf("FAIL: half-erased sector is not recovered\n");
+			return false;
+		}
+	}
+
+	return errors == 0;
+}
@@ -242,6 +242,38 @@ void ExternResetWD()
 	ResetWDG();
 }
 
+/* Random number of the hardware generator (RNG), it is used where pseudo random
+uxRand() is not enough (authorization tokens). Return false on RNG failure */
+bool GetHardwareRandom(uint32_t* value)
+{
+	/* Generator is enabled at the first use (48 MHz clock of PLL "Q") */
+	if((RNG->CR & RNG_CR_RNGEN) == 0)
+	{
+		__HAL_RCC_RNG_CLK_ENABLE();
+		RNG->CR |= RNG_CR_RNGEN;
+	}
+
+	for(uint16_t i = 0; i < 1000; i++)
+	{
+		uint32_t status = RNG->SR;
+		if(status & (RNG_SR_SEIS | RNG_SR_CEIS))
+		{
+			/* Seed or clock error: restart the generator, the next numbers
+			   are checked by it once again */
+			RNG->SR = 0;
+			RNG->CR &= ~RNG_CR_RNGEN;
+			RNG->CR |= RNG_CR_RNGEN;
+			continue;
+		}
+		if(status & RNG_SR_DRDY)
+		{
+			*value = RNG->DR;
+			return true;
+		}
+	}
+	return false;
+}
+
 /* Assert functions --------------------------------------------------------- */
 #ifdef USE_FULL_ASSERT
 void assert_failed(uint8_t* file, uint32_t line)
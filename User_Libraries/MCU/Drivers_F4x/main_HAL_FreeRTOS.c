@@ -34,6 +34,10 @@
 #define MMIO32(addr) 				(*(volatile uint32_t *)(addr))
 #define U_ID 						0x1FFF7A10
 
+/* Run time counter is CPU cycles divided by 2^14 (about 10 kHz at 168 MHz):
+   32-bit counters of tasks wrap after 4 days */
+#define RUN_TIME_COUNTER_SHIFT		14
+
 /* Debug options -------------------------------------------------------------*/
 //#define DEBUG_MAIN_INIT_SEQUENCE
 //#define DEBUG_APP_IDLE_HOOK
@@ -137,6 +141,9 @@ void vApplicationTickHook(void)
 	/* Time-critical task */
 	MainAppTimeCriticalProcess();
 	MainAppTimeCriticalTask();
+
+	/* Wrap of cycles counter must be noticed (once per 25 s at 168 MHz) */
+	RunTimeCounterGet();
 }
 
 /* Additional public functions -----------------------------------------------*/
@@ -168,6 +175,36 @@ extern uint32_t ulApplicationGetNextSequenceNumber(
 	return uxRand();
 }
 
+/* Run time statistics of tasks: DWT cycles counter extended to 64 bits */
+static uint32_t runTimeCyclesHigh;
+static uint32_t runTimeCyclesLast;
+
+void RunTimeCounterInit()
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+uint32_t RunTimeCounterGet()
+{
+	/* It is called by context switch, tick hook and tasks */
+	UBaseType_t uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	uint32_t cycles = DWT->CYCCNT;
+	if(cycles < runTimeCyclesLast) runTimeCyclesHigh++;
+	runTimeCyclesLast = cycles;
+	uint32_t high = runTimeCyclesHigh;
+	portCLEAR_INTERRUPT_MASK_FROM_ISR(uxSavedInterruptStatus);
+
+	return (high << (32 - RUN_TIME_COUNTER_SHIFT)) |
+			(cycles >> RUN_TIME_COUNTER_SHIFT);
+}
+
+uint32_t RunTimeCounterGetHz()
+{
+	return SystemCoreClock >> RUN_TIME_COUNTER_SHIFT;
+}
+
 /* Read U_ID register */
 void uid_read(struct Unique_ID *id)
 {
@@ -249,6 +286,38 @@ void ExternResetWD()
 	ResetWD();
 }
 
+/* Random number of the hardware generator (RNG), it is used where pseudo random
+uxRand() is not enough (authorization tokens). Return false on RNG failure */
+bool GetHardwareRandom(uint32_t* value)
+{
+	/* Generator is enabled at the first use (48 MHz clock of PLL "Q") */
+	if((RNG->CR & RNG_CR_RNGEN) == 0)
+	{
+		__HAL_RCC_RNG_CLK_ENABLE();
+		RNG->CR |= RNG_CR_RNGEN;
+	}
+
+	for(uint16_t i = 0; i < 1000; i++)
+	{
+		uint32_t status = RNG->SR;
+		if(status & (RNG_SR_SEIS | RNG_SR_CEIS))
+		{
+			/* Seed or clock error: restart the generator, the next numbers
+			   are checked by it once again */
+			RNG->SR = 0;
+			RNG->CR &= ~RNG_CR_RNGEN;
+			RNG->CR |= RNG_CR_RNGEN;
+			continue;
+		}
+		if(status & RNG_SR_DRDY)
+		{
+			*value = RNG->DR;
+			return true;
+		}
+	}
+	return false;
+}
+
 /* Assert functions ----------------------------------------------------------*/
 #ifdef USE_FULL_ASSERT
 void assert_failed(uint8_t* file, uint32_t line)
@@ -31,5 +31,11 @@ void uid_read(struct Unique_ID *id);
 /* Some CPU functions */
 void SoftResetCPU();
 void ExternResetWD();
+bool GetHardwareRandom(uint32_t* value);
+
+/* Counter of run time statistics of tasks and its frequency */
+void RunTimeCounterInit();
+uint32_t RunTimeCounterGet();
+uint32_t RunTimeCounterGetHz();
 
 #endif /* _MAIN_APP_H_ */
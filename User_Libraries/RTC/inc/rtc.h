@@ -9,6 +9,7 @@
 
 /* Settings include */
 #include "settings.h"
+#include "settings_registry.h"
 
 /* Public constants ----------------------------------------------------------*/
 enum AM_PM
@@ -54,6 +55,10 @@ struct DateTime
 	uint8_t second;	// 0..59
 };
 
+/* Public variables ----------------------------------------------------------*/
+/* Keys of date and time settings (IDs 8, 9) */
+extern const struct SettingsKeysTable RTC_SettingsKeys;
+
 /* Public function prototypes ------------------------------------------------*/
 /* Init and registration per-second task functions */
 void RTC_Init();
@@ -97,4 +102,9 @@ void RTC_SetSystemCounter(uint32_t counter);
 void RTC_SetSystemCounterWithTicks(uint32_t counter, uint16_t ticks);
 bool RTC_GetTimeIsValide();
 
+/* High resolution timestamp: system counter and fraction of second in
+   1/65536 s. It is cheap (the counter is updated once per second) and may be
+   called from interrupts */
+void RTC_GetTimestamp(uint32_t* counter, uint16_t* fraction);
+
 #endif /* _RTC_H_ */
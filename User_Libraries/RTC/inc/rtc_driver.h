@@ -9,6 +9,11 @@
 
 /* Application includes */
 #include "rtc.h"
+#include "settings_registry.h"
+
+/* Public variables ----------------------------------------------------------*/
+/* Keys of RTC correction (IDs 13, 14) */
+extern const struct SettingsKeysTable RTC_DriverSettingsKeys;
 
 /* Public functions prototypes -----------------------------------------------*/
 /* Init and task driver functions */
@@ -19,6 +24,8 @@ bool RTC_DriverGetHW_Ok();
 /* RTC functions */
 void RTC_DriverGetDateTime(struct DateTime* dateTime, uint16_t* ticks);
 void RTC_DriverSetDateTime(struct DateTime* dateTime, uint16_t ticks);
+/* Fraction of current second in 1/65536 s */
+uint16_t RTC_DriverGetFraction();
 
 bool RTC_GetBKP_GetSetDataFncPtr(
 		uint32_t (**pGetDataFnc)(), void (**pSetDataFnc)(uint32_t));
@@ -15,6 +15,7 @@
 
 /* Application includes */
 #include "rtc.h"
+#include "settings_registry.h"
 
 /* Constants -----------------------------------------------------------------*/
 #ifndef RTC_CLOCK_DELAY_PER_SEC_IT
@@ -546,8 +547,51 @@ void RTC_DriverSetCorrection(uint8_t addedPulses, uint32_t pulsesValue)
 	bkUpAccessFlags &= ~(1 << RTC_BK_UP_ACCESS_RTC_CORRECT);
 	/* Check back-up access flags */
 	if(bkUpAccessFlags == 0) HAL_PWR_DisableBkUpAccess();
+
+	SettingsRegistryChanged();
+}
+
+/* Settings keys: pulses are set in pair, each key keeps another value */
+static void AddedPulses_Get(void* value)
+{
+	uint8_t addedPulses;
+	uint32_t pulsesValue;
+	RTC_DriverGetCorrection(&addedPulses, &pulsesValue);
+	*(uint32_t*)value = addedPulses;
+}
+
+static void AddedPulses_Set(const void* value)
+{
+	uint8_t addedPulses;
+	uint32_t pulsesValue;
+	RTC_DriverGetCorrection(&addedPulses, &pulsesValue);
+	RTC_DriverSetCorrection(*(const uint32_t*)value, pulsesValue);
 }
 
+static void PulsesValue_Get(void* value)
+{
+	uint8_t addedPulses;
+	uint32_t pulsesValue;
+	RTC_DriverGetCorrection(&addedPulses, &pulsesValue);
+	*(uint32_t*)value = pulsesValue;
+}
+
+static void PulsesValue_Set(const void* value)
+{
+	uint8_t addedPulses;
+	uint32_t pulsesValue;
+	RTC_DriverGetCorrection(&addedPulses, &pulsesValue);
+	RTC_DriverSetCorrection(addedPulses, *(const uint32_t*)value);
+}
+
+static const struct SettingsKey RTC_DriverKeys[] =
+{
+	SETTINGS_KEY_UINT(13, AddedPulses, uint8_t, 0, 1, 0),
+	SETTINGS_KEY_UINT(14, PulsesValue, uint32_t, 0, 0x1FF, 0),
+};
+const struct SettingsKeysTable RTC_DriverSettingsKeys =
+		SETTINGS_KEYS_TABLE(RTC_DriverKeys);
+
 
 void RTC_DriverGetDateTime(struct DateTime* dateTime, uint16_t* ticks)
 {
@@ -576,6 +620,14 @@ void RTC_DriverGetDateTime(struct DateTime* dateTime, uint16_t* ticks)
 #endif /* DEBUG_RTC_GET_TIME */
 }
 
+uint16_t RTC_DriverGetFraction()
+{
+	/* Sub-seconds register counts down from the synchronous prescaler */
+	uint32_t subSeconds = (uint32_t)(hRTC.Instance->SSR);
+	return (uint16_t)(((RTC_SYNCH_PREDIV - subSeconds) << 16)/
+			(RTC_SYNCH_PREDIV + 1));
+}
+
 void RTC_DriverSetDateTime(struct DateTime* dateTime, uint16_t ticks)
 {
 	static RTC_DateTypeDef date;
@@ -16,6 +16,7 @@
 /* Application includes */
 #include "settings.h"
 #include "rtc.h"
+#include "settings_registry.h"
 
 /* Constants -----------------------------------------------------------------*/
 /* FreeRTOS constants */
@@ -27,6 +28,12 @@
 #	define LOCAL_GMT 					2
 #endif /* LOCAL_GMT */
 
+#ifdef DST_PRESENT
+#	define DEFAULT_DST 					true
+#else /* DST_PRESENT */
+#	define DEFAULT_DST 					false
+#endif /* DST_PRESENT */
+
 /* Constants for registration per-second tasks */
 #ifndef MAX_RTC_PER_SECOND_TASKS
 #	define MAX_RTC_PER_SECOND_TASKS 	8
@@ -54,6 +61,9 @@ static SemaphoreHandle_t xNewTimeEventWakeupSem = NULL;
 static bool DST;
 static int8_t GMT;
 
+/* System counter of last second for timestamps */
+static volatile uint32_t systemCounter = 0;
+
 /* Date and time state */
 bool timeIsValide;
 
@@ -63,6 +73,7 @@ static uint8_t pTasks = 0;
 
 /* Private function prototypes -----------------------------------------------*/
 static void RTC_Task();
+static void UpdateSystemCounter();
 static uint8_t GetDaysInMonth(uint8_t numMonth, uint16_t year);
 static void GetCorrectDateTime(
 		struct DateTime* correctDateTime, uint8_t correctMonth,
@@ -81,6 +92,7 @@ void RTC_Init()
 {
 
 	RTC_DriverInit();
+	UpdateSystemCounter();
 
 	/* Set defaults */
 	RTC_SetDefaults();
@@ -111,17 +123,8 @@ void RTC_Init()
 
 void RTC_SetDefaults()
 {
-#ifdef DST_PRESENT
-	DST = true;
-#else /* DST_PRESENT */
-	DST = false;
-#endif /* DST_PRESENT */
-
-#ifdef LOCAL_GMT
-GMT = LOCAL_GMT;
-#else /* LOCAL_GMT */
-GMT = 2;
-#endif /* LOCAL_GMT */
+	DST = DEFAULT_DST;
+	GMT = LOCAL_GMT;
 }
 
 bool RTC_AddPerSecondTask(void (*fun_ptr)())
@@ -145,7 +148,9 @@ int8_t RTC_GetGMT()
 void RTC_SetGMT(int8_t val)
 {
 	if(ValueAsGMT_IsValide(val) == false) return;
+	if(GMT == val) return;
 	GMT = val;
+	SettingsRegistryChanged();
 }
 
 bool RTC_GetDST()
@@ -155,9 +160,22 @@ bool RTC_GetDST()
 
 void RTC_SetDST(bool val)
 {
+	if(DST == val) return;
 	DST = val;
+	SettingsRegistryChanged();
 }
 
+/* Settings keys */
+SETTINGS_ACCESSORS(GMT, int32_t, RTC_GetGMT, RTC_SetGMT)
+SETTINGS_ACCESSORS(DST, bool, RTC_GetDST, RTC_SetDST)
+
+static const struct SettingsKey RTC_Keys[] =
+{
+	SETTINGS_KEY_INT(8, GMT, int8_t, -11, 13, LOCAL_GMT),
+	SETTINGS_KEY_BOOL(9, DST, DEFAULT_DST),
+};
+const struct SettingsKeysTable RTC_SettingsKeys = SETTINGS_KEYS_TABLE(RTC_Keys);
+
 /* Calendar functions */
 enum AM_PM ConvertToAM_PM(uint8_t* hour)
 {
@@ -412,6 +430,7 @@ void RTC_SetLocalDateTimeWithTicks(struct DateTime* dateTime, uint16_t ticks)
 	dateTime->dayOfWeek =
 			GetDayOfWeek(dateTime->year, dateTime->month, dateTime->day);
 	RTC_DriverSetDateTime(dateTime, ticks);
+	UpdateSystemCounter();
 }
 
 void RTC_SetSystemDateTime(struct DateTime* dateTime)
@@ -431,6 +450,7 @@ void RTC_SetSystemDateTimeWithTicks(struct DateTime* dateTime, uint16_t ticks)
 	dateTime->dayOfWeek =
 			GetDayOfWeek(dateTime->year, dateTime->month, dateTime->day);
 	RTC_DriverSetDateTime(dateTime, ticks);
+	UpdateSystemCounter();
 }
 
 void RTC_GetSystemCounter(uint32_t* counter)
@@ -469,9 +489,24 @@ bool RTC_GetTimeIsValide()
 	return timeIsValide;
 }
 
+void RTC_GetTimestamp(uint32_t* counter, uint16_t* fraction)
+{
+	uint32_t second;
+
+	/* Read again, if the second was changed between reads */
+	do
+	{
+		second = systemCounter;
+		*fraction = RTC_DriverGetFraction();
+	} while(second != systemCounter);
+	*counter = second;
+}
+
 /* Override some external driver functions */
 void RTC_DriverPerSecondEvent()
 {
+	UpdateSystemCounter();
+
 	/* Send newTimeEvent */
 	if(xNewTimeEventWakeupSem != NULL)
 	{
@@ -498,6 +533,13 @@ static void RTC_Task()
 	}
 }
 
+static void UpdateSystemCounter()
+{
+	struct DateTime dateTime;
+	RTC_DriverGetDateTime(&dateTime, NULL);
+	systemCounter = StructToCounter(&dateTime);
+}
+
 static uint8_t GetDaysInMonth(uint8_t numMonth, uint16_t year)
 {
 	if((numMonth == 0) || (numMonth > sizeof(daysInMonth))) return 0;
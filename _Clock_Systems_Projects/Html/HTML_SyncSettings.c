@@ -1,6 +1,7 @@
 /* Includes ----------------------------------------------------------------- */
 #include "web-server.h"
 #include "html_txt_funcs.h"
+#include "html_query.h"
 #include "HTML_Header.h"
 #include "HTML_SyncSettings.h"
 
@@ -9,6 +10,8 @@
 
 /* Private constants -------------------------------------------------------- */
 #define HTML_SNC_SET_TMP_BUF_LEN 	0xFF
+/* Symbols are removed from NTP servers names */
+#define HTML_SNC_SET_FORBIDDEN_SYMBOLS	"\"'<>&%/\\"
 
 /* Structures definitions --------------------------------------------------- */
 struct __attribute__ ((__packed__)) HTML_SyncSettings
@@ -33,13 +36,14 @@ BaseType_t Parse_HTML_SyncSettings(HTTPClient_t *pxClient)
 	const char* buf = pxClient->pcUrlData;
 	if(QueryCmp(&buf, "/HTML_SyncSettings.html") == pdFALSE) return pdFALSE;
 
-	/* Search for "?" - start of parameters */
+	/* Parameters are looked up by key in any order */
+	struct HTML_Query query;
 	bool setDefSet = pdFALSE;
 	bool apply = pdFALSE;
-	if(SearchForStartParameter(&buf))
+	if(HTML_QueryParse(pxClient, &query))
 	{
 		/* Create temporarily variables */
-		char tmpValStr[32];
+		const char* value;
 		int32_t tmp32;
 
 		/* Get time sync settings (used as preinit actions),
@@ -67,125 +71,51 @@ BaseType_t Parse_HTML_SyncSettings(HTTPClient_t *pxClient)
 		}
 		taskEXIT_CRITICAL();
 
-		while(pdTRUE)
-		{
-			/* Parse parameters */
-			/* Set default settings ------------------------------------------*/
-			if(ParamIsEqu(&buf, "b_def"))
-			{
-				if(ValueCmp(buf, "def_st")) setDefSet = true;
-
-				/* Watch for end of parameters */
-				if(SearchForNextParameter(&buf) == false) break;
-			}
-
-			/* Flag SNTP synchronization */
-			if(ParamIsEqu(&buf, "NTP_en"))
-			{
-				if(ValueCmp(buf, "on"))
-					settings.NTP_SncEn = true;
-
-				/* Watch for end of parameters */
-				if(SearchForNextParameter(&buf) == false) break;
-			}
+		/* Set default settings ----------------------------------------------*/
+		if(HTML_QueryIs(&query, "b_def", "def_st")) setDefSet = true;
 
-			/* NTP sync settings ---------------------------------------------*/
-			/* Period of synchronization */
-			if(ParamIsEqu(&buf, "T_NTP_Snc"))
-			{
-				/* Try to convert string to number */
-				if(GetNumFromStr(&buf, &tmp32, pdTRUE))
-				{
-					if(tmp32 >= 0) settings.NTP_SncPer = (uint32_t)tmp32;
-				}
-
-				/* Watch for end of parameters */
-				if(SearchForNextParameter(&buf) == false) break;
-			}
+		/* Flag SNTP synchronization */
+		if(HTML_QueryIs(&query, "NTP_en", "on")) settings.NTP_SncEn = true;
 
-			/* Startup delay for NTP synchronization */
-			if(ParamIsEqu(&buf, "SUD_NTP_Snc"))
-			{
-				/* Try to convert string to number */
-				if(GetNumFromStr(&buf, &tmp32, pdTRUE))
-				{
-					if(tmp32 >= 0) settings.NTP_StrtUpDel = (uint32_t)tmp32;
-				}
-
-				/* Watch for end of parameters */
-				if(SearchForNextParameter(&buf) == false) break;
-			}
+		/* NTP sync settings -------------------------------------------------*/
+		/* Period of synchronization */
+		if(HTML_QueryGetNum(&query, "T_NTP_Snc", &tmp32))
+		{
+			if(tmp32 >= 0) settings.NTP_SncPer = (uint32_t)tmp32;
+		}
 
-			/* Button "SyncNow" */
-			if(ParamIsEqu(&buf, "b_SncNow"))
-			{
-				if(ValueCmp(buf, "SncNow"))
-				{
-					/* Just execute command */
-					SNTP_SyncNow();
-				}
-
-				/* Watch for end of parameters */
-				if(SearchForNextParameter(&buf) == false) break;
-			}
+		/* Startup delay for NTP synchronization */
+		if(HTML_QueryGetNum(&query, "SUD_NTP_Snc", &tmp32))
+		{
+			if(tmp32 >= 0) settings.NTP_StrtUpDel = (uint32_t)tmp32;
+		}
 
-			/* NTP servers table parsing */
-			char* pTmpStrPrc;
-			char* pLastTmpStrPrc;
-			uint16_t tmpStrFreeLng;
-			for(uint8_t i = 0; i < QUANT_NTP_SERVERS; i++)
-			{
-				/* Parse parameters */
-				/* Create parameter of NTP server enabled flag */
-				/* Init pointers and length */
-				pTmpStrPrc = tmpValStr;
-				pLastTmpStrPrc = pTmpStrPrc;
-				tmpStrFreeLng = HTML_SNC_SET_TMP_BUF_LEN;
-				pTmpStrPrc = SetValue("NTP_en", pTmpStrPrc, tmpStrFreeLng);
-				/* Correct pointers and length */
-				pLastTmpStrPrc = pTmpStrPrc;
-				tmpStrFreeLng -= (pLastTmpStrPrc - pTmpStrPrc);
-				pTmpStrPrc = SetNumToStr(i, pTmpStrPrc, tmpStrFreeLng);
-				if(ParamIsEqu(&buf, tmpValStr))
-				{
-					// Get value as string
-					if(ValueCmp(buf, "on"))
-						settings.NTP_Settings[i].enabled = true;
-
-					// Watch for end of parameters
-					if(SearchForNextParameter(&buf) == false) break;
-				}
-
-				/* Create parameter of NTP server name */
-				/* Init pointers and length */
-				pTmpStrPrc = tmpValStr;
-				pLastTmpStrPrc = pTmpStrPrc;
-				tmpStrFreeLng = HTML_SNC_SET_TMP_BUF_LEN;
-				pTmpStrPrc = SetValue("NTP_nm", pTmpStrPrc, tmpStrFreeLng);
-				/* Correct pointers and length */
-				pLastTmpStrPrc = pTmpStrPrc;
-				tmpStrFreeLng -= (pLastTmpStrPrc - pTmpStrPrc);
-				pTmpStrPrc = SetNumToStr(i, pTmpStrPrc, tmpStrFreeLng);
-				if(ParamIsEqu(&buf, tmpValStr))
-				{
-					GetValueFromTxtField(&buf,
-							settings.NTP_Settings[i].NTP,
-							sizeof(settings.NTP_Settings[i].NTP), true);
-
-					// Watch for end of parameters
-					if(SearchForNextParameter(&buf) == false) break;
-				}
-			}
+		/* Button "SyncNow": just execute command */
+		if(HTML_QueryIs(&query, "b_SncNow", "SncNow")) SNTP_SyncNow();
 
-			/* Apply */
-			if(ParamIsEqu(&buf, "b_apl"))
+		/* NTP servers table parsing */
+		for(uint8_t i = 0; i < QUANT_NTP_SERVERS; i++)
+		{
+			/* NTP server enabled flag */
+			value = HTML_QueryGetIdx(&query, "NTP_en", i);
+			if((value != NULL) && ValueCmp(value, "on"))
+				settings.NTP_Settings[i].enabled = true;
+
+			/* NTP server name (decoded value is not trusted as HTML) */
+			value = HTML_QueryGetIdx(&query, "NTP_nm", i);
+			if(value != NULL)
 			{
-				if(ValueCmp(buf, "apl_st")) apply = pdTRUE;
+				SetValue(value, settings.NTP_Settings[i].NTP,
+						sizeof(settings.NTP_Settings[i].NTP) - 1);
+				settings.NTP_Settings[i].NTP[
+						sizeof(settings.NTP_Settings[i].NTP) - 1] = '\0';
+				RemoveForbiddenSymbols(settings.NTP_Settings[i].NTP,
+						HTML_SNC_SET_FORBIDDEN_SYMBOLS);
 			}
-
-			/* End of parsing */
-			break;
 		}
+
+		/* Apply */
+		if(HTML_QueryIs(&query, "b_apl", "apl_st")) apply = pdTRUE;
 	}
 
 	if(setDefSet)
@@ -208,10 +138,8 @@ BaseType_t Parse_HTML_SyncSettings(HTTPClient_t *pxClient)
 			SNTP_SetStartupDelay(settings.NTP_StrtUpDel);
 			for(uint8_t i = 0; i < QUANT_NTP_SERVERS; i++)
 			{
-				NTP_Servers[i].enabled = settings.NTP_Settings[i].enabled;
-				/* Get value as string */
-				SetValue(settings.NTP_Settings[i].NTP, NTP_Servers[i].NTP,
-						sizeof(settings.NTP_Settings[i].NTP));
+				SNTP_SetServer(i, settings.NTP_Settings[i].NTP,
+						settings.NTP_Settings[i].enabled);
 			}
 		}
 		taskEXIT_CRITICAL();
@@ -237,7 +165,7 @@ Apply settings</button>\
 </pre>";
 
 	/* Attempt to create the temporary string buffer */
-	char* tmpStr = (char*)pvPortMalloc(HTML_SNC_SET_TMP_BUF_LEN);
+	char* tmpStr = (char*)GetHTML_Scratch(pxClient, HTML_SNC_SET_TMP_BUF_LEN);
 	if(tmpStr == NULL)
 	{
 		FreeRTOS_printf(("Could not create temporary string buffer\n"));
@@ -415,8 +343,8 @@ static const char str_rw_e[] = "\
 	/* Enable "pre" tag */
 	SendHTML_Block(pxClient, "<pre>", sizeof("<pre>") - 1);
 
-	/* Free temporary string buffer */
-	vPortFree(tmpStr);
+	/* Release temporary string buffer */
+	ReleaseHTML_Scratch(pxClient, tmpStr);
 	
 	/* Send end of html page */
 	SendHTML_Block(pxClient, str_end, sizeof(str_end) - 1);
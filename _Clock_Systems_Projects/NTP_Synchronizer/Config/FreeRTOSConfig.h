@@ -202,6 +202,23 @@ void vAssertCalled(const char *pcFile, uint32_t ulLine);
 #endif
 #define configASSERT(x) if((x) == 0) vAssertCalled(__FILE__, __LINE__);
 
+/* Heap allocations, which are made while HTTP-pages are rendered, are counted
+(HTTP_ServerStats): pages use scratch memory of the client instead of heap */
+#if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+void HTTP_ServerTraceMalloc();
+#endif
+#define traceMALLOC(pvAddress, uiSize) HTTP_ServerTraceMalloc()
+
+/* Run time of tasks (for "/metrics"): counter of CPU cycles is divided, see
+RunTimeCounterGetHz() */
+#define configGENERATE_RUN_TIME_STATS			1
+#if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+void RunTimeCounterInit();
+uint32_t RunTimeCounterGet();
+#endif
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() RunTimeCounterInit()
+#define portGET_RUN_TIME_COUNTER_VALUE() RunTimeCounterGet()
+
 /* Definitions that map the FreeRTOS port interrupt handlers to their CMSIS
 standard names. */
 #define vPortSVCHandler		SVC_Handler
@@ -201,9 +201,19 @@ not set to 1 then only FreeRTOS_indet_addr_quick() is available. */
 are available to the IP stack.  The total number of network buffers is limited
 to ensure the total amount of RAM that can be consumed by the IP stack is capped
 to a pre-determinable value. */
+/* The Ethernet driver receives frames directly to network buffers: each RX
+descriptor holds a buffer, which is swapped with a free one on receive */
+#define ipconfigZERO_COPY_RX_DRIVER		1
+
+/* Network buffers are sent by DMA directly: TX descriptors hold them until
+the TX-complete interrupt */
+#define ipconfigZERO_COPY_TX_DRIVER		1
+
 #if(ipconfigZERO_COPY_RX_DRIVER != 0)
-	/* _HT_ Actually we should know the value of 'configNUM_RX_DESCRIPTORS' here. */
-	#define ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS		(8 + 6)
+	/* _HT_ Actually we should know the value of 'configNUM_RX_DESCRIPTORS' here.
+	8 buffers are held by RX descriptors (ETH_RXBUFNB), up to 8 frames are
+	sent by TX descriptors (ETH_TXBUFNB) */
+	#define ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS		(8 + 6 + 4)
 #else
 	#define ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS		8
 #endif
@@ -280,7 +290,7 @@ filtering can be removed by using a value other than 1 or 0. */
 #define ipconfigETHERNET_DRIVER_FILTERS_FRAME_TYPES	1
 
 #define ipconfigUSE_CALLBACKS			(1)
-#define ipconfigSUPPORT_SIGNALS			(0)//(1)//
+#define ipconfigSUPPORT_SIGNALS			(1)//(0)//
 
 /* The windows simulator cannot really simulate MAC interrupts, and needs to
 block occasionally to allow other tasks to run. */
@@ -63,6 +63,11 @@ NTP_Synchronizer_V1.0 */
 #define MCU_MIDDLE_PERFORMANCE//MCU_MAX_PERFORMANCE//MCU_HIGH_PERFORMANCE//
 #define WATCH_DOG_RELOAD_PERIOD 	16000
 
+/* Web server --------------------------------------------------------------- */
+/* Metrics ("/metrics") are scraped without login: they tell the tasks and the
+   load of the device to anybody in the network */
+//#define HTTP_METRICS_PUBLIC
+
 /* DEBUGGING ---------------------------------------------------------------- */
 //#define DEBUG_MODULES
 //#define DISABLE_WEB_UI_LOGIN
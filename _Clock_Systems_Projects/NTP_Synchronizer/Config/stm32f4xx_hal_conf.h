@@ -134,8 +134,8 @@ enum
 #define ETH_TX_BUF_SIZE 			ETH_MAX_PACKET_SIZE 
 /* Rx buffers of size ETH_RX_BUF_SIZE */
 #define ETH_RXBUFNB 				((uint32_t)8)
-/* Tx buffers of size ETH_TX_BUF_SIZE */
-#define ETH_TXBUFNB 				((uint32_t)4)
+/* Tx descriptors: they point to network buffers of frames until sent */
+#define ETH_TXBUFNB 				((uint32_t)8)
 
 /* Section 2: PHY configuration section */
 /* PHY Reset delay these values are based on a 1 ms Systick interrupt */
@@ -0,0 +1,883 @@
+/* JSON API for monitoring systems (status and configuration) */
+
+/* Includes ----------------------------------------------------------------- */
+#include <string.h>
+
+#include "settings.h"
+#include "web-server.h"
+#include "UDP_logging.h"
+#include "html_txt_funcs.h"
+#include "html_query.h"
+#include "HTML_API.h"
+
+/* Application includes */
+#include "rtc.h"
+#include "rtc_driver.h"
+#include "sntp.h"
+#include "fw_update.h"
+#include "event_log.h"
+
+/* Private constants -------------------------------------------------------- */
+#define HTML_API_KEY_MAX_LEN 		24
+
+/* Delay of the firmware replacement after closing of connection (ms): reply
+   has to be sent by IP-task */
+#define HTML_API_FIRMWARE_APPLY_DELAY	500
+
+/* Structures definitions --------------------------------------------------- */
+/* JSON writer over the transmit buffer of the client */
+struct JSON_Writer
+{
+	char* pos;
+	char* end;
+	bool first;
+};
+
+struct HTML_API_Settings
+{
+	/* Date and time settings */
+	int8_t GMT;
+	bool DST;
+
+	/* NTP sync settings */
+	bool NTP_SncEn;
+	uint32_t NTP_SncPer;
+	uint32_t NTP_StrtUpDel;
+	struct NTP_ServerSettings NTP_Settings[QUANT_NTP_SERVERS];
+
+	/* RTC correction settings */
+	int16_t RTC_CorrectionPPM;
+
+	/* Logging settings */
+	bool loggingEnable;
+	uint32_t loggingIP_Addr;
+	uint16_t loggingPort;
+	bool logEvents;
+	bool logWarnings;
+	bool logErrors;
+	bool loggingSyslog;
+};
+
+/* Variables ---------------------------------------------------------------- */
+/* Structure for settings operations */
+static struct HTML_API_Settings settings;
+
+/* Firmware upload: the image of the latest started upload is written to flash,
+   the previous one fails */
+static HTTPClient_t* firmwareClient = NULL;
+static enum FW_UpdateResult firmwareResult = FW_UpdateNotStarted;
+
+/* Private function prototypes ---------------------------------------------- */
+static BaseType_t Send_JSON_Status(HTTPClient_t *pxClient);
+static BaseType_t Send_JSON_Config(HTTPClient_t *pxClient);
+static BaseType_t Send_JSON_Error(HTTPClient_t *pxClient, BaseType_t xCode,
+		const char* error);
+static BaseType_t Send_JSON(HTTPClient_t *pxClient, BaseType_t xCode,
+		struct JSON_Writer* json);
+static BaseType_t Send_JSON_Firmware(HTTPClient_t *pxClient,
+		enum FW_UpdateResult result);
+static uint32_t GetEventState();
+static void GetSettings();
+static bool ParseSettings(const char* buf);
+static void ApplySettings();
+
+/* JSON writer functions */
+static void JSON_Begin(HTTPClient_t *pxClient, struct JSON_Writer* json,
+		const char* prefix);
+static void JSON_End(struct JSON_Writer* json);
+static void JSON_AddRaw(struct JSON_Writer* json, const char* str);
+static void JSON_AddKey(struct JSON_Writer* json, const char* key);
+static void JSON_AddStr(struct JSON_Writer* json,
+		const char* key, const char* str);
+static void JSON_AddNum(struct JSON_Writer* json, const char* key, int32_t num);
+static void JSON_AddBool(struct JSON_Writer* json, const char* key, bool val);
+static void JSON_AddIP(struct JSON_Writer* json,
+		const char* key, uint32_t IP_Addr);
+static void JSON_AddDateTime(struct JSON_Writer* json,
+		const char* key, struct DateTime* dateTime);
+
+/* JSON parser functions */
+static bool JSON_NextMember(const char** str, char* key, uint16_t size);
+static bool JSON_GetStr(const char** str, char* dstStr, uint16_t size);
+static bool JSON_GetNum(const char** str, int32_t* num);
+static bool JSON_GetBool(const char** str, bool* val);
+static void JSON_SkipValue(const char** str);
+static void JSON_SkipSpaces(const char** str);
+
+/* Public functions --------------------------------------------------------- */
+BaseType_t Parse_API_Status(HTTPClient_t *pxClient)
+{
+	const char* buf = pxClient->pcUrlData;
+	if(QueryCmp(&buf, "/api/status") == pdFALSE) return pdFALSE;
+
+	return Send_JSON_Status(pxClient);
+}
+
+BaseType_t Parse_API_Config(HTTPClient_t *pxClient)
+{
+	const char* buf = pxClient->pcUrlData;
+	if(QueryCmp(&buf, "/api/config") == pdFALSE) return pdFALSE;
+
+	if(pxClient->xCommand == ECMD_PUT)
+	{
+		/* Get current settings and change them with request body */
+		GetSettings();
+		if(ParseSettings(GetHTML_RequestBody(pxClient)) == false)
+		{
+			return Send_JSON_Error(pxClient, WEB_BAD_REQUEST,
+					"invalid configuration");
+		}
+		ApplySettings();
+	}
+
+	/* Send current configuration */
+	return Send_JSON_Config(pxClient);
+}
+
+/* Event log of flash as binary dump of its sectors (records are described in
+   event_log.h): it is read in parts by range requests */
+BaseType_t Parse_API_EventLog(HTTPClient_t *pxClient)
+{
+	const char* buf = pxClient->pcUrlData;
+	const uint8_t* data;
+	uint32_t size;
+
+	if(QueryCmp(&buf, "/api/eventlog") == pdFALSE) return pdFALSE;
+
+	data = EventLogGetData(&size);
+	if(data == NULL)
+		return Send_JSON_Error(pxClient, WEB_NOT_FOUND, "no event log");
+
+	return SendHTML_Memory(pxClient, "application/octet-stream", data, size);
+}
+
+BaseType_t Parse_API_Events(HTTPClient_t *pxClient)
+{
+	const char* buf = pxClient->pcUrlData;
+	if(QueryCmp(&buf, "/api/events") == pdFALSE) return pdFALSE;
+
+	/* Subscribe client to the per second events */
+	return SendHTML_Header_EventStream(pxClient);
+}
+
+/* Image was received by API_FirmwareBody(), its CRC-32 is in the URL:
+   "/api/firmware?crc32=XXXXXXXX" */
+BaseType_t Parse_API_Firmware(HTTPClient_t *pxClient)
+{
+	struct HTML_Query query;
+	const char* buf = pxClient->pcUrlData;
+	int32_t crc;
+
+	if(QueryCmp(&buf, "/api/firmware") == pdFALSE) return pdFALSE;
+
+	enum FW_UpdateResult result = firmwareResult;
+	if(pxClient != firmwareClient) result = FW_UpdateNotStarted;
+	firmwareClient = NULL;
+	firmwareResult = FW_UpdateNotStarted;
+
+	if(result == FW_UpdateOk)
+	{
+		HTML_QueryParse(pxClient, &query);
+		buf = HTML_QueryGet(&query, "crc32");
+		if((buf == NULL) || (GetHexFromStr(&buf, &crc, false) == false))
+		{
+			return Send_JSON_Error(pxClient, WEB_BAD_REQUEST,
+					"crc32 is required");
+		}
+		result = FW_UpdateEnd((uint32_t)crc);
+	}
+
+	return Send_JSON_Firmware(pxClient, result);
+}
+
+/* Body of firmware upload is written to flash as it comes */
+void API_FirmwareBody(HTTPClient_t *pxClient, const char* data, size_t length)
+{
+	if(data == NULL)
+	{
+		/* Start of the body: its size is known after headers (chunked
+		   uploads are not accepted) */
+		uint64_t size = pxClient->xParser.content_length;
+		firmwareClient = pxClient;
+		firmwareResult = FW_UpdateBegin(
+				(size > FW_UPDATE_MAX_SIZE) ? 0 : (uint32_t)size);
+		return;
+	}
+
+	/* Data is dropped after errors */
+	if((pxClient != firmwareClient) || (firmwareResult != FW_UpdateOk)) return;
+	firmwareResult = FW_UpdateWrite(data, length);
+}
+
+/* Checked image replaces the firmware (MCU is reset) */
+void WebServerApplyFirmware()
+{
+	vTaskDelay(pdMS_TO_TICKS(HTML_API_FIRMWARE_APPLY_DELAY));
+	FW_UpdateApply();
+}
+
+/* Send time to the subscribed client every second, status only on change */
+BaseType_t HTTP_EventStreamWork(HTTPClient_t *pxClient)
+{
+	struct JSON_Writer json;
+	struct DateTime tmpDateTime;
+	struct tm dt;
+	char tmpStr[sizeof("DD.MM.YYYY")];
+	uint32_t state = GetEventState();
+	size_t size;
+	char* buf = GetHTML_ContentBuffer(pxClient, &size);
+
+	JSON_Begin(pxClient, &json, "data: ");
+	if(RTC_GetTimeIsValide())
+	{
+		/* Structures conversion */
+		RTC_GetLocalDateTime(&tmpDateTime);
+		dt.tm_year = tmpDateTime.year - YEAR0;
+		dt.tm_mon = tmpDateTime.month - 1;
+		dt.tm_mday = tmpDateTime.day;
+		dt.tm_hour = tmpDateTime.hour;
+		dt.tm_min = tmpDateTime.minute;
+		dt.tm_sec = tmpDateTime.second;
+
+		SetTimeToStr(&dt, tmpStr, sizeof(tmpStr));
+		JSON_AddStr(&json, "t", tmpStr);
+	}
+	else JSON_AddStr(&json, "t", "n/a");
+
+	/* Date and synchronization status are sent only when changed */
+	if(pxClient->ulEventStreamState != state)
+	{
+		pxClient->ulEventStreamState = state;
+		if(RTC_GetTimeIsValide())
+		{
+			SetDateToStr(&dt, tmpStr, sizeof(tmpStr));
+			JSON_AddStr(&json, "d", tmpStr);
+		}
+		else JSON_AddStr(&json, "d", "n/a");
+		JSON_AddNum(&json, "s", (state >> 8) & 0xFF);
+	}
+	JSON_End(&json);
+	JSON_AddRaw(&json, "\n\n");
+
+	if(json.pos >= json.end) return -1;
+	return SendHTML_Block(pxClient, buf, json.pos - buf);
+}
+
+/* Private functions -------------------------------------------------------- */
+static BaseType_t Send_JSON_Status(HTTPClient_t *pxClient)
+{
+	struct JSON_Writer json;
+	struct DateTime tmpDateTime;
+
+	JSON_Begin(pxClient, &json, "");
+
+	/* RTC status */
+	JSON_AddBool(&json, "rtc_valid", RTC_GetTimeIsValide());
+	if(RTC_GetTimeIsValide())
+	{
+		RTC_GetLocalDateTime(&tmpDateTime);
+		JSON_AddDateTime(&json, "local_time", &tmpDateTime);
+	}
+	JSON_AddNum(&json, "gmt", RTC_GetGMT());
+
+	/* NTP synchronization status */
+	JSON_AddBool(&json, "ntp_enabled", SNTP_GetSyncEnabled());
+	switch(GetNTP_TimeStatus())
+	{
+	case NTP_TimeValid:
+		JSON_AddStr(&json, "ntp_status", "valid");
+		break;
+
+	case NTP_TimeNoActual:
+		JSON_AddStr(&json, "ntp_status", "not_actual");
+		break;
+
+	case NTP_TimeInvalid:
+	default:
+		JSON_AddStr(&json, "ntp_status", "invalid");
+	}
+
+	if(SNTP_GetLastSyncTime(&tmpDateTime))
+	{
+		/* Time of last synchronization is sent as UTC */
+		JSON_AddDateTime(&json, "last_sync", &tmpDateTime);
+		JSON_AddNum(&json, "offset_ms", SNTP_GetLastSyncOffset());
+		JSON_AddNum(&json, "delay_ms", (int32_t)SNTP_GetLastSyncDelay());
+	}
+
+	if(sntpRequestedServer < QUANT_NTP_SERVERS)
+	{
+		JSON_AddStr(&json, "server", NTP_Servers[sntpRequestedServer].NTP);
+		switch(lastNTP_RequestStatus)
+		{
+		case NTP_RequestTimeOut:
+			JSON_AddStr(&json, "server_status", "timeout");
+			break;
+
+		case NTP_RequestComplete:
+			JSON_AddStr(&json, "server_status", "complete");
+			break;
+
+		case NTP_RequestFailed:
+			JSON_AddStr(&json, "server_status", "failed");
+			break;
+
+		default:
+			JSON_AddStr(&json, "server_status", "undefined");
+		}
+	}
+
+	/* Service info */
+	JSON_AddNum(&json, "uptime", (int32_t)GetUpTime());
+	JSON_AddBool(&json, "link", FreeRTOS_IsNetworkUp() != pdFALSE);
+
+	JSON_End(&json);
+	return Send_JSON(pxClient, WEB_REPLY_OK, &json);
+}
+
+static BaseType_t Send_JSON_Config(HTTPClient_t *pxClient)
+{
+	struct JSON_Writer json;
+	char key[HTML_API_KEY_MAX_LEN];
+	char* pKey;
+
+	GetSettings();
+	JSON_Begin(pxClient, &json, "");
+
+	/* Date and time settings */
+	JSON_AddNum(&json, "gmt", settings.GMT);
+	JSON_AddBool(&json, "dst", settings.DST);
+
+	/* NTP sync settings */
+	JSON_AddBool(&json, "ntp_en", settings.NTP_SncEn);
+	JSON_AddNum(&json, "ntp_period", (int32_t)settings.NTP_SncPer);
+	JSON_AddNum(&json, "ntp_startup_delay", (int32_t)settings.NTP_StrtUpDel);
+	for(uint8_t i = 0; i < QUANT_NTP_SERVERS; i++)
+	{
+		pKey = SetValue("ntp_server", key, sizeof(key));
+		SetNumToStr(i, pKey, sizeof(key) - (pKey - key));
+		JSON_AddStr(&json, key, settings.NTP_Settings[i].NTP);
+
+		pKey = SetValue("ntp_server", key, sizeof(key));
+		pKey = SetNumToStr(i, pKey, sizeof(key) - (pKey - key));
+		SetValue("_en", pKey, sizeof(key) - (pKey - key));
+		JSON_AddBool(&json, key, settings.NTP_Settings[i].enabled);
+	}
+
+	/* RTC correction settings */
+	JSON_AddNum(&json, "rtc_corr", settings.RTC_CorrectionPPM);
+
+	/* Logging settings */
+	JSON_AddBool(&json, "log_en", settings.loggingEnable);
+	JSON_AddIP(&json, "log_ip", settings.loggingIP_Addr);
+	JSON_AddNum(&json, "log_port", FreeRTOS_ntohs(settings.loggingPort));
+	JSON_AddBool(&json, "log_evt", settings.logEvents);
+	JSON_AddBool(&json, "log_wrn", settings.logWarnings);
+	JSON_AddBool(&json, "log_err", settings.logErrors);
+	JSON_AddBool(&json, "log_sys", settings.loggingSyslog);
+
+	/* Network settings (read only) */
+	JSON_AddBool(&json, "dhcp", currProtocolType == DHCP);
+	JSON_AddIP(&json, "ip", staticIP_Addr);
+	JSON_AddIP(&json, "mask", staticNetMask);
+	JSON_AddIP(&json, "gw", staticIP_GW);
+	JSON_AddIP(&json, "dns", staticIP_DNS);
+
+	JSON_End(&json);
+	return Send_JSON(pxClient, WEB_REPLY_OK, &json);
+}
+
+static BaseType_t Send_JSON_Error(HTTPClient_t *pxClient, BaseType_t xCode,
+		const char* error)
+{
+	struct JSON_Writer json;
+
+	JSON_Begin(pxClient, &json, "");
+	JSON_AddStr(&json, "error", error);
+	JSON_End(&json);
+	return Send_JSON(pxClient, xCode, &json);
+}
+
+static BaseType_t Send_JSON(HTTPClient_t *pxClient, BaseType_t xCode,
+		struct JSON_Writer* json)
+{
+	size_t size;
+	char* buf = GetHTML_ContentBuffer(pxClient, &size);
+
+	/* Writer stops at the end of buffer */
+	if(json->pos >= json->end)
+	{
+		FreeRTOS_printf(("JSON reply does not fit the buffer\n"));
+		return -1;
+	}
+
+	return SendHTML_Content(pxClient, xCode, "application/json",
+			buf, json->pos - buf);
+}
+
+static BaseType_t Send_JSON_Firmware(HTTPClient_t *pxClient,
+		enum FW_UpdateResult result)
+{
+	struct JSON_Writer json;
+
+	switch(result)
+	{
+	case FW_UpdateOk:
+		/* Firmware is replaced after the reply */
+		pxClient->request.bCloseConnection = pdTRUE_UNSIGNED;
+		HTTP_ServerApplyFirmwareAfterNetConnClose();
+
+		JSON_Begin(pxClient, &json, "");
+		JSON_AddStr(&json, "firmware", "accepted");
+		JSON_End(&json);
+		return Send_JSON(pxClient, WEB_REPLY_OK, &json);
+
+	case FW_UpdateWrongSize:
+	case FW_UpdateOverflow:
+		return Send_JSON_Error(pxClient, WEB_PAYLOAD_TOO_LARGE,
+				"image size is invalid");
+
+	case FW_UpdateIncomplete:
+		return Send_JSON_Error(pxClient, WEB_BAD_REQUEST,
+				"image is incomplete");
+
+	case FW_UpdateWrongImage:
+		return Send_JSON_Error(pxClient, WEB_BAD_REQUEST,
+				"image is not firmware");
+
+	case FW_UpdateWrongCRC:
+		return Send_JSON_Error(pxClient, WEB_BAD_REQUEST, "crc32 mismatch");
+
+	case FW_UpdateFlashError:
+		return Send_JSON_Error(pxClient, WEB_INTERNAL_SERVER_ERROR,
+				"flash error");
+
+	case FW_UpdateNotStarted:
+	default:
+		return Send_JSON_Error(pxClient, WEB_BAD_REQUEST, "image is absent");
+	}
+}
+
+static uint32_t GetEventState()
+{
+	struct DateTime tmpDateTime;
+	/* Bit 31 is always set to differ from the initial state of client */
+	uint32_t state = (1UL << 31);
+
+	state |= (uint32_t)GetNTP_TimeStatus() << 8;
+	if(SNTP_GetSyncEnabled()) state |= (1UL << 16);
+	if(FreeRTOS_IsNetworkUp() != pdFALSE) state |= (1UL << 17);
+	if(RTC_GetTimeIsValide())
+	{
+		state |= (1UL << 18);
+		RTC_GetLocalDateTime(&tmpDateTime);
+		state |= tmpDateTime.day;
+		state |= (uint32_t)tmpDateTime.month << 24;
+	}
+
+	return state;
+}
+static void GetSettings()
+{
+	taskENTER_CRITICAL();
+	{
+		/* Date and time settings */
+		settings.GMT = RTC_GetGMT();
+		settings.DST = RTC_GetDST();
+
+		/* NTP sync settings */
+		settings.NTP_SncEn = SNTP_GetSyncEnabled();
+		settings.NTP_SncPer = SNTP_GetSyncPeriod();
+		settings.NTP_StrtUpDel = SNTP_GetStartupDelay();
+		for(uint8_t i = 0; i < QUANT_NTP_SERVERS; i++)
+		{
+			settings.NTP_Settings[i].enabled = NTP_Servers[i].enabled;
+			SetValue(NTP_Servers[i].NTP, settings.NTP_Settings[i].NTP,
+					sizeof(settings.NTP_Settings[i].NTP));
+		}
+
+		/* RTC correction settings */
+		settings.RTC_CorrectionPPM = RTC_DriverGetCorrectionPPM();
+
+		/* Logging settings */
+		settings.loggingEnable = GetUDP_LoggingEnable();
+		settings.loggingIP_Addr = GetUDP_LoggingIP_Addr();
+		settings.loggingPort = GetUDP_LoggingPort();
+		settings.logEvents = GetUDP_LogEvents();
+		settings.logWarnings = GetUDP_LogWarnings();
+		settings.logErrors = GetUDP_LogErrors();
+		settings.loggingSyslog = GetUDP_LoggingSyslog();
+	}
+	taskEXIT_CRITICAL();
+}
+
+static bool ParseSettings(const char* buf)
+{
+	/* Create temporarily variables */
+	char key[HTML_API_KEY_MAX_LEN];
+	char tmpValStr[16];
+	int32_t tmp32;
+	bool ok;
+
+	JSON_SkipSpaces(&buf);
+	if(*buf != '{') return false;
+
+	while(JSON_NextMember(&buf, key, sizeof(key)))
+	{
+		ok = true;
+
+		/* Date and time settings */
+		if(strcmp(key, "gmt") == 0)
+		{
+			ok = JSON_GetNum(&buf, &tmp32) && ValueAsGMT_IsValide(tmp32);
+			if(ok) settings.GMT = (int8_t)tmp32;
+		}
+		else if(strcmp(key, "dst") == 0) ok = JSON_GetBool(&buf, &settings.DST);
+
+		/* NTP sync settings */
+		else if(strcmp(key, "ntp_en") == 0)
+			ok = JSON_GetBool(&buf, &settings.NTP_SncEn);
+		else if(strcmp(key, "ntp_period") == 0)
+		{
+			ok = JSON_GetNum(&buf, &tmp32) && (tmp32 >= 0);
+			if(ok) settings.NTP_SncPer = (uint32_t)tmp32;
+		}
+		else if(strcmp(key, "ntp_startup_delay") == 0)
+		{
+			ok = JSON_GetNum(&buf, &tmp32) && (tmp32 >= 0);
+			if(ok) settings.NTP_StrtUpDel = (uint32_t)tmp32;
+		}
+		else if(strncmp(key, "ntp_server", sizeof("ntp_server") - 1) == 0)
+		{
+			/* "ntp_server<i>" or "ntp_server<i>_en" */
+			const char* pIdx = &key[sizeof("ntp_server") - 1];
+			uint8_t i = (uint8_t)(*pIdx - '0');
+			ok = (*pIdx >= '0') && (i < QUANT_NTP_SERVERS);
+			if(ok && (pIdx[1] == '\0'))
+			{
+				ok = JSON_GetStr(&buf, settings.NTP_Settings[i].NTP,
+						sizeof(settings.NTP_Settings[i].NTP));
+			}
+			else if(ok && (strcmp(&pIdx[1], "_en") == 0))
+			{
+				ok = JSON_GetBool(&buf, &settings.NTP_Settings[i].enabled);
+			}
+			else ok = false;
+		}
+
+		/* RTC correction settings */
+		else if(strcmp(key, "rtc_corr") == 0)
+		{
+			ok = JSON_GetNum(&buf, &tmp32) &&
+					(tmp32 >= SHRT_MIN) && (tmp32 <= SHRT_MAX);
+			if(ok) settings.RTC_CorrectionPPM = (int16_t)tmp32;
+		}
+
+		/* Logging settings */
+		else if(strcmp(key, "log_en") == 0)
+			ok = JSON_GetBool(&buf, &settings.loggingEnable);
+		else if(strcmp(key, "log_ip") == 0)
+		{
+			ok = JSON_GetStr(&buf, tmpValStr, sizeof(tmpValStr));
+			if(ok) settings.loggingIP_Addr = FreeRTOS_inet_addr(tmpValStr);
+		}
+		else if(strcmp(key, "log_port") == 0)
+		{
+			ok = JSON_GetNum(&buf, &tmp32) && (tmp32 >= 0) && (tmp32 <= 0xFFFF);
+			if(ok) settings.loggingPort = FreeRTOS_htons(tmp32);
+		}
+		else if(strcmp(key, "log_evt") == 0)
+			ok = JSON_GetBool(&buf, &settings.logEvents);
+		else if(strcmp(key, "log_wrn") == 0)
+			ok = JSON_GetBool(&buf, &settings.logWarnings);
+		else if(strcmp(key, "log_err") == 0)
+			ok = JSON_GetBool(&buf, &settings.logErrors);
+		else if(strcmp(key, "log_sys") == 0)
+			ok = JSON_GetBool(&buf, &settings.loggingSyslog);
+
+		/* Unknown and read only members are ignored */
+		else JSON_SkipValue(&buf);
+
+		if(ok == false) return false;
+	}
+
+	/* Members have to be closed with the end of object */
+	return *buf == '}';
+}
+
+static void ApplySettings()
+{
+	taskENTER_CRITICAL();
+	{
+		/* Date and time settings */
+		RTC_SetGMT(settings.GMT);
+		RTC_SetDST(settings.DST);
+
+		/* NTP sync settings */
+		SNTP_SetSyncEnabled(settings.NTP_SncEn);
+		SNTP_SetSyncPeriod(settings.NTP_SncPer);
+		SNTP_SetStartupDelay(settings.NTP_StrtUpDel);
+		for(uint8_t i = 0; i < QUANT_NTP_SERVERS; i++)
+		{
+			SNTP_SetServer(i, settings.NTP_Settings[i].NTP,
+					settings.NTP_Settings[i].enabled);
+		}
+
+		/* RTC correction settings */
+		RTC_DriverSetCorrectionPPM(settings.RTC_CorrectionPPM);
+
+		/* Logging settings */
+		SetUDP_LoggingEnable(settings.loggingEnable);
+		SetUDP_LoggingIP_Addr(settings.loggingIP_Addr);
+		SetUDP_LoggingPort(settings.loggingPort);
+		SetUDP_LogEvents(settings.logEvents);
+		SetUDP_LogWarnings(settings.logWarnings);
+		SetUDP_LogErrors(settings.logErrors);
+		SetUDP_LoggingSyslog(settings.loggingSyslog);
+	}
+	taskEXIT_CRITICAL();
+}
+
+/* JSON writer functions ---------------------------------------------------- */
+static void JSON_Begin(HTTPClient_t *pxClient, struct JSON_Writer* json,
+		const char* prefix)
+{
+	size_t size;
+
+	/* Write JSON directly to the transmit buffer of the client */
+	json->pos = GetHTML_ContentBuffer(pxClient, &size);
+	json->end = json->pos + size;
+	json->first = true;
+	JSON_AddRaw(json, prefix);
+	JSON_AddRaw(json, "{");
+}
+
+static void JSON_End(struct JSON_Writer* json)
+{
+	JSON_AddRaw(json, "}");
+}
+
+static void JSON_AddRaw(struct JSON_Writer* json, const char* str)
+{
+	while(*str)
+	{
+		if(json->pos >= json->end) return;
+		*json->pos++ = *str++;
+	}
+}
+
+static void JSON_AddKey(struct JSON_Writer* json, const char* key)
+{
+	if(json->first == false) JSON_AddRaw(json, ",");
+	json->first = false;
+
+	JSON_AddRaw(json, "\"");
+	JSON_AddRaw(json, key);
+	JSON_AddRaw(json, "\":");
+}
+
+static void JSON_AddStr(struct JSON_Writer* json,
+		const char* key, const char* str)
+{
+	char esc[3] = {'\\', 0, 0};
+
+	JSON_AddKey(json, key);
+	JSON_AddRaw(json, "\"");
+	while(*str)
+	{
+		if((*str == '"') || (*str == '\\'))
+		{
+			/* Escape special symbols */
+			esc[1] = *str;
+			JSON_AddRaw(json, esc);
+		}
+		else if((uint8_t)*str >= ' ')
+		{
+			if(json->pos >= json->end) return;
+			*json->pos++ = *str;
+		}
+		/* Control symbols are skipped */
+		str++;
+	}
+	JSON_AddRaw(json, "\"");
+}
+
+static void JSON_AddNum(struct JSON_Writer* json, const char* key, int32_t num)
+{
+	JSON_AddKey(json, key);
+	if(json->pos >= json->end) return;
+	json->pos = SetNumToStr(num, json->pos, json->end - json->pos);
+}
+
+static void JSON_AddBool(struct JSON_Writer* json, const char* key, bool val)
+{
+	JSON_AddKey(json, key);
+	JSON_AddRaw(json, val ? "true" : "false");
+}
+
+static void JSON_AddIP(struct JSON_Writer* json,
+		const char* key, uint32_t IP_Addr)
+{
+	char tmpStr[16];
+
+	FreeRTOS_inet_ntoa(IP_Addr, tmpStr);
+	JSON_AddStr(json, key, tmpStr);
+}
+
+static void JSON_AddDateTime(struct JSON_Writer* json,
+		const char* key, struct DateTime* dateTime)
+{
+	/* ISO 8601: "YYYY-MM-DDTHH:MM:SS" */
+	char tmpStr[sizeof("YYYY-MM-DDTHH:MM:SS")];
+	uint8_t fields[] = {dateTime->month, dateTime->day,
+			dateTime->hour, dateTime->minute, dateTime->second};
+	static const char separators[] = "--T::";
+
+	SetNumToStr(dateTime->year, tmpStr, 5);
+	for(uint8_t i = 0; i < sizeof(fields); i++)
+	{
+		tmpStr[4 + 3*i] = separators[i];
+		tmpStr[5 + 3*i] = (fields[i] / 10) + '0';
+		tmpStr[6 + 3*i] = (fields[i] % 10) + '0';
+	}
+	tmpStr[sizeof(tmpStr) - 1] = '\0';
+
+	JSON_AddStr(json, key, tmpStr);
+}
+
+/* JSON parser functions ---------------------------------------------------- */
+static bool JSON_NextMember(const char** str, char* key, uint16_t size)
+{
+	/* Skip start of object or separator of members */
+	JSON_SkipSpaces(str);
+	if((**str == '{') || (**str == ',')) (*str)++;
+
+	/* Get name of member */
+	JSON_SkipSpaces(str);
+	if(**str != '"') return false;
+	if(JSON_GetStr(str, key, size) == false) return false;
+
+	JSON_SkipSpaces(str);
+	if(**str != ':') return false;
+	(*str)++;
+
+	/* Set pointer to value */
+	JSON_SkipSpaces(str);
+	return true;
+}
+
+static bool JSON_GetStr(const char** str, char* dstStr, uint16_t size)
+{
+	if((**str != '"') || (size == 0)) return false;
+	(*str)++;
+
+	for(;;)
+	{
+		char ch = **str;
+		if(ch == '\0') return false;
+		(*str)++;
+
+		/* End of string */
+		if(ch == '"') break;
+
+		if(ch == '\\')
+		{
+			/* Only simple escaped symbols are supported */
+			ch = **str;
+			if(ch == '\0') return false;
+			(*str)++;
+		}
+
+		/* Store symbol, if there is a space for it and for end of string */
+		if(size <= 1) return false;
+		*dstStr++ = ch;
+		size--;
+	}
+
+	*dstStr = '\0';
+	return true;
+}
+
+static bool JSON_GetNum(const char** str, int32_t* num)
+{
+	bool negative = false;
+	int32_t res = 0;
+
+	if(**str == '-')
+	{
+		negative = true;
+		(*str)++;
+	}
+	if((**str < '0') || (**str > '9')) return false;
+
+	while((**str >= '0') && (**str <= '9'))
+	{
+		/* Check for overflow */
+		if(res > (INT32_MAX - 9) / 10) return false;
+		res = res*10 + (**str - '0');
+		(*str)++;
+	}
+
+	*num = negative ? -res : res;
+	return true;
+}
+
+static bool JSON_GetBool(const char** str, bool* val)
+{
+	const char* buf = *str;
+
+	if(ValueCmp(buf, "true"))
+	{
+		*val = true;
+		*str += sizeof("true") - 1;
+		return true;
+	}
+	if(ValueCmp(buf, "false"))
+	{
+		*val = false;
+		*str += sizeof("false") - 1;
+		return true;
+	}
+	return false;
+}
+
+static void JSON_SkipValue(const char** str)
+{
+	uint16_t level = 0;
+
+	for(;;)
+	{
+		char ch = **str;
+		if(ch == '\0') return;
+
+		if(ch == '"')
+		{
+			/* Skip string with escaped symbols */
+			for((*str)++; **str && (**str != '"'); (*str)++)
+			{
+				if((**str == '\\') && (*(*str + 1) != '\0')) (*str)++;
+			}
+			if(**str) (*str)++;
+			continue;
+		}
+
+		if((ch == '{') || (ch == '[')) level++;
+		else if((ch == '}') || (ch == ']'))
+		{
+			if(level == 0) return;
+			level--;
+		}
+		else if((ch == ',') && (level == 0)) return;
+
+		(*str)++;
+	}
+}
+
+static void JSON_SkipSpaces(const char** str)
+{
+	while((**str == ' ') || (**str == '\t') ||
+		  (**str == '\r') || (**str == '\n'))
+	{
+		(*str)++;
+	}
+}
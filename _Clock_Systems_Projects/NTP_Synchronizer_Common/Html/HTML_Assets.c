@@ -0,0 +1,66 @@
+/* Static assets of the web UI (gzip-compressed, with precomputed ETags) */
+/* This file is generated by User_Libraries/Eth_HTML/Tools/gen_static_assets.py
+ * from the "static" directories, do not edit it manually! */
+
+/* Includes ----------------------------------------------------------------- */
+#include "httpserver-netconn.h"
+
+/* Variables ---------------------------------------------------------------- */
+/* /static/common.js (214 bytes) */
+static const uint8_t asset_static_common_js[] =
+{
+	0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x4D, 0x8F, 0xC1, 0x0E, 0x82, 0x30,
+	0x10, 0x44, 0xEF, 0xFD, 0x8A, 0x89, 0x07, 0x43, 0x39, 0x40, 0x8C, 0x37, 0x09, 0xF1, 0x60, 0x3C,
+	0x18, 0x6F, 0x26, 0x7E, 0x00, 0xE2, 0x82, 0x44, 0x68, 0x9B, 0x76, 0x41, 0x89, 0xF1, 0xDF, 0x2D,
+	0xA4, 0x1A, 0x6F, 0x3B, 0x93, 0x99, 0xB7, 0xBB, 0x69, 0x8C, 0x9D, 0xEE, 0x3A, 0xAD, 0xE0, 0x4A,
+	0xDB, 0x18, 0x86, 0xAE, 0xC0, 0x37, 0xC2, 0x83, 0x2E, 0x38, 0x1F, 0x60, 0x8A, 0x9A, 0x1C, 0xE2,
+	0x54, 0x54, 0xBD, 0x2A, 0xB9, 0x99, 0x62, 0xAC, 0xCD, 0xE9, 0x48, 0x63, 0x44, 0x03, 0x4B, 0xF1,
+	0x12, 0xC0, 0x50, 0x58, 0x78, 0x81, 0x1C, 0xB3, 0x87, 0xED, 0xAC, 0x36, 0x88, 0xBC, 0x24, 0x15,
+	0x0C, 0x3F, 0x78, 0x4B, 0xF5, 0x6D, 0x2B, 0xB3, 0xD0, 0x51, 0xFA, 0x4A, 0xA1, 0x94, 0x70, 0x61,
+	0x6B, 0xFA, 0x76, 0x83, 0xC2, 0xC6, 0x07, 0x31, 0x63, 0x38, 0x71, 0xB6, 0xDC, 0xB7, 0xD4, 0xFD,
+	0x78, 0xFF, 0xCE, 0x3F, 0xB8, 0xA9, 0x42, 0xE1, 0x4E, 0xE3, 0x6E, 0x5E, 0x90, 0x63, 0xB5, 0x96,
+	0x58, 0x2E, 0x11, 0x4D, 0x0B, 0x13, 0x1E, 0x0D, 0xE5, 0xF9, 0x82, 0xE9, 0xC9, 0x0B, 0x29, 0x81,
+	0x97, 0x25, 0xEE, 0xAD, 0x42, 0x55, 0xB4, 0x8E, 0xB2, 0xB7, 0x78, 0x8B, 0xAB, 0x2E, 0xFB, 0x09,
+	0x9B, 0x68, 0xE5, 0x21, 0xC6, 0x92, 0x73, 0xFE, 0xCC, 0xEF, 0xDF, 0x99, 0xF8, 0x00, 0xFF, 0x2F,
+	0x9E, 0xDB, 0x33, 0x01, 0x00, 0x00,
+};
+
+/* /static/main.js (372 bytes) */
+static const uint8_t asset_static_main_js[] =
+{
+	0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x75, 0x52, 0x41, 0x4E, 0xC3, 0x30,
+	0x10, 0xBC, 0xE7, 0x15, 0x4B, 0x0E, 0x95, 0x5D, 0x95, 0xA4, 0x1C, 0x38, 0x45, 0xB9, 0x80, 0x7A,
+	0x00, 0x21, 0x90, 0x28, 0x1F, 0xB0, 0xE2, 0x4D, 0x63, 0x29, 0xB1, 0x2B, 0x7B, 0x93, 0x50, 0xDA,
+	0xFC, 0x9D, 0x4D, 0xD2, 0x22, 0x2A, 0xC4, 0xC5, 0xB6, 0x66, 0xC7, 0xB3, 0xB3, 0x63, 0xA7, 0x4B,
+	0x78, 0x31, 0x1D, 0x42, 0x20, 0x45, 0x6D, 0x00, 0x57, 0x02, 0x55, 0x08, 0x8D, 0x32, 0x16, 0xF6,
+	0x6A, 0x87, 0x20, 0x02, 0xFA, 0x0E, 0xFD, 0x6D, 0x40, 0x4B, 0x80, 0x1D, 0xAF, 0x01, 0x4A, 0xEF,
+	0x1A, 0x88, 0xD5, 0xDE, 0xA4, 0x33, 0x10, 0x4B, 0x58, 0xA6, 0x91, 0x29, 0x45, 0x6F, 0xAC, 0x76,
+	0x7D, 0xB2, 0x19, 0xD1, 0xAD, 0x6B, 0x7D, 0x81, 0x32, 0x3A, 0x46, 0x00, 0x9D, 0xF2, 0x80, 0x01,
+	0x72, 0xB0, 0xD8, 0xC3, 0xAF, 0xAA, 0xB8, 0x12, 0x59, 0xB1, 0x89, 0x8C, 0xD9, 0x18, 0x12, 0x67,
+	0x1B, 0x0C, 0x61, 0xEC, 0x9F, 0x43, 0xD9, 0xDA, 0x82, 0x8C, 0xB3, 0xA2, 0x91, 0x5C, 0x1C, 0xE5,
+	0xCE, 0x82, 0x5C, 0x7B, 0xDE, 0xBE, 0xBD, 0x26, 0x7B, 0xE5, 0x03, 0x8A, 0x26, 0xD1, 0x8A, 0x14,
+	0x8B, 0x68, 0xE2, 0x82, 0x76, 0x45, 0xDB, 0xB0, 0x6C, 0xB2, 0x43, 0xDA, 0xD4, 0x38, 0x1E, 0x1F,
+	0x0E, 0x4F, 0x5A, 0xC4, 0x9A, 0x62, 0x99, 0x4D, 0x1A, 0xEC, 0x17, 0x13, 0x92, 0xFF, 0x53, 0xA9,
+	0x89, 0x65, 0x42, 0xF8, 0x49, 0x8F, 0xCE, 0xD2, 0x38, 0x7E, 0x0E, 0x7C, 0xE1, 0xD7, 0x65, 0x9E,
+	0x28, 0xCF, 0xA1, 0xB5, 0x1A, 0x4B, 0x63, 0x51, 0x4B, 0xF0, 0x48, 0xAD, 0xB7, 0x59, 0x34, 0x51,
+	0xD2, 0x25, 0xBC, 0x63, 0xED, 0x94, 0x86, 0xBE, 0x72, 0x35, 0xCE, 0x71, 0x3A, 0x0B, 0x6C, 0x93,
+	0x77, 0x0F, 0xE1, 0x60, 0x8B, 0xCA, 0x3B, 0x6B, 0xBE, 0xD4, 0x38, 0xDE, 0xE5, 0x05, 0x8A, 0x4A,
+	0x59, 0x26, 0x72, 0xA0, 0xE7, 0x3E, 0x42, 0x04, 0x82, 0x9B, 0xEB, 0x46, 0x8B, 0x05, 0xCC, 0x28,
+	0x3B, 0x0A, 0x52, 0xC2, 0xE9, 0x04, 0x82, 0xE7, 0x1E, 0x61, 0x4D, 0x57, 0x9E, 0x27, 0x8A, 0x96,
+	0x52, 0x4E, 0x72, 0x73, 0x7A, 0x53, 0xC4, 0x45, 0xED, 0x38, 0xB5, 0x73, 0x16, 0x00, 0xB5, 0x2B,
+	0x26, 0x1B, 0x89, 0x9F, 0x3C, 0x5F, 0x0A, 0xC3, 0xB4, 0x86, 0x79, 0xF6, 0x30, 0x62, 0x43, 0x16,
+	0x0D, 0x11, 0xD6, 0x81, 0xBF, 0x0C, 0xD2, 0x87, 0x69, 0xD0, 0xB5, 0x24, 0x7E, 0xDE, 0x48, 0x1E,
+	0xFF, 0x0A, 0x0D, 0x2B, 0xB8, 0xBB, 0x5F, 0xAF, 0xD7, 0x2C, 0xF9, 0x0D, 0x79, 0x45, 0x9C, 0xE7,
+	0x6E, 0x02, 0x00, 0x00,
+};
+
+/* Table of assets (sorted by path for binary search!) */
+const struct HTTP_StaticAsset staticAssets[] =
+{
+	{"/static/common.js", "text/javascript", "\"db9e2fff\"",
+			asset_static_common_js, sizeof(asset_static_common_js), true},
+	{"/static/main.js", "text/javascript", "\"e79c4579\"",
+			asset_static_main_js, sizeof(asset_static_main_js), true},
+};
+const uint16_t staticAssetsNum =
+		sizeof(staticAssets) / sizeof(staticAssets[0]);
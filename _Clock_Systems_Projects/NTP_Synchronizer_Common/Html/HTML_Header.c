@@ -23,20 +23,11 @@ static const char str_hdr_2[] = "</title>\r\
   <meta http-equiv=\"expires\" content=\"0\">\r\
   <meta http-equiv=\"expires\" content=\"Tue, 01 Jan 1980 1:00:00 GMT\">\r\
   <meta http-equiv=\"pragma\" content=\"no-cache\">\r\
-  <script type=\"text/javascript\">\r\
-  function stopRKey(evt)\r\
-  {\r\
-    var evt = (evt) ? evt : ((event) ? event : null);\r\
-    var node = (evt.target) ? evt.target : \
-((evt.srcElement) ? evt.srcElement : null);\r\
-    if ((evt.keyCode == 13) && (node.type==\"text\"))  {return false;}\r\
-  }\r\
-  document.onkeypress = stopRKey;\r\
-  </script>\r\
+  <script type=\"text/javascript\" src=\"/static/common.js\"></script>\r\
 </head>\r\
 <body";
 static const char str_hdr_3[] = ">\r\
-<form action=\"\">\r\
+<form action=\"\" method=\"post\">\r\
   <font size=\"+2\">\r";
 
 static const char str_html_enum_b[] = "\
@@ -39,10 +39,11 @@ static BaseType_t Send_HTML(HTTPClient_t *pxClient)
 <pre>";
 	static const char str_end[] = "\r\r\
 <input name=\"Refresh\" value=\"Refresh status\" type=\"submit\">\r\
-</pre>";
+</pre>\r\
+<script type=\"text/javascript\" src=\"/static/main.js\"></script>";
 
 	/* Attempt to create the temporary string buffer */
-	char* tmpStr = (char*)pvPortMalloc(HTML_MAIN_TMP_BUF_LEN);
+	char* tmpStr = (char*)GetHTML_Scratch(pxClient, HTML_MAIN_TMP_BUF_LEN);
 	if(tmpStr == NULL)
 	{
 		FreeRTOS_printf(("Could not create temporary string buffer\n"));
@@ -54,25 +55,25 @@ static BaseType_t Send_HTML(HTTPClient_t *pxClient)
 
 	/* Send html page part by part */
 	/* Send header and begin of html*/
-	Send_HTML_Header(pxClient, "HTML_Main", NULL, 15);
+	Send_HTML_Header(pxClient, "HTML_Main", NULL, 0);
 	SendHTML_Block(pxClient, str_begin, sizeof(str_begin) - 1);
 
 	/* Send current local time and date --------------------------------------*/
 	static const char str_curr_date_b[] = "\r</pre>\
 RTC status:<pre>\r\
-current local date (DD.MM.YYYY): ";
+current local date (DD.MM.YYYY): <span id=\"dt\">";
 	static const char str_curr_time_b[] = "\r\
-current local time (HH.MM.SS):   ";
+current local time (HH.MM.SS):   <span id=\"tm\">";
 
 	if(RTC_GetTimeIsValide() == false)
 	{
 		/* Show invalid RTC state */
 		SendHTML_Block(pxClient, str_curr_date_b,
 				sizeof(str_curr_date_b) - 1);
-		SendHTML_Block(pxClient, "n/a\r", sizeof("n/a\r") - 1);
+		SendHTML_Block(pxClient, "n/a</span>\r", sizeof("n/a</span>\r") - 1);
 		SendHTML_Block(pxClient, str_curr_time_b,
 				sizeof(str_curr_time_b) - 1);
-		SendHTML_Block(pxClient, "n/a", sizeof("n/a") - 1);
+		SendHTML_Block(pxClient, "n/a</span>", sizeof("n/a</span>") - 1);
 	}
 	else
 	{
@@ -93,7 +94,7 @@ current local time (HH.MM.SS):   ";
 			GetSizeOfStr(tmpStr, HTML_MAIN_TMP_BUF_LEN));
 
 		/* Send day of week */
-		SendHTML_Block(pxClient, " ", sizeof(" ") - 1);
+		SendHTML_Block(pxClient, "</span> ", sizeof("</span> ") - 1);
 		switch(tmpDateTime.dayOfWeek)
 		{
 		case MONDAY:
@@ -131,6 +132,7 @@ current local time (HH.MM.SS):   ";
 		SetTimeToStr(&dt, tmpStr, HTML_MAIN_TMP_BUF_LEN);
 		SendHTML_Block(pxClient, tmpStr,
 			GetSizeOfStr(tmpStr, HTML_MAIN_TMP_BUF_LEN));
+		SendHTML_Block(pxClient, "</span>", sizeof("</span>") - 1);
 	}
 	
 	/* Show synchronization status -------------------------------------------*/
@@ -321,8 +323,8 @@ last used NTP server exchange status:        ";
 	SendHTML_Block(pxClient, tmpStr,
 		GetSizeOfStr(tmpStr, HTML_MAIN_TMP_BUF_LEN));
 
-	/* Free temporary string buffer */
-	vPortFree(tmpStr);
+	/* Release temporary string buffer */
+	ReleaseHTML_Scratch(pxClient, tmpStr);
 	
 	/* Send end of html page */
 	SendHTML_Block(pxClient, str_end, sizeof(str_end) - 1);
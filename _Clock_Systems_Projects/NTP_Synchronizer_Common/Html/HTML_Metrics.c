@@ -0,0 +1,347 @@
+/* Metrics for monitoring systems (text format of Prometheus): counters are
+ * read from statistics blocks of modules without locks */
+
+/* Includes ----------------------------------------------------------------- */
+#include <assert.h>
+#include <string.h>
+
+/* FreeRTOS includes */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "FreeRTOS_IP.h"
+#include "NetworkBufferManagement.h"
+
+#include "settings.h"
+#include "web-server.h"
+#include "HTML_Metrics.h"
+
+/* Application includes */
+#include "main_app.h"
+#include "sntp.h"
+#include "TRS_sync_proto.h"
+#include "UDP_logging.h"
+#include "event_log.h"
+
+/* Private constants -------------------------------------------------------- */
+#define METRICS_CONTENT_TYPE		"text/plain; version=0.0.4"
+
+/* Tasks of the firmware with the idle and timer ones (11 now): their states
+   are taken together in the scratch memory of the request */
+#ifndef METRICS_MAX_TASKS
+#	define METRICS_MAX_TASKS		14
+#endif /* METRICS_MAX_TASKS */
+static_assert(METRICS_MAX_TASKS * sizeof(TaskStatus_t) <=
+		ipconfigHTTP_SCRATCH_BUFFER_SIZE,
+		"states of tasks do not fit the scratch memory");
+
+/* Structures definitions --------------------------------------------------- */
+/* Text writer over the transmit buffer of the client: full buffer is sent as
+   a chunk of reply */
+struct Metrics_Writer
+{
+	HTTPClient_t* client;
+	char* buf;
+	char* pos;
+	char* end;
+	BaseType_t xRc;
+};
+
+/* Private function prototypes ---------------------------------------------- */
+static void Metrics_HTTP(struct Metrics_Writer* w);
+static void Metrics_NTP(struct Metrics_Writer* w);
+static void Metrics_TRS(struct Metrics_Writer* w);
+static void Metrics_Logging(struct Metrics_Writer* w);
+static void Metrics_Network(struct Metrics_Writer* w);
+static void Metrics_Memory(struct Metrics_Writer* w);
+static void Metrics_Tasks(struct Metrics_Writer* w);
+
+static void Metrics_Flush(struct Metrics_Writer* w);
+static void Metrics_AddRaw(struct Metrics_Writer* w, const char* str);
+static void Metrics_AddFixed(struct Metrics_Writer* w, int64_t num,
+		uint8_t decimals);
+static void Metrics_Describe(struct Metrics_Writer* w, const char* name,
+		const char* type, const char* help);
+static void Metrics_Add(struct Metrics_Writer* w, const char* name,
+		const char* type, const char* help, int64_t num, uint8_t decimals);
+
+/* Public functions --------------------------------------------------------- */
+BaseType_t Parse_Metrics(HTTPClient_t *pxClient)
+{
+	struct Metrics_Writer w;
+	size_t size;
+
+	w.client = pxClient;
+	w.buf = GetHTML_ContentBuffer(pxClient, &size);
+	w.pos = w.buf;
+	w.end = w.buf + size;
+	w.xRc = SendHTML_Header_OK_Type(pxClient, METRICS_CONTENT_TYPE);
+
+	Metrics_HTTP(&w);
+	Metrics_NTP(&w);
+	Metrics_TRS(&w);
+	Metrics_Logging(&w);
+	Metrics_Network(&w);
+	Metrics_Memory(&w);
+	Metrics_Tasks(&w);
+
+	Metrics_Flush(&w);
+	if(w.xRc < 0) return w.xRc;
+	return SendHTML_Block(pxClient, "", 0);
+}
+
+/* Private functions -------------------------------------------------------- */
+static void Metrics_HTTP(struct Metrics_Writer* w)
+{
+	const struct HTTP_ServerStats* stats = HTTP_ServerGetStats();
+	const uint32_t bounds[] = HTTP_LATENCY_BOUNDS;
+	uint32_t count = 0;
+
+	Metrics_Add(w, "http_connections_total", "counter",
+			"Accepted connections.", stats->connections, 0);
+	Metrics_Add(w, "http_connections_rejected_total", "counter",
+			"Connections over the limit of one client.", stats->rejected, 0);
+	Metrics_Add(w, "http_requests_total", "counter",
+			"Requests.", stats->requests, 0);
+	Metrics_Add(w, "http_requests_throttled_total", "counter",
+			"Requests delayed by the rate limit.", stats->throttled, 0);
+	Metrics_Add(w, "http_send_errors_total", "counter",
+			"Failed transmissions.", stats->sendErrors, 0);
+	Metrics_Add(w, "http_received_bytes_total", "counter",
+			"Received bytes.", stats->bytesReceived, 0);
+	Metrics_Add(w, "http_sent_bytes_total", "counter",
+			"Sent bytes.", stats->bytesSent, 0);
+
+	/* Buckets of histogram are cumulative */
+	Metrics_Describe(w, "http_request_duration_seconds", "histogram",
+			"Processing time of requests.");
+	for(uint16_t i = 0; i < HTTP_LATENCY_BUCKETS_NUM; i++)
+	{
+		count += stats->latency[i];
+		Metrics_AddRaw(w, "http_request_duration_seconds_bucket{le=\"");
+		if(i < HTTP_LATENCY_BUCKETS_NUM - 1)
+			Metrics_AddFixed(w, bounds[i], 3);
+		else
+			Metrics_AddRaw(w, "+Inf");
+		Metrics_AddRaw(w, "\"} ");
+		Metrics_AddFixed(w, count, 0);
+		Metrics_AddRaw(w, "\n");
+	}
+	Metrics_AddRaw(w, "http_request_duration_seconds_sum ");
+	Metrics_AddFixed(w, stats->latencySum, 3);
+	Metrics_AddRaw(w, "\nhttp_request_duration_seconds_count ");
+	Metrics_AddFixed(w, count, 0);
+	Metrics_AddRaw(w, "\n");
+}
+
+static void Metrics_NTP(struct Metrics_Writer* w)
+{
+	const struct SNTP_Stats* stats = SNTP_GetStats();
+
+	Metrics_Add(w, "ntp_requests_total", "counter",
+			"Sent requests.", stats->requests, 0);
+	Metrics_Add(w, "ntp_samples_total", "counter",
+			"Valid replies.", stats->samples, 0);
+	Metrics_Add(w, "ntp_timeouts_total", "counter",
+			"Requests without reply.", stats->timeouts, 0);
+	Metrics_Add(w, "ntp_rejected_total", "counter",
+			"Kiss-of-Death and invalid replies.", stats->rejected, 0);
+	Metrics_Add(w, "ntp_offset_seconds", "gauge",
+			"Offset of local clock at last synchronization.",
+			SNTP_GetLastSyncOffset(), 3);
+	Metrics_Add(w, "ntp_delay_seconds", "gauge",
+			"Round trip delay of last synchronization.",
+			SNTP_GetLastSyncDelay(), 3);
+	Metrics_Add(w, "ntp_jitter_seconds", "gauge",
+			"Smoothed variation of offset between samples.",
+			stats->jitter, 6);
+}
+
+static void Metrics_TRS(struct Metrics_Writer* w)
+{
+	const struct TRS_SyncProtoStats* stats = TRS_SyncProtoGetStats();
+
+	Metrics_Add(w, "trs_frames_sent_total", "counter",
+			"Frames of synchro protocol.", stats->framesSent, 0);
+	Metrics_Add(w, "trs_frames_dropped_total", "counter",
+			"Frames not sent: transmitter was busy.", stats->framesDropped, 0);
+}
+
+static void Metrics_Logging(struct Metrics_Writer* w)
+{
+	const struct UDP_LoggingStats* stats = UDP_LoggingGetStats();
+
+	Metrics_Add(w, "log_records_total", "counter",
+			"Records written to the ring.", stats->records, 0);
+	Metrics_Add(w, "log_records_dropped_total", "counter",
+			"Records lost: ring was full.", stats->dropped, 0);
+	Metrics_Add(w, "log_records_limited_total", "counter",
+			"Records dropped by rate limits of severities.", stats->limited, 0);
+	Metrics_Add(w, "log_datagrams_total", "counter",
+			"Sent datagrams of records.", stats->datagrams, 0);
+	Metrics_Add(w, "log_send_errors_total", "counter",
+			"Datagrams not sent.", stats->sendErrors, 0);
+
+	const struct EventLogStats* eventLog = EventLogGetStats();
+
+	Metrics_Add(w, "event_log_ready", "gauge",
+			"Event log in flash is written.", EventLogIsReady(), 0);
+	Metrics_Add(w, "event_log_records_total", "counter",
+			"Records appended to the event log.", eventLog->records, 0);
+	Metrics_Add(w, "event_log_writes_total", "counter",
+			"Blocks of records programmed to flash.", eventLog->writes, 0);
+	Metrics_Add(w, "event_log_erases_total", "counter",
+			"Erased sectors of the event log.", eventLog->erases, 0);
+	Metrics_Add(w, "event_log_errors_total", "counter",
+			"Failed erases and writes of the event log.", eventLog->errors, 0);
+	Metrics_Add(w, "event_log_dropped_total", "counter",
+			"Records dropped by the full event log.", eventLog->dropped, 0);
+}
+
+static void Metrics_Network(struct Metrics_Writer* w)
+{
+	const struct ETH_IF_Stats* stats = ETH_IF_GetStats();
+
+	Metrics_Add(w, "eth_dma_abnormal_interrupts_total", "counter",
+			"Abnormal interrupts of Ethernet DMA.",
+			stats->abnormalInterrupts, 0);
+	Metrics_Add(w, "eth_rx_buffer_unavailable_total", "counter",
+			"Reception was suspended: no free descriptors.",
+			stats->rxBufferUnavailable, 0);
+	Metrics_Add(w, "eth_rx_missed_frames_total", "counter",
+			"Frames missed by controller: no free descriptors.",
+			stats->rxMissedFrames, 0);
+	Metrics_Add(w, "eth_rx_fifo_overflows_total", "counter",
+			"Frames missed by overflow of Rx FIFO.",
+			stats->rxFifoOverflows, 0);
+	Metrics_Add(w, "eth_tx_descriptor_timeouts_total", "counter",
+			"Frames dropped: no free Tx descriptors.",
+			stats->txDescriptorTimeouts, 0);
+	Metrics_Add(w, "net_buffers_free", "gauge",
+			"Free network buffers.", uxGetNumberOfFreeNetworkBuffers(), 0);
+	Metrics_Add(w, "net_buffers_free_min", "gauge",
+			"Minimum of free network buffers since start.",
+			uxGetMinimumFreeNetworkBuffers(), 0);
+}
+
+static void Metrics_Memory(struct Metrics_Writer* w)
+{
+	Metrics_Add(w, "heap_free_bytes", "gauge",
+			"Free heap.", xPortGetFreeHeapSize(), 0);
+	Metrics_Add(w, "heap_free_min_bytes", "gauge",
+			"Minimum of free heap since start.",
+			xPortGetMinimumEverFreeHeapSize(), 0);
+}
+
+static void Metrics_Tasks(struct Metrics_Writer* w)
+{
+	UBaseType_t num = uxTaskGetNumberOfTasks();
+	uint32_t runTimeHz = RunTimeCounterGetHz();
+	TaskStatus_t* tasks;
+
+	/* Tasks over the maximum are told by the number: the states are
+	   skipped (or if some task was created after) */
+	Metrics_Add(w, "tasks", "gauge", "Number of tasks.", num, 0);
+	if(num > METRICS_MAX_TASKS) return;
+	tasks = GetHTML_Scratch(w->client, num * sizeof(TaskStatus_t));
+	if(tasks == NULL) return;
+	num = uxTaskGetSystemState(tasks, num, NULL);
+	if(num == 0)
+	{
+		ReleaseHTML_Scratch(w->client, tasks);
+		return;
+	}
+
+	/* Counter of run time wraps after 4 days */
+	Metrics_Describe(w, "task_cpu_seconds_total", "counter",
+			"Run time of task.");
+	for(UBaseType_t i = 0; i < num; i++)
+	{
+		Metrics_AddRaw(w, "task_cpu_seconds_total{task=\"");
+		Metrics_AddRaw(w, tasks[i].pcTaskName);
+		Metrics_AddRaw(w, "\"} ");
+		Metrics_AddFixed(w, (uint64_t)tasks[i].ulRunTimeCounter * 1000 /
+				runTimeHz, 3);
+		Metrics_AddRaw(w, "\n");
+	}
+
+	Metrics_Describe(w, "task_stack_free_min_bytes", "gauge",
+			"Minimum of free stack of task since start.");
+	for(UBaseType_t i = 0; i < num; i++)
+	{
+		Metrics_AddRaw(w, "task_stack_free_min_bytes{task=\"");
+		Metrics_AddRaw(w, tasks[i].pcTaskName);
+		Metrics_AddRaw(w, "\"} ");
+		Metrics_AddFixed(w, tasks[i].usStackHighWaterMark *
+				sizeof(StackType_t), 0);
+		Metrics_AddRaw(w, "\n");
+	}
+
+	ReleaseHTML_Scratch(w->client, tasks);
+}
+
+/* Writer functions --------------------------------------------------------- */
+static void Metrics_Flush(struct Metrics_Writer* w)
+{
+	/* After an error of transmission text is discarded */
+	if((w->pos > w->buf) && (w->xRc >= 0))
+		w->xRc = SendHTML_Block(w->client, w->buf, w->pos - w->buf);
+	w->pos = w->buf;
+}
+
+static void Metrics_AddRaw(struct Metrics_Writer* w, const char* str)
+{
+	while(*str)
+	{
+		if(w->pos >= w->end) Metrics_Flush(w);
+		*w->pos++ = *str++;
+	}
+}
+
+/* Number "num / 10^decimals" with all decimals */
+static void Metrics_AddFixed(struct Metrics_Writer* w, int64_t num,
+		uint8_t decimals)
+{
+	char tmpStr[24];
+	char* pos = tmpStr + sizeof(tmpStr);
+	bool negative = (num < 0);
+	uint64_t value = negative ? -(uint64_t)num : (uint64_t)num;
+	uint8_t digits = 0;
+
+	/* Digits are written from the end */
+	*(--pos) = '\0';
+	do
+	{
+		if((digits == decimals) && (decimals != 0)) *(--pos) = '.';
+		*(--pos) = '0' + (value % 10);
+		value /= 10;
+		digits++;
+	} while((value != 0) || (digits <= decimals));
+	if(negative) *(--pos) = '-';
+
+	Metrics_AddRaw(w, pos);
+}
+
+static void Metrics_Describe(struct Metrics_Writer* w, const char* name,
+		const char* type, const char* help)
+{
+	Metrics_AddRaw(w, "# HELP ");
+	Metrics_AddRaw(w, name);
+	Metrics_AddRaw(w, " ");
+	Metrics_AddRaw(w, help);
+	Metrics_AddRaw(w, "\n# TYPE ");
+	Metrics_AddRaw(w, name);
+	Metrics_AddRaw(w, " ");
+	Metrics_AddRaw(w, type);
+	Metrics_AddRaw(w, "\n");
+}
+
+/* Metric with one value */
+static void Metrics_Add(struct Metrics_Writer* w, const char* name,
+		const char* type, const char* help, int64_t num, uint8_t decimals)
+{
+	Metrics_Describe(w, name, type, help);
+	Metrics_AddRaw(w, name);
+	Metrics_AddRaw(w, " ");
+	Metrics_AddFixed(w, num, decimals);
+	Metrics_AddRaw(w, "\n");
+}
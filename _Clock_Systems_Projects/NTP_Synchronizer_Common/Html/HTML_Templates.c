@@ -0,0 +1,93 @@
+/* Compiled HTML templates of the web UI pages */
+/* This file is generated by User_Libraries/Eth_HTML/Tools/gen_html_templates.py
+ * from the "templates" directories, do not edit it manually! */
+
+/* Includes ----------------------------------------------------------------- */
+#include "HTML_Templates.h"
+
+/* Variables ---------------------------------------------------------------- */
+const uint8_t tplDateTimeSettings[] =
+	"\x01\x69\x00"
+	"    Date and time settings:<br>\n"
+	"  </font>\n"
+	"<pre>\n"
+	"Set time (HH:MM:SS):   <input name=\"hrs\" size=\"2\" value=\""
+	"\x12\x00"
+	"\x01\x26\x00"
+	"\">:<input name=\"mnts\" size=\"2\" value=\""
+	"\x12\x01"
+	"\x01\x27\x00"
+	"\">:<input name=\"scnds\" size=\"2\" value=\""
+	"\x12\x02"
+	"\x01\x3c\x00"
+	"\">\n"
+	"\n"
+	"Set date (DD.MM.YYYY): <input name=\"ds\" size=\"2\" value=\""
+	"\x12\x03"
+	"\x01\x27\x00"
+	"\">.<input name=\"mnths\" size=\"2\" value=\""
+	"\x12\x04"
+	"\x01\x25\x00"
+	"\">.<input name=\"yrs\" size=\"4\" value=\""
+	"\x11\x05"
+	"\x01\x03\x00"
+	"\"> "
+	"\x10\x06"
+	"\x01\x3b\x00"
+	"\n"
+	"\n"
+	"Set GMT and DST flag:  <input name=\"gmt\" size=\"2\" value=\""
+	"\x11\x07"
+	"\x01\x14\x00"
+	"\"><input name=\"dst\" "
+	"\x14\x08"
+	"\x01\x61\x00"
+	"type=\"checkbox\">\n"
+	"\n"
+	"<button name=\"b_apl\" type=\"submit\" value=\"apl_st\">Apply settings</button></pre>";
+
+const uint8_t tplServiceSettings[] =
+	"\x01\x85\x00"
+	"    Service settings:<br>\n"
+	"  </font>\n"
+	"<pre>\n"
+	"</pre>RTC settings:<pre>\n"
+	"Set RTC correction in PPM    <input name=\"rtc_cr\" size=\"2\" value=\""
+	"\x11\x00"
+	"\x01\x51\x00"
+	"\">\n"
+	"</pre>Logging settings configure:<pre>\n"
+	"Enable logging     <input name=\"enLog\" "
+	"\x14\x01"
+	"\x01\x64\x00"
+	"type=\"checkbox\">\n"
+	"\n"
+	"UDP-logging host settings:\n"
+	"logging IP address <input name=\"logIP\" size=\"8\" value=\""
+	"\x13\x02"
+	"\x01\x3b\x00"
+	"\">\n"
+	"logging port       <input name=\"logPrt\" size=\"4\" value=\""
+	"\x11\x03"
+	"\x01\x4e\x00"
+	"\">\n"
+	"\n"
+	"UDP-logging messages configure:\n"
+	"Log events         <input name=\"enLogEvt\" "
+	"\x14\x04"
+	"\x01\x3b\x00"
+	"type=\"checkbox\">\n"
+	"Log warnings       <input name=\"enLogWrn\" "
+	"\x14\x05"
+	"\x01\x3b\x00"
+	"type=\"checkbox\">\n"
+	"Log errors         <input name=\"enLogErr\" "
+	"\x14\x06"
+	"\x01\x3b\x00"
+	"type=\"checkbox\">\n"
+	"Syslog (RFC 5424)  <input name=\"enLogSys\" "
+	"\x14\x07"
+	"\x01\x61\x00"
+	"type=\"checkbox\">\n"
+	"\n"
+	"<button name=\"b_apl\" type=\"submit\" value=\"apl_st\">Apply settings</button></pre>";
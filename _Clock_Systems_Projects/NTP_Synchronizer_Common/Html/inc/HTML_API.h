@@ -0,0 +1,15 @@
+#ifndef _HTTP_API_H_
+#define _HTTP_API_H_
+
+// Includes --------------------------------------------------------------------
+#include "httpserver-netconn.h"
+
+// Public function prototypes --------------------------------------------------
+BaseType_t Parse_API_Status(HTTPClient_t *pxClient);
+BaseType_t Parse_API_Config(HTTPClient_t *pxClient);
+BaseType_t Parse_API_EventLog(HTTPClient_t *pxClient);
+BaseType_t Parse_API_Events(HTTPClient_t *pxClient);
+BaseType_t Parse_API_Firmware(HTTPClient_t *pxClient);
+void API_FirmwareBody(HTTPClient_t *pxClient, const char* data, size_t length);
+
+#endif // _HTTP_API_H_
@@ -0,0 +1,11 @@
+#ifndef _HTML_METRICS_H_
+#define _HTML_METRICS_H_
+
+// Includes --------------------------------------------------------------------
+#include "httpserver-netconn.h"
+
+// Public function prototypes --------------------------------------------------
+/* Counters of modules in text format of Prometheus */
+BaseType_t Parse_Metrics(HTTPClient_t *pxClient);
+
+#endif // _HTML_METRICS_H_
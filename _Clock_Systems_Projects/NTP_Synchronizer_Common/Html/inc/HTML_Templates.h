@@ -0,0 +1,44 @@
+/* Compiled HTML templates of the web UI pages */
+/* This file is generated by User_Libraries/Eth_HTML/Tools/gen_html_templates.py
+ * from the "templates" directories, do not edit it manually! */
+#ifndef _HTML_TEMPLATES_H_
+#define _HTML_TEMPLATES_H_
+
+/* Includes ----------------------------------------------------------------- */
+#include "html_template.h"
+
+/* Public constants --------------------------------------------------------- */
+/* Variables of DateTimeSettings template */
+enum DateTimeSettings_Vars
+{
+	TPL_DATE_TIME_SETTINGS_HOUR,
+	TPL_DATE_TIME_SETTINGS_MINUTE,
+	TPL_DATE_TIME_SETTINGS_SECOND,
+	TPL_DATE_TIME_SETTINGS_DAY,
+	TPL_DATE_TIME_SETTINGS_MONTH,
+	TPL_DATE_TIME_SETTINGS_YEAR,
+	TPL_DATE_TIME_SETTINGS_DAY_OF_WEEK,
+	TPL_DATE_TIME_SETTINGS_GMT,
+	TPL_DATE_TIME_SETTINGS_DST,
+	TPL_DATE_TIME_SETTINGS_VARS_NUM
+};
+
+/* Variables of ServiceSettings template */
+enum ServiceSettings_Vars
+{
+	TPL_SERVICE_SETTINGS_RTC_CORR,
+	TPL_SERVICE_SETTINGS_LOG_EN,
+	TPL_SERVICE_SETTINGS_LOG_IP,
+	TPL_SERVICE_SETTINGS_LOG_PORT,
+	TPL_SERVICE_SETTINGS_LOG_EVT,
+	TPL_SERVICE_SETTINGS_LOG_WRN,
+	TPL_SERVICE_SETTINGS_LOG_ERR,
+	TPL_SERVICE_SETTINGS_LOG_SYS,
+	TPL_SERVICE_SETTINGS_VARS_NUM
+};
+
+/* Variables ---------------------------------------------------------------- */
+extern const uint8_t tplDateTimeSettings[];
+extern const uint8_t tplServiceSettings[];
+
+#endif /* _HTML_TEMPLATES_H_ */
@@ -0,0 +1,20 @@
+/* Live status of the main page (server-sent events from "api/events") */
+if(window.EventSource)
+{
+  var es = new EventSource("api/events"), st;
+  es.onmessage = function(m)
+  {
+    var e = JSON.parse(m.data), dt = document.getElementById("dt");
+    if(e.t) document.getElementById("tm").textContent = e.t;
+    if(e.s === undefined) return;
+
+    /* Reload whole page on date or synchronization status change */
+    if(((st !== undefined) && (st != e.s)) || (dt && (dt.textContent != e.d)))
+    {
+      es.close();
+      location.reload();
+    }
+    st = e.s;
+  };
+}
+else setTimeout(function(){location.reload();}, 15000);
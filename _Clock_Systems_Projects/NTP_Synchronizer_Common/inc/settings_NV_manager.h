@@ -24,8 +24,6 @@ void SettingsNV_ManagerDriverInit();
 void SettingsNV_ManagerDriverProcess();
 
 #if defined (STM32F4x_FAMILY)
-bool GetBackUpNV_Memory(uint8_t* mem, uint16_t size);
-bool SetBackUpNV_Memory(uint8_t* mem, uint16_t size);
 bool GetBackUpNV_Table_1(uint8_t* mem, uint16_t offset, uint16_t size);
 bool SetBackUpNV_Table_1(uint8_t* mem, uint16_t offset, uint16_t size);
 bool GetBackUpNV_Table_2(uint8_t* mem, uint16_t offset, uint16_t size);
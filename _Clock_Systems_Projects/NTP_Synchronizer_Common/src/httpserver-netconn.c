@@ -16,42 +16,190 @@
 #include "HTML_SyncSettings.h"
 #include "HTML_DateTimeSettings.h"
 #include "HTML_ServiceSettings.h"
+#include "HTML_API.h"
+#include "HTML_Metrics.h"
 
 /* Application includes */
+#include "rtc.h"
 #include "httpserver-netconn.h"
 
+/* Constants ---------------------------------------------------------------*/
+#define HTTP_ROUTES_NUM		(sizeof(routes) / sizeof(routes[0]))
+
+/* Metrics need login, unless they are public (see settings.h) */
+#ifdef HTTP_METRICS_PUBLIC
+#	define HTTP_METRICS_AUTH	false
+#else
+#	define HTTP_METRICS_AUTH	true
+#endif /*HTTP_METRICS_PUBLIC*/
+
+/* Variables -----------------------------------------------------------------*/
+/* HTML-pages routes (keep the table sorted by path for binary search!) */
+static const struct HTTP_Route routes[] =
+{
+	{"/",							Parse_HTML_Main,
+			HTTP_ROUTE_GET | HTTP_ROUTE_POST,	true,	NULL},
+	{"/HTML_DateTimeSettings.html",	Parse_HTML_DateTimeSettings,
+			HTTP_ROUTE_GET | HTTP_ROUTE_POST,	true,	NULL},
+	{"/HTML_Main.html",				Parse_HTML_Main,
+			HTTP_ROUTE_GET | HTTP_ROUTE_POST,	true,	NULL},
+	{"/HTML_NetworkSettings.html",	Parse_HTML_NetworkSettings,
+			HTTP_ROUTE_GET | HTTP_ROUTE_POST,	true,	NULL},
+	{"/HTML_ServiceSettings.html",	Parse_HTML_ServiceSettings,
+			HTTP_ROUTE_GET | HTTP_ROUTE_POST,	true,	NULL},
+	{"/HTML_SyncSettings.html",		Parse_HTML_SyncSettings,
+			HTTP_ROUTE_GET | HTTP_ROUTE_POST,	true,	NULL},
+	{"/api/config",					Parse_API_Config,
+			HTTP_ROUTE_GET | HTTP_ROUTE_PUT,	true,	NULL},
+	{"/api/eventlog",				Parse_API_EventLog,
+			HTTP_ROUTE_GET,		true,	NULL},
+	{"/api/events",					Parse_API_Events,
+			HTTP_ROUTE_GET,		false,	NULL},
+	{"/api/firmware",				Parse_API_Firmware,
+			HTTP_ROUTE_POST,	true,	API_FirmwareBody},
+	{"/api/status",					Parse_API_Status,
+			HTTP_ROUTE_GET,		false,	NULL},
+#ifndef DISABLE_WEB_UI_LOGIN
+	{"/login",						HTML_Login,
+			HTTP_ROUTE_GET | HTTP_ROUTE_POST,	false,	NULL},
+#endif /*DISABLE_WEB_UI_LOGIN*/
+	{"/metrics",						Parse_Metrics,
+			HTTP_ROUTE_GET,		HTTP_METRICS_AUTH,	NULL},
+	{"/robots.txt",					Parse_robots,
+			HTTP_ROUTE_GET,		false,	NULL},
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static const struct HTTP_Route* FindRoute(const char* url);
+static const struct HTTP_StaticAsset* FindStaticAsset(const char* url);
+static int RouteCmp(const char* path, const char* url);
+#ifndef DISABLE_WEB_UI_LOGIN
+static void DiscardBody(HTTPClient_t *pxClient, const char* data,
+		size_t length);
+#endif /*DISABLE_WEB_UI_LOGIN*/
+
 /* Public functions ----------------------------------------------------------*/
+void HTTP_ServerInit()
+{
+	/* Per second events for the live web UI */
+	if(RTC_AddPerSecondTask(HTTP_ServerEventStreamSignal) == false)
+	{
+		FreeRTOS_printf(("Could not register HTTP server per-second task\n"));
+	}
+}
+
 BaseType_t prvOpenURL(HTTPClient_t *pxClient)
 {
-	/* Try to parse HTTP GET command */
 	BaseType_t xResult = 0;
 
-	/* At first, service all requests without logging */
-	/* Analyze for robot requests */
-	xResult = Parse_robots(pxClient);
-	if(xResult != 0) return xResult;
+	/* Static assets are public and are served directly from the flash */
+	const struct HTTP_StaticAsset* asset = FindStaticAsset(pxClient->pcUrlData);
+	if(asset != NULL)
+	{
+		if(pxClient->xCommand != ECMD_GET) return Send_405(pxClient);
+		return SendHTML_StaticAsset(pxClient, asset);
+	}
+
+	/* Wrong or unknown HTTP command */
+	const struct HTTP_Route* route = FindRoute(pxClient->pcUrlData);
+	if(route == NULL) return Send_404(pxClient);
 
 #ifndef DISABLE_WEB_UI_LOGIN
-	/* At second, try to get login state */
-	xResult = HTML_Login(pxClient);
-	if(xResult != 0) return xResult;
+	if(route->auth)
+	{
+		/* Page is available in the session of logged in client only (login
+		   form is sent otherwise) */
+		xResult = HTML_Login(pxClient);
+		if(xResult != 0) return xResult;
+	}
 #endif /*DISABLE_WEB_UI_LOGIN*/
 
-	xResult = Parse_HTML_Main(pxClient);
-	if(xResult != 0) return xResult;
+	/* Check for allowed method */
+	if((route->methods & (1 << pxClient->xCommand)) == 0)
+		return Send_405(pxClient);
 
-	xResult = Parse_HTML_DateTimeSettings(pxClient);
+	xResult = route->handler(pxClient);
 	if(xResult != 0) return xResult;
 
-	xResult = Parse_HTML_SyncSettings(pxClient);
-	if(xResult != 0) return xResult;
+	/* Page did not accept the request */
+	return Send_404(pxClient);
+}
 
-	xResult = Parse_HTML_NetworkSettings(pxClient);
-	if(xResult != 0) return xResult;
+FHTTPBodyFunction HTTP_GetBodyHandler(HTTPClient_t *pxClient)
+{
+	const struct HTTP_Route* route = FindRoute(pxClient->pcUrlData);
+	if((route == NULL) || (route->body == NULL)) return NULL;
+	if((route->methods & (1 << pxClient->xCommand)) == 0) return NULL;
 
-	xResult = Parse_HTML_ServiceSettings(pxClient);
-	if(xResult != 0) return xResult;
+#ifndef DISABLE_WEB_UI_LOGIN
+	/* Body of not logged in client is not stored (login form is sent as
+	   reply to the request) */
+	if(route->auth && (HTML_LoginSessionIsValid(pxClient) == false))
+		return DiscardBody;
+#endif /*DISABLE_WEB_UI_LOGIN*/
 
-	/* Wrong or unknown HTTP GET command */
-	return Send_404(pxClient);
+	return route->body;
+}
+
+/* Private functions ---------------------------------------------------------*/
+static const struct HTTP_Route* FindRoute(const char* url)
+{
+	int16_t first = 0;
+	int16_t last = HTTP_ROUTES_NUM - 1;
+
+	/* Binary search in the sorted routes table */
+	while(first <= last)
+	{
+		int16_t middle = (first + last) / 2;
+		int cmp = RouteCmp(routes[middle].path, url);
+
+		if(cmp == 0) return &routes[middle];
+		if(cmp < 0) first = middle + 1;
+		else last = middle - 1;
+	}
+
+	return NULL;
 }
+
+static const struct HTTP_StaticAsset* FindStaticAsset(const char* url)
+{
+	int16_t first = 0;
+	int16_t last = staticAssetsNum - 1;
+
+	/* Binary search in the sorted (by generator) assets table */
+	while(first <= last)
+	{
+		int16_t middle = (first + last) / 2;
+		int cmp = RouteCmp(staticAssets[middle].path, url);
+
+		if(cmp == 0) return &staticAssets[middle];
+		if(cmp < 0) first = middle + 1;
+		else last = middle - 1;
+	}
+
+	return NULL;
+}
+
+static int RouteCmp(const char* path, const char* url)
+{
+	for(;; path++, url++)
+	{
+		/* The path of URL ends with parameters or with end of string */
+		char ch = *url;
+		if((ch == '?') || (ch == ' ')) ch = '\0';
+
+		if(*path != ch) return (int)((uint8_t)*path) - (int)((uint8_t)ch);
+		if(ch == '\0') return 0;
+	}
+}
+
+#ifndef DISABLE_WEB_UI_LOGIN
+static void DiscardBody(HTTPClient_t *pxClient, const char* data,
+		size_t length)
+{
+	/* Body is received, but it is not stored */
+	(void) pxClient;
+	(void) data;
+	(void) length;
+}
+#endif /*DISABLE_WEB_UI_LOGIN*/
@@ -13,13 +13,18 @@
 
 /* Critical applications headers include */
 #include "web-server.h"
+#include "UDP_logging.h"
 #include "settings_NV_manager.h"
+#include "settings_registry.h"
+#include "event_log.h"
+#include "flash_access.h"
 #include "main_app.h"
 
 /* Public functions ----------------------------------------------------------*/
 void MainAppInit()
 {
 	/* Init drivers and hardware */
+	FlashAccessInit();
 	RTC_Init();
 
 	/* Init applications variables before restoring settings */
@@ -28,6 +33,9 @@ void MainAppInit()
 	SNTP_Init();
 	TRS_SyncProtoInit();
 	UI_Init();
+	/* Event log is found before logging writes to it */
+	EventLogInit();
+	UDP_LoggingInit();
 	
 	/* Init settings manager
 	 * and restore NV settings before RAM settings but after app init */
@@ -44,4 +52,8 @@ void MainAppSetDefaults()
 	SNTP_SetDefaults();
 	TRS_SyncProtoSetDefaults();
 	UI_SetDefaults();
+	UDP_LoggingSetDefaults();
+
+	/* Defaults are set without setters: store all settings */
+	SettingsRegistryChanged();
 }
@@ -5,6 +5,8 @@
 #include "settings_NV_manager.h"
 
 /* Includes ----------------------------------------------------------------- */
+#include <string.h>
+
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
 #include "task.h"
@@ -22,6 +24,8 @@
 #include "sntp.h"
 #include "TRS_sync_proto.h"
 #include "UDP_logging.h"
+#include "settings_NV_log.h"
+#include "settings_registry.h"
 
 /* Private constants -------------------------------------------------------- */
 /* FreeRTOS constants */
@@ -30,11 +34,23 @@
 #endif /*SETTINGS_MANAGER_APP_TASK_PRIORITY*/
 #define SETTINGS_MANAGER_APP_TASK_STACK_SIZE (configMINIMAL_STACK_SIZE)
 
+/* Settings are stored after one second without changes */
+#define SETTINGS_STORE_DELAY			1000
+
 /* Debug options ------------------------------------------------------------ */
 //#define DEBUG_WAIT_FOR_NETWORK_CONNECT
 //#define DEBUG_WAIT_FOR_5_SEC
 
+/* Schema version of stored settings (increased, when meaning of keys is
+   changed, stored values of previous versions are migrated):
+   0 - raw structure of the first firmware in the first sector,
+   1 - NV log with values of fixed size,
+   2 - keys of registry (strings without padding) */
+#define SETTINGS_SCHEMA_VERSION		2
+
 /* Private structures and classes definitions ------------------------------- */
+/* Settings of schema version 0: the first firmware stored the structure raw
+   to the first sector of NV memory */
 struct __attribute__ ((__packed__)) BackUpSettingsNV_Struct
 {
 	/* Network settings */
@@ -73,26 +89,59 @@ struct __attribute__ ((__packed__)) BackUpSettingsNV_Struct
 	uint16_t dataIsValide;
 };
 
+/* Migration of stored values of the version to the next one */
+struct SettingsMigration
+{
+	uint16_t version;
+	void (*migrate)();
+};
+
 /* Variables ---------------------------------------------------------------- */
 /* Handle of the application task */
 static TaskHandle_t xAppTaskHandle = NULL;
 static struct BackUpSettingsNV_Struct bkSettingsStruct;
 static volatile bool storeSettingsAndReset_MCU = false;
+/* Some keys are absent in NV memory */
+static bool storeAllSettings = true;
+/* Generation of the registry when settings were stored */
+static uint32_t storedGeneration = 0;
+
+/* Schema version read from NV memory */
+static uint16_t storedVersion = SETTINGS_SCHEMA_VERSION;
+
+/* Keys of modules (IDs are unique over all tables) */
+static const struct SettingsKeysTable* const settingsTables[] =
+{
+	&WebServerSettingsKeys,
+	&RTC_SettingsKeys,
+	&SNTP_SettingsKeys,
+	&RTC_DriverSettingsKeys,
+	&UDP_LoggingSettingsKeys,
+};
 
 /* Private function prototypes ---------------------------------------------- */
 static void AppTask();
 static void RestoreAllSettings();
 static void StoreAllSettings();
-static bool IsChangedSettings();
+static void MigrateRawStructure();
+
+/* Migrations in order of versions (version 1 is read as version 2) */
+static const struct SettingsMigration settingsMigrations[] =
+{
+	{0, MigrateRawStructure},
+};
 
 /* Public functions --------------------------------------------------------- */
 void SettingsNV_ManagerInit()
 {
 	/* Init driver */
 	SettingsNV_ManagerDriverInit();
+	SettingsRegistryInit(settingsTables,
+			sizeof(settingsTables) / sizeof(settingsTables[0]));
 	
 	/* Restore settings before RAM settings but after app init */
 	RestoreAllSettings();
+	storedGeneration = SettingsRegistryGetGeneration();
 
 	/* Create application task */
 	if(xTaskCreate(AppTask, "SettingsNV_Manager",
@@ -102,11 +151,15 @@ void SettingsNV_ManagerInit()
 		FreeRTOS_printf(("Could not create SettingsNV_Manager task\n"));
 		return;
 	}
+
+	/* Setters of settings wake up the task */
+	SettingsRegistrySetListener(xAppTaskHandle);
 }
 
 void StoreSettingsAndReset_MCU()
 {
 	storeSettingsAndReset_MCU = true;
+	if(xAppTaskHandle != NULL) xTaskNotifyGive(xAppTaskHandle);
 }
 
 /* Private functions -------------------------------------------------------- */
@@ -120,78 +173,86 @@ void StoreSettingsAndReset_MCU()
 static void AppTask()
 {
 #ifdef DEBUG_WAIT_FOR_5_SEC
-	TickType_t xTimeOut;
-	xTimeOut = xTaskGetTickCount();
+	vTaskDelay(5000);
 #endif /*DEBUG_WAIT_FOR_5_SEC*/
 
-	for(;;)
-	{
-		bool check = true;
 #ifdef DEBUG_WAIT_FOR_NETWORK_CONNECT
-		if(FreeRTOS_IsNetworkUp() == pdFALSE) check = false;
+	while(FreeRTOS_IsNetworkUp() == pdFALSE) vTaskDelay(1000);
 #endif /*DEBUG_WAIT_FOR_NETWORK_CONNECT*/
 
-#ifdef DEBUG_WAIT_FOR_5_SEC
-		if((xTaskGetTickCount() - xTimeOut) < 5000) check = false;
-#endif /*DEBUG_WAIT_FOR_5_SEC*/
-
-		if(check)
+	for(;;)
+	{
+		/* Keys, which are absent in NV memory, changed settings or request
+		   of reset */
+		if(storeAllSettings || storeSettingsAndReset_MCU ||
+		   (SettingsRegistryGetGeneration() != storedGeneration))
 		{
-			/* Check valid-data properties */
-			if(bkSettingsStruct.dataIsValide != 0xA5A5)
-			{
-				bkSettingsStruct.dataIsValide = 0xA5A5;
-				StoreAllSettings();
-			}
-			else if(IsChangedSettings())
+			/* Wait until settings are not changed for the delay, so a page
+			   with several settings is stored once */
+			if(storeSettingsAndReset_MCU == false)
 			{
-				/* Add one second delay before store settings */
-				if(storeSettingsAndReset_MCU == false) vTaskDelay(1000);
-				StoreAllSettings();
+				while(ulTaskNotifyTake(pdTRUE,
+						pdMS_TO_TICKS(SETTINGS_STORE_DELAY)) != 0);
 			}
 
-			/* Additional checking flag "storeSettingsAndReset_MCU" */
-			if(storeSettingsAndReset_MCU)
-			{
-				storeSettingsAndReset_MCU = false;
-
-				/* Reset MCU */
-				SoftResetCPU();
-			}
+			/* Changes after this point trigger the next storing */
+			storeAllSettings = false;
+			storedGeneration = SettingsRegistryGetGeneration();
+			StoreAllSettings();
 		}
 
-		/* Wait for next cycle (every second) */
-		vTaskDelay(1000);
+		/* Sleep until settings are changed */
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
 	}
 }
 
 static void RestoreAllSettings()
 {
-	uint8_t* arr = (uint8_t*) &bkSettingsStruct;
-
 #if defined (STM32F4x_FAMILY)
-	if(GetBackUpNV_Memory(arr, sizeof(bkSettingsStruct)) == false)
-#endif /*STM32F1x_FAMILY*/
+	uint16_t version = 0;
+	uint16_t restored = 0;
+
+	/* Raw structure of version 0 is taken before the log formats NV
+	   memory */
+	memcpy(&bkSettingsStruct, SettingsNV_DriverGetSector(0),
+			sizeof(bkSettingsStruct));
+	if(SettingsNV_LogInit())
 	{
-		/* Some wrong with data size: reset valid-data properties */
-		bkSettingsStruct.dataIsValide = 0;
+		/* Log of version 1 has no key of version */
+		if(SettingsNV_LogRead(SETTINGS_KEY_SCHEMA_VERSION, &version,
+				sizeof(version)) != sizeof(version)) version = 1;
+
+		/* Absent keys keep default settings of applications */
+		restored = SettingsRegistryRestore();
 	}
 
-	/* Check valid-data properties */
-	if(bkSettingsStruct.dataIsValide != 0xA5A5)
+	/* Stored values of previous versions are converted */
+	for(uint16_t i = 0; i < sizeof(settingsMigrations) /
+			sizeof(settingsMigrations[0]); i++)
 	{
-		/* Data is invalid */
-		return;
+		if(version <= settingsMigrations[i].version)
+			settingsMigrations[i].migrate();
 	}
 
-	/* If need, validate data before restoring */
+	/* Version of newer firmware is kept: its keys are stored in the log */
+	storedVersion = (version > SETTINGS_SCHEMA_VERSION) ?
+			version : SETTINGS_SCHEMA_VERSION;
+	storeAllSettings = (version != storedVersion) ||
+			(restored != SettingsRegistryGetKeysNum());
+#endif /*STM32F4x_FAMILY*/
+}
+
+static void MigrateRawStructure()
+{
+	/* Nothing to migrate: default settings are kept */
+	if(bkSettingsStruct.dataIsValide != 0xA5A5) return;
+
 	/* Network settings */
 	currProtocolType = bkSettingsStruct.protocolType;
 	staticIP_Addr = bkSettingsStruct.IP_Addr;
 	staticNetMask = bkSettingsStruct.netMask;
 	staticIP_GW = bkSettingsStruct.IP_GW;
 	staticIP_DNS = bkSettingsStruct.IP_DNS;
-	//WebServer_ApplyNetworkSettings();
 
 	/* Login and password for UI */
 	SetLogin(bkSettingsStruct.login);
@@ -228,48 +289,17 @@ static void StoreAllSettings()
 	if(storingChanges) return;
 	storingChanges = true;
 
-	taskENTER_CRITICAL();
-	{
-		/* Network settings */
-		bkSettingsStruct.protocolType = currProtocolType;
-		bkSettingsStruct.IP_Addr = staticIP_Addr,
-		bkSettingsStruct.netMask = staticNetMask,
-		bkSettingsStruct.IP_GW = staticIP_GW;
-		bkSettingsStruct.IP_DNS = staticIP_DNS;
-
-		/* Login and password for UI */
-		SetValue(GetLogin(), bkSettingsStruct.login, HTML_LOGIN_MAX_LEN);
-		SetValue(GetPassword(), bkSettingsStruct.password, HTML_PASSW_MAX_LEN);
-
-		/* Date and time settings */
-		bkSettingsStruct.RTC_GMT = RTC_GetGMT();
-		bkSettingsStruct.RTC_DST = RTC_GetDST();
-
-		/* NTP settings */
-		bkSettingsStruct.SNTP_SyncEnabled = SNTP_GetSyncEnabled();
-		bkSettingsStruct.SNTP_SyncPeriod = SNTP_GetSyncPeriod();
-		bkSettingsStruct.SNTP_StartupDelay = SNTP_GetStartupDelay();
-
-		/* Service settings (do not reset with other settings) ---------------*/
-		/* RTC correction functions */
-		RTC_DriverGetCorrection(&bkSettingsStruct.RTC_DriverAddedPulses,
-				&bkSettingsStruct.RTC_DriverPulsesValue);
-
-		/* Logging settings */
-		bkSettingsStruct.loggingEnable = GetUDP_LoggingEnable();
-		bkSettingsStruct.loggingIP_Addr = GetUDP_LoggingIP_Addr();
-		bkSettingsStruct.loggingPort = GetUDP_LoggingPort();
-		bkSettingsStruct.logEvents = GetUDP_LogEvents();
-		bkSettingsStruct.logWarnings = GetUDP_LogWarnings();
-		bkSettingsStruct.logErrors = GetUDP_LogErrors();
-
-		uint8_t* arr = (uint8_t*) &bkSettingsStruct;
-
 #if defined (STM32F4x_FAMILY)
-		SetBackUpNV_Memory(arr, sizeof(bkSettingsStruct));
-#endif /*STM32F1x_FAMILY*/
-	}
-	taskEXIT_CRITICAL();
+	/* Only changed keys are appended to the log, they are committed together
+	   with the version: after power failure the previous settings are read */
+	SettingsNV_LogBegin();
+	if(SettingsRegistryStore() &&
+	   SettingsNV_LogWrite(SETTINGS_KEY_SCHEMA_VERSION, &storedVersion,
+			sizeof(storedVersion)))
+		SettingsNV_LogCommit();
+	else
+		SettingsNV_LogRollback();
+#endif /*STM32F4x_FAMILY*/
 
 	if(storeSettingsAndReset_MCU)
 	{
@@ -281,48 +311,3 @@ static void StoreAllSettings()
 
 	storingChanges = false;
 }
-
-static bool IsChangedSettings()
-{
-	/* Network settings */
-	if(bkSettingsStruct.protocolType != currProtocolType) return true;
-	if(bkSettingsStruct.IP_Addr != staticIP_Addr) return true;
-	if(bkSettingsStruct.netMask != staticNetMask) return true;
-	if(bkSettingsStruct.IP_GW != staticIP_GW) return true;
-	if(bkSettingsStruct.IP_DNS != staticIP_DNS) return true;
-
-	/* Login and password for UI */
-	if(ValueCmp(GetLogin(), bkSettingsStruct.login) == false) return true;
-	if(ValueCmp(GetPassword(), bkSettingsStruct.password) == false) return true;
-
-	/* Date and time settings */
-	if(bkSettingsStruct.RTC_GMT != RTC_GetGMT()) return true;
-	if(bkSettingsStruct.RTC_DST != RTC_GetDST()) return true;
-
-	/* NTP settings */
-	if(bkSettingsStruct.SNTP_SyncEnabled != SNTP_GetSyncEnabled())
-		return true;
-	if(bkSettingsStruct.SNTP_SyncPeriod != SNTP_GetSyncPeriod())
-		return true;
-	if(bkSettingsStruct.SNTP_StartupDelay != SNTP_GetStartupDelay())
-		return true;
-
-	/* Service settings (do not reset with other settings) -------------------*/
-	/* RTC correction functions */
-	uint8_t addedPulses;
-	uint32_t pulsesValue;
-	RTC_DriverGetCorrection(&addedPulses, &pulsesValue);
-	if(bkSettingsStruct.RTC_DriverAddedPulses != addedPulses) return true;
-	if(bkSettingsStruct.RTC_DriverPulsesValue != pulsesValue) return true;
-
-	/* Logging settings */
-	if(bkSettingsStruct.loggingEnable != GetUDP_LoggingEnable()) return true;
-	if(bkSettingsStruct.loggingIP_Addr != GetUDP_LoggingIP_Addr()) return true;
-	if(bkSettingsStruct.loggingPort != GetUDP_LoggingPort()) return true;
-	if(bkSettingsStruct.logEvents != GetUDP_LogEvents()) return true;
-	if(bkSettingsStruct.logWarnings != GetUDP_LogWarnings()) return true;
-	if(bkSettingsStruct.logErrors != GetUDP_LogErrors()) return true;
-
-	/* Nothing changes */
-	return false;
-}
@@ -16,8 +16,17 @@ enum TRS_SyncProtoCommState
 	PRES_SINHR_WITH_PC
 };
 
+/* Counters of transmission (since start), they are only changed by the task
+   of the protocol */
+struct TRS_SyncProtoStats
+{
+	uint32_t framesSent;
+	uint32_t framesDropped;		/* Transmitter was busy */
+};
+
 /* Public function prototypes ----------------------------------------------- */
 void TRS_SyncProtoInit();
 void TRS_SyncProtoSetDefaults();
+const struct TRS_SyncProtoStats* TRS_SyncProtoGetStats();
 
 #endif /* _TRS_SYNC_PROTO_H_ */
@@ -32,10 +32,23 @@ struct NTP_ServerSettings
 	char NTP[0xFF];
 };
 
+/* Counters of synchronization (since start): they are only changed by the
+   SNTP task, readers get them without locks */
+struct SNTP_Stats
+{
+	uint32_t requests;
+	uint32_t samples;		/* Valid replies */
+	uint32_t timeouts;
+	uint32_t rejected;		/* Kiss-of-Death and invalid replies */
+	uint32_t jitter;		/* Smoothed variation of offset between samples, us */
+};
+
 /* Public variables --------------------------------------------------------- */
 extern struct NTP_ServerSettings NTP_Servers[];
 extern enum NTP_RequestStatus lastNTP_RequestStatus;
 extern uint8_t sntpRequestedServer;
+/* Keys of NTP settings (IDs 10..12) */
+extern const struct SettingsKeysTable SNTP_SettingsKeys;
 
 /* Public function prototypes ----------------------------------------------- */
 void SNTP_Init();
@@ -44,7 +57,11 @@ void SNTP_SetDefaults();
 
 bool SNTP_GetLastSyncTime(struct DateTime* dateTime);
 bool SNTP_SyncNow();
+/* Offset of local clock and round trip delay of last synchronization, ms */
+int32_t SNTP_GetLastSyncOffset();
+uint32_t SNTP_GetLastSyncDelay();
 enum NTP_TimeStatus GetNTP_TimeStatus();
+const struct SNTP_Stats* SNTP_GetStats();
 
 /* Settings functions */
 bool SNTP_GetSyncEnabled();
@@ -53,6 +70,8 @@ uint32_t SNTP_GetSyncPeriod();
 void SNTP_SetSyncPeriod(uint32_t seconds);
 uint32_t SNTP_GetStartupDelay();
 void SNTP_SetStartupDelay(uint32_t seconds);
+/* Server of the list (index < QUANT_NTP_SERVERS), name is truncated */
+void SNTP_SetServer(uint8_t index, const char* name, bool enabled);
 
 /* Functions, which can be overriden */
 void SNTP_SetSystemCounter(uint32_t counter);
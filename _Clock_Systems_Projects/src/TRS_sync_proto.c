@@ -87,6 +87,7 @@ static SemaphoreHandle_t xNewTimeEventWakeupSem = NULL;
 
 /* For transmitting answer's bytes */
 static uint8_t transBuff[DATA_PACKAGE_SIZE_MAX];
+static struct TRS_SyncProtoStats trsStats;
 
 /* Private function prototypes ---------------------------------------------- */
 static void TRS_SyncProtoTask();
@@ -138,6 +139,11 @@ void TRS_SyncProtoSetDefaults()
 
 }
 
+const struct TRS_SyncProtoStats* TRS_SyncProtoGetStats()
+{
+	return &trsStats;
+}
+
 /* Private functions ---------------------------------------------------------*/
 static void TRS_SyncProtoTask()
 {
@@ -196,7 +202,8 @@ static void SendCmd(uint8_t* pointer)
 			(*pointer) - TRS_SNC_PRT_HEADER_SIZE;
 	uint8_t crc = CheckCRC(&transBuff[1], (*pointer) - 1);
 	transBuff[(*pointer)++] = crc;
-	TRS_SyncProtoDriverSendTX_Buff(transBuff, *pointer);
+	if(TRS_SyncProtoDriverSendTX_Buff(transBuff, *pointer)) trsStats.framesSent++;
+	else trsStats.framesDropped++;
 }
 
 static void GetHeader(uint8_t* pointer)
@@ -20,6 +20,8 @@
 #include "settings.h"
 #include "httpserver-netconn.h"
 #include "sntp.h"
+#include "settings_registry.h"
+#include "UDP_logging.h"
 
 /* Private constants ---------------------------------------------------------*/
 /* FreeRTOS constants */
@@ -68,6 +70,13 @@
 #	define SNTP_RECV_TIMEOUT          	3000
 #endif
 
+/* Erase of the event log (it stalls CPU up to 2 s) is not started, when the
+   request is due within the guard time or the reply is waited: the stall
+   would be measured as the delay of the reply. Milliseconds */
+#ifndef SNTP_ERASE_GUARD_TIME
+#	define SNTP_ERASE_GUARD_TIME		3000
+#endif /*SNTP_ERASE_GUARD_TIME*/
+
 #ifndef SNTP_ACTUAL_TIME_TIMEOUT
 #	define SNTP_ACTUAL_TIME_TIMEOUT 	(5*60)
 #endif /*SNTP_ACTUAL_TIME_TIMEOUT*/
@@ -175,6 +184,9 @@ static Socket_t xUDPSocket = NULL;
 
 /* NTP task timeout */
 static uint32_t ntpTimeout = 0;
+/* Next action of the task (the status above is reset, when it is taken) */
+static volatile enum SNTP_status ntpPendingStatus = SNTP_StatusSendRequest;
+static volatile TickType_t xNextActionTime;
 
 /* NTP state variables */
 static enum SNTP_status ntpStatus;
@@ -186,6 +198,10 @@ static TickType_t xActualTimer;
 static uint32_t lastSyncTime;
 static bool lastSyncTimeIsValide = false;
 static enum NTP_TimeStatus timeStatus;
+static TickType_t xRequestSentTime;
+static int32_t lastSyncOffset;
+static uint32_t lastSyncDelay;
+static struct SNTP_Stats sntpStats;
 uint8_t sntpRequestedServer;
 enum NTP_RequestStatus lastNTP_RequestStatus;
 
@@ -292,6 +308,9 @@ void SNTP_SetDefaults()
 	NTP_Servers[2].enabled = true;
 	SetValue("192.168.0.1", NTP_Servers[3].NTP, sizeof(NTP_Servers[2].NTP));
 	NTP_Servers[3].enabled = false;
+
+	/* Variables were set without setters */
+	SettingsRegistryChanged();
 }
 
 bool SNTP_GetLastSyncTime(struct DateTime* dateTime)
@@ -327,6 +346,21 @@ bool SNTP_SyncNow()
 	return true;
 }
 
+int32_t SNTP_GetLastSyncOffset()
+{
+	return lastSyncOffset;
+}
+
+uint32_t SNTP_GetLastSyncDelay()
+{
+	return lastSyncDelay;
+}
+
+const struct SNTP_Stats* SNTP_GetStats()
+{
+	return &sntpStats;
+}
+
 enum NTP_TimeStatus GetNTP_TimeStatus()
 {
 	/* Check for time status */
@@ -343,7 +377,9 @@ bool SNTP_GetSyncEnabled()
 void SNTP_SetSyncEnabled(bool enabled)
 {
 	/* Store value */
+	bool changed = (NTP_SyncEnabled != enabled);
 	NTP_SyncEnabled = enabled;
+	if(changed) SettingsRegistryChanged();
 	
 	if(enabled == false) 
 	{
@@ -379,7 +415,9 @@ void SNTP_SetSyncPeriod(uint32_t seconds)
 	if(seconds > 24*3600) seconds = 24*3600;
 	
 	/* Store value */
+	if(syncPeriod == seconds) return;
 	syncPeriod = seconds;
+	SettingsRegistryChanged();
 	
 	/* Update timeout */
 	if(xUDPSocket != NULL) 
@@ -398,7 +436,54 @@ void SNTP_SetStartupDelay(uint32_t seconds)
 	if(seconds > 24*3600) seconds = 24*3600;
 
 	/* Store value */
+	if(startupDelay == seconds) return;
 	startupDelay = seconds;
+	SettingsRegistryChanged();
+}
+
+void SNTP_SetServer(uint8_t index, const char* name, bool enabled)
+{
+	struct NTP_ServerSettings* server;
+
+	if(index >= QUANT_NTP_SERVERS) return;
+	server = &NTP_Servers[index];
+
+	/* Store value */
+	if(	(server->enabled == enabled) &&
+		(strncmp(server->NTP, name, sizeof(server->NTP) - 1) == 0)) return;
+	server->enabled = enabled;
+	SetValue(name, server->NTP, sizeof(server->NTP) - 1);
+	server->NTP[sizeof(server->NTP) - 1] = '\0';
+	SettingsRegistryChanged();
+}
+
+/* Settings keys */
+SETTINGS_ACCESSORS(SyncEnabled, bool, SNTP_GetSyncEnabled, SNTP_SetSyncEnabled)
+SETTINGS_ACCESSORS(SyncPeriod, uint32_t, SNTP_GetSyncPeriod, SNTP_SetSyncPeriod)
+SETTINGS_ACCESSORS(StartupDelay, uint32_t, SNTP_GetStartupDelay,
+		SNTP_SetStartupDelay)
+
+static const struct SettingsKey SNTP_Keys[] =
+{
+	SETTINGS_KEY_BOOL(10, SyncEnabled, true),
+	SETTINGS_KEY_UINT(11, SyncPeriod, uint32_t, 20, 24*3600,
+			DEFAULT_NTP_SYNC_PERIOD),
+	SETTINGS_KEY_UINT(12, StartupDelay, uint32_t, 0, 24*3600,
+			DEFAULT_NTP_STARTUP_DELAY),
+};
+const struct SettingsKeysTable SNTP_SettingsKeys =
+		SETTINGS_KEYS_TABLE(SNTP_Keys);
+
+/* Event log is erased between requests (see SNTP_ERASE_GUARD_TIME) */
+bool UDP_LoggingEraseIsAllowed()
+{
+	TickType_t now = xTaskGetTickCount();
+
+	if((xSNTP_WorkTaskHandle == NULL) || (NTP_SyncEnabled == false))
+		return true;
+	if(ntpPendingStatus == SNTP_StatusTryNextServer) return false;
+	return (int32_t) (xNextActionTime - now) >
+			(int32_t) pdMS_TO_TICKS(SNTP_ERASE_GUARD_TIME);
 }
 
 __attribute__((weak)) void SNTP_RTC_SetSystemCounter(uint32_t counter)
@@ -467,6 +552,7 @@ static void xSNTP_WorkTask(void *pvParameters)
 	
 	/* Send first request after startup delay */
 	timeout = startupDelay * 1000;
+	xNextActionTime = xTaskGetTickCount() + pdMS_TO_TICKS(timeout);
 	
 	/* Select first NTP server */
 	SNTP_SelectFirstServer();
@@ -568,6 +654,29 @@ static void SyncTimeWithTimestamp(uint32_t *receive_timestamp)
 	/* @todo: if MSB is 1, SNTP time is 2036-based! */
 	uint32_t s = (FreeRTOS_htonl(receive_timestamp[0]) - DIFF_SEC_1900_1970);
 
+	/* Estimate round trip delay and offset of local clock (in ms) */
+	uint32_t localSec = s;
+	uint16_t localMs = 0;
+	RTC_GetSystemCounterWithTicks(&localSec, &localMs);
+	lastSyncDelay = (xTaskGetTickCount() - xRequestSentTime) *
+			portTICK_PERIOD_MS;
+	int64_t offset = ((int64_t)s - localSec) * 1000 +
+			(FreeRTOS_htonl(receive_timestamp[1]) / 4294967) +
+			(lastSyncDelay / 2) - localMs;
+	if(offset > INT32_MAX) offset = INT32_MAX;
+	if(offset < INT32_MIN) offset = INT32_MIN;
+
+	/* Jitter is smoothed difference of successive offsets (as RFC 3550) */
+	if(sntpStats.samples > 0)
+	{
+		int64_t diff = (offset - lastSyncOffset) * 1000;
+		if(diff < 0) diff = -diff;
+		if(diff > INT32_MAX) diff = INT32_MAX;
+		sntpStats.jitter += (diff - (int64_t)sntpStats.jitter) / 16;
+	}
+	sntpStats.samples++;
+	lastSyncOffset = (int32_t)offset;
+
 #ifdef SNTP_SET_ACCURATE_TIME
 	uint32_t ms = FreeRTOS_htonl(receive_timestamp[1])/4294967;
 	s += ms / 1000;
@@ -639,6 +748,8 @@ static void SNTP_TryNextServer(void* arg)
 	else
 	{
 		/* Store request status */
+		sntpStats.timeouts++;
+		UDP_LOG_WARNING("NTP: no reply from server %u", pCurrNTP_Serv);
 		taskENTER_CRITICAL(); 
 		{
 			/* Store request status */
@@ -802,6 +913,8 @@ timestamp in response\n"));
 		taskEXIT_CRITICAL(); 
 		
 		/* Kiss-of-death packet. Use another server or increase UPDATE_DELAY. */
+		sntpStats.rejected++;
+		UDP_LOG_WARNING("NTP: Kiss-of-Death from server %u", pCurrNTP_Serv);
 		SNTP_TryNextServer(NULL);
 	} 
 	else 
@@ -811,6 +924,11 @@ timestamp in response\n"));
 		sntpRequestedServer = pCurrNTP_Serv;
 		
 		/* Another error, try the same server again */
+		sntpStats.rejected++;
+		/* Bad input of network is not a fault of the device: it is not
+		   logged as an error, which is programmed to flash at once */
+		UDP_LOG_WARNING("NTP: invalid reply %d from server %u", result,
+				pCurrNTP_Serv);
 		SNTP_MakeRetryTimeout(NULL);
 	}
 							   
@@ -834,6 +952,8 @@ static void SNTP_SendRequest(uint32_t* server_addr)
 	xAddress.sin_port = FreeRTOS_htons(SNTP_PORT);
 	FreeRTOS_sendto(xUDPSocket, (void*)&sntpmsg, sizeof(sntpmsg), 0, 
 					&xAddress, sizeof(xAddress));
+	xRequestSentTime = xTaskGetTickCount();
+	sntpStats.requests++;
 	
 	/* Set up receive timeout: try next server or retry on timeout */
 	SetSNTP_TaskStatus(SNTP_StatusTryNextServer, SNTP_RECV_TIMEOUT);
@@ -882,6 +1002,8 @@ static void SetSNTP_TaskStatus(enum SNTP_status status, uint32_t timeout)
 	{
 		ntpStatus = status;
 		ntpTimeout = timeout;
+		ntpPendingStatus = status;
+		xNextActionTime = xTaskGetTickCount() + pdMS_TO_TICKS(timeout);
 	}
 	taskEXIT_CRITICAL(); 	
 	